@@ -25,10 +25,6 @@
 
 #include "compact.h"
 
-#ifdef HAVE_OMP_H
-    #include <omp.h>
-#endif
-
 /** \file compact.c
 
    Sediment compaction
@@ -45,6 +41,106 @@ compact_error_quark(void)
     return g_quark_from_static_string("compact-error-quark");
 }
 
+typedef struct {
+    double* c;          ///< Compressibility of each grain type
+    double* rho_grain;  ///< Grain density of each grain type
+    double* rho_max;    ///< Maximum density of each grain type
+    double* rho;        ///< Saturated density of each grain type
+}
+Compact_sediment;
+
+static Compact_sediment*
+_compact_sediment_new(void)
+{
+    Compact_sediment* sed = eh_new(Compact_sediment, 1);
+
+    sed->c         = sed_sediment_property(NULL, &sed_type_compressibility);
+    sed->rho_grain = sed_sediment_property(NULL, &sed_type_rho_grain);
+    sed->rho_max   = sed_sediment_property(NULL, &sed_type_rho_max);
+    sed->rho       = sed_sediment_property(NULL, &sed_type_rho_sat);
+
+    return sed;
+}
+
+static Compact_sediment*
+_compact_sediment_destroy(Compact_sediment* sed)
+{
+    if (sed) {
+        eh_free(sed->c);
+        eh_free(sed->rho_grain);
+        eh_free(sed->rho_max);
+        eh_free(sed->rho);
+        eh_free(sed);
+    }
+
+    return NULL;
+}
+
+/* Compact a column using sediment properties and work arrays (each at least
+   as long as the column) supplied by the caller.
+*/
+static void
+_compact_column(Sed_column s, const Compact_sediment* sed,
+    double* load_eff, double* load, double* p)
+{
+    const gint n_grains = sed_sediment_env_n_types();
+    const gint col_len  = sed_column_len(s);
+
+    { /* Calculate the effective load of the overlying sediment. */
+        gint  i;
+
+        sed_column_load(s, 0, -1, load);
+        sed_column_pressure(s, 0, -1, p);
+
+        for (i = 0; i < col_len; i++) {
+            load_eff[i] = load[i] - p[i];
+
+            if (load_eff[i] < 0) {
+                load_eff[i] = 0.;
+            }
+        }
+    }
+
+    { /* Calculate the densities that the sediment should be. */
+        gint i, n;
+        Sed_cell this_cell;
+        double t_new;
+        double rho_new;
+        double t_0;
+        const double rho_sea_water = sed_rho_sea_water();
+
+        for (i = col_len - 1; i >= 0 ; i--) {
+            /* From the top of the column to the bottom. */
+
+            this_cell = sed_column_nth_cell(s, i);
+
+            for (n = 0, t_new = 0. ; n < n_grains ; n++) {
+                /* Compact each grain type. */
+
+                t_0 = sed_cell_sediment_volume(this_cell)
+                    * sed_cell_fraction(this_cell, n);
+                rho_new = sed->rho_max[n]
+                    + (sed->rho[n] - sed->rho_max[n]) / exp(sed->c[n] * load_eff[i]);
+
+                t_new += t_0 * (sed->rho_grain[n] - rho_sea_water)
+                    / (rho_new - rho_sea_water);
+
+                if (t_new < 0) {
+                    t_new = 0;
+                    eh_require_not_reached();
+                }
+
+            }
+
+            // If the new thickness is greater than the current thickness, we
+            // don't do anything.  In this case overlying sediment has been eroded.
+            if (t_new < sed_cell_size(this_cell)) {
+                sed_column_compact_cell(s, i, t_new);
+            }
+        }
+    }
+}
+
 /** Compact a column of sediment
 
 Compact a column of sediment.  The amount that a cell of sediment
@@ -78,94 +174,47 @@ compact(Sed_column s)
     //if ( s || sed_column_len(s)<2 )
     if (s && sed_column_len(s) > 2) {
         /* There is a column with overlying load; compact it! */
-        //const double hydro_static = sed_column_water_pressure( s );
-        const gint n_grains = sed_sediment_env_n_types();
-        const gint col_len  = sed_column_len(s);
-        double*    load_eff = eh_new0(double, col_len);
-
-        eh_require(load_eff);
-
-        { /* Calculate the effective load of the overlying sediment. */
-            gint  i;
-            double* load = sed_column_load(s, 0, -1, NULL);
-            double* p    = sed_column_pressure(s, 0, -1, NULL);
-
-            for (i = 0; i < col_len; i++) {
-                load_eff[i] = load[i] - p[i];
-
-                if (load_eff[i] < 0) {
-                    load_eff[i] = 0.;
-                }
-            }
+        const gint col_len    = sed_column_len(s);
+        Compact_sediment* sed = _compact_sediment_new();
+        double* load_eff      = eh_new0(double, col_len);
+        double* load          = eh_new0(double, col_len);
+        double* p             = eh_new0(double, col_len);
 
-            /*
-                     for (i=sed_column_len(s)-1; i>=0; --i)
-                     {
-                        p = sed_cell_pressure( sed_column_nth_cell( s , i ) );
+        _compact_column(s, sed, load_eff, load, p);
 
-                        load_eff[i] = load[i] - p;
-
-                        if ( load_eff[i] < 0 )
-                           load_eff[i] = 0.;
-                     }
-            */
-            eh_free(p);
-            eh_free(load);
-        }
-
-        { /* Calculate the densities that the sediment should be. */
-            gint i, n;
-            Sed_cell this_cell;
-            double t_new;
-            double* c         = sed_sediment_property(NULL,
-                    &sed_type_compressibility);
-            double* rho_grain = sed_sediment_property(NULL, &sed_type_rho_grain);
-            double* rho_max   = sed_sediment_property(NULL, &sed_type_rho_max);
-            double* rho       = sed_sediment_property(NULL, &sed_type_rho_sat);
-            double rho_new;
-            double t_0;
-            const double rho_sea_water = sed_rho_sea_water();
-
-            for (i = sed_column_len(s) - 1; i >= 0 ; i--) {
-                /* From the top of the column to the bottom. */
-
-                this_cell = sed_column_nth_cell(s, i);
-
-                for (n = 0, t_new = 0. ; n < n_grains ; n++) {
-                    /* Compact each grain type. */
-
-                    t_0 = sed_cell_sediment_volume(this_cell)
-                        * sed_cell_fraction(this_cell, n);
-                    rho_new = rho_max[n] + (rho[n] - rho_max[n]) / exp(c[n] * load_eff[i]);
+        eh_free(p);
+        eh_free(load);
+        eh_free(load_eff);
+        _compact_sediment_destroy(sed);
+    }
 
-                    t_new += t_0 * (rho_grain[n] - rho_sea_water) / (rho_new - rho_sea_water);
+    return 0;
+}
 
-                    if (t_new < 0) {
-                        t_new = 0;
-                        eh_require_not_reached();
-                    }
+static void
+_compact_column_worker(Sed_cube cube, gssize n, gssize id, Sed_worker w,
+    gpointer user_data)
+{
+    Sed_column s = sed_cube_col(cube, id);
 
-                }
+    if (sed_column_len(s) > 2) {
+        const gint col_len = sed_column_len(s);
 
-                // If the new thickness is greater than the current thickness, we
-                // don't do anything.  In this case overlying sediment has been eroded.
-                if (t_new < sed_cell_size(this_cell)) {
-                    sed_column_compact_cell(s, i, t_new);
-                }
-            }
+        _compact_column(s, (Compact_sediment*)user_data,
+            sed_worker_scratch(w, 0, col_len),
+            sed_worker_scratch(w, 1, col_len),
+            sed_worker_scratch(w, 2, col_len));
+    }
+}
 
-            eh_free(c);
-            eh_free(rho_max);
-            eh_free(rho_grain);
-            eh_free(rho);
-        }
+/** Compact each column of a cube
 
-        eh_free(load_eff);
-    }
+The columns are compacted in parallel using sed_cube_n_threads() threads.
 
-    return 0;
-}
+\param p A Sed_cube to compact
 
+\return TRUE on success.
+*/
 gboolean
 compact_cube(Sed_cube p)
 {
@@ -174,17 +223,11 @@ compact_cube(Sed_cube p)
     eh_require(p);
 
     if (p) {
-        gint i;
-        const gint len = sed_cube_size(p);
+        Compact_sediment* sed = _compact_sediment_new();
 
-        #pragma omp parallel for num_threads(4)
-
-        for (i = 0 ; i < len ; i++) {
-            Sed_column s = sed_cube_col(p, i);
-            compact(s);
-        }
+        success = sed_cube_foreach_column_parallel(p, &_compact_column_worker, sed);
 
-        success = TRUE;
+        _compact_sediment_destroy(sed);
     }
 
     return success;
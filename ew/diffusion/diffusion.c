@@ -44,6 +44,178 @@
 #define DIFFUSION_OPT_FILL  (1<<0)
 #define DIFFUSION_OPT_LAND  (1<<1)
 #define DIFFUSION_OPT_WATER (1<<2)
+#define DIFFUSION_OPT_IMPLICIT (1<<3)
+
+/* Solve one line of an implicit diffusion step.
+
+   Solves (1 - r*L) u = rhs along a line of n nodes, where L is the
+   diffusion operator with k[i] the coefficient between nodes i and i+1.
+   No sediment moves through the ends of the line, so the sum of u is
+   that of rhs.  work must hold at least 4*n doubles.
+*/
+static void
+_diffusion_solve_line(double* u, const double* k, const double* rhs,
+    gint n, double r, double* work)
+{
+    double* l = work;
+    double* d = work + n;
+    double* up = work + 2 * n;
+    double* b = work + 3 * n;
+    gint i;
+
+    if (n < 2) {
+        for (i = 0 ; i < n ; i++) {
+            u[i] = rhs[i];
+        }
+
+        return;
+    }
+
+    for (i = 0 ; i < n ; i++) {
+        l[i]  = (i > 0)     ? -r * k[i - 1] : 0.;
+        up[i] = (i < n - 1) ? -r * k[i]     : 0.;
+        d[i]  = 1. - l[i] - up[i];
+        b[i]  = rhs[i];
+    }
+
+    // The system is diagonally dominant so this will not fail.
+    if (!tridiag(l, d, up, b, u, n)) {
+        eh_require_not_reached();
+    }
+}
+
+/* Fluxes between the columns of a profile for a backward-Euler step.
+
+   u holds the new elevations on output.  du[i] is the thickness of
+   sediment to move from column i to i+1 (negative to move it back).
+   No sediment moves through the ends of the profile so du[n_cols-1] is
+   zero.
+*/
+static void
+_diffusion_implicit_fluxes(Sed_cube prof, const double* k, gint n_cols,
+    double dt, double* u, double* du)
+{
+    const double r = dt / (sed_cube_y_res(prof) * sed_cube_y_res(prof));
+    double* rhs = eh_new(double, n_cols);
+    double* work = eh_new(double, 4 * n_cols);
+    gint i;
+
+    for (i = 0 ; i < n_cols ; i++) {
+        rhs[i] = sed_cube_top_height(prof, 0, i);
+    }
+
+    _diffusion_solve_line(u, k, rhs, n_cols, r, work);
+
+    for (i = 0 ; i < n_cols - 1 ; i++) {
+        du[i] = k[i] * (u[i] - u[i + 1]) * r;
+    }
+
+    du[n_cols - 1] = 0.;
+
+    eh_free(work);
+    eh_free(rhs);
+}
+
+/* Fluxes between the columns of a cube for a Peaceman-Rachford ADI step.
+
+   The first half step is implicit in x and explicit in y, the second is
+   implicit in y and explicit in x.  Over the full step the x-fluxes are
+   those of the half-step depths and the y-fluxes are the average of
+   those of the start and end depths, so moving the fluxes reproduces the
+   ADI solution exactly.  No sediment moves through the edges of the
+   cube, so the fluxes of the last row and column are zero.
+*/
+static void
+_diffusion_adi_fluxes(Sed_cube prof, double** k_x, double** k_y, double dt,
+    double** qx, double** qy)
+{
+    const gint n_x = sed_cube_n_x(prof);
+    const gint n_y = sed_cube_n_y(prof);
+    const double dx = sed_cube_x_res(prof);
+    const double dy = sed_cube_y_res(prof);
+    const double r_x = .5 * dt / (dx * dx);
+    const double r_y = .5 * dt / (dy * dy);
+    const gint n_max = eh_max(n_x, n_y);
+    Eh_dbl_grid u_0_grid = sed_cube_water_depth_grid(prof, NULL);
+    Eh_dbl_grid u_half_grid = eh_grid_dup(u_0_grid);
+    Eh_dbl_grid u_1_grid = eh_grid_dup(u_0_grid);
+    double** u_0 = eh_dbl_grid_data(u_0_grid);
+    double** u_half = eh_dbl_grid_data(u_half_grid);
+    double** u_1 = eh_dbl_grid_data(u_1_grid);
+    double* line = eh_new(double, n_max);
+    double* k = eh_new(double, n_max);
+    double* rhs = eh_new(double, n_max);
+    double* work = eh_new(double, 4 * n_max);
+    gint i, j;
+
+    // Implicit in x.
+    for (j = 0 ; j < n_y ; j++) {
+        for (i = 0 ; i < n_x ; i++) {
+            rhs[i] = u_0[i][j];
+
+            if (j < n_y - 1) {
+                rhs[i] += r_y * k_y[i][j] * (u_0[i][j + 1] - u_0[i][j]);
+            }
+
+            if (j > 0) {
+                rhs[i] -= r_y * k_y[i][j - 1] * (u_0[i][j] - u_0[i][j - 1]);
+            }
+
+            k[i] = k_x[i][j];
+        }
+
+        _diffusion_solve_line(line, k, rhs, n_x, r_x, work);
+
+        for (i = 0 ; i < n_x ; i++) {
+            u_half[i][j] = line[i];
+        }
+    }
+
+    // Implicit in y.
+    for (i = 0 ; i < n_x ; i++) {
+        for (j = 0 ; j < n_y ; j++) {
+            rhs[j] = u_half[i][j];
+
+            if (i < n_x - 1) {
+                rhs[j] += r_x * k_x[i][j] * (u_half[i + 1][j] - u_half[i][j]);
+            }
+
+            if (i > 0) {
+                rhs[j] -= r_x * k_x[i - 1][j] * (u_half[i][j] - u_half[i - 1][j]);
+            }
+        }
+
+        _diffusion_solve_line(u_1[i], k_y[i], rhs, n_y, r_y, work);
+    }
+
+    for (i = 0 ; i < n_x ; i++) {
+        for (j = 0 ; j < n_y ; j++) {
+            qx[i][j] = 0.;
+            qy[i][j] = 0.;
+        }
+    }
+
+    for (i = 0 ; i < n_x - 1 ; i++) {
+        for (j = 0 ; j < n_y ; j++) {
+            qx[i][j] = 2. * r_x * k_x[i][j] * (u_half[i + 1][j] - u_half[i][j]);
+        }
+    }
+
+    for (i = 0 ; i < n_x ; i++) {
+        for (j = 0 ; j < n_y - 1 ; j++) {
+            qy[i][j] = r_y * k_y[i][j] * (u_0[i][j + 1] - u_0[i][j]
+                    + u_1[i][j + 1] - u_1[i][j]);
+        }
+    }
+
+    eh_free(work);
+    eh_free(rhs);
+    eh_free(k);
+    eh_free(line);
+    eh_grid_destroy(u_1_grid, TRUE);
+    eh_grid_destroy(u_half_grid, TRUE);
+    eh_grid_destroy(u_0_grid, TRUE);
+}
 
 /** 1D-diffusion of seafloor elevations.
 
@@ -75,6 +247,13 @@ that it is difficult to move, one that it is easy to move.
 \param dt         The time step of the diffusion
 \param options    Options that control the method of diffusion
 
+If \a options includes DIFFUSION_OPT_IMPLICIT, the elevations at the end of
+the time step are found with a backward-Euler step that is stable for any
+time step.  No sediment moves through the ends of the profile so the mass
+of the profile is unchanged.  Otherwise, the time step is divided so that
+the explicit scheme is stable and the flux through each end of the profile
+is taken to be that of its neighbor.
+
 \return           A Sed_cell array of sediment that was lost
 */
 
@@ -166,7 +345,7 @@ diffuse_sediment(Sed_cube prof, double k_max,
     //---
     // If necessary, adjust the time step for stability.
     //---
-    if (k_max * dt / (dx * dx) > .5) {
+    if (!(options & DIFFUSION_OPT_IMPLICIT) && k_max * dt / (dx * dx) > .5) {
         dt_new = (dx * dx) / 2. / k_max;
 
         if (options & DIFFUSION_OPT_LAND) {
@@ -249,29 +428,37 @@ diffuse_sediment(Sed_cube prof, double k_max,
                 }
             }
 
-        //---
-        // Get slopes.  Forward difference to find slope
-        //---
-        for (i = 0 ; i < n_cols - 1 ; i++) {
-            dudx[i] = -sed_cube_y_slope(prof, 0, i);
-        }
+        if (options & DIFFUSION_OPT_IMPLICIT) {
+            //---
+            // Determine sediment fluxes between cells from the elevations at
+            // the end of the time step.  These are also the new elevations.
+            //---
+            _diffusion_implicit_fluxes(prof, k, n_cols, dt, u, du);
+        } else {
+            //---
+            // Get slopes.  Forward difference to find slope
+            //---
+            for (i = 0 ; i < n_cols - 1 ; i++) {
+                dudx[i] = -sed_cube_y_slope(prof, 0, i);
+            }
 
-        dudx[n_cols - 1] = dudx[n_cols - 2];
-        dudx[0] = dudx[1];
+            dudx[n_cols - 1] = dudx[n_cols - 2];
+            dudx[0] = dudx[1];
 
-        //---
-        // Determine sediment fluxes between cells.
-        // '+' means move to the right, '-' to the left find in meters
-        //---
-        for (i = 0 ; i < n_cols ; i++) {
-            qx = -k[i] * dudx[i];
-            du[i] = qx * dt / dx;
+            //---
+            // Determine sediment fluxes between cells.
+            // '+' means move to the right, '-' to the left find in meters
+            //---
+            for (i = 0 ; i < n_cols ; i++) {
+                qx = -k[i] * dudx[i];
+                du[i] = qx * dt / dx;
+            }
         }
 
         //---
         // Determine the new elevations.
         //---
-        if (options & DIFFUSION_OPT_FILL) {
+        if ((options & DIFFUSION_OPT_FILL) && !(options & DIFFUSION_OPT_IMPLICIT)) {
             for (i = 0 ; i < n_cols ; i++) {
                 u_init[i] = sed_cube_top_height(prof, 0, i);
             }
@@ -314,29 +501,30 @@ diffuse_sediment(Sed_cube prof, double k_max,
 
         //---
         // assume the the flux in (or out) of the first cell is the same as the
-        // flux in (or out) of the second cell.
+        // flux in (or out) of the second cell.  do the same for the last cell.
+        // the implicit scheme is closed at both ends so nothing is lost or
+        // gained there.
         //---
-        if (du[0] < 0) {
-            sed_column_separate_top(sed_cube_col(prof, 0),
-                -du[0],
-                alpha_grain,
-                add_cell);
-            sed_cell_add(lost_left, add_cell);
-        } else {
-            sed_cell_copy(rem_cell[0], rem_cell[1]);
-        }
+        if (!(options & DIFFUSION_OPT_IMPLICIT)) {
+            if (du[0] < 0) {
+                sed_column_separate_top(sed_cube_col(prof, 0),
+                    -du[0],
+                    alpha_grain,
+                    add_cell);
+                sed_cell_add(lost_left, add_cell);
+            } else {
+                sed_cell_copy(rem_cell[0], rem_cell[1]);
+            }
 
-        //---
-        // do the same for the last cell.
-        //---
-        if (du[n_cols - 1] > 0) {
-            sed_column_separate_top(sed_cube_col(prof, n_cols - 1),
-                du[n_cols - 1],
-                alpha_grain,
-                add_cell);
-            sed_cell_add(lost_right, add_cell);
-        } else {
-            sed_cell_copy(rem_cell[n_cols - 1], rem_cell[n_cols - 2]);
+            if (du[n_cols - 1] > 0) {
+                sed_column_separate_top(sed_cube_col(prof, n_cols - 1),
+                    du[n_cols - 1],
+                    alpha_grain,
+                    add_cell);
+                sed_cell_add(lost_right, add_cell);
+            } else {
+                sed_cell_copy(rem_cell[n_cols - 1], rem_cell[n_cols - 2]);
+            }
         }
 
         //---
@@ -436,6 +624,12 @@ that it is difficult to move, one that it is easy to move.
 \param dt            The time step of the diffusion
 \param options       Options that control the method of diffusion
 
+If \a options includes DIFFUSION_OPT_IMPLICIT, the fluxes are found with an
+alternating-direction implicit (ADI) step that is stable for any time step.
+No sediment moves through the edges of the cube, so the only sediment that
+is lost is that which would have built a column above sea level.
+Otherwise, the time step is divided so that the explicit scheme is stable.
+
 \return              A Sed_cell array of sediment that was lost
 */
 
@@ -466,6 +660,7 @@ diffuse_sediment_2(Sed_cube prof, double k_long_max,
     double a, k_max, dt_new, depth;
     double dx, dy;
     double water_depth;
+    gboolean is_open;
     gssize i, j, n, iter, n_iter = 1;
     gssize remove_index, add_index;
     gssize n_x, n_y;
@@ -482,6 +677,9 @@ diffuse_sediment_2(Sed_cube prof, double k_long_max,
     dx       = sed_cube_x_res(prof);
     dy       = sed_cube_y_res(prof);
 
+    // The implicit scheme is closed at the edges of the domain.
+    is_open  = !(options & DIFFUSION_OPT_IMPLICIT);
+
     //---
     // alpha_grain defines the ease at which different grain types can be moved.
     // values near zero are hard to move, values near one are easily moved.
@@ -504,7 +702,8 @@ diffuse_sediment_2(Sed_cube prof, double k_long_max,
     //---
     k_max = sqrt(pow(k_long_max, 2) + pow(k_cross_max, 2));
 
-    if (k_max * dt * (1. / dx / dx + 1. / dy / dy) > .25) {
+    if (!(options & DIFFUSION_OPT_IMPLICIT)
+        && k_max * dt * (1. / dx / dx + 1. / dy / dy) > .25) {
         dt_new = .25 / k_max / (1 / dx / dx + 1. / dy / dy);
         dt_new /= 2;
 
@@ -620,34 +819,44 @@ diffuse_sediment_2(Sed_cube prof, double k_long_max,
         slope_dir = sed_cube_slope_dir_grid(prof, NULL);
         get_diffusion_components(slope_dir, k_long, k_cross, k_x, k_y);
 
-        eh_message("calculate seafloor slopes");
-        //---
-        // Get slopes.  Forward difference to find slope
-        //---
-        dudx = sed_cube_x_slope_grid(prof, NULL);
-        dudy = sed_cube_y_slope_grid(prof, NULL);
+        if (options & DIFFUSION_OPT_IMPLICIT) {
+            eh_message("calculate sediment fluxes");
 
-        eh_message("calculate sediment fluxes");
-
-        //---
-        // Determine sediment fluxes between cells.
-        // '+' means move to the right, '-' to the left
-        //---
-        for (i = 0 ; i < n_x ; i++) {
-            for (j = 0 ; j < n_y ; j++) {
-                qy[i][j] = eh_dbl_grid_val(k_y, i, j) * eh_dbl_grid_val(dudy, i, j) * dt / dy;
-                qx[i][j] = eh_dbl_grid_val(k_x, i, j) * eh_dbl_grid_val(dudx, i, j) * dt / dx;
-                /*
-                            qy[i][j] = k_y->data[i][j]*dudy->data[i][j]*dt/dy
-                                     + y_current->data[i][j]*dt/dy;
-                            qx[i][j] = k_x->data[i][j]*dudx->data[i][j]*dt/dx
-                                     + x_current->data[i][j]*dt/dx;
-                            long_shore = slope_dir->data[i][j] + M_PI_2;
-                            long_shore = 0;
-                            qy[i][j] = x_current->data[i][j]*dt/dy*sin( long_shore );
-                            qx[i][j] = x_current->data[i][j]*dt/dx*cos( long_shore );
-                */
+            _diffusion_adi_fluxes(prof, eh_dbl_grid_data(k_x), eh_dbl_grid_data(k_y),
+                dt, qx, qy);
+        } else {
+            eh_message("calculate seafloor slopes");
+            //---
+            // Get slopes.  Forward difference to find slope
+            //---
+            dudx = sed_cube_x_slope_grid(prof, NULL);
+            dudy = sed_cube_y_slope_grid(prof, NULL);
+
+            eh_message("calculate sediment fluxes");
+
+            //---
+            // Determine sediment fluxes between cells.
+            // '+' means move to the right, '-' to the left
+            //---
+            for (i = 0 ; i < n_x ; i++) {
+                for (j = 0 ; j < n_y ; j++) {
+                    qy[i][j] = eh_dbl_grid_val(k_y, i, j) * eh_dbl_grid_val(dudy, i, j) * dt / dy;
+                    qx[i][j] = eh_dbl_grid_val(k_x, i, j) * eh_dbl_grid_val(dudx, i, j) * dt / dx;
+                    /*
+                                qy[i][j] = k_y->data[i][j]*dudy->data[i][j]*dt/dy
+                                         + y_current->data[i][j]*dt/dy;
+                                qx[i][j] = k_x->data[i][j]*dudx->data[i][j]*dt/dx
+                                         + x_current->data[i][j]*dt/dx;
+                                long_shore = slope_dir->data[i][j] + M_PI_2;
+                                long_shore = 0;
+                                qy[i][j] = x_current->data[i][j]*dt/dy*sin( long_shore );
+                                qx[i][j] = x_current->data[i][j]*dt/dx*cos( long_shore );
+                    */
+                }
             }
+
+            eh_grid_destroy(dudx, TRUE);
+            eh_grid_destroy(dudy, TRUE);
         }
 
         eh_grid_destroy(slope_dir, TRUE);
@@ -673,8 +882,6 @@ diffuse_sediment_2(Sed_cube prof, double k_long_max,
               qx[-1][-1] = 0;
               qy[-1][-1] = 0;
         */
-        eh_grid_destroy(dudx, TRUE);
-        eh_grid_destroy(dudy, TRUE);
 
         //---
         // Determine the new elevations.
@@ -851,7 +1058,7 @@ diffuse_sediment_2(Sed_cube prof, double k_long_max,
                 //            add_index    = (qy[i][j]>0)?(j+1):(j-1);
                 if (fabs(qy[i][j]) > 0) {
                     //               if ( is_in_domain( prof->n_x , prof->n_y , i , remove_index ) )
-                    if (remove_index != 0 && remove_index != n_y - 1)
+                    if (!is_open || (remove_index != 0 && remove_index != n_y - 1))
                         sed_column_separate_top(sed_cube_col_ij(prof, i, remove_index),
                             fabs(qy[i][j]),
                             alpha_grain,
@@ -893,7 +1100,7 @@ diffuse_sediment_2(Sed_cube prof, double k_long_max,
 
                 if (fabs(qx[i][j]) > 0) {
                     //               if ( is_in_domain( prof->n_x , prof->n_y , remove_index , j ) )
-                    if (remove_index != 0 && remove_index != n_x - 1)
+                    if (!is_open || (remove_index != 0 && remove_index != n_x - 1))
                         sed_column_separate_top(sed_cube_col_ij(prof, remove_index, j),
                             fabs(qx[i][j]),
                             alpha_grain,
@@ -941,10 +1148,13 @@ diffuse_sediment_2(Sed_cube prof, double k_long_max,
                 sed_column_add_cell(sed_cube_col_ij(prof, i, j), add_cell);
             }
 
+        //---
+        // Sediment that is moved out through the edges of the domain is lost.
+        //---
         for (i = 0 ; i < n_x ; i++) {
             sed_cell_clear(add_cell);
 
-            if (qy[i][0] < 0)
+            if (is_open && qy[i][0] < 0)
                 sed_column_separate_top(sed_cube_col_ij(prof, i, 0),
                     fabs(qy[i][0]),
                     alpha_grain,
@@ -960,7 +1170,7 @@ diffuse_sediment_2(Sed_cube prof, double k_long_max,
 
             sed_cell_clear(add_cell);
 
-            if (qy[i][n_y - 1] > 0)
+            if (is_open && qy[i][n_y - 1] > 0)
                 sed_column_separate_top(sed_cube_col_ij(prof, i, n_y - 1),
                     fabs(qy[i][n_y - 1]),
                     alpha_grain,
@@ -983,7 +1193,7 @@ diffuse_sediment_2(Sed_cube prof, double k_long_max,
         for (j = 0 ; j < n_y ; j++) {
             sed_cell_clear(add_cell);
 
-            if (qx[0][j] < 0)
+            if (is_open && qx[0][j] < 0)
                 sed_column_separate_top(sed_cube_col_ij(prof, 0, j),
                     fabs(qx[0][j]),
                     alpha_grain,
@@ -999,7 +1209,7 @@ diffuse_sediment_2(Sed_cube prof, double k_long_max,
 
             sed_cell_clear(add_cell);
 
-            if (qx[n_x - 1][j] > 0)
+            if (is_open && qx[n_x - 1][j] > 0)
                 sed_column_separate_top(sed_cube_col_ij(prof, n_x - 1, j),
                     fabs(qx[n_x - 1][j]),
                     alpha_grain,
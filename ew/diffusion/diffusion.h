@@ -24,6 +24,7 @@
 #define DIFFUSION_OPT_FILL  (1<<0)
 #define DIFFUSION_OPT_LAND  (1<<1)
 #define DIFFUSION_OPT_WATER (1<<2)
+#define DIFFUSION_OPT_IMPLICIT (1<<3)
 
 # include <utils/utils.h>
 # include <sed/sed_sedflux.h>
@@ -0,0 +1,319 @@
+#include <math.h>
+#include <utils/utils.h>
+#include <sed/sed_sedflux.h>
+#include <check.h>
+
+#include "diffusion.h"
+
+#define TEST_K          (100.)
+#define TEST_SKIN_DEPTH (1e4)
+#define TEST_LENGTH     (20000.)
+
+/* A flat, submarine cube with a mound of sediment at its center.
+*/
+static Sed_cube
+_diffusion_test_cube(gint n_x, gint n_y)
+{
+    Sed_cube p = sed_cube_new(n_x, n_y);
+    Sed_cell cell = sed_cell_new_env();
+    const double x_0 = .5 * (n_x - 1);
+    const double y_0 = .5 * (n_y - 1);
+    const double w = MAX(.025 * n_y, 2.);
+    gint i, j;
+
+    sed_cell_set_equal_fraction(cell);
+
+    sed_cube_set_x_res(p, TEST_LENGTH / n_y);
+    sed_cube_set_y_res(p, TEST_LENGTH / n_y);
+
+    for (i = 0 ; i < n_x ; i++) {
+        for (j = 0 ; j < n_y ; j++) {
+            const double r_2 = (n_x > 1 ? (i - x_0) * (i - x_0) : 0.)
+                + (j - y_0) * (j - y_0);
+
+            sed_cube_set_base_height(p, i, j, -100.);
+
+            sed_cell_resize(cell, 50. + 10. * exp(-r_2 / (w * w)));
+            sed_column_add_cell(sed_cube_col_ij(p, i, j), cell);
+        }
+    }
+
+    sed_cube_set_sea_level(p, 0.);
+
+    sed_cell_destroy(cell);
+
+    return p;
+}
+
+static double
+_diffusion_test_step(Sed_cube p, double dt, int options)
+{
+    GTimer* timer = g_timer_new();
+    Sed_cell* lost;
+    double cpu;
+
+    if (sed_cube_is_1d(p)) {
+        lost = diffuse_sediment(p, TEST_K, TEST_SKIN_DEPTH, dt, options);
+    } else {
+        lost = diffuse_sediment_2(p, TEST_K, TEST_K, TEST_SKIN_DEPTH, dt, options);
+    }
+
+    cpu = g_timer_elapsed(timer, NULL);
+
+    if (lost) {
+        gint n;
+
+        for (n = 0 ; n < 4 ; n++) {
+            sed_cell_destroy(lost[n]);
+        }
+
+        eh_free(lost);
+    }
+
+    g_timer_destroy(timer);
+
+    return cpu;
+}
+
+static void
+_diffusion_test_range(Sed_cube p, double* min, double* max)
+{
+    gint i, j;
+
+    *min = G_MAXDOUBLE;
+    *max = -G_MAXDOUBLE;
+
+    for (i = 0 ; i < sed_cube_n_x(p) ; i++) {
+        for (j = 0 ; j < sed_cube_n_y(p) ; j++) {
+            const double z = sed_cube_top_height(p, i, j);
+
+            *min = MIN(*min, z);
+            *max = MAX(*max, z);
+        }
+    }
+}
+
+/* Diffuse with a time step that is n_limit times the explicit stability limit.
+*/
+static void
+_diffusion_test_implicit(gint n_x, gint n_y, double n_limit)
+{
+    Sed_cube p = _diffusion_test_cube(n_x, n_y);
+    const double dx = sed_cube_y_res(p);
+    const double dt = n_limit * .5 * dx * dx / TEST_K;
+    const double mass_0 = sed_cube_mass(p);
+    double min_0, max_0, min_1, max_1;
+
+    _diffusion_test_range(p, &min_0, &max_0);
+
+    _diffusion_test_step(p, dt, DIFFUSION_OPT_WATER | DIFFUSION_OPT_IMPLICIT);
+
+    _diffusion_test_range(p, &min_1, &max_1);
+
+    fail_unless(eh_compare_dbl(sed_cube_mass(p), mass_0, 1e-6),
+        "Implicit diffusion did not conserve mass");
+    fail_unless(max_1 < max_0, "Implicit diffusion did not lower the mound");
+    fail_unless(max_1 <= max_0 + 1e-6 && min_1 >= min_0 - 1e-6,
+        "Implicit diffusion is unstable");
+
+    sed_cube_destroy(p);
+}
+
+START_TEST(test_diffusion_implicit_1d)
+{
+    _diffusion_test_implicit(1, 200, 100.);
+}
+END_TEST
+
+START_TEST(test_diffusion_implicit_2d)
+{
+    _diffusion_test_implicit(40, 40, 10.);
+}
+END_TEST
+
+/* A submarine cube whose surface slopes down across x and y, so that
+   sediment moves toward its edges.
+*/
+static Sed_cube
+_diffusion_test_ramp(gint n_x, gint n_y)
+{
+    Sed_cube p = sed_cube_new(n_x, n_y);
+    Sed_cell cell = sed_cell_new_env();
+    gint i, j;
+
+    sed_cell_set_equal_fraction(cell);
+
+    sed_cube_set_x_res(p, TEST_LENGTH / n_y);
+    sed_cube_set_y_res(p, TEST_LENGTH / n_y);
+
+    for (i = 0 ; i < n_x ; i++) {
+        for (j = 0 ; j < n_y ; j++) {
+            sed_cube_set_base_height(p, i, j, -100.);
+
+            sed_cell_resize(cell, 10. + 40. * (i + j) / (n_x + n_y));
+            sed_column_add_cell(sed_cube_col_ij(p, i, j), cell);
+        }
+    }
+
+    sed_cube_set_sea_level(p, 0.);
+
+    sed_cell_destroy(cell);
+
+    return p;
+}
+
+/* Sediment must not be created or lost at the edges of the domain.
+*/
+static void
+_diffusion_test_implicit_edges(gint n_x, gint n_y, double n_limit)
+{
+    Sed_cube p = _diffusion_test_ramp(n_x, n_y);
+    const double dx = sed_cube_y_res(p);
+    const double dt = n_limit * .5 * dx * dx / TEST_K;
+    const double mass_0 = sed_cube_mass(p);
+    const double z_0 = sed_cube_top_height(p, 0, 0);
+    const double z_1 = sed_cube_top_height(p, n_x - 1, n_y - 1);
+
+    _diffusion_test_step(p, dt, DIFFUSION_OPT_WATER | DIFFUSION_OPT_IMPLICIT);
+
+    fail_unless(eh_compare_dbl(sed_cube_mass(p), mass_0, 1e-6),
+        "Implicit diffusion created or lost sediment at an edge");
+    fail_unless(sed_cube_top_height(p, 0, 0) > z_0,
+        "Sediment should move toward the low edge");
+    fail_unless(sed_cube_top_height(p, n_x - 1, n_y - 1) < z_1,
+        "Sediment should move away from the high edge");
+
+    sed_cube_destroy(p);
+}
+
+START_TEST(test_diffusion_implicit_1d_edges)
+{
+    _diffusion_test_implicit_edges(1, 200, 100.);
+}
+END_TEST
+
+START_TEST(test_diffusion_implicit_2d_edges)
+{
+    _diffusion_test_implicit_edges(40, 40, 10.);
+}
+END_TEST
+
+/* Diffuse and return the CPU time, checking that the step was stable.
+*/
+static double
+_diffusion_test_timed_step(Sed_cube p, double dt, int options)
+{
+    double min_0, max_0, min_1, max_1;
+    double cpu;
+
+    _diffusion_test_range(p, &min_0, &max_0);
+
+    cpu = _diffusion_test_step(p, dt, options);
+
+    _diffusion_test_range(p, &min_1, &max_1);
+
+    fail_unless(max_1 <= max_0 + 1e-6 && min_1 >= min_0 - 1e-6,
+        "Diffusion is unstable");
+
+    return cpu;
+}
+
+START_TEST(test_diffusion_benchmark)
+{
+    gint n_y_1d[] = { 100, 200, 400, 800 };
+    gint n_y_2d[] = { 10, 20, 40, 80 };
+    const double dt = 365.;
+    gint k;
+
+    for (k = 0 ; k < sizeof(n_y_1d) / sizeof(n_y_1d[0]) ; k++) {
+        Sed_cube p_ex = _diffusion_test_cube(1, n_y_1d[k]);
+        Sed_cube p_im = _diffusion_test_cube(1, n_y_1d[k]);
+        double t_ex, t_im;
+
+        t_ex = _diffusion_test_timed_step(p_ex, dt, DIFFUSION_OPT_WATER);
+        t_im = _diffusion_test_timed_step(p_im, dt,
+                DIFFUSION_OPT_WATER | DIFFUSION_OPT_IMPLICIT);
+
+        eh_message("1D, %4d columns: explicit %f s, implicit %f s",
+            n_y_1d[k], t_ex, t_im);
+
+        sed_cube_destroy(p_im);
+        sed_cube_destroy(p_ex);
+    }
+
+    for (k = 0 ; k < sizeof(n_y_2d) / sizeof(n_y_2d[0]) ; k++) {
+        Sed_cube p_ex = _diffusion_test_cube(n_y_2d[k], n_y_2d[k]);
+        Sed_cube p_im = _diffusion_test_cube(n_y_2d[k], n_y_2d[k]);
+        double t_ex, t_im;
+
+        t_ex = _diffusion_test_timed_step(p_ex, dt, DIFFUSION_OPT_WATER);
+        t_im = _diffusion_test_timed_step(p_im, dt,
+                DIFFUSION_OPT_WATER | DIFFUSION_OPT_IMPLICIT);
+
+        eh_message("2D, %2dx%-2d columns: explicit %f s, ADI %f s",
+            n_y_2d[k], n_y_2d[k], t_ex, t_im);
+
+        sed_cube_destroy(p_im);
+        sed_cube_destroy(p_ex);
+    }
+}
+END_TEST
+
+Suite*
+sed_diffusion_suite(void)
+{
+    Suite* s = suite_create("Diffusion");
+    TCase* test_case_core = tcase_create("Core");
+
+    suite_add_tcase(s, test_case_core);
+
+    tcase_add_test(test_case_core, test_diffusion_implicit_1d);
+    tcase_add_test(test_case_core, test_diffusion_implicit_2d);
+    tcase_add_test(test_case_core, test_diffusion_implicit_1d_edges);
+    tcase_add_test(test_case_core, test_diffusion_implicit_2d_edges);
+
+    // Timing runs take a while so they are only run when asked for.
+    if (g_getenv("SED_BENCHMARK")) {
+        TCase* test_case_benchmark = tcase_create("Benchmark");
+
+        suite_add_tcase(s, test_case_benchmark);
+
+        tcase_set_timeout(test_case_benchmark, 0);
+
+        tcase_add_test(test_case_benchmark, test_diffusion_benchmark);
+    }
+
+    return s;
+}
+
+int
+main(void)
+{
+    int n;
+    Sed_sediment sed   = NULL;
+    GError*      error = NULL;
+
+    eh_init_glib();
+
+    sed = sed_sediment_scan(SED_SEDIMENT_TEST_FILE, &error);
+
+    if (!sed) {
+        eh_error("%s: Unable to read sediment file: %s", SED_SEDIMENT_TEST_FILE,
+            error->message);
+    } else {
+        sed_sediment_set_env(sed);
+    }
+
+    {
+        Suite* s = sed_diffusion_suite();
+        SRunner* sr = srunner_create(s);
+
+        srunner_run_all(sr, CK_NORMAL);
+        n = srunner_ntests_failed(sr);
+        srunner_free(sr);
+    }
+
+    sed_sediment_unset_env();
+
+    return n;
+}
@@ -6,6 +6,7 @@ static const gchar* _DEFAULT_CONFIG[] = {
     "diffusion 1% depth",
     "long-shore diffusion constant",
     "cross-shore diffusion constant",
+    "diffusion method",
     NULL
 };
 
@@ -90,6 +90,7 @@ typedef struct {
     int len;                       // number of cells allocated (length of w, u, etc).
     double failure_line;           // elevation to the bottom of the column.
     gboolean need_update;
+    gint stamp;                    // stamp of the Sed_column this was built from.
 }
 Fail_column;
 
@@ -112,6 +113,12 @@ typedef struct {
     int size;             ///< number of columns.
     int len;              ///< number of columns allocated (length of col).
     int count;
+    int n_threads;        ///< number of threads to use (0 for sed_cube_n_threads).
+    double quake;         ///< the quake value that the factors of safety are for.
+    int n_cols_rebuilt;   ///< number of columns that were rebuilt.
+    int n_cols_reused;    ///< number of columns that were reused.
+    int n_fos_computed;   ///< number of factors of safety that were calculated.
+    int n_fos_reused;     ///< number of factors of safety that were reused.
 }
 Fail_profile;
 
@@ -175,11 +182,19 @@ Fail_profile*
 fail_init_fail_profile(Sed_cube p,
     Failure_t fail_const);
 void
+fail_set_n_threads(Fail_profile* f, int n_threads);
+int
+fail_n_threads(Fail_profile* f);
+void
 fail_examine_fail_profile(Fail_profile* p);
 void
 fail_reset_fail_profile(Fail_profile* p);
 void
 fail_update_fail_profile(Fail_profile* p);
+void
+fail_clear_ignored_surfaces(Fail_profile* p);
+gint
+fail_fprint_fail_profile_stats(Fail_profile* p, FILE* fp);
 
 void
 fail_destroy_failure_profile(Fail_profile* f);
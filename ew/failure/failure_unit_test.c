@@ -0,0 +1,270 @@
+#include <string.h>
+#include <utils/utils.h>
+#include <sed/sed_sedflux.h>
+#include <check.h>
+
+#include "failure.h"
+
+/* A long 1D profile of a prograding wedge of sediment.
+*/
+static Sed_cube
+_failure_test_profile(gint n_y)
+{
+    Sed_cube p = sed_cube_new(1, n_y);
+    double* f = eh_new0(double, sed_sediment_env_n_types());
+    Sed_cell cell;
+    gint j, n;
+
+    f[sed_sediment_env_n_types() - 1] = 1.;
+    cell = sed_cell_new_sized(sed_sediment_env_n_types(), 1., f);
+
+    sed_cube_set_y_res(p, 100.);
+
+    for (j = 0 ; j < n_y ; j++) {
+        Sed_column c = sed_cube_col(p, j);
+        const gint n_cells = 10 + 30 * (n_y - j) / n_y;
+
+        sed_column_set_base_height(c, -10. - .5 * j);
+
+        for (n = 0 ; n < n_cells ; n++) {
+            sed_column_add_cell(c, cell);
+        }
+    }
+
+    sed_cube_set_sea_level(p, 0.);
+
+    sed_cell_destroy(cell);
+    eh_free(f);
+
+    return p;
+}
+
+static Fail_profile*
+_failure_test_examine(Sed_cube p, gint n_threads, double* cpu)
+{
+    Fail_profile* f = fail_create_fail_profile(sed_cube_n_y(p));
+    Failure_t fail_const;
+    GTimer* timer = g_timer_new();
+
+    fail_const.consolidation     = FAILURE_DEFAULT_CONSOLIDATION;
+    fail_const.cohesion          = FAILURE_DEFAULT_COHESION;
+    fail_const.frictionAngle     = FAILURE_DEFAULT_FRICTION_ANGLE * S_RADS_PER_DEGREE;
+    fail_const.gravity           = FAILURE_DEFAULT_GRAVITY;
+    fail_const.density_sea_water = FAILURE_DEFAULT_DENSITY_SEA_WATER;
+
+    fail_set_n_threads(f, n_threads);
+
+    g_timer_start(timer);
+
+    f = fail_reinit_fail_profile(f, p, fail_const);
+    fail_update_fail_profile(f);
+    fail_examine_fail_profile(f);
+
+    *cpu = g_timer_elapsed(timer, NULL);
+
+    g_timer_destroy(timer);
+
+    return f;
+}
+
+/* Check that a profile examined with threads matches one examined serially.
+*/
+static void
+_failure_test_compare(Fail_profile* f, Fail_profile* f_serial, gint n_y)
+{
+    gint i;
+
+    fail_unless(f->fs_min_val == f_serial->fs_min_val,
+        "Minimum factor of safety depends on number of threads");
+    fail_unless(f->fs_min_start == f_serial->fs_min_start,
+        "Start of failure surface depends on number of threads");
+    fail_unless(f->fs_min_len == f_serial->fs_min_len,
+        "Length of failure surface depends on number of threads");
+
+    for (i = 0; i < n_y; i++) {
+        fail_unless(memcmp(f->col[i]->fs, f_serial->col[i]->fs,
+                sizeof(double)*MAX_FAILURE_LENGTH) == 0,
+            "Factors of safety depend on number of threads");
+    }
+}
+
+START_TEST(test_failure_threads)
+{
+    const gint n_y = 200;
+    gint n_threads[] = { 2, 3 };
+    gint len = sizeof(n_threads) / sizeof(n_threads[0]);
+    Sed_cube p = _failure_test_profile(n_y);
+    Fail_profile* f_serial;
+    double t;
+    gint k;
+
+    f_serial = _failure_test_examine(p, 1, &t);
+
+    for (k = 0; k < len; k++) {
+        Fail_profile* f = _failure_test_examine(p, n_threads[k], &t);
+
+        _failure_test_compare(f, f_serial, n_y);
+
+        fail_destroy_failure_profile(f);
+    }
+
+    fail_destroy_failure_profile(f_serial);
+    sed_cube_destroy(p);
+}
+END_TEST
+
+START_TEST(test_failure_benchmark)
+{
+    const gint n_y = 2000;
+    gint n_threads[] = { 2, 4, 8 };
+    gint len = sizeof(n_threads) / sizeof(n_threads[0]);
+    Sed_cube p = _failure_test_profile(n_y);
+    Fail_profile* f_serial;
+    double t_serial;
+    gint k;
+
+    f_serial = _failure_test_examine(p, 1, &t_serial);
+
+    eh_message("Profile length: %d", n_y);
+    eh_message("Wall time with 1 thread: %f", t_serial);
+
+    for (k = 0; k < len; k++) {
+        double t;
+        Fail_profile* f = _failure_test_examine(p, n_threads[k], &t);
+
+        eh_message("Wall time with %d threads: %f (speed-up %.2f)",
+            n_threads[k], t, t_serial / t);
+
+        _failure_test_compare(f, f_serial, n_y);
+
+        fail_destroy_failure_profile(f);
+    }
+
+    fail_destroy_failure_profile(f_serial);
+    sed_cube_destroy(p);
+}
+END_TEST
+
+START_TEST(test_failure_incremental)
+{
+    const gint n_y = 500;
+    gint dirty[] = { 100, 101, 250, 400 };
+    gint n_dirty = sizeof(dirty) / sizeof(dirty[0]);
+    Sed_cube p = _failure_test_profile(n_y);
+    Sed_cell cell;
+    Fail_profile* f_inc;
+    Fail_profile* f_full;
+    double t;
+    gint i, len, n_rebuilt, n_reused;
+
+    f_inc = _failure_test_examine(p, 1, &t);
+
+    {
+        double* f = eh_new0(double, sed_sediment_env_n_types());
+
+        f[0] = 1.;
+        cell = sed_cell_new_sized(sed_sediment_env_n_types(), 2., f);
+
+        eh_free(f);
+    }
+
+    for (i = 0; i < n_dirty; i++) {
+        sed_column_add_cell(sed_cube_col(p, dirty[i]), cell);
+    }
+
+    n_rebuilt = f_inc->n_cols_rebuilt;
+    n_reused  = f_inc->n_fos_reused;
+
+    fail_update_fail_profile(f_inc);
+    fail_examine_fail_profile(f_inc);
+
+    fail_unless(f_inc->n_cols_rebuilt - n_rebuilt >= n_dirty,
+        "Modified columns were not rebuilt");
+    fail_unless(f_inc->n_cols_rebuilt - n_rebuilt < n_y,
+        "Unmodified columns were rebuilt");
+    fail_unless(f_inc->n_fos_reused > n_reused,
+        "No factors of safety were reused");
+
+    f_full = _failure_test_examine(p, 1, &t);
+
+    fail_unless(f_inc->fs_min_val == f_full->fs_min_val,
+        "Minimum factor of safety differs from a full update");
+    fail_unless(f_inc->fs_min_start == f_full->fs_min_start,
+        "Start of failure surface differs from a full update");
+    fail_unless(f_inc->fs_min_len == f_full->fs_min_len,
+        "Length of failure surface differs from a full update");
+
+    for (i = sed_cube_river_mouth_1d(p); i < n_y; i++) {
+        for (len = MIN_FAILURE_LENGTH;
+            len < MAX_FAILURE_LENGTH && i + len < n_y;
+            len++) {
+            fail_unless(f_inc->col[i]->fs[len] == f_full->col[i]->fs[len],
+                "Factor of safety differs from a full update");
+        }
+    }
+
+    sed_cell_destroy(cell);
+    fail_destroy_failure_profile(f_full);
+    fail_destroy_failure_profile(f_inc);
+    sed_cube_destroy(p);
+}
+END_TEST
+
+Suite*
+sed_failure_suite(void)
+{
+    Suite* s = suite_create("Failure");
+    TCase* test_case_core = tcase_create("Core");
+
+    suite_add_tcase(s, test_case_core);
+
+    tcase_set_timeout(test_case_core, 0);
+
+    tcase_add_test(test_case_core, test_failure_threads);
+    tcase_add_test(test_case_core, test_failure_incremental);
+
+    // Timing runs take a while so they are only run when asked for.
+    if (g_getenv("SED_BENCHMARK")) {
+        TCase* test_case_benchmark = tcase_create("Benchmark");
+
+        suite_add_tcase(s, test_case_benchmark);
+
+        tcase_set_timeout(test_case_benchmark, 0);
+
+        tcase_add_test(test_case_benchmark, test_failure_benchmark);
+    }
+
+    return s;
+}
+
+int
+main(void)
+{
+    int n;
+    Sed_sediment sed   = NULL;
+    GError*      error = NULL;
+
+    eh_init_glib();
+
+    sed = sed_sediment_scan(SED_SEDIMENT_TEST_FILE, &error);
+
+    if (!sed) {
+        eh_error("%s: Unable to read sediment file: %s", SED_SEDIMENT_TEST_FILE,
+            error->message);
+    } else {
+        sed_sediment_set_env(sed);
+    }
+
+    {
+        Suite* s = sed_failure_suite();
+        SRunner* sr = srunner_create(s);
+
+        srunner_run_all(sr, CK_NORMAL);
+        n = srunner_ntests_failed(sr);
+        srunner_free(sr);
+    }
+
+    sed_sediment_unset_env();
+
+    return n;
+}
@@ -20,7 +20,6 @@
 
 #include <stdio.h>
 #include <math.h>
-#include <pthread.h>
 #include <utils/utils.h>
 #include <sed/sed_sedflux.h>
 #include "failure.h"
@@ -30,7 +29,6 @@
 #endif
 
 #define FAIL_LOCAL_MODEL
-#undef FAIL_WITH_THREADS
 
 Sed_cube
 get_failure_surface(const Sed_cube p, int start, int len)
@@ -323,6 +321,7 @@ fail_create_fail_column(int n, gboolean allocate)
     }
 
     f->need_update = TRUE;
+    f->stamp       = 0;
 
     return f;
 }
@@ -406,10 +405,13 @@ fail_load_fail_column(Fail_column* f, FILE* fp)
     return TRUE;
 }
 
+/* Read-only data shared by the threads that initialize the columns of a
+   profile.  Each thread writes only to its own element of slice.
+*/
 typedef struct {
     Sed_cube p;
     Failure_t fail_const;
-    double* failure_line;
+    const double* failure_line;
     Fail_column** slice;
 }
 Init_failure_t;
@@ -417,6 +419,40 @@ Init_failure_t;
 void
 init_column(gpointer data, gpointer user_data);
 
+/* Call f for each of the len column indices in ids.  If n_threads is more
+   than one, the calls are made by a pool of n_threads threads.  Each call
+   is passed a pointer to its index and user_data.  All of the calls have
+   finished when this function returns.
+*/
+static void
+_fail_foreach_column(int* ids, int len, GFunc f, gpointer user_data,
+    int n_threads)
+{
+    int i;
+
+    if (n_threads > 1 && len > 1) {
+        GThreadPool* pool;
+
+        if (!g_thread_supported()) {
+            g_thread_init(NULL);
+        }
+
+        pool = g_thread_pool_new(f, user_data, MIN(n_threads, len), FALSE, NULL);
+
+        for (i = 0 ; i < len ; i++) {
+            g_thread_pool_push(pool, &(ids[i]), NULL);
+        }
+
+        g_thread_pool_free(pool, FALSE, TRUE);
+    } else {
+        for (i = 0 ; i < len ; i++) {
+            f(&(ids[i]), user_data);
+        }
+    }
+
+    return;
+}
+
 Fail_profile*
 fail_init_fail_profile(Sed_cube p,
     Failure_t fail_const)
@@ -424,17 +460,12 @@ fail_init_fail_profile(Sed_cube p,
     return fail_reinit_fail_profile(NULL, p, fail_const);
 }
 
-#define FAIL_INIT_N_THREADS (10)
-
 Fail_profile*
 fail_reinit_fail_profile(Fail_profile* f,
     Sed_cube p,
     Failure_t fail_const)
 {
     int i, n_cols;
-#ifdef FAIL_WITH_THREADS
-    GThreadPool* t_pool;
-#endif
     double* failure_line;
     Init_failure_t data;
     int* queue;
@@ -442,14 +473,6 @@ fail_reinit_fail_profile(Fail_profile* f,
     eh_require(p != NULL);
     eh_require(sed_cube_is_1d(p));
 
-#ifdef FAIL_WITH_THREADS
-
-    if (!g_thread_supported()) {
-        g_thread_init(NULL);
-    }
-
-#endif
-
     n_cols = sed_cube_n_y(p);
 
     if (f) {
@@ -470,31 +493,17 @@ fail_reinit_fail_profile(Fail_profile* f,
     data.failure_line = failure_line;
     data.slice        = f->col;
 
-#ifdef FAIL_WITH_THREADS
-    t_pool = g_thread_pool_new((GFunc)&init_column,
-            &data,
-            FAIL_INIT_N_THREADS,
-            TRUE,
-            NULL);
-#endif
-
-    queue = eh_new(int, sed_cube_n_y(p));
+    queue = eh_new(int, n_cols);
 
-    // allocate memory for the failure slices.
-    for (i = 0 ; i < sed_cube_n_y(p) ; i++) {
+    for (i = 0 ; i < n_cols ; i++) {
         queue[i] = i;
-
-#ifdef FAIL_WITH_THREADS
-        g_thread_pool_push(t_pool, &(queue[i]), NULL);
-#else
-        init_column(&(queue[i]), &data);
-#endif
-
     }
 
-#ifdef FAIL_WITH_THREADS
-    g_thread_pool_free(t_pool, FALSE, TRUE);
-#endif
+    // initialize the failure slices.
+    _fail_foreach_column(queue, n_cols, &init_column, &data, fail_n_threads(f));
+
+    f->quake           = sed_cube_quake(p);
+    f->n_cols_rebuilt += n_cols;
 
     eh_free(failure_line);
     eh_free(queue);
@@ -530,9 +539,42 @@ fail_create_fail_profile(int n_cols)
 
     f->count = 0;
 
+    f->n_threads = 0;
+    f->quake     = 0.;
+
+    f->n_cols_rebuilt = 0;
+    f->n_cols_reused  = 0;
+    f->n_fos_computed = 0;
+    f->n_fos_reused   = 0;
+
     return f;
 }
 
+/** Set the number of threads used to examine a profile
+
+\param f         A Fail_profile
+\param n_threads Number of threads.  If zero, use sed_cube_n_threads().
+*/
+void
+fail_set_n_threads(Fail_profile* f, int n_threads)
+{
+    eh_require(f != NULL);
+    f->n_threads = (n_threads > 0) ? n_threads : 0;
+}
+
+/** The number of threads used to examine a profile
+
+\param f A Fail_profile
+
+\return The number of threads.
+*/
+int
+fail_n_threads(Fail_profile* f)
+{
+    eh_require(f != NULL);
+    return (f->n_threads > 0) ? f->n_threads : sed_cube_n_threads();
+}
+
 void
 fail_dump_fail_profile(Fail_profile* f, FILE* fp)
 {
@@ -585,11 +627,11 @@ fail_resize_fail_profile(Fail_profile* f, int n_cols)
 void
 init_column(gpointer data, gpointer user_data)
 {
-    int i                = *((int*)data);
-    Sed_cube p           = ((Init_failure_t*)user_data)->p;
-    Failure_t fail_const = ((Init_failure_t*)user_data)->fail_const;
-    double* failure_line = ((Init_failure_t*)user_data)->failure_line;
-    Fail_column** slice  = ((Init_failure_t*)user_data)->slice;
+    int i                      = *((int*)data);
+    Sed_cube p                 = ((Init_failure_t*)user_data)->p;
+    Failure_t fail_const       = ((Init_failure_t*)user_data)->fail_const;
+    const double* failure_line = ((Init_failure_t*)user_data)->failure_line;
+    Fail_column** slice        = ((Init_failure_t*)user_data)->slice;
 
     slice[i] = fail_reinit_fail_column(slice[i],
             sed_cube_col(p, i),
@@ -652,76 +694,64 @@ fail_get_failure_line(Sed_cube p)
     return failure_line;
 }
 
-#define N_THREADS (4)
+/** Find the failure surface of a profile with the minimum factor of safety
+
+The factor of safety is calculated for every failure surface that starts
+seaward of the river mouth.  The surfaces for each starting column are
+calculated independently, by fail_n_threads() threads.  The minimum is then
+found in order of starting column and surface length so that the chosen
+surface does not depend on the number of threads.
 
+\param p A Fail_profile
+*/
 void
 fail_examine_fail_profile(Fail_profile* p)
 {
-    int i, j;
-#ifdef FAIL_WITH_THREADS
-    GThreadPool* fos_pool[N_THREADS];
-#endif
-    int river_mouth, block_size;
-    int start;
-    int** queue;
+    int i;
+    int river_mouth, n_starts;
+    int start, len;
+    double fs;
+    int* queue;
 
     eh_require(p != NULL);
 
-#ifdef FAIL_WITH_THREADS
-
-    if (!g_thread_supported()) {
-        g_thread_init(NULL);
-    }
-
-    for (i = 0 ; i < N_THREADS ; i++)
-        fos_pool[i] = g_thread_pool_new((GFunc)&get_node_fos,
-                p,
-                1,
-                TRUE,
-                NULL);
-
-#endif
-
-    // divide the profile up into blocks of block_size columns each.
-    // a single thread pool will work on each block.
     river_mouth = sed_cube_river_mouth_1d(p->p) - 3;
 
     if (river_mouth < 0) {
         river_mouth = 0;
     }
 
-    block_size  = (p->size - river_mouth) / N_THREADS;
-    queue       = eh_new(int*, N_THREADS);
-
-    for (i = 0 ; i < N_THREADS ; i++) {
-        queue[i] = eh_new(int, block_size);
-        start    = i * block_size + river_mouth;
+    n_starts = p->size - river_mouth;
 
-        for (j = 0 ; j < block_size ; j++, start++) {
-            queue[i][j] = start;
-
-#ifdef FAIL_WITH_THREADS
-            g_thread_pool_push(fos_pool[i], &(queue[i][j]), NULL);
-#else
-            get_node_fos(&(queue[i][j]), p);
-#endif
+    if (n_starts > 0) {
+        queue = eh_new(int, n_starts);
 
+        for (i = 0 ; i < n_starts ; i++) {
+            queue[i] = river_mouth + i;
         }
-    }
 
-#ifdef FAIL_WITH_THREADS
+        _fail_foreach_column(queue, n_starts, &get_node_fos, p, fail_n_threads(p));
 
-    for (i = 0 ; i < N_THREADS ; i++) {
-        g_thread_pool_free(fos_pool[i], FALSE, TRUE);
-    }
+        eh_free(queue);
 
-#endif
+        // reduce in a fixed order so that ties are broken the same way
+        // no matter how the work was divided.
+        for (start = river_mouth ; start < p->size ; start++) {
+            for (len = MIN_FAILURE_LENGTH ;
+                len < MAX_FAILURE_LENGTH && start + len < p->size ;
+                len++) {
+                fs = p->col[start]->fs[len];
 
-    for (i = 0 ; i < N_THREADS ; i++) {
-        eh_free(queue[i]);
-    }
+                if (fail_fos_is_valid(fs) && fs < p->fs_min_val) {
+                    p->fs_min_val   = fs;
+                    p->fs_min_start = start;
+                    p->fs_min_len   = len;
+                }
+            }
+        }
 
-    eh_free(queue);
+        p->count += n_starts;
+    }
 
     // mark each column as updated.
     for (i = 0 ; i < p->size ; i++) {
@@ -749,52 +779,44 @@ fail_reset_fail_profile(Fail_profile* p)
     }
 }
 
+/** Bring a failure profile up to date with its Sed_cube
+
+Only the columns of the profile whose Sed_column has been modified (as
+given by its stamp), or whose failure line has moved, are rebuilt.  The
+factors of safety of failure surfaces that cross a rebuilt column are
+marked to be calculated again by fail_examine_fail_profile, while those of
+the other surfaces are reused.  If the cube's quake value has changed, all
+of the factors of safety are calculated again.
+
+\param p A Fail_profile
+*/
 void
 fail_update_fail_profile(Fail_profile* p)
 {
     int i;
     int start, len;
-    Fail_column* f_col;
+    int next_update;
     Sed_column s_col;
     double* failure_line;
     double fs, fs_min_val;
-    double fail_col_h, sed_col_h;
+    gboolean quake_changed;
 
     eh_require(p != NULL);
 
     // calculate the new elevations of the failure line.
     failure_line = fail_get_failure_line(p->p);
 
+    quake_changed = (sed_cube_quake(p->p) != p->quake);
+    p->quake      = sed_cube_quake(p->p);
+
     p->count = 0;
 
-    // look for changes in the elevation of the failure plane between the
-    // sed_profile and the fail_profile.
+    // rebuild the columns that have changed since they were last built.
     for (i = 0 ; i < p->size ; i++) {
-
-        f_col = p->col[i];
         s_col = sed_cube_col(p->p, i);
 
-        if (f_col->size > 0) {
-            fail_col_h = f_col->height[f_col->size - 1];
-        } else {
-            fail_col_h = f_col->failure_line;
-        }
-
-        sed_col_h  = sed_column_top_height(s_col);
-        /*
-        eh_watch_dbl( fabs(fail_col_h-sed_col_h) );
-        eh_watch_dbl( f_col->failure_line );
-        eh_watch_dbl( fail_col_h );
-        eh_watch_dbl( sed_col_h );
-        eh_watch_int( f_col->size-1 );
-        eh_watch_dbl_vec( f_col->height , 0 , f_col->size-1 );
-        */
-
-        // Assume the the factor of safety does not need to be recalculated if
-        // the column did not change in thickness by some amount.  Say for now,
-        // 10cm.
-        //      if ( fabs(fail_col_h-sed_col_h) > FAIL_MIN_DELTA_H )
-        if (fabs(fail_col_h - sed_col_h) > .1) {
+        if (sed_column_stamp(s_col) != p->col[i]->stamp
+            || failure_line[i] != p->col[i]->failure_line) {
 
             p->col[i] = fail_reinit_fail_column(p->col[i],
                     s_col,
@@ -804,18 +826,29 @@ fail_update_fail_profile(Fail_profile* p)
 
             p->count++;
 
+        } else if (quake_changed) {
+            p->col[i]->need_update = TRUE;
         }
 
     }
 
+    p->n_cols_rebuilt += p->count;
+    p->n_cols_reused  += p->size - p->count;
+
     eh_free(failure_line);
 
-    // mark all of the failure surfaces that need to be calculated again.
-    for (i = 0 ; i < p->size ; i++)
-        for (len = 0 ; len < MAX_FAILURE_LENGTH ; len++)
-            if (i + len < p->size && p->col[i + len]->need_update) {
-                p->col[i]->fs[len] = FAIL_FOS_NOT_VALID;
-            }
+    // mark all of the failure surfaces that cross a column that needs to be
+    // calculated again.  a surface of length len that starts at column start
+    // covers columns start through start+len-1.
+    for (start = p->size - 1, next_update = p->size ; start >= 0 ; start--) {
+        if (p->col[start]->need_update) {
+            next_update = start;
+        }
+
+        for (len = next_update - start + 1 ; len < MAX_FAILURE_LENGTH ; len++) {
+            p->col[start]->fs[len] = FAIL_FOS_NOT_VALID;
+        }
+    }
 
     // reset the minimum factor of safety values for the profile.
     p->fs_min_val   = 999;
@@ -843,37 +876,83 @@ fail_update_fail_profile(Fail_profile* p)
     return;
 }
 
+/** Forget the failure surfaces that have been marked to be ignored
+
+Surfaces are marked to be ignored (with fail_set_failure_surface_ignore)
+while searching for failures during a time step.  Call this at the start of
+the next time step so that they are examined again.
+
+\param p A Fail_profile
+*/
+void
+fail_clear_ignored_surfaces(Fail_profile* p)
+{
+    int start, len;
+
+    eh_require(p != NULL);
+
+    for (start = 0 ; start < p->size ; start++) {
+        for (len = 0 ; len < MAX_FAILURE_LENGTH ; len++) {
+            if (fail_get_ignore_surface(p, start, len)) {
+                p->col[start]->fs[len]     = FAIL_FOS_NOT_VALID;
+                p->col[start]->need_update = TRUE;
+            }
+        }
+    }
+}
+
+/** Print the number of columns and factors of safety that were reused
+
+\param p  A Fail_profile
+\param fp A FILE to print to (or NULL for stdout).
+
+\return The number of bytes printed.
+*/
+gint
+fail_fprint_fail_profile_stats(Fail_profile* p, FILE* fp)
+{
+    gint n = 0;
+
+    eh_require(p != NULL);
+
+    if (!fp) {
+        fp = stdout;
+    }
+
+    n += fprintf(fp, "Failure columns rebuilt          : %d\n",
+            p->n_cols_rebuilt);
+    n += fprintf(fp, "Failure columns reused           : %d\n",
+            p->n_cols_reused);
+    n += fprintf(fp, "Factors of safety calculated     : %d\n",
+            g_atomic_int_get(&p->n_fos_computed));
+    n += fprintf(fp, "Factors of safety reused         : %d\n",
+            g_atomic_int_get(&p->n_fos_reused));
+
+    return n;
+}
+
+/** Calculate the factors of safety of the failure surfaces that start at a column
+
+The factor of safety of each surface is stored in the Fail_column of the
+starting column.  Only that column is written to, so this function can be
+called for different columns at the same time.
+
+\param data      Pointer to the index of the starting column.
+\param user_data The Fail_profile
+*/
 void
 get_node_fos(gpointer data, gpointer user_data)
 {
-#ifdef FAIL_WITH_THREADS
-    static GStaticMutex fs_min_lock = G_STATIC_MUTEX_INIT;
-#endif
     int fail_start = *((int*)data);
     Fail_profile* p = (Fail_profile*)user_data;
-    double fs, fs_min_val = 999;
-    int fs_min_len;
     int fail_len;
 
     for (fail_len = MIN_FAILURE_LENGTH ;
         fail_len < MAX_FAILURE_LENGTH && fail_start + fail_len < p->size ;
         fail_len++) {
         if (!fail_get_ignore_surface(p, fail_start, fail_len)) {
-            fs = fail_get_fail_profile_fos(p, fail_start, fail_len);
-
-            // NOTE: Toggle between these statements to choose the surface to fail.
-            // Choose the surface with the lowest factor of safety or choose the
-            // largest surface that is less than the factor of safety needed for failure.
-            if (fail_fos_is_valid(fs) && fs < fs_min_val)
-                //         if (    fail_fos_is_valid(fs)
-                //              && fs<MIN_FACTOR_OF_SAFETY
-                //              && fail_len>fs_min_len )
-            {
-                fs_min_val = fs;
-                fs_min_len = fail_len;
-            }
-
-            p->col[fail_start]->fs[fail_len] = fs;
+            p->col[fail_start]->fs[fail_len] =
+                fail_get_fail_profile_fos(p, fail_start, fail_len);
         } else
             eh_debug("ignoring surface at (%d,%d)",
                 fail_start,
@@ -881,22 +960,6 @@ get_node_fos(gpointer data, gpointer user_data)
 
     }
 
-#ifdef FAIL_WITH_THREADS
-    g_static_mutex_lock(&fs_min_lock);
-#endif
-
-    if (fail_fos_is_valid(fs_min_val) && fs_min_val < p->fs_min_val) {
-        p->fs_min_val   = fs_min_val;
-        p->fs_min_start = fail_start;
-        p->fs_min_len   = fs_min_len;
-    }
-
-    p->count++;
-
-#ifdef FAIL_WITH_THREADS
-    g_static_mutex_unlock(&fs_min_lock);
-#endif
-
     return;
 }
 
@@ -966,8 +1029,12 @@ fail_get_fail_profile_fos(Fail_profile* f, int start, int len)
         }
 
         eh_free(ellipse);
+
+        g_atomic_int_inc(&f->n_fos_computed);
     } else {
         fs = f->col[start]->fs[len];
+
+        g_atomic_int_inc(&f->n_fos_reused);
     }
 
     return fs;
@@ -1209,6 +1276,7 @@ fail_reinit_fail_column(Fail_column* f,
     }
 
     f->failure_line = h;
+    f->stamp        = sed_column_stamp(c);
     /*
        if ( h>1e50 )
        {
@@ -26,10 +26,30 @@ double*
 solve_excess_pore_pressure(double* psi, double* k, double* c, int n, double dz,
     double dt, double psi_top, double sed_rate)
 {
-    double* l = eh_new(double, n);
-    double* d = eh_new(double, n);
-    double* u = eh_new(double, n);
-    double* b = eh_new(double, n);
+    double* work = eh_new(double, 4 * n);
+
+    solve_excess_pore_pressure_with_work(psi, k, c, n, dz, dt, psi_top, sed_rate,
+        work);
+
+    eh_free(work);
+
+    return psi;
+}
+
+/** Solve for excess pore pressure using the caller's scratch space
+
+This is the same as solve_excess_pore_pressure but does not allocate any
+memory of its own so that the work space can be reused from one column to
+the next.  \a work must hold at least 4*n doubles.
+*/
+double*
+solve_excess_pore_pressure_with_work(double* psi, double* k, double* c, int n,
+    double dz, double dt, double psi_top, double sed_rate, double* work)
+{
+    double* l = work;
+    double* d = work + n;
+    double* u = work + 2 * n;
+    double* b = work + 3 * n;
     int i;
 
     // given these new k and c, calculate the new entries for our
@@ -54,11 +74,6 @@ solve_excess_pore_pressure(double* psi, double* k, double* c, int n, double dz,
     psi[0]   = psi[2];
     psi[n - 1] = psi_top;
 
-    eh_free(l);
-    eh_free(d);
-    eh_free(u);
-    eh_free(b);
-
     return psi;
 }
 
@@ -29,6 +29,9 @@ G_BEGIN_DECLS
 double*
 solve_excess_pore_pressure(double* psi, double* k, double* c, int n, double dz,
     double dt, double psi_top, double sed_rate);
+double*
+solve_excess_pore_pressure_with_work(double* psi, double* k, double* c, int n,
+    double dz, double dt, double psi_top, double sed_rate, double* work);
 void
 get_matrix_coefficients(double* psi, double* k, double* c, double ds, double dz,
     double dt, double psi_top, int n, double f,  double* l, double* d, double* u,
@@ -0,0 +1,93 @@
+#include <math.h>
+#include <utils/utils.h>
+#include <check.h>
+
+#include "flow.h"
+
+#define TEST_DZ (.1)
+#define TEST_DT (3.15e7)
+
+/* Excess pore pressure, conductivity and compressibility of a test column.
+*/
+static void
+_flow_test_column(gint n, gint seed, double* psi, double* k, double* c)
+{
+    gint j;
+
+    for (j = 0 ; j < n ; j++) {
+        psi[j] = 1e4 * (1. + sin(.1 * (j + seed)));
+        k[j]   = 1e-9 * (1. + .5 * cos(.3 * (j + 2 * seed)));
+        c[j]   = 1.;
+    }
+
+    psi[n - 1] = 0.;
+}
+
+/* A work buffer that is reused for columns of different lengths must give
+   the same pressures as solving each column with its own buffers.
+*/
+START_TEST(test_flow_with_work)
+{
+    const gint n_z = 101;
+    double* psi = eh_new(double, n_z);
+    double* ans = eh_new(double, n_z);
+    double* k = eh_new(double, n_z);
+    double* c = eh_new(double, n_z);
+    double* work = eh_new(double, 4 * n_z);
+    gint i, j;
+
+    for (i = 0 ; i < 20 ; i++) {
+        const gint n = MAX(n_z - (i * 7) % (n_z / 2), 4);
+
+        _flow_test_column(n, i, ans, k, c);
+        solve_excess_pore_pressure(ans, k, c, n, TEST_DZ, TEST_DT, 0., 0.);
+
+        _flow_test_column(n, i, psi, k, c);
+        solve_excess_pore_pressure_with_work(psi, k, c, n, TEST_DZ, TEST_DT,
+            0., 0., work);
+
+        for (j = 0 ; j < n ; j++) {
+            fail_unless(psi[j] == ans[j],
+                "Solution with a reused work buffer differs");
+        }
+    }
+
+    eh_free(work);
+    eh_free(c);
+    eh_free(k);
+    eh_free(ans);
+    eh_free(psi);
+}
+END_TEST
+
+Suite*
+flow_suite(void)
+{
+    Suite* s = suite_create("Flow");
+    TCase* test_case_core = tcase_create("Core");
+
+    suite_add_tcase(s, test_case_core);
+
+    tcase_add_test(test_case_core, test_flow_with_work);
+
+    return s;
+}
+
+int
+main(void)
+{
+    int n;
+
+    eh_init_glib();
+
+    {
+        Suite* s = flow_suite();
+        SRunner* sr = srunner_create(s);
+
+        srunner_run_all(sr, CK_NORMAL);
+        n = srunner_ntests_failed(sr);
+        srunner_free(sr);
+    }
+
+    return n;
+}
@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include "hydroalloc_mem.h"
+#include "hydrostate.h"
 
 /*      FUNCTION ALLOCATE_1D FILE */
 FILE**
@@ -13,7 +14,7 @@ allocate_1d_F(int nrows)
 
     if (!i) {
         perror("allocate_1d_F");
-        exit(-1);
+        hydroabort(-1);
     }
 
     return i;
@@ -40,7 +41,7 @@ matrixalloc1D(int max_width, long size)
     if (!atemp) {
         perror("matrixalloc_1");
         sleep(5);
-        exit(1);
+        hydroabort(1);
     }
 
     return atemp;
@@ -68,7 +69,7 @@ matrixalloc2D(int max_width, int max_length, long size)
     if (!atemp) {
         perror("matrixalloc_2");
         sleep(5);
-        exit(1);
+        hydroabort(1);
     }
 
     for (i = 0; i < max_width; ++i) {
@@ -77,7 +78,7 @@ matrixalloc2D(int max_width, int max_length, long size)
         if (!atemp[i]) {
             perror("matrixalloc_3");
             sleep(5);
-            exit(1);
+            hydroabort(1);
         }
     }
 
@@ -101,7 +102,7 @@ matrixalloc3D(int max_width, int max_length, int max_height, long size)
     if (!atemp) {
         perror("matrixalloc_4");
         sleep(5);
-        exit(1);
+        hydroabort(1);
     }
 
     for (i = 0; i < max_width; ++i) {
@@ -110,7 +111,7 @@ matrixalloc3D(int max_width, int max_length, int max_height, long size)
         if (!atemp[i]) {
             perror("matrixalloc_5");
             sleep(5);
-            exit(1);
+            hydroabort(1);
         }
     }
 
@@ -121,7 +122,7 @@ matrixalloc3D(int max_width, int max_length, int max_height, long size)
             if (!atemp[i][j]) {
                 perror("matrixalloc_6");
                 sleep(5);
-                exit(1);
+                hydroabort(1);
             }
         }
 
@@ -10,6 +10,9 @@
  *  Author3:       A.J. Kettner   (August 2002)(april 2003)
  */
 
+#ifndef HYDROCLIMATE_H_
+#define HYDROCLIMATE_H_
+
 #include <stdio.h>
 #include <math.h>
 #include <ctype.h>
@@ -24,6 +27,21 @@
 /*----------------------------------------------------
  *  Numerical Recipes utilities (nrutil) array types
  -----------------------------------------------------*/
+/*
+ *  Renamed so as not to clash with the nrutil copies in the other sedflux
+ *  libraries that HydroTrend is now linked with.
+ */
+#define nrerror       hydronrerror
+#define matrix        hydromatrix
+#define dmatrix       hydrodmatrix
+#define f3tensor      hydrof3tensor
+#define d3tensor      hydrod3tensor
+#define free_matrix   hydrofree_matrix
+#define free_dmatrix  hydrofree_dmatrix
+#define free_f3tensor hydrofree_f3tensor
+#define free_d3tensor hydrofree_d3tensor
+#define itoa          hydroitoa
+
 void
 nrerror(char []);
 float**
@@ -43,33 +61,6 @@ free_f3tensor(float***, long, long, long, long, long, long);
 void
 free_d3tensor(double***, long, long, long, long, long, long);
 
-int nelevbins, shouldern;
-
-double  Eiceannual, Enivalannual, ELAchange[maxepoche];
-double  ELAstart[maxepoche], Ewetannual;
-double  glacierarea, glacierelev, lapserate[maxepoche], MEtotal;
-double  Minput, Moutput, MQprevious, MQnext, Pannual;
-double  Pchange[maxepoche], Pmassbal[maxepoche], Pexponent[maxepoche];
-double  Pmonth[nmonth];
-double  Pnominal[nmonth][maxepoche], Pnomstd[nmonth][maxepoche];
-double  Prange[maxepoche];
-double  Pstart[maxepoche], Pstd[maxepoche];
-double  Qbedannual, *Qbedannualoutlet, Qgrandtotal[maxepoche], *** Qgrandtotaloutlet,
-        Qpeak, *Qpeakevents, *Qpeakperoutlet, ** Qpeakperoutletall, Qtotal, ** Qtotaloutlet,
-        *Qtotaloutletannual, *** Qbar, Qbartotal[maxepoche], Qpeakall[maxepoche],
-        ** Qpeakallevents;
-double Qsgrandtotal[maxepoche], Qsgrandtotaldelta[maxepoche], ** Qsgrandtotaloutlet,
-       ** Csgrandtotaloutlet, Qsbarnew[maxepoche], Qsbarnew2[maxepoche], Qsannual,
-       *Qsannualoutlet, *Csannualoutlet, Qsbartot[maxepoche], Qsbar[maxepoche],
-       Qsmean[maxepoche], ** Coutlettotal;
-double baseflowtot[maxepoche], Csannual, Csgrandtotal[maxepoche];
-double  shoulderright[maxshoulder], shoulderleft, shouldermain;
-double  Snowremains;
-double  Tannual, Tchange[maxepoche];
-double**  Televday, Tmonth[nmonth], Tnominal[nmonth][maxepoche];
-double  Tnomstd[nmonth][maxepoche], Tstart[maxepoche], Tstd[maxepoche];
-double** Qpeakfloodtemp;
-
 /*
  * Variable     Def.Location    Type    Units   Usage
  * --------     ------------    ----    -----   -----
@@ -141,3 +132,6 @@ double** Qpeakfloodtemp;
  *
  */
 
+#include "hydrostate.h"
+
+#endif
@@ -41,8 +41,8 @@ hydrocommandline(int* argc, char** argv)
      *------------------------*/
     err = 0;
 
-    for (jj = 0; jj < *argc; jj++) {
-        strcpy(commandlinearg[jj], argv[jj]);
+    for (jj = 0; jj < *argc && jj < HYDRO_MAX_ARGS; jj++) {
+        strncpy(commandlinearg[jj], argv[jj], MAXCH - 1);
     }
 
     if (*argc == 1) {
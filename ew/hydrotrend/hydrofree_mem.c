@@ -1,5 +1,6 @@
 #include "hydrofree_mem.h"
 #include <stdlib.h>
+#include "hydrostate.h"
 
 /**********************************************/
 /*** for freeing memory (1D "matrices") ***/
@@ -10,6 +10,7 @@
  */
 
 #include <string.h>
+#include "hydrostate.h"
 
 /*--------------------------------
  *  Convert n to characters in s
@@ -74,7 +75,7 @@ nrerror(char error_text[])
     fprintf(stderr, "Numerical Recipes run-time error...\n");
     fprintf(stderr, "%s\n", error_text);
     fprintf(stderr, "...now exiting to system...\n");
-    exit(1);
+    hydroabort(1);
 }
 
 /*----------------------------------------------------------------------
@@ -11,7 +11,7 @@
  *  --------    ------------    ----    -----   -----
  *  Mgw     HydroGlacial.c  double m^3/a Annual mass of Ice discharge going to GW
  * Mice     HydroGlacial.c  double  m^3/a   Annual mass of Ice derived discharge
- * Minput   HydroGlacial.c  double  m^3/a   Annual mass input into the Glacial routine
+ * Miceinput HydroGlacial.c  double  m^3/a   Annual mass input into the Glacial routine
  * Mout     HydroGlacial.c  double  m^3/a   Annual mass output from the Glacial routine
  * Mwrap    HydroGlacial.c  double  m^3/a   Annual mass of discharge carried over from the previous year
  * Parea    HydroGlacial.c  double  m^2 daily area over which "ice" precipitation occurs
@@ -63,7 +63,7 @@ hydroglacial()
     double elabin, elaerror, approxarea, Parea;
     double massavailable, maxmelt, meltday[maxday], shldday[maxday];
     double smallgapprox;
-    double totalmelt, Tcorrection, Tfix, Mice, Mgw, Mout, Mwrap, Minput;
+    double totalmelt, Tcorrection, Tfix, Mice, Mgw, Mout, Mwrap, Miceinput;
     double Tmean;
     double Volumelast, Volumeglacierarea;
     double lastareakm, glacierareakm;
@@ -326,7 +326,7 @@ hydroglacial()
             fprintf(stderr, " \t ELAstart[ep]      \t = %e  \n", ELAstart[ep]);
             fprintf(stderr, " \t ELAchange[ep]      \t = %e  \n", ELAchange[ep]);
             fprintf(stderr, " \t setstartmeanQandQs  \t = %d \n", setstartmeanQandQs);
-            exit(-1);
+            hydroabort(-1);
         }
 
         /*-----------------------------------------------------------------------
@@ -490,18 +490,18 @@ hydroglacial()
         }
 
         Mout = Mice + Mgw + Eiceannual * glacierarea;
-        Minput = massavailable + Mwrap;
+        Miceinput = massavailable + Mwrap;
 
-        if ((fabs(Mout - Minput) / Minput) > masscheck) {
+        if ((fabs(Mout - Miceinput) / Miceinput) > masscheck) {
             fprintf(stderr, "ERROR in HydroGlacial: \n");
             fprintf(stderr, "  Mass Balance error: Mout != Minput \n\n");
             fprintf(stderr, "\t fabs(Mout-Minput)/Minput > masscheck \n");
             fprintf(stderr, "\t note: masscheck set in HydroParams.h \n");
             fprintf(stderr, "\t masscheck = %f (%%) \n", masscheck);
             fprintf(stderr, "\t fabs(Mout-Minput)/Minput = %f (%%) \n\n",
-                fabs(Mout - Minput) / Minput);
+                fabs(Mout - Miceinput) / Miceinput);
             fprintf(stderr, " \t Minput = massavailable + Mwrap \n");
-            fprintf(stderr, " \t Minput \t\t = %e \n", Minput);
+            fprintf(stderr, " \t Minput \t\t = %e \n", Miceinput);
             fprintf(stderr, " \t massavailable \t = %e \n", massavailable);
             fprintf(stderr, " \t Mwrap \t\t = %e \n\n", Mwrap);
             fprintf(stderr, " \t Mout = Mice + Mgw + Eiceannual*glacierarea \n");
@@ -509,7 +509,7 @@ hydroglacial()
             fprintf(stderr, " \t Mice \t\t = %e \n", Mice);
             fprintf(stderr, " \t Mgw \t\t = %e \n", Mgw);
             fprintf(stderr, " \t Eiceannual \t = %e \n\n", Eiceannual * glacierarea);
-            exit(-1);
+            hydroabort(-1);
         }
 
     }   /* endif glacial */
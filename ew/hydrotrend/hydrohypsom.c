@@ -93,7 +93,7 @@ hydrohypsom()
             if ((Snowcarry = (double*) calloc(nelevbins, sizeof(double))) == NULL) {
                 fprintf(stderr, " PlumeArray ERROR: memory allocation failed \n");
                 fprintf(stderr, "    failed on Snowcarry \n");
-                exit(1);
+                hydroabort(1);
             }
 
         /*
@@ -169,7 +169,7 @@ hydrohypsom()
                 (areabins = (double*) calloc(nelevbins, sizeof(double))) == NULL) {
                 fprintf(stderr, " PlumeArray ERROR: memory allocation failed \n");
                 fprintf(stderr, "    failed on elevbins, distbins, or areabins \n");
-                exit(1);
+                hydroabort(1);
             }
 
             Televday    = dmatrix(0, nelevbins, 0, daysiy);
@@ -10,9 +10,13 @@
  *
  */
 
+#ifndef HYDROINOUT_H_
+#define HYDROINOUT_H_
+
 #define dbg (1)
 #define maxepochd           (110)      /* Also defined in hydroclimate.h and in hydroparams.h*/
 #define fnameinput          "HYDRO_INPUT/HYDRO.IN"
+#define fnameinputprefix    "HYDRO_INPUT/HYDRO"
 #define fnameinputext       ".IN"
 #define fnameq              ".Q"
 #define fnameqs             ".QS"
@@ -39,48 +43,6 @@
 #define OUTPUT_DIR          "/home/ftp/pub/forHydrousers/"
 #define INPUTSTRING         "/home/ftp/incoming/toHydrotrend/"
 
-FILE*    fidinput;
-FILE*    fidq;
-FILE*    fidqs;
-FILE*    fidtrend1;
-FILE*    fidtrend2;
-FILE*    fidtrend3;
-FILE*    fidstat;
-FILE*    fiddistot;
-FILE**    fiddis;
-FILE*    fidconvdistot;
-FILE**    fidconvdis;
-FILE*    fidinputgw_r;
-FILE**    fidhyps;
-FILE*    fidlog;
-FILE*    fidlapserate;
-FILE*    outp, *outp1, *outp2, *outp3, *outp4, *outp5;
-FILE*    outpnival_ice;
-
-char title[maxepochd][121];
-char moname[12][4];
-char ffnameinput[MAXCH];
-char ffnameq[MAXCH];
-char ffnameqs[MAXCH];
-char ffnametrend1[MAXCH];
-char ffnametrend2[MAXCH];
-char ffnametrend3[MAXCH];
-char ffnamestat[MAXCH];
-char ffnamedis[MAXCH];
-char ffnamedistot[MAXCH];
-char ffnameconvdis[MAXCH];
-char ffnameconvdistot[MAXCH];
-char ffnamehyps[MAXCH];
-char ffnameinputgw_r[MAXCH];
-char ffnamelog[MAXCH];
-char ffidasc[MAXCH];
-char ffidasc1[MAXCH];
-char ffidasc2[MAXCH];
-char ffidasc3[MAXCH];
-char ffidasc4[MAXCH];
-char ffidasc5[MAXCH];
-char ffidnival_ice[MAXCH];
-
 /*
  * Variable     Def.Location    Type    Units   Usage
  * --------     ------------    ----    -----   -----
@@ -136,3 +98,6 @@ char ffidnival_ice[MAXCH];
  *
  */
 
+#include "hydrostate.h"
+
+#endif
@@ -104,42 +104,48 @@ hydroopenfiles()
         err = 1;
     }
 
-    strcpy(ffnamedistot, startname);
-    sprintf(dummystring, "%s", ffnamedistot);
-    strcpy(ffnamedistot, dummystring);
-    strcat(ffnamedistot, fnamedis);
+    /*----------------------------------------------------
+     *  Records that go to a record function (see
+     *  HydroTrend_api.h) are not written to these files.
+     *----------------------------------------------------*/
+    if (hydro_state->record_func == NULL) {
+        strcpy(ffnamedistot, startname);
+        sprintf(dummystring, "%s", ffnamedistot);
+        strcpy(ffnamedistot, dummystring);
+        strcat(ffnamedistot, fnamedis);
 
-    if (verbose) {
-        printf("Opening %s... \n", ffnamedistot);
-    }
-
-    if ((fiddistot = fopen(ffnamedistot, "wb")) == NULL) {
-        fprintf(stderr, "  HydroOpenFiles ERROR: Unable to open the discharge file %s \n",
-            ffnamedistot);
-        err = 1;
-    }
-
-    if (outletmodelflag == 1) {
-        fiddis = allocate_1d_F(maxnoutlet);
-    }
+        if (verbose) {
+            printf("Opening %s... \n", ffnamedistot);
+        }
 
-    if (outletmodelflag == 1)
-        for (p = 0; p < maxnoutlet; p++) {
-            strcpy(ffnamedis, startname);
-            sprintf(dummystring, "%sOUTLET%d", ffnamedis, p + 1);
-            strcpy(ffnamedis, dummystring);
-            strcat(ffnamedis, fnamedis);
+        if ((fiddistot = fopen(ffnamedistot, "wb")) == NULL) {
+            fprintf(stderr, "  HydroOpenFiles ERROR: Unable to open the discharge file %s \n",
+                ffnamedistot);
+            err = 1;
+        }
 
-            if (verbose) {
-                printf("Opening %s... \n", ffnamedis);
-            }
+        if (outletmodelflag == 1) {
+            fiddis = allocate_1d_F(maxnoutlet);
+        }
 
-            if ((fiddis[p] = fopen(ffnamedis, "wb")) == NULL) {
-                fprintf(stderr, "  HydroOpenFiles ERROR: Unable to open the discharge file %s \n",
-                    ffnamedis);
-                err = 1;
+        if (outletmodelflag == 1)
+            for (p = 0; p < maxnoutlet; p++) {
+                strcpy(ffnamedis, startname);
+                sprintf(dummystring, "%sOUTLET%d", ffnamedis, p + 1);
+                strcpy(ffnamedis, dummystring);
+                strcat(ffnamedis, fnamedis);
+
+                if (verbose) {
+                    printf("Opening %s... \n", ffnamedis);
+                }
+
+                if ((fiddis[p] = fopen(ffnamedis, "wb")) == NULL) {
+                    fprintf(stderr, "  HydroOpenFiles ERROR: Unable to open the discharge file %s \n",
+                        ffnamedis);
+                    err = 1;
+                }
             }
-        }
+    }
 
     /*-----------------------
      *  Opening ascii files
@@ -151,7 +151,6 @@ hydrosetnumberoutlet(int x)
     int dumint, noutletoption;
     double dumdbl;
     float hydroran4(long * idum);
-    static int err = 0;
     dumdbl = 0.5;
 
     /*------------------------
@@ -167,7 +166,7 @@ hydrosetnumberoutlet(int x)
         dumdbl = (double)hydroran4(&rnseed4);
 
         if (0 > dumdbl || dumdbl > 1) {
-            err++;
+            hydro_state->outlet_err++;
             fprintf(stderr,
                 "A function in HydroRan2 failed in HydroSetNumberOutlet (HydroOutlet) \n");
             fprintf(stderr, " \t dumflt = %f: \t setting value to 0.5, x = %d \n", dumdbl, x);
@@ -177,12 +176,12 @@ hydrosetnumberoutlet(int x)
         dumdbl = dumdbl * 10.0;
         dumint = (int)(dumdbl);
 
-        if (err > 1) {
+        if (hydro_state->outlet_err > 1) {
             fprintf(stderr, " ERROR in HydroSetNumberOutlet (HydroOutlet).\n");
             fprintf(stderr, "\t Randomnummer generator failed twice: HydroTrend Aborted \n\n");
             fprintf(fidlog, " ERROR in HydroSetNumberOutlet (HydroOutlet).\n");
             fprintf(fidlog, "\t Randomnummer generator failed twice: HydroTrend Aborted \n\n");
-            exit(1);
+            hydroabort(1);
         }
     }
 
@@ -311,7 +310,7 @@ hydroqfractionshuffle(int k)
  *  Start of HydroAllocmemOutlet
  *--------------------------------*/
 void
-hydroallocmemoutlet(int ep)
+hydroallocmemoutlet(int epoch)
 {
     outletpcttotevents      = malloc2d(maxnoutlet, maxepoch, double);
     Qbedannualoutlet        = malloc1d(maxnoutlet, double);
@@ -331,7 +330,7 @@ hydroallocmemoutlet(int ep)
     Qdummy                  = malloc2d(maxepoch, maxnoutlet, double);
     Qgrandtotaltotoutlet    = malloc1d(maxnoutlet, double);
     Qsgrandtotaltotoutlet   = malloc1d(maxnoutlet, double);
-    Qpeakfloodtemp          = malloc2d(nyears[ep], daysiy, double);
+    Qpeakfloodtemp          = malloc2d(nyears[epoch], daysiy, double);
     return;
 } /* end of HydroAllocmemOutlet1 */
 
@@ -340,17 +339,17 @@ hydroallocmemoutlet(int ep)
  *  Start of HydroAllocmemOutlet1; TEST
  *---------------------------------------*/
 void
-hydroallocmemoutlet1(int ep)
+hydroallocmemoutlet1(int epoch)
 {
-    numberday               = malloc1d(eventsnr[ep], long);   //max allocatie is 365
-    nroutlets               = malloc1d(eventsnr[ep], int);
-    outletpct               = malloc3d(maxnoutlet, maxepoch, eventsnr[ep], double);
-    Qgrandtotaloutlet       = malloc3d(maxepoche, maxnoutlet, eventsnr[ep], double);
-    Qpeakevents             = malloc1d(eventsnr[ep], double);
-    Qtotaloutlet            = malloc2d(maxnoutlet, eventsnr[ep], double);
-    Qbar                    = malloc3d(maxepoche, maxnoutlet, eventsnr[ep], double);
-    Qpeakallevents          = malloc2d(maxepoche, eventsnr[ep], double);
-    daysievent              = malloc1d(eventsnr[ep], long);   // max = days*years per event
+    numberday               = malloc1d(eventsnr[epoch], long);   //max allocatie is 365
+    nroutlets               = malloc1d(eventsnr[epoch], int);
+    outletpct               = malloc3d(maxnoutlet, maxepoch, eventsnr[epoch], double);
+    Qgrandtotaloutlet       = malloc3d(maxepoche, maxnoutlet, eventsnr[epoch], double);
+    Qpeakevents             = malloc1d(eventsnr[epoch], double);
+    Qtotaloutlet            = malloc2d(maxnoutlet, eventsnr[epoch], double);
+    Qbar                    = malloc3d(maxepoche, maxnoutlet, eventsnr[epoch], double);
+    Qpeakallevents          = malloc2d(maxepoche, eventsnr[epoch], double);
+    daysievent              = malloc1d(eventsnr[epoch], long);   // max = days*years per event
     return;
 } /* end of HydroAllocmemOutlet1 */
 
@@ -395,7 +394,7 @@ hydrofreememoutlet(int j)
  *  Start of HydroFreeMemOutlet1 TEST
  *-------------------------------------*/
 void
-hydrofreememoutlet1(int ep)
+hydrofreememoutlet1(int epoch)
 {
     freematrix1D((void*)numberday);
     freematrix1D((void*)nroutlets);
@@ -12,7 +12,7 @@
  * Variable     Def.Location    Type    Units   Usage
  * --------     ------------    ----    -----   -----
  * comLen       HydroOutput.c   int     -       length of the title string
- * Cs           HydroOutput.c   float   kg/m^3  averaged suspended concentration per grain class
+ * conc         HydroOutput.c   float   kg/m^3  averaged suspended concentration per grain class
  * Cstot        HydroOutput.c   float   kg/m^3  averaged suspended concentration total
  * dep[]        HydroOutput.c   float   m       river depth
  * err          various         int     -       error flag, halts program
@@ -40,6 +40,11 @@
 #include "hydrofree_mem.h"
 #include "hydrodaysmonths.h"
 
+#define recperyear (hydro_state->output_recperyear)
+
+static void
+hydrooutputrecord(int outlet, float* rec);
+
 /*------------------------
  *  Start of HydroOutput
  *------------------------*/
@@ -56,13 +61,12 @@ hydrooutput()
     int ii, jj, kk, p;
     int err, comLen, nrecords, nYears;
 
-    static int recperyear;
-
     float   vel[daysiy], wid[daysiy], dep[daysiy];
     float**   veloutlet, **widoutlet, **depoutlet;
     float   Qavg[daysiy], Qbavg[daysiy], **Qavgoutlet, **Qbavgoutlet;
     float   Qsavg[daysiy], **Qsavgoutlet;
-    float   Cs, Cstot, *Csoutlet, *Cstotoutlet;
+    float   conc, Cstot, *concoutlet, *Cstotoutlet;
+    float   rec[4 + maxgrn];
     Cstot = 0.0;
     err = 0;
 
@@ -75,7 +79,7 @@ hydrooutput()
     Qavgoutlet          = malloc2d(daysiy, maxnoutlet, float);
     Qbavgoutlet         = malloc2d(daysiy, maxnoutlet, float);
     Qsavgoutlet         = malloc2d(daysiy, maxnoutlet, float);
-    Csoutlet            = malloc1d(maxnoutlet, float);
+    concoutlet            = malloc1d(maxnoutlet, float);
     Cstotoutlet         = malloc1d(maxnoutlet, float);
 
     /*------------------------------------------------
@@ -97,20 +101,22 @@ hydrooutput()
         nYears   = syear[nepochs - 1] + nyears[nepochs - 1] - syear[0];
         comLen   = strlen(title[0]) - 1;
         nrecords = nYears * recperyear;
-        fwrite(&comLen,  sizeof(int),      1, fiddistot);
-        fwrite(title[0], sizeof(char), comLen, fiddistot);
-        fwrite(&ngrain,  sizeof(int),      1, fiddistot);
-        fwrite(&recperyear,  sizeof(int),      1, fiddistot);
-        fwrite(&nrecords,  sizeof(int),      1, fiddistot);
+        if (hydro_state->record_func == NULL) {
+            fwrite(&comLen,  sizeof(int),      1, fiddistot);
+            fwrite(title[0], sizeof(char), comLen, fiddistot);
+            fwrite(&ngrain,  sizeof(int),      1, fiddistot);
+            fwrite(&recperyear,  sizeof(int),      1, fiddistot);
+            fwrite(&nrecords,  sizeof(int),      1, fiddistot);
 
-        if (outletmodelflag == 1)
-            for (p = 0; p < maxnoutlet; p++) {
-                fwrite(&comLen,  sizeof(int),      1, fiddis[p]);
-                fwrite(title[0], sizeof(char), comLen, fiddis[p]);
-                fwrite(&ngrain,  sizeof(int),      1, fiddis[p]);
-                fwrite(&recperyear,  sizeof(int),      1, fiddis[p]);
-                fwrite(&nrecords,  sizeof(int),      1, fiddis[p]);
-            }
+            if (outletmodelflag == 1)
+                for (p = 0; p < maxnoutlet; p++) {
+                    fwrite(&comLen,  sizeof(int),      1, fiddis[p]);
+                    fwrite(title[0], sizeof(char), comLen, fiddis[p]);
+                    fwrite(&ngrain,  sizeof(int),      1, fiddis[p]);
+                    fwrite(&recperyear,  sizeof(int),      1, fiddis[p]);
+                    fwrite(&nrecords,  sizeof(int),      1, fiddis[p]);
+                }
+        }
     }
 
     /*-------------------------------------
@@ -120,7 +126,7 @@ hydrooutput()
 
         /*------------------------------------------
          *  Calculate V,W,D.
-         *  Daily Qb and Cs are already calculated
+         *  Daily Qb and conc are already calculated
          *------------------------------------------*/
         for (jj = 0; jj < recperyear; jj++) {
             Qavg[jj]    = (float)(Qsumtot[jj]);
@@ -291,7 +297,8 @@ hydrooutput()
     }  /* end if-else for time interval */
 
     /*
-     *  Print the data for each year to the binary file
+     *  Print the data for each year to the binary file (or hand
+     *  it to the record function of the run)
      *      velocity
      *      width
      *      depth
@@ -299,37 +306,41 @@ hydrooutput()
      *      *conc[ii]
      */
     for (jj = 0; jj < recperyear; jj++) {
-        fwrite(&vel[jj], sizeof(float), 1, fiddistot);
-        fwrite(&wid[jj], sizeof(float), 1, fiddistot);
-        fwrite(&dep[jj], sizeof(float), 1, fiddistot);
-        fwrite(&Qbavg[jj], sizeof(float), 1, fiddistot);
+        rec[0] = vel[jj];
+        rec[1] = wid[jj];
+        rec[2] = dep[jj];
+        rec[3] = Qbavg[jj];
 
         for (kk = 0; kk < ngrain; kk++) {
-            Cs = (float)(grainpct[kk][ep] * Qsavg[jj] / Qavg[jj]);
+            conc = (float)(grainpct[kk][ep] * Qsavg[jj] / Qavg[jj]);
 
             if (Qavg[jj] == 0.0) {
-                Cs = 0.0;
+                conc = 0.0;
             }
 
-            fwrite(&Cs, sizeof(float), 1, fiddistot);
+            rec[4 + kk] = conc;
         }
 
+        hydrooutputrecord(0, rec);
+
         if (outletmodelflag == 1)
             for (p = 0; p < maxnoutlet; p++) {
-                fwrite(&veloutlet[jj][p], sizeof(float), 1, fiddis[p]);
-                fwrite(&widoutlet[jj][p], sizeof(float), 1, fiddis[p]);
-                fwrite(&depoutlet[jj][p], sizeof(float), 1, fiddis[p]);
-                fwrite(&Qbavgoutlet[jj][p], sizeof(float), 1, fiddis[p]);
+                rec[0] = veloutlet[jj][p];
+                rec[1] = widoutlet[jj][p];
+                rec[2] = depoutlet[jj][p];
+                rec[3] = Qbavgoutlet[jj][p];
 
                 for (kk = 0; kk < ngrain; kk++) {
-                    Csoutlet[p] = (float)(grainpct[kk][ep] * Qsavgoutlet[jj][p] / Qavgoutlet[jj][p]);
+                    concoutlet[p] = (float)(grainpct[kk][ep] * Qsavgoutlet[jj][p] / Qavgoutlet[jj][p]);
 
                     if (Qavgoutlet[jj][p] == 0.0) {
-                        Csoutlet[p] = 0.0;
+                        concoutlet[p] = 0.0;
                     }
 
-                    fwrite(&Csoutlet[p], sizeof(float), 1, fiddis[p]);
+                    rec[4 + kk] = concoutlet[p];
                 }
+
+                hydrooutputrecord(p + 1, rec);
             }
     }
 
@@ -396,14 +407,14 @@ hydrooutput()
                     Cstot = 0.0;
                 }
 
-                Cs = (float)(grainpct[kk][ep] * Qsavg[jj] / Qavg[jj]);
+                conc = (float)(grainpct[kk][ep] * Qsavg[jj] / Qavg[jj]);
 
                 if (Qavg[jj] == 0) {
-                    Cs = 0.0;
+                    conc = 0.0;
                 }
 
-                Cstot += Cs;
-                fprintf(outp4, "%.3f ", Cs);
+                Cstot += conc;
+                fprintf(outp4, "%.3f ", conc);
 
                 if (kk == ngrain - 1) {
                     fprintf(outp2, "%.3f\t %.3f ", Cstot, Cstot * vel[jj]*wid[jj]*dep[jj]);
@@ -424,14 +435,14 @@ hydrooutput()
                             Cstotoutlet[p] = 0.0;
                         }
 
-                        Csoutlet[p] = (float)(grainpct[kk][ep] * Qsavgoutlet[jj][p] / Qavgoutlet[jj][p]);
+                        concoutlet[p] = (float)(grainpct[kk][ep] * Qsavgoutlet[jj][p] / Qavgoutlet[jj][p]);
 
                         if (Qavgoutlet[jj][p] == 0) {
-                            Csoutlet[p] = 0.0;
+                            concoutlet[p] = 0.0;
                         }
 
-                        Cstotoutlet[p] += Csoutlet[p];
-                        fprintf(outp4, "%.3f ", Csoutlet[p]);
+                        Cstotoutlet[p] += concoutlet[p];
+                        fprintf(outp4, "%.3f ", concoutlet[p]);
 
                         if (kk == ngrain - 1) {
                             fprintf(outp2, "%.3f %.3f ", Cstotoutlet[p],
@@ -460,9 +471,39 @@ hydrooutput()
     freematrix2D((void**)Qavgoutlet, daysiy);
     freematrix2D((void**)Qbavgoutlet, daysiy);
     freematrix2D((void**)Qsavgoutlet, daysiy);
-    freematrix1D((void*)Csoutlet);
+    freematrix1D((void*)concoutlet);
     freematrix1D((void*)Cstotoutlet);
 
     return (err);
 }  /* end of HydroOutput.c */
 
+/*--------------------------------------------------------------
+ *  Write one record of an outlet (0 is the river as a whole)
+ *  to its binary file, or pass it to the record function.
+ *--------------------------------------------------------------*/
+static void
+hydrooutputrecord(int outlet, float* rec)
+{
+    if (hydro_state->record_func) {
+        Hydrotrend_record r;
+
+        r.outlet       = outlet;
+        r.year         = yr;
+        r.n_grains     = ngrain;
+        r.rec_per_year = recperyear;
+        r.velocity     = rec[0];
+        r.width        = rec[1];
+        r.depth        = rec[2];
+        r.bedload      = rec[3];
+        r.conc         = rec + 4;
+
+        if ((*hydro_state->record_func)(&r, hydro_state->record_data) != 0) {
+            fprintf(stderr, " HydroOutput: run stopped by its record function \n\n");
+            hydroabort(1);
+        }
+    } else if (outlet == 0) {
+        fwrite(rec, sizeof(float), 4 + ngrain, fiddistot);
+    } else {
+        fwrite(rec, sizeof(float), 4 + ngrain, fiddis[outlet - 1]);
+    }
+}  /* end of HydroOutputRecord */
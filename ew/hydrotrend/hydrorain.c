@@ -286,7 +286,7 @@ hydrorain()
             fprintf(stderr, " \t Day \t d \t %d \n", ii + 1);
             fprintf(stderr, " \t Year \t d \t %d \n", yr + 1);
             fprintf(stderr, " \t Epoch \t - \t %d \n", ep + 1);
-            exit(-1);
+            hydroabort(-1);
         }
 
         /*------------------------------------------------
@@ -403,7 +403,7 @@ hydrorain()
         fprintf(stderr, " \t Year \t d \t %d \n", yr + 1);
         fprintf(stderr, " \t Epoch \t - \t %d \n\n", ep + 1);
 
-        exit(-1);
+        hydroabort(-1);
     }
 
 #ifdef DBG
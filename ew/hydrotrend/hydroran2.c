@@ -19,6 +19,23 @@
 #include <math.h>
 #include "hydroparams.h"
 
+/*
+ *  The generators keep their state in the Hydrotrend_state of the run
+ *  (where idum2, idum22, idum23 and idum5 start at 123456789).
+ */
+#define idum2   (hydro_state->idum2)
+#define iy      (hydro_state->iy)
+#define iv      (hydro_state->iv)
+#define idum22  (hydro_state->idum22)
+#define iy2     (hydro_state->iy2)
+#define iv2     (hydro_state->iv2)
+#define idum23  (hydro_state->idum23)
+#define iy3     (hydro_state->iy3)
+#define iv3     (hydro_state->iv3)
+#define idum5   (hydro_state->idum5)
+#define iy5     (hydro_state->iy5)
+#define iv5     (hydro_state->iv5)
+
 #define IM1 2147483563
 #define IM2 2147483399
 #define AM  (1.0/IM1)
@@ -89,9 +106,6 @@ hydroran2(long* idum)
 {
     int jj;
     long kk;
-    static long idum2 = 123456789;
-    static long iy = 0;
-    static long iv[NTAB];
     float temp;
 
     /*----------------------------
@@ -163,9 +177,6 @@ hydroran3(long* idumb)
 {
     int jjj;
     long kkk;
-    static long idum22 = 123456789;
-    static long iy2 = 0;
-    static long iv2[BNTAB];
     float temp2;
 
     /*----------------------------
@@ -238,9 +249,6 @@ hydroran4(long* idumc)
 {
     int j;
     long k;
-    static long idum23 = 123456789;
-    static long iy3 = 0;
-    static long iv3[CNTAB];
     float temp3;
 
     /*----------------------------
@@ -313,9 +321,6 @@ hydroran5(long* idumd)
 {
     int j;
     long k;
-    static long idum5 = 123456789;
-    static long iy5 = 0;
-    static long iv5[DNTAB];
     float temp5;
 
     /*----------------------------
@@ -379,3 +384,56 @@ hydroran5(long* idumd)
 
 }  /* end of HydroRan5.c */
 
+/*
+ *  HydroRand
+ *
+ *  Generates uniformly distributed integers between 0 and 2^31-1.
+ *
+ *  This is the additive feedback generator of the C library's rand()
+ *  with its default seed (as if from srand(1)), which HydroSedLoad used
+ *  to call.  It returns the same sequence as rand() did but keeps its
+ *  state in the Hydrotrend_state so that concurrent runs do not share it.
+ */
+#define RAND_SEP    (3)
+
+void
+hydrorandinit(void)
+{
+    long word, hi, lo;
+    int ii;
+
+    hydro_state->rand_tbl[0] = word = 1;
+
+    for (ii = 1; ii < HYDRO_RAND_DEG; ii++) {
+        hi = word / 127773;
+        lo = word % 127773;
+        word = 16807 * lo - 2836 * hi;
+
+        if (word < 0) {
+            word += 2147483647;
+        }
+
+        hydro_state->rand_tbl[ii] = (unsigned int)word;
+    }
+
+    hydro_state->rand_front = RAND_SEP;
+    hydro_state->rand_rear = 0;
+
+    for (ii = 0; ii < 10 * HYDRO_RAND_DEG; ii++) {
+        hydrorand();
+    }
+}
+
+int
+hydrorand(void)
+{
+    unsigned int* tbl = hydro_state->rand_tbl;
+    unsigned int val;
+
+    val = (tbl[hydro_state->rand_front] += tbl[hydro_state->rand_rear]);
+
+    hydro_state->rand_front = (hydro_state->rand_front + 1) % HYDRO_RAND_DEG;
+    hydro_state->rand_rear = (hydro_state->rand_rear + 1) % HYDRO_RAND_DEG;
+
+    return (int)(val >> 1);
+}  /* end of HydroRand */
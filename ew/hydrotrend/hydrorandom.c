@@ -40,11 +40,6 @@
 #include "hydrofree_mem.h"
 #include "hydrornseeds.h"
 
-long rnseed  = INIT_RAN_NUM_SEED;
-long rnseed3 = INIT_RAN_NUM_SEED;
-long rnseed4 = INIT_RAN_NUM_SEED;
-long rnseed5 = INIT_RAN_NUM_SEED;
-
 /*------------------------
  *  Start of HydroRandom
  *------------------------*/
@@ -105,9 +105,9 @@ Read_Rainfall_Etc(gw_rainfall_etc* gw_rain)
     }
 
     if (webflag != 1) {
-        if ((fidinputgw_r = fopen(fnameinputgw_r, "r")) == NULL) {
+        if ((fidinputgw_r = fopen(ffnameinputgw_r, "r")) == NULL) {
             fprintf(stderr, "  Read_Rainfall_Etc MESSAGE: Unable to open input file %s \n",
-                fnameinputgw_r);
+                ffnameinputgw_r);
             fprintf(stderr, "    Hydrotrend will generate it's own climate values based on\n");
             fprintf(stderr, "    line 14-25 of the input values in the input file.\n\n");
             raindatafile = 0;
@@ -146,7 +146,7 @@ Read_Rainfall_Etc(gw_rainfall_etc* gw_rain)
             fprintf(stderr, "    is not equal to number of years of climate data: %f.\n",
                 dummydouble);
             fprintf(stderr, "    program aborted \n");
-            exit(-1);
+            hydroabort(-1);
         }
 
         /*------------------------------
@@ -178,10 +178,10 @@ Read_Rainfall_Etc(gw_rainfall_etc* gw_rain)
                         n = (n + 1) * (k + 1) * (i + 1);
                         fprintf(stderr, "  HydroReadclimate.c ERROR: Error occured when\n");
                         fprintf(stderr, "    trying to read line %ld\n", n);
-                        fprintf(stderr, "    of file: %s.\n", fnameinputgw_r);
+                        fprintf(stderr, "    of file: %s.\n", ffnameinputgw_r);
                         fprintf(stderr, "    Precipitation or Temperature data is missing\n");
                         fprintf(stderr, "    program aborted \n");
-                        exit(-1);
+                        hydroabort(-1);
                     }
 
                     if (dummyR < 0.0 || dummyR > 1000.0) {
@@ -189,7 +189,7 @@ Read_Rainfall_Etc(gw_rainfall_etc* gw_rain)
                         fprintf(stderr, "    Precipitation data out of range,\n");
                         fprintf(stderr, "    ppt is 1000.0 < %f < 0.0\n ", dummyR);
                         fprintf(stderr, "    program aborted \n");
-                        exit(-1);
+                        hydroabort(-1);
                     }
 
                     if (dummyT < -50.0 || dummyT > 50.0) {
@@ -197,7 +197,7 @@ Read_Rainfall_Etc(gw_rainfall_etc* gw_rain)
                         fprintf(stderr, "    Precipitation data out of range,\n");
                         fprintf(stderr, "    ppt of 80.0 < %f < -80.0 ", dummyT);
                         fprintf(stderr, "    program aborted \n");
-                        exit(-1);
+                        hydroabort(-1);
                     }
 
                     dummyRtot += dummyR;
@@ -28,8 +28,8 @@ int
 hydroreadhypsom()
 {
     double dumdbl, dummyelev, adjusttosealevel;
-    int dumint, err, kk, i, k, ep;
-    char chs[120], dummystring[100];
+    int dumint, err, kk, i, k, epoch;
+    char chs[120], dummystring[MAXCH];
     err = 0;
 
     /*-----------------------
@@ -38,18 +38,18 @@ hydroreadhypsom()
     if (webflag == 0) {
         fidhyps = allocate_1d_F(nepochs);
 
-        for (ep = 0; ep < nepochs; ep++) {
-            sprintf(dummystring, "%s%d", fnamehyps, ep);
+        for (epoch = 0; epoch < nepochs; epoch++) {
+            sprintf(dummystring, "%s%d", inputprefix, epoch);
             strcpy(ffnamehyps, dummystring);
             strcat(ffnamehyps, fnamehypsext);
 
-            if ((fidhyps[ep] = fopen(ffnamehyps, "r")) == NULL) {
+            if ((fidhyps[epoch] = fopen(ffnamehyps, "r")) == NULL) {
                 fprintf(stderr,
                     "  openfiles ERROR: Unable to open the hypsometeric integral data file %s \n",
                     ffnamehyps);
                 fprintf(stderr, "    Make sure the input file name is all in capitals\n");
                 fprintf(stderr, "    program aborted \n");
-                exit(1);
+                hydroabort(1);
             }
         }
     }
@@ -57,9 +57,9 @@ hydroreadhypsom()
     /*------------------------
      *  Take off file header
      *------------------------*/
-    for (ep = 0; ep < nepochs; ep++)
+    for (epoch = 0; epoch < nepochs; epoch++)
         for (k = 0; k < 8; k++) {
-            fgets(chs, 120, fidhyps[ep]);
+            fgets(chs, 120, fidhyps[epoch]);
         }
 
     /*------------------
@@ -69,14 +69,14 @@ hydroreadhypsom()
 
     if (!hypsarea) {
         perror("HYDROTREND ERROR; hydroreadhypsom.c\n");
-        exit(-1);
+        hydroabort(-1);
     }
 
     hypselev = (double**)malloc((nepochs) * sizeof(double*));
 
     if (!hypselev) {
         perror("HYDROTREND ERROR; hydroreadhypsom.c\n");
-        exit(-1);
+        hydroabort(-1);
     }
 
     /*--------------------------------------------
@@ -94,14 +94,14 @@ hydroreadhypsom()
 
             if (!hypselev[i]) {
                 perror("HYDROTREND ERROR; hydroreadhypsom.c\n");
-                exit(-1);
+                hydroabort(-1);
             }
 
             hypsarea[i] = (double*)malloc((nhypts[i]) * sizeof(double));
 
             if (!hypsarea[i]) {
                 perror("HYDROTREND ERROR; hydroreadhypsom.c\n");
-                exit(-1);
+                hydroabort(-1);
             }
 
             for (kk = 0; kk < nhypts[i]; kk++) {
@@ -110,7 +110,7 @@ hydroreadhypsom()
 
                 if (dumint != 2) {
                     printf("hydrotrend error; hydroreadhypsom.c\n");
-                    exit(-1);
+                    hydroabort(-1);
                 }
 
                 if (kk == 0 && dummyelev < 0.0) {
@@ -135,7 +135,7 @@ hydroreadhypsom()
                         printf("   Elevation bin size was set to %.4g, calculated binsize at %d is %.4g.\n",
                             elevbinsize, kk + 1, hypselev[i][kk] - hypselev[i][kk - 1]);
                         printf("   Elevation = %.4g\n\n", hypselev[i][kk]);
-                        exit(-1);
+                        hydroabort(-1);
                     }
             }
 
@@ -198,14 +198,14 @@ hydroreadhypsom()
 
             if (!hypselev[k + 1]) {
                 perror("HYDROTREND ERROR; hydroreadhypsom.c\n");
-                exit(-1);
+                hydroabort(-1);
             }
 
             hypsarea[k + 1] = (double*)malloc((nhypts[k]) * sizeof(double));
 
             if (!hypsarea[k + 1]) {
                 perror("HYDROTREND ERROR; hydroreadhypsom.c\n");
-                exit(-1);
+                hydroabort(-1);
             }
 
             for (kk = 0; kk < nhypts[k]; kk++) {
@@ -223,14 +223,14 @@ hydroreadhypsom()
 
             if (!hypselev[k + 1]) {
                 perror("HYDROTREND ERROR; hydroreadhypsom.c\n");
-                exit(-1);
+                hydroabort(-1);
             }
 
             hypsarea[k + 1] = (double*)malloc((nhypts[k]) * sizeof(double));
 
             if (!hypsarea[k + 1]) {
                 perror("HYDROTREND ERROR; hydroreadhypsom.c\n");
-                exit(-1);
+                hydroabort(-1);
             }
 
             for (kk = 0; kk < nhypts[k]; kk++) {
@@ -46,12 +46,12 @@ hydroreadinput()
      *  Open the input file
      *-----------------------*/
     if (webflag == 0)
-        if ((fidinput = fopen(fnameinput, "r")) == NULL) {
+        if ((fidinput = fopen(ffnameinput, "r")) == NULL) {
             fprintf(stderr, "  HydroReadInput.c ERROR: Unable to open the input file %s \n",
-                fnameinput);
+                ffnameinput);
             fprintf(stderr, "    Make sure the input file name is all in capitals\n");
             fprintf(stderr, "    program aborted \n");
-            exit(1);
+            hydroabort(1);
         }
 
     /*---------------------------------------
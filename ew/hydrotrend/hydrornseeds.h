@@ -2,16 +2,9 @@
 #define HYDRORNSEEDS_H_
 
 /*
-static long     rnseed = INIT_RAN_NUM_SEED;
-static long     rnseed3 = INIT_RAN_NUM_SEED;
-static long rnseed4 = INIT_RAN_NUM_SEED;
-static long rnseed5 = INIT_RAN_NUM_SEED;
-*/
-
-extern long rnseed;
-extern long rnseed3;
-extern long rnseed4;
-extern long rnseed5;
+ *  The seeds (rnseed, rnseed3, rnseed4 and rnseed5) are members of the
+ *  Hydrotrend_state of the current run.  They start at INIT_RAN_NUM_SEED.
+ */
+#include "hydrostate.h"
 
 #endif
-
@@ -39,7 +39,7 @@ hydrosecurityinputcheck()
             "  HydroSecurityinputcheck.c ERROR: Unable to open the input file %s \n", ffnameinput);
         fprintf(stderr, "    Make sure the input file name is all in capitals\n");
         fprintf(stderr, "    program aborted \n");
-        exit(1);
+        hydroabort(1);
     }
 
     if ((fidhyps[i] = fopen(ffnamehyps, "r")) == NULL) {
@@ -48,7 +48,7 @@ hydrosecurityinputcheck()
             ffnamehyps);
         fprintf(stderr, "    Make sure the input file name is all in capitals\n");
         fprintf(stderr, "    program aborted \n");
-        exit(1);
+        hydroabort(1);
     }
 
     if ((fidinputgw_r = fopen(ffnameinputgw_r, "r")) == NULL) {
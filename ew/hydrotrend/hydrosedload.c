@@ -268,14 +268,14 @@ hydrosedload(gw_rainfall_etc* gw_rain)
         C = malloc1d(nyears[ep], double);
 
         for (j = 0; j < nyears[ep]; j++) {
-            unit_normal2 = ((rand() / 327680000.9));
+            unit_normal2 = ((hydrorand() / 327680000.9));
             //      printf( "%f\n",unit_normal2);
             normal2 = (s * unit_normal2) + cbar;
             C[j] = normal2;
             //      printf("%f\n",C[j]);
         }
 
-        //  exit(-1);
+        //  hydroabort(-1);
     }
 
     for (i = 0; i < daysiy; i++) {
@@ -372,7 +372,7 @@ hydrosedload(gw_rainfall_etc* gw_rain)
 
                             if (test == 0.000) {
                                 printf("test=%f", test);
-                                exit(-1);
+                                hydroabort(-1);
                             }
 
                             cbaroutlet[p]   = (1.4 - (0.025 * Tbar) + (0.00013 * H) + (0.145 * log(test)));
@@ -47,7 +47,7 @@ hydrosetglobalpar()
             fprintf(stderr,
                 "  HydroSetGlobalPar ERROR: Unable to open the lapserate table file %s \n",
                 fnamelapserate);
-            exit(-1);
+            hydroabort(-1);
         }
 
         dumint = 5;
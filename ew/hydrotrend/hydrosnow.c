@@ -19,7 +19,7 @@
  * shldday[]    HydroSnow.c     double  m^3/s   shoulder discharge array
  * Tcorrection  HydroSnow.c     double  degC    melt modifier for rain fall
  * melt         HydroSnow.c     double  m       snow melt on a given day
- * Minput       HydroSnow.c     double  m^3/a   snow input in a year
+ * Msnowinput   HydroSnow.c     double  m^3/a   snow input in a year
  * Mout         HydroSnow.c     double  m^3/a   snow melt output in a year
  * Mwrapin      HydroSnow.c     double  m^3/a   nival discharge from previous year
  * Mwrapout     HydroSnow.c     double  m^3/a   nival discharge to next year
@@ -57,13 +57,13 @@ hydrosnow()
 
     int err, ii, jj, kk;
     double shldday[maxday], Tcorrection, melt;
-    double Minput, Mout, Mwrapin, Mwrapout, Mgw, Mnival;
+    double Msnowinput, Mout, Mwrapin, Mwrapout, Mgw, Mnival;
 
     /*-----------------
      *  Set Variables
      *-----------------*/
     err = 0;
-    Minput      = 0.0;
+    Msnowinput  = 0.0;
     Mgw         = 0.0;
     Mnival      = 0.0;
     Mout        = 0.0;
@@ -355,20 +355,20 @@ hydrosnow()
 #endif
 
     Mout = Mgw + Mnival + Enivalannual * totalarea[ep] + Msnowend + Mwrapout;
-    Minput = MPnival + Mwrapin + Msnowstart;
+    Msnowinput = MPnival + Mwrapin + Msnowstart;
 
-    if ((fabs(Mout - Minput) / Minput) > masscheck) {
+    if ((fabs(Mout - Msnowinput) / Msnowinput) > masscheck) {
         fprintf(stderr, "\nERROR in HydroSnow: \n");
         fprintf(stderr, "  Mass Balance error: Mout != Minput \n\n");
 
         fprintf(stderr, "\t fabs(Mout-Minput)/Minput > masscheck \n");
         fprintf(stderr, "\t note: masscheck set in HydroParams.h \n");
         fprintf(stderr, "\t masscheck     \t = %f (%%) \n", masscheck);
-        fprintf(stderr, "\t abs(out-in)/in\t = %f (%%) \n", fabs(Mout - Minput) / Minput);
-        fprintf(stderr, "\t out-in        \t = %e (m^3) \n\n", Mout - Minput);
+        fprintf(stderr, "\t abs(out-in)/in\t = %f (%%) \n", fabs(Mout - Msnowinput) / Msnowinput);
+        fprintf(stderr, "\t out-in        \t = %e (m^3) \n\n", Mout - Msnowinput);
 
         fprintf(stderr, " \t Minput = MPnival + Mwrapin + Msnowstart (m^3) \n");
-        fprintf(stderr, " \t Minput       \t = %e \n", Minput);
+        fprintf(stderr, " \t Minput       \t = %e \n", Msnowinput);
         fprintf(stderr, " \t MPnival      \t = %e \n", MPnival);
         fprintf(stderr, " \t Mwrapin      \t = %e \n", Mwrapin);
         fprintf(stderr, " \t Msnowstart   \t = %e \n\n", Msnowstart);
@@ -381,7 +381,7 @@ hydrosnow()
         fprintf(stderr, " \t Enivalannual \t = %e \n", Enivalannual * totalarea[ep]);
         fprintf(stderr, " \t Mwrapout     \t = %e \n", Mwrapout);
         fprintf(stderr, " \t Msnowend     \t = %e \n\n", Msnowend);
-        exit(-1);
+        hydroabort(-1);
     }
 
     return (err);
@@ -0,0 +1,692 @@
+/*
+ *  HydroState.h
+ *
+ *  Holds everything that one HydroTrend run reads and writes.
+ *
+ *  The model was written with its state in global variables that were
+ *  declared in hydroparams.h, hydroinout.h, hydrotimeser.h and
+ *  hydroclimate.h.  Those variables are now members of a Hydrotrend_state
+ *  and the old names are macros that refer to the state that the current
+ *  thread is running (hydro_state).  This way the model code reads as it
+ *  always has but several rivers can be run at once, one per thread.
+ *
+ *  malloc, calloc, realloc and free are macros as well.  The memory that
+ *  a run allocates is kept in a list of its state so that a run that is
+ *  aborted (hydroabort) doesn't leak it.
+ *
+ *  Define HYDROSTATE_NO_GLOBALS before including this file to get the
+ *  structure without the macros.
+ */
+
+#ifndef HYDROSTATE_H_
+#define HYDROSTATE_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <ctype.h>
+#include <time.h>
+#include <setjmp.h>
+
+#include "hydroparams.h"
+#include "hydroinout.h"
+#include "hydrotimeser.h"
+#include "hydroclimate.h"
+#include "hydrotrend_api.h"
+
+#if defined(_MSC_VER)
+# define HYDRO_THREAD_LOCAL __declspec(thread)
+#else
+# define HYDRO_THREAD_LOCAL __thread
+#endif
+
+#define HYDRO_RAN_NTAB  (32)    /* shuffle table of the hydroran generators */
+#define HYDRO_RAND_DEG  (31)    /* degree of the hydrorand generator */
+#define HYDRO_MAX_ARGS  (3)
+
+/*
+ *  Every block that a run allocates starts with one of these so that
+ *  whatever an aborted run leaves behind can be found and freed.  The
+ *  union keeps the memory that follows it aligned for any type.
+ */
+typedef union _Hydro_block {
+    struct {
+        union _Hydro_block* prev;
+        union _Hydro_block* next;
+        Hydrotrend_state*   owner;
+    } link;
+    long double align;
+} Hydro_block;
+
+struct _Hydrotrend_state {
+    /*=== Formerly the globals of hydroparams.h ===*/
+
+    /*-------------------
+     *  Time Parameters
+     *-------------------*/
+    int     nepochs, ep;
+    int     yr, total_yr;
+    int     nyears[maxepoch], syear[maxepoch];
+    int     tblstart[maxepoch], tblend[maxepoch];
+    char        timestep[2];
+
+    /*---------------------------------
+     *  Sediment Transport Parameters
+     *---------------------------------*/
+    int     ngrain;                     /* number of grain sizes */
+    double      grainpct[maxgrn][maxepoch]; /* % of each grain size, HARDWIRED */
+
+    /*--------------------
+     *  Event Parameters
+     *--------------------*/
+    int     eventcounter;                               /* keeps track of the events per epoch */
+    long*    numberday;                          /* parameter to store temperatly which day of the year the event occured */
+    int     eventsperyear;                              /* number of events that occur per year */
+    int     eventsnr[maxepoch];
+    double      floodvalue[maxepoch];
+    int     floodcounter;
+    int     eventnrflag;                                /* indicates is number of events is given or is Qpeak which triggers events is given */
+
+    /*--------------------
+     *  Delta Parameters
+     *--------------------*/
+    int     noutlet;                                    /* number of outlets */
+    int     minnoutlet;                                 /* min number of outlets in a range */
+    int     maxnoutlet;                                 /* max number of outlets in a range */
+    double***  outletpct;                               /* % of each outlet, HARDWIRED */
+    double  sedfilter[maxepoch];                        /* filter variable for the delta outlets */
+    double  totpercentageQ[maxepoch];
+    double** outletpcttotevents;                       /* total average percentages per outlet */
+    int*     nroutlets;
+    int     outletmodelflag;                            /* 1 if delta, 0 for no delta (no multiple outlets) */
+    int     nooutletpctflag;                            /* indicator if Q fractions are given by user or not */
+    int     noutletflag;
+    int     steadyoutletpctflag;                        /* indicator if Q fractions has to be kept the same or change per event */
+    double**      outletpctdummy;
+
+    /*----------------------------
+     *  Sediment Load Parameters
+     *----------------------------*/
+    double threshbed[maxepoch];
+    double* C;
+
+    /*------------------------
+     *  Hydraulic Parameters
+     *------------------------*/
+    double  depcof[maxepoch],       deppow[maxepoch];   /* d = (c * Q^f) */
+    double  velcof[maxepoch],   velpow[maxepoch];   /* v = (k * Q^m)  */
+    double  widcof[maxepoch],       widpow[maxepoch];   /* w = (a * Q^b) */
+    double  avgvel[maxepoch];                     /* Avg. river vel. (m/s) */
+    double  rslope[maxepoch];                     /* Riverbed avg. slope (deg)*/
+
+    /*----------------------
+     *  Terrain Parameters
+     *----------------------*/
+    double elevbinsize;
+    int nhypts[maxepoch];           /* size of hypsometry array per epoch */
+    double*  areabins;
+    double*  elevbins;
+    double  hypspow[maxepoch];
+    double**  hypsarea;
+    double**  hypselev;
+    double  basinlength[maxepoch];   /* River basin length (meters) */
+    double  maxalt[maxepoch];        /* Now computed in hydroreadhypsom.c  */
+    double  totalarea[maxepoch];     /* Now computed in hydroreadhypsom.c  */
+    double  basin_relief[maxepoch];  /****  REPLACE maxalt ??  ****/
+    double  basin_area[maxepoch];    /****  REPLACE totalarea ?? ****/
+
+    /*---------------------------------
+     *  General Hydrologic Parameters
+     *---------------------------------*/
+    int* distbins;              /* days to discharge a bin */
+    int exceedflood;            /* flag for whether maxflood exceeded */
+    int floodtry;
+    double  maxflood;               /* theoretical max flood size */
+    double  Rvol[maxepoch];         /* storage capacity of lake/reservoir */
+    double Ralt[maxepoch];          /* alitude of the lake/reservoir */
+    double  Rarea[maxepoch];        /* drainage area above the reservoir */
+    double TE[maxepoch];            /* Trapping efficiency */
+    double TEsubbasin[maxepoch];
+    char    Rparamcheck[maxepoch];  /* indicator if alt. or drainage area is used as input */
+    double  alphac[maxepoch];    /*  OBSOLETE ?? */
+    double  betac[maxepoch];     /*  OBSOLETE ?? */
+    double  rhosed[maxepoch];    /***  HARDWIRE  ***/
+    double  rhowater[maxepoch];  /***  HARDWIRE  ***/
+
+    /*------------------------
+     *  Rainfall Parameters
+     *------------------------*/
+    double  alphag[maxepoch];       /***  HARDWIRE  ***/
+    double  betag[maxepoch];        /***  HARDWIRE  ***/
+    double  pcr[maxepoch];      /***  HARDWIRE  ***/
+    double  pmax[maxepoch];     /***  HARDWIRE  ***/
+    double  MPrain;
+
+    /*--------------------------
+     *  Groundwater Parameters
+     *--------------------------*/
+    double  Ko[maxepoch];                         /* sat. hydr. cond. (mm/day) */
+    double  alphass[maxepoch];
+    double  betass[maxepoch];
+    double  gwinitial;                    /* initial GW storage (m^3) */
+    double  gwlast;
+    double  gwmin[maxepoch], gwmax[maxepoch];     /* min/max storage (m^3) */
+    double  percentgw[maxepoch];              /* % of snow/ice melt to GW */
+    double  alphagwe[maxepoch];           /* evaporation coeff */
+    double  betagwe[maxepoch];            /* evaporation exponent */
+
+    /*-----------------------------
+     *  Snowmelt/Nival Parameters
+     *-----------------------------*/
+    double  dryevap[maxepoch];
+    double  Meltrate[maxepoch];         /***  HARDWIRE ***/
+    double lapserate[maxepoch];
+    double  Msnowstart, Msnowend;
+    double  MPnival;
+
+    /*---------------------------
+     *  Glacier Melt Parameters
+     *---------------------------*/
+    int ELAindex;
+    double  bigg, smallg, lastarea, initiallastarea;
+    double  ela, lastela, initiallastela;
+    double  Gmass;
+    double  MPglacial;
+    double bethaexpo, bethaglacier;
+
+    /*----------------------------
+     *  Random Number Parameters
+     *----------------------------*/
+    int         nran;
+    double*          ranarray;
+    double rmin, rmax;
+
+    /*--------------------------
+     *  Mass Check Parameters
+     *--------------------------*/
+    double  maxerr;
+    double  totalmass;
+
+    /*-------------------------
+     *  Geographic Parameters
+     *-------------------------*/
+    double lat, lon;
+    double alpha3, alpha4, alpha5;
+    double alpha6, alpha7, alpha8;
+    double k1, k2;
+    int Qsbarformulaflag[maxepoch];
+
+    /*-----------------------
+     *  Rainfile parameters
+     *-----------------------*/
+    int raindatafile;
+
+    /*---------------------------------------------
+     *  Parameters to set Qsbarnew for each epoch
+     *---------------------------------------------*/
+    int setstartmeanQandQs; /* loop counter for each epoch (count to 3) */
+
+    /*-------------------------------------------------
+     *  Variables to set ASCII write option ON or OFF
+     *-------------------------------------------------*/
+    char asciioutput[MAXCHAR];
+
+    /*---------------------------------------------------------
+     *  Set the file name and directory parameters + security
+     *---------------------------------------------------------*/
+    char startname[80];
+    char directory[100];
+    char chrdump[80];
+    char commandlinearg[HYDRO_MAX_ARGS][MAXCH];
+    int webflag;
+    int globalparflag;
+    int lapserateflag, velpowflag, widpowflag;
+    double*  Qgrandtotaltotoutlet, Qgrandtotaltot, ** Qdummy, ** Qgrandtotalperepoch;
+    double  Qsgrandtotaltot, *Qsgrandtotaltotoutlet, Qpeakmax, TEtot, yeartot;
+    double Qsoutletdummy;
+    double** Qsbartotoutlet;
+
+    /*=== Formerly the globals of hydroinout.h ===*/
+    FILE*    fidinput;
+    FILE*    fidq;
+    FILE*    fidqs;
+    FILE*    fidtrend1;
+    FILE*    fidtrend2;
+    FILE*    fidtrend3;
+    FILE*    fidstat;
+    FILE*    fiddistot;
+    FILE**    fiddis;
+    FILE*    fidconvdistot;
+    FILE**    fidconvdis;
+    FILE*    fidinputgw_r;
+    FILE**    fidhyps;
+    FILE*    fidlog;
+    FILE*    fidlapserate;
+    FILE*    outp, *outp1, *outp2, *outp3, *outp4, *outp5;
+    FILE*    outpnival_ice;
+    char title[maxepochd][121];
+    char moname[12][4];
+    char ffnameinput[MAXCH];
+    char ffnameq[MAXCH];
+    char ffnameqs[MAXCH];
+    char ffnametrend1[MAXCH];
+    char ffnametrend2[MAXCH];
+    char ffnametrend3[MAXCH];
+    char ffnamestat[MAXCH];
+    char ffnamedis[MAXCH];
+    char ffnamedistot[MAXCH];
+    char ffnameconvdis[MAXCH];
+    char ffnameconvdistot[MAXCH];
+    char ffnamehyps[MAXCH];
+    char ffnameinputgw_r[MAXCH];
+    char ffnamelog[MAXCH];
+    char ffidasc[MAXCH];
+    char ffidasc1[MAXCH];
+    char ffidasc2[MAXCH];
+    char ffidasc3[MAXCH];
+    char ffidasc4[MAXCH];
+    char ffidasc5[MAXCH];
+    char ffidnival_ice[MAXCH];
+
+    /*=== Formerly the globals of hydrotimeser.h ===*/
+    int  FLAindex[daysiy];
+    long* daysievent;
+
+    /*-------------------------------
+     *  Daily suspended and bedload
+     *-------------------------------*/
+    double  Cs[daysiy], ** Csoutlet, Qb[daysiy], ** Qboutlet, Qs[daysiy], ** Qsoutlet;
+
+    /*---------------------------------------------------------
+     *  Daily Temperature, Precipitation and Snow time series
+     *---------------------------------------------------------*/
+    double  rainarea[daysiy], Ecanopy[daysiy];
+    double  Pdaily[daysiy], Tdaily[daysiy], ** Snowelevday;
+
+    /*--------------------------------------------------------------------
+     *  Arrays for each type of daily discharge (rain,snow,ice,total,GW)
+     *--------------------------------------------------------------------*/
+    double  Qrain[maxday], Qice[maxday], Qnival[maxday], Qsumtot[maxday], ** Qsum,
+            Qss[maxday];
+
+    /*--------------------------------------------------
+     *  Arrays for carryover from one year to the next
+     *--------------------------------------------------*/
+    double  Qrainwrap[wrapday], Qicewrap[wrapday], Qnivalwrap[wrapday];
+    double  Qsswrap[wrapday], *Snowcarry;
+
+    /*-------------------------------------------
+     *  Arrays for the groundwater storage pool
+     *-------------------------------------------*/
+    double  gwstore[daysiy], Qicetogw[daysiy], Qnivaltogw[daysiy];
+    double  Egw[daysiy], Qexceedgw[daysiy];
+
+    /*=== Formerly the globals of hydroclimate.h ===*/
+    int nelevbins, shouldern;
+    double  Eiceannual, Enivalannual, ELAchange[maxepoche];
+    double  ELAstart[maxepoche], Ewetannual;
+    double  glacierarea, glacierelev, MEtotal;
+    double  Minput, Moutput, MQprevious, MQnext, Pannual;
+    double  Pchange[maxepoche], Pmassbal[maxepoche], Pexponent[maxepoche];
+    double  Pmonth[nmonth];
+    double  Pnominal[nmonth][maxepoche], Pnomstd[nmonth][maxepoche];
+    double  Prange[maxepoche];
+    double  Pstart[maxepoche], Pstd[maxepoche];
+    double  Qbedannual, *Qbedannualoutlet, Qgrandtotal[maxepoche], *** Qgrandtotaloutlet,
+            Qpeak, *Qpeakevents, *Qpeakperoutlet, ** Qpeakperoutletall, Qtotal, ** Qtotaloutlet,
+            *Qtotaloutletannual, *** Qbar, Qbartotal[maxepoche], Qpeakall[maxepoche],
+            ** Qpeakallevents;
+    double Qsgrandtotal[maxepoche], Qsgrandtotaldelta[maxepoche], ** Qsgrandtotaloutlet,
+           ** Csgrandtotaloutlet, Qsbarnew[maxepoche], Qsbarnew2[maxepoche], Qsannual,
+           *Qsannualoutlet, *Csannualoutlet, Qsbartot[maxepoche], Qsbar[maxepoche],
+           Qsmean[maxepoche], ** Coutlettotal;
+    double baseflowtot[maxepoche], Csannual, Csgrandtotal[maxepoche];
+    double  shoulderright[maxshoulder], shoulderleft, shouldermain;
+    double  Snowremains;
+    double  Tannual, Tchange[maxepoche];
+    double**  Televday, Tmonth[nmonth], Tnominal[nmonth][maxepoche];
+    double  Tnomstd[nmonth][maxepoche], Tstart[maxepoche], Tstd[maxepoche];
+    double** Qpeakfloodtemp;
+
+    /*=== Random number generators ===*/
+    long    rnseed, rnseed3, rnseed4, rnseed5;
+    long    idum2, iy, iv[HYDRO_RAN_NTAB];      /* hydroran2 */
+    long    idum22, iy2, iv2[HYDRO_RAN_NTAB];   /* hydroran3 */
+    long    idum23, iy3, iv3[HYDRO_RAN_NTAB];   /* hydroran4 */
+    long    idum5, iy5, iv5[HYDRO_RAN_NTAB];    /* hydroran5 */
+    unsigned int rand_tbl[HYDRO_RAND_DEG];      /* hydrorand */
+    int     rand_front, rand_rear;
+
+    /*=== Formerly static variables of a function ===*/
+    int     outlet_err;         /* hydrosetnumberoutlet */
+    int     output_recperyear;  /* hydrooutput */
+
+    /*=== Running the model ===*/
+    int     argc;
+    char    argv[HYDRO_MAX_ARGS][MAXCH];
+    char    inputprefix[MAXCH];         /* input files are inputprefix.IN, etc. */
+    Hydrotrend_record_func record_func; /* if set, records are not written to .DIS files */
+    void*   record_data;
+    jmp_buf abort_env;
+    int     abort_is_set;
+    int     abort_status;
+    Hydro_block* blocks;                /* memory allocated by the run */
+};
+
+extern HYDRO_THREAD_LOCAL Hydrotrend_state* hydro_state;
+
+void
+hydroabort(int status);
+void
+hydrorandinit(void);
+int
+hydrorand(void);
+
+void*
+hydromalloc(size_t size);
+void*
+hydrocalloc(size_t n, size_t size);
+void*
+hydrorealloc(void* ptr, size_t size);
+void
+hydrofree(void* ptr);
+void
+hydrofreeblocks(Hydrotrend_state* s);
+
+#if !defined(HYDROSTATE_NO_GLOBALS)
+#define malloc(size)           hydromalloc(size)
+#define calloc(n, size)        hydrocalloc(n, size)
+#define realloc(ptr, size)     hydrorealloc(ptr, size)
+#define free(ptr)              hydrofree(ptr)
+
+#define nepochs                (hydro_state->nepochs)
+#define ep                     (hydro_state->ep)
+#define yr                     (hydro_state->yr)
+#define total_yr               (hydro_state->total_yr)
+#define nyears                 (hydro_state->nyears)
+#define syear                  (hydro_state->syear)
+#define tblstart               (hydro_state->tblstart)
+#define tblend                 (hydro_state->tblend)
+#define timestep               (hydro_state->timestep)
+#define ngrain                 (hydro_state->ngrain)
+#define grainpct               (hydro_state->grainpct)
+#define eventcounter           (hydro_state->eventcounter)
+#define numberday              (hydro_state->numberday)
+#define eventsperyear          (hydro_state->eventsperyear)
+#define eventsnr               (hydro_state->eventsnr)
+#define floodvalue             (hydro_state->floodvalue)
+#define floodcounter           (hydro_state->floodcounter)
+#define eventnrflag            (hydro_state->eventnrflag)
+#define noutlet                (hydro_state->noutlet)
+#define minnoutlet             (hydro_state->minnoutlet)
+#define maxnoutlet             (hydro_state->maxnoutlet)
+#define outletpct              (hydro_state->outletpct)
+#define sedfilter              (hydro_state->sedfilter)
+#define totpercentageQ         (hydro_state->totpercentageQ)
+#define outletpcttotevents     (hydro_state->outletpcttotevents)
+#define nroutlets              (hydro_state->nroutlets)
+#define outletmodelflag        (hydro_state->outletmodelflag)
+#define nooutletpctflag        (hydro_state->nooutletpctflag)
+#define noutletflag            (hydro_state->noutletflag)
+#define steadyoutletpctflag    (hydro_state->steadyoutletpctflag)
+#define outletpctdummy         (hydro_state->outletpctdummy)
+#define threshbed              (hydro_state->threshbed)
+#define C                      (hydro_state->C)
+#define depcof                 (hydro_state->depcof)
+#define deppow                 (hydro_state->deppow)
+#define velcof                 (hydro_state->velcof)
+#define velpow                 (hydro_state->velpow)
+#define widcof                 (hydro_state->widcof)
+#define widpow                 (hydro_state->widpow)
+#define avgvel                 (hydro_state->avgvel)
+#define rslope                 (hydro_state->rslope)
+#define elevbinsize            (hydro_state->elevbinsize)
+#define nhypts                 (hydro_state->nhypts)
+#define areabins               (hydro_state->areabins)
+#define elevbins               (hydro_state->elevbins)
+#define hypspow                (hydro_state->hypspow)
+#define hypsarea               (hydro_state->hypsarea)
+#define hypselev               (hydro_state->hypselev)
+#define basinlength            (hydro_state->basinlength)
+#define maxalt                 (hydro_state->maxalt)
+#define totalarea              (hydro_state->totalarea)
+#define basin_relief           (hydro_state->basin_relief)
+#define basin_area             (hydro_state->basin_area)
+#define distbins               (hydro_state->distbins)
+#define exceedflood            (hydro_state->exceedflood)
+#define floodtry               (hydro_state->floodtry)
+#define maxflood               (hydro_state->maxflood)
+#define Rvol                   (hydro_state->Rvol)
+#define Ralt                   (hydro_state->Ralt)
+#define Rarea                  (hydro_state->Rarea)
+#define TE                     (hydro_state->TE)
+#define TEsubbasin             (hydro_state->TEsubbasin)
+#define Rparamcheck            (hydro_state->Rparamcheck)
+#define alphac                 (hydro_state->alphac)
+#define betac                  (hydro_state->betac)
+#define rhosed                 (hydro_state->rhosed)
+#define rhowater               (hydro_state->rhowater)
+#define alphag                 (hydro_state->alphag)
+#define betag                  (hydro_state->betag)
+#define pcr                    (hydro_state->pcr)
+#define pmax                   (hydro_state->pmax)
+#define MPrain                 (hydro_state->MPrain)
+#define Ko                     (hydro_state->Ko)
+#define alphass                (hydro_state->alphass)
+#define betass                 (hydro_state->betass)
+#define gwinitial              (hydro_state->gwinitial)
+#define gwlast                 (hydro_state->gwlast)
+#define gwmin                  (hydro_state->gwmin)
+#define gwmax                  (hydro_state->gwmax)
+#define percentgw              (hydro_state->percentgw)
+#define alphagwe               (hydro_state->alphagwe)
+#define betagwe                (hydro_state->betagwe)
+#define dryevap                (hydro_state->dryevap)
+#define Meltrate               (hydro_state->Meltrate)
+#define lapserate              (hydro_state->lapserate)
+#define Msnowstart             (hydro_state->Msnowstart)
+#define Msnowend               (hydro_state->Msnowend)
+#define MPnival                (hydro_state->MPnival)
+#define ELAindex               (hydro_state->ELAindex)
+#define bigg                   (hydro_state->bigg)
+#define smallg                 (hydro_state->smallg)
+#define lastarea               (hydro_state->lastarea)
+#define initiallastarea        (hydro_state->initiallastarea)
+#define ela                    (hydro_state->ela)
+#define lastela                (hydro_state->lastela)
+#define initiallastela         (hydro_state->initiallastela)
+#define Gmass                  (hydro_state->Gmass)
+#define MPglacial              (hydro_state->MPglacial)
+#define bethaexpo              (hydro_state->bethaexpo)
+#define bethaglacier           (hydro_state->bethaglacier)
+#define nran                   (hydro_state->nran)
+#define ranarray               (hydro_state->ranarray)
+#define rmin                   (hydro_state->rmin)
+#define rmax                   (hydro_state->rmax)
+#define maxerr                 (hydro_state->maxerr)
+#define totalmass              (hydro_state->totalmass)
+#define lat                    (hydro_state->lat)
+#define lon                    (hydro_state->lon)
+#define alpha3                 (hydro_state->alpha3)
+#define alpha4                 (hydro_state->alpha4)
+#define alpha5                 (hydro_state->alpha5)
+#define alpha6                 (hydro_state->alpha6)
+#define alpha7                 (hydro_state->alpha7)
+#define alpha8                 (hydro_state->alpha8)
+#define k1                     (hydro_state->k1)
+#define k2                     (hydro_state->k2)
+#define Qsbarformulaflag       (hydro_state->Qsbarformulaflag)
+#define raindatafile           (hydro_state->raindatafile)
+#define setstartmeanQandQs     (hydro_state->setstartmeanQandQs)
+#define asciioutput            (hydro_state->asciioutput)
+#define startname              (hydro_state->startname)
+#define directory              (hydro_state->directory)
+#define chrdump                (hydro_state->chrdump)
+#define commandlinearg         (hydro_state->commandlinearg)
+#define webflag                (hydro_state->webflag)
+#define globalparflag          (hydro_state->globalparflag)
+#define lapserateflag          (hydro_state->lapserateflag)
+#define velpowflag             (hydro_state->velpowflag)
+#define widpowflag             (hydro_state->widpowflag)
+#define Qgrandtotaltotoutlet   (hydro_state->Qgrandtotaltotoutlet)
+#define Qgrandtotaltot         (hydro_state->Qgrandtotaltot)
+#define Qdummy                 (hydro_state->Qdummy)
+#define Qgrandtotalperepoch    (hydro_state->Qgrandtotalperepoch)
+#define Qsgrandtotaltot        (hydro_state->Qsgrandtotaltot)
+#define Qsgrandtotaltotoutlet  (hydro_state->Qsgrandtotaltotoutlet)
+#define Qpeakmax               (hydro_state->Qpeakmax)
+#define TEtot                  (hydro_state->TEtot)
+#define yeartot                (hydro_state->yeartot)
+#define Qsoutletdummy          (hydro_state->Qsoutletdummy)
+#define Qsbartotoutlet         (hydro_state->Qsbartotoutlet)
+#define fidinput               (hydro_state->fidinput)
+#define fidq                   (hydro_state->fidq)
+#define fidqs                  (hydro_state->fidqs)
+#define fidtrend1              (hydro_state->fidtrend1)
+#define fidtrend2              (hydro_state->fidtrend2)
+#define fidtrend3              (hydro_state->fidtrend3)
+#define fidstat                (hydro_state->fidstat)
+#define fiddistot              (hydro_state->fiddistot)
+#define fiddis                 (hydro_state->fiddis)
+#define fidconvdistot          (hydro_state->fidconvdistot)
+#define fidconvdis             (hydro_state->fidconvdis)
+#define fidinputgw_r           (hydro_state->fidinputgw_r)
+#define fidhyps                (hydro_state->fidhyps)
+#define fidlog                 (hydro_state->fidlog)
+#define fidlapserate           (hydro_state->fidlapserate)
+#define outp                   (hydro_state->outp)
+#define outp1                  (hydro_state->outp1)
+#define outp2                  (hydro_state->outp2)
+#define outp3                  (hydro_state->outp3)
+#define outp4                  (hydro_state->outp4)
+#define outp5                  (hydro_state->outp5)
+#define outpnival_ice          (hydro_state->outpnival_ice)
+#define title                  (hydro_state->title)
+#define moname                 (hydro_state->moname)
+#define ffnameinput            (hydro_state->ffnameinput)
+#define ffnameq                (hydro_state->ffnameq)
+#define ffnameqs               (hydro_state->ffnameqs)
+#define ffnametrend1           (hydro_state->ffnametrend1)
+#define ffnametrend2           (hydro_state->ffnametrend2)
+#define ffnametrend3           (hydro_state->ffnametrend3)
+#define ffnamestat             (hydro_state->ffnamestat)
+#define ffnamedis              (hydro_state->ffnamedis)
+#define ffnamedistot           (hydro_state->ffnamedistot)
+#define ffnameconvdis          (hydro_state->ffnameconvdis)
+#define ffnameconvdistot       (hydro_state->ffnameconvdistot)
+#define ffnamehyps             (hydro_state->ffnamehyps)
+#define ffnameinputgw_r        (hydro_state->ffnameinputgw_r)
+#define ffnamelog              (hydro_state->ffnamelog)
+#define ffidasc                (hydro_state->ffidasc)
+#define ffidasc1               (hydro_state->ffidasc1)
+#define ffidasc2               (hydro_state->ffidasc2)
+#define ffidasc3               (hydro_state->ffidasc3)
+#define ffidasc4               (hydro_state->ffidasc4)
+#define ffidasc5               (hydro_state->ffidasc5)
+#define ffidnival_ice          (hydro_state->ffidnival_ice)
+#define FLAindex               (hydro_state->FLAindex)
+#define daysievent             (hydro_state->daysievent)
+#define Cs                     (hydro_state->Cs)
+#define Csoutlet               (hydro_state->Csoutlet)
+#define Qb                     (hydro_state->Qb)
+#define Qboutlet               (hydro_state->Qboutlet)
+#define Qs                     (hydro_state->Qs)
+#define Qsoutlet               (hydro_state->Qsoutlet)
+#define rainarea               (hydro_state->rainarea)
+#define Ecanopy                (hydro_state->Ecanopy)
+#define Pdaily                 (hydro_state->Pdaily)
+#define Tdaily                 (hydro_state->Tdaily)
+#define Snowelevday            (hydro_state->Snowelevday)
+#define Qrain                  (hydro_state->Qrain)
+#define Qice                   (hydro_state->Qice)
+#define Qnival                 (hydro_state->Qnival)
+#define Qsumtot                (hydro_state->Qsumtot)
+#define Qsum                   (hydro_state->Qsum)
+#define Qss                    (hydro_state->Qss)
+#define Qrainwrap              (hydro_state->Qrainwrap)
+#define Qicewrap               (hydro_state->Qicewrap)
+#define Qnivalwrap             (hydro_state->Qnivalwrap)
+#define Qsswrap                (hydro_state->Qsswrap)
+#define Snowcarry              (hydro_state->Snowcarry)
+#define gwstore                (hydro_state->gwstore)
+#define Qicetogw               (hydro_state->Qicetogw)
+#define Qnivaltogw             (hydro_state->Qnivaltogw)
+#define Egw                    (hydro_state->Egw)
+#define Qexceedgw              (hydro_state->Qexceedgw)
+#define nelevbins              (hydro_state->nelevbins)
+#define shouldern              (hydro_state->shouldern)
+#define Eiceannual             (hydro_state->Eiceannual)
+#define Enivalannual           (hydro_state->Enivalannual)
+#define ELAchange              (hydro_state->ELAchange)
+#define ELAstart               (hydro_state->ELAstart)
+#define Ewetannual             (hydro_state->Ewetannual)
+#define glacierarea            (hydro_state->glacierarea)
+#define glacierelev            (hydro_state->glacierelev)
+#define MEtotal                (hydro_state->MEtotal)
+#define Minput                 (hydro_state->Minput)
+#define Moutput                (hydro_state->Moutput)
+#define MQprevious             (hydro_state->MQprevious)
+#define MQnext                 (hydro_state->MQnext)
+#define Pannual                (hydro_state->Pannual)
+#define Pchange                (hydro_state->Pchange)
+#define Pmassbal               (hydro_state->Pmassbal)
+#define Pexponent              (hydro_state->Pexponent)
+#define Pmonth                 (hydro_state->Pmonth)
+#define Pnominal               (hydro_state->Pnominal)
+#define Pnomstd                (hydro_state->Pnomstd)
+#define Prange                 (hydro_state->Prange)
+#define Pstart                 (hydro_state->Pstart)
+#define Pstd                   (hydro_state->Pstd)
+#define Qbedannual             (hydro_state->Qbedannual)
+#define Qbedannualoutlet       (hydro_state->Qbedannualoutlet)
+#define Qgrandtotal            (hydro_state->Qgrandtotal)
+#define Qgrandtotaloutlet      (hydro_state->Qgrandtotaloutlet)
+#define Qpeak                  (hydro_state->Qpeak)
+#define Qpeakevents            (hydro_state->Qpeakevents)
+#define Qpeakperoutlet         (hydro_state->Qpeakperoutlet)
+#define Qpeakperoutletall      (hydro_state->Qpeakperoutletall)
+#define Qtotal                 (hydro_state->Qtotal)
+#define Qtotaloutlet           (hydro_state->Qtotaloutlet)
+#define Qtotaloutletannual     (hydro_state->Qtotaloutletannual)
+#define Qbar                   (hydro_state->Qbar)
+#define Qbartotal              (hydro_state->Qbartotal)
+#define Qpeakall               (hydro_state->Qpeakall)
+#define Qpeakallevents         (hydro_state->Qpeakallevents)
+#define Qsgrandtotal           (hydro_state->Qsgrandtotal)
+#define Qsgrandtotaldelta      (hydro_state->Qsgrandtotaldelta)
+#define Qsgrandtotaloutlet     (hydro_state->Qsgrandtotaloutlet)
+#define Csgrandtotaloutlet     (hydro_state->Csgrandtotaloutlet)
+#define Qsbarnew               (hydro_state->Qsbarnew)
+#define Qsbarnew2              (hydro_state->Qsbarnew2)
+#define Qsannual               (hydro_state->Qsannual)
+#define Qsannualoutlet         (hydro_state->Qsannualoutlet)
+#define Csannualoutlet         (hydro_state->Csannualoutlet)
+#define Qsbartot               (hydro_state->Qsbartot)
+#define Qsbar                  (hydro_state->Qsbar)
+#define Qsmean                 (hydro_state->Qsmean)
+#define Coutlettotal           (hydro_state->Coutlettotal)
+#define baseflowtot            (hydro_state->baseflowtot)
+#define Csannual               (hydro_state->Csannual)
+#define Csgrandtotal           (hydro_state->Csgrandtotal)
+#define shoulderright          (hydro_state->shoulderright)
+#define shoulderleft           (hydro_state->shoulderleft)
+#define shouldermain           (hydro_state->shouldermain)
+#define Snowremains            (hydro_state->Snowremains)
+#define Tannual                (hydro_state->Tannual)
+#define Tchange                (hydro_state->Tchange)
+#define Televday               (hydro_state->Televday)
+#define Tmonth                 (hydro_state->Tmonth)
+#define Tnominal               (hydro_state->Tnominal)
+#define Tnomstd                (hydro_state->Tnomstd)
+#define Tstart                 (hydro_state->Tstart)
+#define Tstd                   (hydro_state->Tstd)
+#define Qpeakfloodtemp         (hydro_state->Qpeakfloodtemp)
+#define rnseed                 (hydro_state->rnseed)
+#define rnseed3                (hydro_state->rnseed3)
+#define rnseed4                (hydro_state->rnseed4)
+#define rnseed5                (hydro_state->rnseed5)
+#define inputprefix            (hydro_state->inputprefix)
+#endif
+
+#endif /* hydrostate.h */
@@ -115,7 +115,7 @@ hydrosumflow()
                 fprintf(stderr, "   baseflow is higher than your average discharge in year %d:\n", yr);
                 fprintf(stderr, "   baseflow = %e, Qbar= %e. \n", baseflowtot[ep], Qbartotal[ep]);
                 fprintf(stderr, "Qgrandtotal[ep]=%e. \n", Qgrandtotal[ep]);
-                exit(-1);
+                hydroabort(-1);
             }
 
             Qsumtot[ii] = ((Qbartotal[ep] - baseflowtot[ep]) / Qbartotal[ep]) *
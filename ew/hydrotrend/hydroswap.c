@@ -48,7 +48,7 @@ hydroswap()
     int i, err, verbose, comLen, nYears, p;
     int word;
     int start;
-    static int recperyear;
+    int recperyear;
     char* dataWord;
     char dummystring[300];
     word = DEFAULT_WORD;
@@ -186,6 +186,13 @@ hydroswap()
             fclose(fidconvdis[p]);
         }
 
+    if (outletmodelflag == 1) {
+        free(fidconvdis);
+        fidconvdis = NULL;
+    }
+
+    free(dataWord);
+
     return (err);
 }  /* end of HydroSwap */
 
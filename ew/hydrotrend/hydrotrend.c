@@ -47,11 +47,105 @@
 #include <time.h>
 #include <string.h>
 
+static int
+hydrorun(int argc, char** argv);
+static void
+hydroclosefiles(void);
+
+/*
+ *  The state of the run of the calling thread.
+ */
+HYDRO_THREAD_LOCAL Hydrotrend_state* hydro_state = NULL;
+
+/*---------------------------
+ *  Start of HydroTrend_run
+ *---------------------------*/
+int
+hydrotrend_run(Hydrotrend_state* s)
+{
+    Hydrotrend_state* last_state = hydro_state;
+    char* argv[HYDRO_MAX_ARGS];
+    int ii, err;
+
+    for (ii = 0; ii < s->argc; ii++) {
+        argv[ii] = s->argv[ii];
+    }
+
+    hydro_state = s;
+
+    /*--------------------------------------------------------
+     *  An error deep within the model (hydroabort) returns
+     *  here rather than ending the program.
+     *--------------------------------------------------------*/
+    if (setjmp(s->abort_env) == 0) {
+        s->abort_is_set = 1;
+        err = hydrorun(s->argc, argv);
+    } else {
+        hydroclosefiles();
+        err = s->abort_status != 0 ? s->abort_status : 1;
+    }
+
+    /*--------------------------------------------------------
+     *  Free the memory that the run didn't (all of it if the
+     *  run was aborted) and forget the array of .DIS files
+     *  so that a later run doesn't close them again.
+     *--------------------------------------------------------*/
+    hydrofreeblocks(s);
+    fiddis = NULL;
+
+    s->abort_is_set = 0;
+    hydro_state = last_state;
+
+    return err;
+}  /* end of HydroTrend_run */
+
+/*------------------------
+ *  Start of HydroAbort
+ *------------------------*/
+void
+hydroabort(int status)
+{
+    if (hydro_state && hydro_state->abort_is_set) {
+        hydro_state->abort_status = status;
+        longjmp(hydro_state->abort_env, 1);
+    }
+
+    exit(status);
+}  /* end of HydroAbort */
+
+/*-----------------------------------------------------
+ *  Close the output files that an aborted run left
+ *  open.  All of them are still open at that point.
+ *-----------------------------------------------------*/
+static void
+hydroclosefiles(void)
+{
+    FILE** fid[] = { &fidq, &fidqs, &fidtrend1, &fidtrend2, &fidtrend3,
+                     &fidstat, &fiddistot, &fidlog, &outp, &outp1, &outp2,
+                     &outp3, &outp4, &outp5, &outpnival_ice
+                   };
+    int ii, p;
+
+    for (ii = 0; ii < sizeof(fid) / sizeof(fid[0]); ii++)
+        if (*fid[ii]) {
+            fclose(*fid[ii]);
+            *fid[ii] = NULL;
+        }
+
+    if (fiddis) {
+        for (p = 0; p < maxnoutlet; p++)
+            if (fiddis[p]) {
+                fclose(fiddis[p]);
+                fiddis[p] = NULL;
+            }
+    }
+}
+
 /*---------------------
  *  Start the program
  *---------------------*/
-int
-main(int argc, char** argv)
+static int
+hydrorun(int argc, char** argv)
 {
 
     /*-------------------
@@ -59,6 +153,7 @@ main(int argc, char** argv)
      *-------------------*/
     char    pst[TMLEN];
     time_t  tloc;
+    struct  tm timebuf;
     struct  tm* timeptr;
     int     err, ii, lyear, maxnran, verbose, p, k, x;
     double  logarea;
@@ -84,7 +179,7 @@ main(int argc, char** argv)
      *  Get the start time
      *----------------------*/
     time(&tloc);
-    timeptr = localtime(&tloc);
+    timeptr = localtime_r(&tloc, &timebuf);
 
     /*--------------------------------
      *  Set the hardwired parameters
@@ -97,7 +192,7 @@ main(int argc, char** argv)
 
     if (err) {
         fprintf(stderr, " ERROR in HydroSetParams: HydroTrend Aborted \n\n");
-        exit(1);
+        hydroabort(1);
     }
 
     /*-----------------------------------------------------------------
@@ -111,7 +206,18 @@ main(int argc, char** argv)
 
     if (err) {
         fprintf(stderr, " ERROR in HydroCommandLine: HydroTrend Aborted \n\n");
-        exit(1);
+        hydroabort(1);
+    }
+
+    /*----------------------------------------------
+     *  Unless they came from the command line, the
+     *  input files all start with inputprefix.
+     *----------------------------------------------*/
+    if (webflag == 0) {
+        strcpy(ffnameinput, inputprefix);
+        strcat(ffnameinput, fnameinputext);
+        strcpy(ffnameinputgw_r, inputprefix);
+        strcat(ffnameinputgw_r, fnameclimateext);
     }
 
     /*--------------------------------------------
@@ -144,7 +250,7 @@ main(int argc, char** argv)
                 fclose(fidhyps[ep]);
             }
 
-            exit(1);
+            hydroabort(1);
         }
     }
 
@@ -161,7 +267,7 @@ main(int argc, char** argv)
 
     if (err) {
         fprintf(stderr, " ERROR in HydroReadInput: HydroTrend Aborted \n\n");
-        exit(1);
+        hydroabort(1);
     }
 
     /*---------------------------------------
@@ -211,7 +317,7 @@ main(int argc, char** argv)
     if (err) {
         fprintf(stderr, " ERROR in HydroReadHypsom: HydroTrend Aborted \n\n");
         fprintf(fidlog, " ERROR in HydroReadHypsom: HydroTrend Aborted \n\n");
-        exit(1);
+        hydroabort(1);
     }
 
     /*---------------------------------------------
@@ -228,7 +334,7 @@ main(int argc, char** argv)
     if (err) {
         fprintf(stderr, " ERROR in HydroReadclimate: HydroTrend Aborted \n\n");
         fprintf(fidlog, " ERROR in HydroReadclimate: HydroTrend Aborted \n\n");
-        exit(1);
+        hydroabort(1);
     }
 
     /*------------------------------------------
@@ -245,7 +351,7 @@ main(int argc, char** argv)
         if (err) {
             fprintf(stderr, " ERROR in HydroSetGlobalPar: HydroTrend Aborted \n\n");
             fprintf(fidlog, " ERROR in HydroSetGlobalPar: HydroTrend Aborted \n\n");
-            exit(1);
+            hydroabort(1);
         }
     }
 
@@ -263,7 +369,7 @@ main(int argc, char** argv)
     if (err) {
         fprintf(stderr, " ERROR in HydroCheckInput: HydroTrend Aborted \n\n");
         fprintf(fidlog, " ERROR in HydroCheckInput: HydroTrend Aborted \n\n");
-        exit(1);
+        hydroabort(1);
     }
 
     /*-----------------------
@@ -278,7 +384,7 @@ main(int argc, char** argv)
     if (err) {
         fprintf(stderr, " ERROR in HydroOpenFiles: HydroTrend Aborted \n\n");
         fprintf(fidlog, " ERROR in HydroOpenFiles: HydroTrend Aborted \n\n");
-        exit(1);
+        hydroabort(1);
     }
 
     if (verbose) {
@@ -304,7 +410,7 @@ main(int argc, char** argv)
         if (err) {
             fprintf(stderr, " ERROR in HydroSetGeoParams: HydroTrend Aborted \n\n");
             fprintf(fidlog, " ERROR in HydroSetGeoParams: HydroTrend Aborted \n\n");
-            exit(1);
+            hydroabort(1);
         }
 
         /*----------------------------------------------------------------------------
@@ -371,7 +477,7 @@ main(int argc, char** argv)
             if (err) {
                 fprintf(stderr, " ERROR in HydroRandom: HydroTrend Aborted \n\n");
                 fprintf(fidlog, " ERROR in HydroRandom: HydroTrend Aborted \n\n");
-                exit(1);
+                hydroabort(1);
             }
 
             nran = 0;
@@ -404,7 +510,7 @@ main(int argc, char** argv)
                     if (err) {
                         fprintf(stderr, " ERROR in HydroOutletFraction (HydroOutlet): HydroTrend Aborted \n\n");
                         fprintf(fidlog, " ERROR in HydroOutletFraction (HydroOutlet): HydroTrend Aborted \n\n");
-                        exit(1);
+                        hydroabort(1);
                     }
                 }
 
@@ -420,7 +526,7 @@ main(int argc, char** argv)
                     if (err) {
                         fprintf(stderr, " ERROR in HydroOutletFraction (HydroOutlet): HydroTrend Aborted \n\n");
                         fprintf(fidlog, " ERROR in HydroOutletFraction (HydroOutlet): HydroTrend Aborted \n\n");
-                        exit(1);
+                        hydroabort(1);
                     }
                 }
 
@@ -436,7 +542,7 @@ main(int argc, char** argv)
                 if (err) {
                     fprintf(stderr, " ERROR in HydroOutletFraction (HydroOutlet): HydroTrend Aborted \n\n");
                     fprintf(fidlog, " ERROR in HydroOutletFraction (HydroOutlet): HydroTrend Aborted \n\n");
-                    exit(1);
+                    hydroabort(1);
                 }
             }
 
@@ -482,7 +588,7 @@ main(int argc, char** argv)
             if (err) {
                 fprintf(stderr, " ERROR in HydroShoulder: HydroTrend Aborted \n\n");
                 fprintf(fidlog, " ERROR in HydroShoulder: HydroTrend Aborted \n\n");
-                exit(1);
+                hydroabort(1);
             }
 
             /*---------------------------------------
@@ -590,7 +696,7 @@ main(int argc, char** argv)
                         if (err) {
                             fprintf(stderr, " ERROR in HydroRandom: HydroTrend Aborted \n\n");
                             fprintf(fidlog, " ERROR in HydroRandom: HydroTrend Aborted \n\n");
-                            exit(1);
+                            hydroabort(1);
                         }
                     }
 
@@ -606,7 +712,7 @@ main(int argc, char** argv)
                     if (err) {
                         fprintf(stderr, " ERROR in HydroClimate: HydroTrend Aborted \n\n");
                         fprintf(fidlog, " ERROR in HydroClimate: HydroTrend Aborted \n\n");
-                        exit(1);
+                        hydroabort(1);
                     }
 
 #ifdef DBG
@@ -626,7 +732,7 @@ main(int argc, char** argv)
                     if (err) {
                         fprintf(stderr, " ERROR in HydroWeather: HydroTrend Aborted \n\n");
                         fprintf(fidlog, " ERROR in HydroWeather: HydroTrend Aborted \n\n");
-                        exit(1);
+                        hydroabort(1);
                     }
 
                     /*-------------------------------------------------
@@ -641,7 +747,7 @@ main(int argc, char** argv)
                     if (err) {
                         fprintf(stderr, " ERROR in HydroHypsom: HydroTrend Aborted \n\n");
                         fprintf(fidlog, " ERROR in HydroHypsom: HydroTrend Aborted \n\n");
-                        exit(1);
+                        hydroabort(1);
                     }
 
                     /*-------------------------------------------------
@@ -658,7 +764,7 @@ main(int argc, char** argv)
                     if (err) {
                         fprintf(stderr, " ERROR in HydroGlacial: HydroTrend Aborted \n\n");
                         fprintf(fidlog, " ERROR in HydroGlacial: HydroTrend Aborted \n\n");
-                        exit(1);
+                        hydroabort(1);
                     }
 
                     /*------------------------------------------
@@ -675,7 +781,7 @@ main(int argc, char** argv)
                     if (err) {
                         fprintf(stderr, " ERROR in HydroSnow: HydroTrend Aborted \n\n");
                         fprintf(fidlog, " ERROR in HydroSnow: HydroTrend Aborted \n\n");
-                        exit(1);
+                        hydroabort(1);
                     }
 
                     /*---------------------------------
@@ -690,7 +796,7 @@ main(int argc, char** argv)
                     if (err) {
                         fprintf(stderr, " ERROR in HydroRain: HydroTrend Aborted \n\n");
                         fprintf(fidlog, " ERROR in HydroRain: HydroTrend Aborted \n\n");
-                        exit(1);
+                        hydroabort(1);
                     }
 
                     /*------------------------------------------------------------
@@ -707,7 +813,7 @@ main(int argc, char** argv)
                     if (err) {
                         fprintf(stderr, " ERROR in HydroSumFlow: HydroTrend Aborted \n\n");
                         fprintf(fidlog, " ERROR in HydroSumFlow: HydroTrend Aborted \n\n");
-                        exit(1);
+                        hydroabort(1);
                     }
 
                     /*-----------------------------------------
@@ -769,7 +875,7 @@ main(int argc, char** argv)
                     if (err) {
                         fprintf(stderr, " ERROR in HydroMaxEvents: HydroTrend Aborted \n\n");
                         fprintf(fidlog, " ERROR in HydroMaxEvents: HydroTrend Aborted \n\n");
-                        exit(1);
+                        hydroabort(1);
                     }
                 }
 
@@ -786,7 +892,7 @@ main(int argc, char** argv)
                     if (err) {
                         fprintf(stderr, " ERROR in HydroSedLoad: HydroTrend Aborted \n\n");
                         fprintf(fidlog, " ERROR in HydroSedLoad: HydroTrend Aborted \n\n");
-                        exit(1);
+                        hydroabort(1);
                     }
                 }
 
@@ -803,7 +909,7 @@ main(int argc, char** argv)
                     if (err) {
                         fprintf(stderr, " ERROR in HydroOutput: HydroTrend Aborted \n\n");
                         fprintf(fidlog, " ERROR in HydroOutput: HydroTrend Aborted \n\n");
-                        exit(1);
+                        hydroabort(1);
                     }
 
                     /*------------------------------------------
@@ -845,7 +951,7 @@ main(int argc, char** argv)
                     fprintf(stderr, "\n\n HydroTrend ERROR: nran exceeded maxran.\n");
                     fprintf(stderr, "\t increase maxran in HydroParams.h. \n");
                     fprintf(stderr, "\t nran = %d, maxran = %d \n\n", nran, maxran);
-                    exit(1);
+                    hydroabort(1);
                 }
 
 #ifdef DBG
@@ -941,7 +1047,7 @@ main(int argc, char** argv)
                 if (err) {
                     fprintf(stderr, " ERROR in Hydrocalqsnew: HydroTrend Aborted \n\n");
                     fprintf(fidlog, " ERROR in Hydrocalqsnew: HydroTrend Aborted \n\n");
-                    exit(1);
+                    hydroabort(1);
                 }
 
                 fprintf(stderr, "\nCalculating sediment load for epoch nr. %d, \n", (ep + 1));
@@ -1083,7 +1189,7 @@ main(int argc, char** argv)
      *  Print the program stop time
      *-------------------------------*/
     time(&tloc);
-    timeptr = localtime(&tloc);
+    timeptr = localtime_r(&tloc, &timebuf);
     strftime(pst, TMLEN, "%X  %x", timeptr);
     fprintf(fidlog, "\n ------------------------- \n");
     fprintf(fidlog, "\n Stop: %19s \n", pst);
@@ -1097,7 +1203,7 @@ main(int argc, char** argv)
     fclose(fidtrend1);
     fclose(fidtrend2);
     fclose(fidtrend3);
-    fclose(fiddistot);
+    fclose(fidstat);
     fclose(fidlog);
 
     if (strncmp(asciioutput, ON, 2) == 0) {
@@ -1110,24 +1216,41 @@ main(int argc, char** argv)
         fclose(outpnival_ice);
     }
 
-    if (outletmodelflag == 1)
-        for (p = 0; p < maxnoutlet; p++) {
-            fclose(fiddis[p]);
+    /*---------------------------------------------------
+     *  Records handed to a record function were not
+     *  written to the discharge files (see HydroOutput)
+     *---------------------------------------------------*/
+    if (hydro_state->record_func == NULL) {
+        fclose(fiddistot);
+
+        if (outletmodelflag == 1)
+            for (p = 0; p < maxnoutlet; p++) {
+                fclose(fiddis[p]);
+            }
+
+        /*-------------------------------------------------
+         *  Swap big-endian and little-endian file format
+         *-------------------------------------------------*/
+        if (verbose) {
+            printf("Calling HydroSwap... \n");
         }
 
-    /*-------------------------------------------------
-     *  Swap big-endian and little-endian file format
-     *-------------------------------------------------*/
-    if (verbose) {
-        printf("Calling HydroSwap... \n");
-    }
+        err = hydroswap();
 
-    err = hydroswap();
+        if (err) {
+            fprintf(stderr, " WARNING in HydroSwap: Continuing \n\n");
+        }
 
-    if (err) {
-        fprintf(stderr, " WARNING in HydroSwap: Continuing \n\n");
+        if (outletmodelflag == 1) {
+            free(fiddis);
+            fiddis = NULL;
+        }
     }
 
+    fidq = fidqs = fidtrend1 = fidtrend2 = fidtrend3 = fidstat = fidlog = NULL;
+    fiddistot = NULL;
+    outp = outp1 = outp2 = outp3 = outp4 = outp5 = outpnival_ice = NULL;
+
     /*-------------------------------------------
      *  Run CGI script for the internet version
      *-------------------------------------------*/
@@ -1145,6 +1268,8 @@ main(int argc, char** argv)
         freematrix1D((void*) gw_rain->Tperyear);
     }
 
+    free(gw_rain);
+
     /*---------------------------------------------------
      *  Free memory for possible multiple outlet module
      *---------------------------------------------------*/
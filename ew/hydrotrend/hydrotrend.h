@@ -62,13 +62,13 @@ hydrosetnumberoutlet(int x);
 int
 hydroqfractionshuffle(int k);
 void
-hydroallocmemoutlet(int ep);
+hydroallocmemoutlet(int epoch);
 void
-hydroallocmemoutlet1(int ep);
+hydroallocmemoutlet1(int epoch);
 void
 hydrofreememoutlet(int j);
 void
-hydrofreememoutlet1(int ep);
+hydrofreememoutlet1(int epoch);
 int
 hydroshuffle(int dvals[31], int mnth);
 int
@@ -0,0 +1,305 @@
+/*
+ *  HydroTrend_api.c
+ *
+ *  Create, set up and run HydroTrend states (see HydroTrend_api.h).
+ *
+ */
+
+#define HYDROSTATE_NO_GLOBALS
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "hydrostate.h"
+
+/*-----------------------------------
+ *  Start of HydroTrend_state_new
+ *-----------------------------------*/
+Hydrotrend_state*
+hydrotrend_state_new(void)
+{
+    Hydrotrend_state* s = (Hydrotrend_state*)calloc(1, sizeof(Hydrotrend_state));
+
+    if (s) {
+        Hydrotrend_state* last_state = hydro_state;
+
+        s->rnseed  = INIT_RAN_NUM_SEED;
+        s->rnseed3 = INIT_RAN_NUM_SEED;
+        s->rnseed4 = INIT_RAN_NUM_SEED;
+        s->rnseed5 = INIT_RAN_NUM_SEED;
+
+        s->idum2  = 123456789;
+        s->idum22 = 123456789;
+        s->idum23 = 123456789;
+        s->idum5  = 123456789;
+
+        s->argc = 1;
+        strcpy(s->argv[0], "hydrotrend");
+        strcpy(s->inputprefix, fnameinputprefix);
+
+        hydro_state = s;
+        hydrorandinit();
+        hydro_state = last_state;
+    }
+
+    return s;
+}  /* end of HydroTrend_state_new */
+
+Hydrotrend_state*
+hydrotrend_state_destroy(Hydrotrend_state* s)
+{
+    if (s) {
+        hydrofreeblocks(s);
+        free(s);
+    }
+
+    return NULL;
+}
+
+/*-----------------------------------------------------------------
+ *  The model's malloc, calloc, realloc and free (see
+ *  HydroState.h).  A block is put at the front of the list of
+ *  the state that is running and is taken out when it is freed.
+ *-----------------------------------------------------------------*/
+static void*
+hydrolinkblock(Hydro_block* b, Hydrotrend_state* owner)
+{
+    b->link.prev  = NULL;
+    b->link.next  = NULL;
+    b->link.owner = owner;
+
+    if (owner) {
+        b->link.next = owner->blocks;
+
+        if (owner->blocks) {
+            owner->blocks->link.prev = b;
+        }
+
+        owner->blocks = b;
+    }
+
+    return b + 1;
+}
+
+static void
+hydrounlinkblock(Hydro_block* b)
+{
+    if (b->link.prev) {
+        b->link.prev->link.next = b->link.next;
+    } else if (b->link.owner) {
+        b->link.owner->blocks = b->link.next;
+    }
+
+    if (b->link.next) {
+        b->link.next->link.prev = b->link.prev;
+    }
+}
+
+void*
+hydromalloc(size_t size)
+{
+    Hydro_block* b = (Hydro_block*)malloc(sizeof(Hydro_block) + size);
+
+    return b ? hydrolinkblock(b, hydro_state) : NULL;
+}
+
+void*
+hydrocalloc(size_t n, size_t size)
+{
+    void* ptr = NULL;
+
+    if (size == 0 || n <= (((size_t) - 1) - sizeof(Hydro_block)) / size) {
+        ptr = hydromalloc(n * size);
+    }
+
+    if (ptr) {
+        memset(ptr, 0, n * size);
+    }
+
+    return ptr;
+}
+
+void*
+hydrorealloc(void* ptr, size_t size)
+{
+    Hydro_block* b;
+    Hydro_block* new_b;
+
+    if (!ptr) {
+        return hydromalloc(size);
+    }
+
+    b = (Hydro_block*)ptr - 1;
+    hydrounlinkblock(b);
+
+    new_b = (Hydro_block*)realloc(b, sizeof(Hydro_block) + size);
+
+    if (!new_b) {
+        /* The old block is still allocated */
+        hydrolinkblock(b, b->link.owner);
+        return NULL;
+    }
+
+    return hydrolinkblock(new_b, new_b->link.owner);
+}
+
+void
+hydrofree(void* ptr)
+{
+    if (ptr) {
+        Hydro_block* b = (Hydro_block*)ptr - 1;
+
+        hydrounlinkblock(b);
+        free(b);
+    }
+}
+
+/*-------------------------------------------------------
+ *  Free whatever the runs of a state didn't free.  The
+ *  model's pointers to this memory are left dangling.
+ *-------------------------------------------------------*/
+void
+hydrofreeblocks(Hydrotrend_state* s)
+{
+    while (s->blocks) {
+        Hydro_block* b = s->blocks;
+
+        s->blocks = b->link.next;
+        free(b);
+    }
+}
+
+/*---------------------------------------------------------------
+ *  Use the arguments of the hydrotrend program for a run.
+ *  argv[1] is the name of the run (the output files start with
+ *  it) and argv[2] is only used by the web version.
+ *---------------------------------------------------------------*/
+int
+hydrotrend_state_set_command_line(Hydrotrend_state* s, int argc, char** argv)
+{
+    int ii;
+
+    s->argc = argc;
+
+    for (ii = 0; ii < argc && ii < HYDRO_MAX_ARGS; ii++)
+        if (argv[ii] != s->argv[ii]) {
+            strncpy(s->argv[ii], argv[ii], MAXCH - 1);
+            s->argv[ii][MAXCH - 1] = '\0';
+        }
+
+    return (argc <= HYDRO_MAX_ARGS) ? 0 : 1;
+}
+
+int
+hydrotrend_state_set_name(Hydrotrend_state* s, const char* name)
+{
+    char* argv[2];
+
+    argv[0] = s->argv[0];
+    argv[1] = (char*)name;
+
+    return hydrotrend_state_set_command_line(s, 2, argv);
+}
+
+/*-------------------------------------------------------------
+ *  The input files of a run are prefix.IN, prefix.CLIMATE and
+ *  prefix0.HYPS, prefix1.HYPS, ... (one per epoch).  The
+ *  default is HYDRO_INPUT/HYDRO.
+ *-------------------------------------------------------------*/
+void
+hydrotrend_state_set_input(Hydrotrend_state* s, const char* prefix)
+{
+    strncpy(s->inputprefix, prefix, MAXCH - 1);
+    s->inputprefix[MAXCH - 1] = '\0';
+}
+
+void
+hydrotrend_state_set_record_func(Hydrotrend_state* s,
+    Hydrotrend_record_func f, void* data)
+{
+    s->record_func = f;
+    s->record_data = data;
+}
+
+/*-------------------------------------------------------------------
+ *  Run an ensemble of states with a pool of n_threads threads.  The
+ *  states must write to different files (give them different names
+ *  or output directories).  Returns the number of runs that failed.
+ *-------------------------------------------------------------------*/
+typedef struct {
+    Hydrotrend_state**  s;
+    int                 n_states;
+    int                 next;
+    int                 n_failed;
+    pthread_mutex_t     lock;
+} Hydrotrend_ensemble;
+
+static void*
+hydroensembleworker(void* data)
+{
+    Hydrotrend_ensemble* e = (Hydrotrend_ensemble*)data;
+    int ii;
+
+    for (;;) {
+        pthread_mutex_lock(&e->lock);
+        ii = e->next++;
+        pthread_mutex_unlock(&e->lock);
+
+        if (ii >= e->n_states) {
+            break;
+        }
+
+        if (hydrotrend_run(e->s[ii]) != 0) {
+            pthread_mutex_lock(&e->lock);
+            e->n_failed++;
+            pthread_mutex_unlock(&e->lock);
+        }
+    }
+
+    return NULL;
+}
+
+int
+hydrotrend_run_ensemble(Hydrotrend_state** s, int n_states, int n_threads)
+{
+    Hydrotrend_ensemble e;
+    pthread_t* tid;
+    int ii, n_started;
+
+    if (n_threads > n_states) {
+        n_threads = n_states;
+    }
+
+    if (n_threads < 1) {
+        n_threads = 1;
+    }
+
+    e.s        = s;
+    e.n_states = n_states;
+    e.next     = 0;
+    e.n_failed = 0;
+    pthread_mutex_init(&e.lock, NULL);
+
+    tid = (pthread_t*)malloc(n_threads * sizeof(pthread_t));
+
+    for (ii = 0, n_started = 0; ii < n_threads; ii++)
+        if (pthread_create(&tid[n_started], NULL, hydroensembleworker, &e) == 0) {
+            n_started++;
+        }
+
+    /*---------------------------------------------------
+     *  If no thread could be started, run them here.
+     *---------------------------------------------------*/
+    if (n_started == 0) {
+        hydroensembleworker(&e);
+    }
+
+    for (ii = 0; ii < n_started; ii++) {
+        pthread_join(tid[ii], NULL);
+    }
+
+    free(tid);
+    pthread_mutex_destroy(&e.lock);
+
+    return e.n_failed;
+}  /* end of HydroTrend_run_ensemble */
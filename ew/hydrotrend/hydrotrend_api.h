@@ -0,0 +1,80 @@
+/*
+ *  HydroTrend_api.h
+ *
+ *  Run HydroTrend as a library.
+ *
+ *  Each run of the model keeps all of its state in a Hydrotrend_state so
+ *  that any number of rivers (or members of an ensemble) can be run at the
+ *  same time, each in its own thread.  Rather than writing the daily river
+ *  records to the binary .DIS files, a run can hand each record to a
+ *  callback as it is produced.
+ *
+ *      Hydrotrend_state* s = hydrotrend_state_new();
+ *
+ *      hydrotrend_state_set_name(s, "RIVER1");
+ *      hydrotrend_state_set_input(s, "HYDRO_INPUT/RIVER1");
+ *      hydrotrend_state_set_record_func(s, my_func, my_data);
+ *
+ *      if (hydrotrend_run(s) != 0)
+ *          ...
+ *
+ *      s = hydrotrend_state_destroy(s);
+ */
+
+#ifndef HYDROTREND_API_H_
+#define HYDROTREND_API_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct _Hydrotrend_state Hydrotrend_state;
+
+/*
+ *  One daily (or event) record of a river outlet.  The outlet is 0 for the
+ *  river as a whole and 1, 2, ... for each outlet of a delta.  conc holds
+ *  the suspended sediment concentration (kg/m^3) of each of the n_grains
+ *  grain sizes.
+ */
+typedef struct {
+    int             outlet;
+    int             year;
+    int             n_grains;
+    int             rec_per_year;
+    float           velocity;       /* m/s */
+    float           width;          /* m */
+    float           depth;          /* m */
+    float           bedload;        /* kg/s */
+    const float*    conc;           /* kg/m^3 */
+} Hydrotrend_record;
+
+/*
+ *  Called for each record of a run.  Return non-zero to stop the run.
+ */
+typedef int (*Hydrotrend_record_func)(const Hydrotrend_record* rec,
+    void* data);
+
+Hydrotrend_state*
+hydrotrend_state_new(void);
+Hydrotrend_state*
+hydrotrend_state_destroy(Hydrotrend_state* s);
+int
+hydrotrend_state_set_command_line(Hydrotrend_state* s, int argc, char** argv);
+int
+hydrotrend_state_set_name(Hydrotrend_state* s, const char* name);
+void
+hydrotrend_state_set_input(Hydrotrend_state* s, const char* prefix);
+void
+hydrotrend_state_set_record_func(Hydrotrend_state* s,
+    Hydrotrend_record_func f, void* data);
+
+int
+hydrotrend_run(Hydrotrend_state* s);
+int
+hydrotrend_run_ensemble(Hydrotrend_state** s, int n_states, int n_threads);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* hydrotrend_api.h */
@@ -0,0 +1,30 @@
+/*
+ *  HydroTrend_main.c
+ *
+ *  The hydrotrend program: one run of the model, set up from the
+ *  command line (see HydroCommandLine.c).
+ *
+ */
+
+#include <stdio.h>
+#include "hydrotrend_api.h"
+
+int
+main(int argc, char** argv)
+{
+    Hydrotrend_state* s = hydrotrend_state_new();
+    int err;
+
+    if (s == NULL) {
+        fprintf(stderr, " ERROR in HydroTrend: Unable to allocate the model state \n\n");
+        return 1;
+    }
+
+    hydrotrend_state_set_command_line(s, argc, argv);
+
+    err = hydrotrend_run(s);
+
+    s = hydrotrend_state_destroy(s);
+
+    return (err ? 1 : 0);
+}
@@ -34,22 +34,17 @@
 #include "hydrornseeds.h"
 #define MAXIT (3000)
 #define swap_dbl_vec( x , i , j ) { double temp; temp=x[i]; x[i]=x[j]; x[j]=temp; }
-typedef int (Cost_fcn)(double*, int);
-
-/*--------------------
- *  Global variables
- *--------------------*/
-int jj;
+typedef int (Cost_fcn)(double*, int, int);
 
 /*--------------------
  *  Global functions
  *--------------------*/
-double*
+static double*
 anneal(double* x, int n, Cost_fcn* f, int cost_min, int jj);
-int
+static int
 eh_get_fuzzy_int(int y, int z, int jj, int count);
 int
-cost_fcn(double* x, int n);
+cost_fcn(double* x, int n, int jj);
 float
 hydroran4(long* idum);
 
@@ -69,7 +64,7 @@ hydroweather(gw_rainfall_etc* gw_rain)
 
     double dumdbl, parray[31], sumt, sump;
     double Tstdcorr;
-    int darray[31], err, ii, pind, count;
+    int darray[31], err, ii, jj, pind, count;
     int ndaysppt, daysinmnd;
     Cost_fcn cost_fcn;
     err = 0;
@@ -170,7 +165,7 @@ hydroweather(gw_rainfall_etc* gw_rain)
                 if (start_of(jj) + darray[pind] - 2 >= daysiy) {
                     fprintf(stderr, "ERROR in HydroWeather \n");
                     fprintf(stderr, "   # days exceeded 365, case 1 \n");
-                    exit(1);
+                    hydroabort(1);
                 }
 
                 //         Pdaily[daystrm[jj]+darray[pind]-2] = parray[pind];
@@ -198,7 +193,7 @@ hydroweather(gw_rainfall_etc* gw_rain)
                 //         fprintf(stderr,"   daystrm[jj] = %d \n", daystrm[jj] );
                 fprintf(stderr, "   daystrm[jj] = %d \n", start_of(jj));
                 fprintf(stderr, "   darray[pind] = %d \n", darray[pind]);
-                exit(1);
+                hydroabort(1);
             }
 
             //      Pdaily[daystrm[jj]+darray[pind]-2] = Pmonth[jj] - sump;
@@ -289,7 +284,7 @@ hydroweather(gw_rainfall_etc* gw_rain)
  *-------------------------------------*/
 
 /*  FUNCTION TO DISTRIBUTE RAINDAYS IN A MORE "NATURAL WAY" */
-double*
+static double*
 anneal(double* x, int n, Cost_fcn* f, int cost_min, int jj)
 {
 
@@ -307,7 +302,7 @@ anneal(double* x, int n, Cost_fcn* f, int cost_min, int jj)
     count = 0;
 
     do {
-        cost_before = (*f)(x, n);
+        cost_before = (*f)(x, n, jj);
         //      i = eh_get_fuzzy_int(daystrm[jj], n-1, jj, count);
         i = eh_get_fuzzy_int(start_of(jj), n - 1, jj, count);
         count++;
@@ -319,7 +314,7 @@ anneal(double* x, int n, Cost_fcn* f, int cost_min, int jj)
         } while (j == i);
 
         swap_dbl_vec(x, i, j);
-        cost_after = (*f)(x, n);
+        cost_after = (*f)(x, n, jj);
 
         if (cost_after > cost_before) {
             swap_dbl_vec(x, i, j);
@@ -331,7 +326,7 @@ anneal(double* x, int n, Cost_fcn* f, int cost_min, int jj)
 
 
 /* FUNCTION EH_GET_FUZZY_INT */
-int
+static int
 eh_get_fuzzy_int(int y, int z, int jj, int count)
 {
     double x, dumflt;
@@ -361,7 +356,7 @@ eh_get_fuzzy_int(int y, int z, int jj, int count)
 
 /* FUNCTION Cost_fcn */
 int
-cost_fcn(double* x, int n)
+cost_fcn(double* x, int n, int jj)
 {
 
     /*-------------------------------------------------
@@ -0,0 +1,96 @@
+#include <stdio.h>
+#include <glib.h>
+
+#define HYDROSTATE_NO_GLOBALS
+#include "hydrostate.h"
+
+#define N_STATES (6)
+
+static int
+_count_records(const Hydrotrend_record* rec, void* data)
+{
+    (*(gint*)data)++;
+    return 0;
+}
+
+/* States whose input files don't exist.  Each of their runs is aborted
+   while reading its input. */
+static void
+_new_missing_input_states(Hydrotrend_state** s, gint n, gint* n_records)
+{
+    gint i;
+
+    for (i = 0 ; i < n ; i++) {
+        gchar* name = g_strdup_printf("ENSEMBLE%d", i);
+
+        s[i] = hydrotrend_state_new();
+        g_assert(s[i] != NULL);
+
+        g_assert_cmpint(hydrotrend_state_set_name(s[i], name), ==, 0);
+        hydrotrend_state_set_input(s[i], "/nonexistent/HYDRO_INPUT/HYDRO");
+        hydrotrend_state_set_record_func(s[i], &_count_records, n_records);
+
+        g_free(name);
+    }
+}
+
+void
+test_hydrotrend_run_aborted(void)
+{
+    Hydrotrend_state* s[1];
+    gint n_records = 0;
+
+    _new_missing_input_states(s, 1, &n_records);
+
+    g_assert_cmpint(hydrotrend_run(s[0]), !=, 0);
+
+    // The aborted run left nothing allocated, and the state can be run again.
+    g_assert(s[0]->blocks == NULL);
+    g_assert_cmpint(s[0]->abort_is_set, ==, 0);
+
+    g_assert_cmpint(hydrotrend_run(s[0]), !=, 0);
+    g_assert(s[0]->blocks == NULL);
+
+    g_assert_cmpint(n_records, ==, 0);
+
+    s[0] = hydrotrend_state_destroy(s[0]);
+    g_assert(s[0] == NULL);
+}
+
+void
+test_hydrotrend_run_ensemble(void)
+{
+    Hydrotrend_state* s[N_STATES];
+    gint n_records = 0;
+    gint n_threads[] = { 1, 3, N_STATES, 2 * N_STATES, 0, -1 };
+    gint i, j;
+
+    _new_missing_input_states(s, N_STATES, &n_records);
+
+    for (j = 0 ; j < G_N_ELEMENTS(n_threads) ; j++) {
+        g_assert_cmpint(hydrotrend_run_ensemble(s, N_STATES, n_threads[j]), ==,
+            N_STATES);
+
+        for (i = 0 ; i < N_STATES ; i++) {
+            g_assert(s[i]->blocks == NULL);
+        }
+    }
+
+    g_assert_cmpint(hydrotrend_run_ensemble(s, 0, 4), ==, 0);
+    g_assert_cmpint(n_records, ==, 0);
+
+    for (i = 0 ; i < N_STATES ; i++) {
+        s[i] = hydrotrend_state_destroy(s[i]);
+    }
+}
+
+int
+main(int argc, char* argv[])
+{
+    g_test_init(&argc, &argv, NULL);
+
+    g_test_add_func("/hydrotrend/run/aborted", &test_hydrotrend_run_aborted);
+    g_test_add_func("/hydrotrend/run/ensemble", &test_hydrotrend_run_ensemble);
+
+    return g_test_run();
+}
@@ -0,0 +1,380 @@
+//---
+//
+// This file is part of sedflux.
+//
+// sedflux is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// sedflux is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with sedflux; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//---
+
+/** \file plume_cache.c
+
+A bounded cache of plume deposits.
+
+Running the plume is expensive but rivers that are driven by HydroTrend
+tend to cycle through a small number of distinct floods.  The deposit
+grids of recent plumes are kept, keyed on the values that went into them
+(river discharge, grain properties, ocean currents, and so on), and the
+least recently used deposits are dropped once the grids of the cache take
+up more than a given number of bytes.  Deposits are not copied: the cache
+owns the grids that are put into it and lookups return the grids
+themselves.
+
+Key values are matched to within a relative tolerance.  Each value is
+quantized to a bin whose width grows with the size of the value so that two
+keys match if each pair of values is in the same bin.  With a tolerance of
+zero, keys must match exactly.
+*/
+
+#include <string.h>
+#include <math.h>
+#include <glib.h>
+#include <utils/utils.h>
+
+#include "plume_cache.h"
+
+typedef struct {
+    gint64*      key;     //< Quantized key values
+    gint         len;     //< Length of key
+    guint        hash;
+    Eh_dbl_grid* deposit; //< NULL-terminated array of deposit grids
+    gsize        n_bytes; //< Size of the deposit grids
+    GList*       link;    //< Link of the entry in the LRU queue
+}
+Plume_cache_entry;
+
+struct _Plume_cache {
+    GHashTable* table;       //< Entries, keyed on themselves
+    GQueue*     lru;         //< Entries, most recently used first
+    gsize       n_bytes;     //< Size of the deposits of all the entries
+    gsize       max_bytes;
+    double      tolerance;
+    gint        n_hits;
+    gint        n_misses;
+};
+
+static gsize
+_plume_cache_deposit_bytes(Eh_dbl_grid* deposit)
+{
+    gsize n_bytes = 0;
+    Eh_dbl_grid* d;
+
+    for (d = deposit ; *d ; d++) {
+        n_bytes += (gsize)eh_grid_n_x(*d) * eh_grid_n_y(*d) * sizeof(double);
+    }
+
+    return n_bytes;
+}
+
+static void
+_plume_cache_destroy_deposit(Eh_dbl_grid* deposit)
+{
+    if (deposit) {
+        Eh_dbl_grid* d;
+
+        for (d = deposit ; *d ; d++) {
+            eh_grid_destroy(*d, TRUE);
+        }
+
+        eh_free(deposit);
+    }
+}
+
+/* Each value is stored as a sign and a bin number.  With a tolerance, bins
+   are evenly spaced in log space so that their width is relative to the
+   value. */
+static void
+_plume_cache_quantize(gint64* dest, const double* key, gint len, double tol)
+{
+    gint i;
+
+    for (i = 0 ; i < len ; i++) {
+        const double v = key[i];
+
+        if (v == 0.) {
+            dest[2 * i]     = 0;
+            dest[2 * i + 1] = 0;
+        } else if (tol > 0.) {
+            dest[2 * i]     = (v > 0.) ? 1 : -1;
+            dest[2 * i + 1] = (gint64)floor(log(fabs(v)) / log1p(tol));
+        } else {
+            dest[2 * i]     = (v > 0.) ? 1 : -1;
+            memcpy(dest + 2 * i + 1, &v, sizeof(double));
+        }
+    }
+}
+
+static guint
+_plume_cache_entry_hash(gconstpointer ptr)
+{
+    const Plume_cache_entry* e = (const Plume_cache_entry*)ptr;
+    return e->hash;
+}
+
+static gboolean
+_plume_cache_entry_equal(gconstpointer a, gconstpointer b)
+{
+    const Plume_cache_entry* e_1 = (const Plume_cache_entry*)a;
+    const Plume_cache_entry* e_2 = (const Plume_cache_entry*)b;
+
+    return e_1->len == e_2->len
+        && memcmp(e_1->key, e_2->key, e_1->len * sizeof(gint64)) == 0;
+}
+
+static void
+_plume_cache_entry_set_key(Plume_cache_entry* e, const double* key, gint len,
+    double tol)
+{
+    gint i;
+
+    e->len  = 2 * len;
+    e->key  = eh_new(gint64, e->len);
+    e->hash = 17;
+
+    _plume_cache_quantize(e->key, key, len, tol);
+
+    for (i = 0 ; i < e->len ; i++) {
+        e->hash = e->hash * 31 + (guint)(e->key[i] ^ (e->key[i] >> 32));
+    }
+}
+
+static void
+_plume_cache_entry_destroy(Plume_cache_entry* e)
+{
+    if (e) {
+        _plume_cache_destroy_deposit(e->deposit);
+        eh_free(e->key);
+        eh_free(e);
+    }
+}
+
+/** Create a cache of plume deposits
+
+\param max_bytes Largest total size of the deposit grids to keep
+\param tolerance Relative tolerance for matching key values
+
+\return A new Plume_cache, or NULL if \a max_bytes is zero (all of the cache
+        functions accept a NULL cache and do nothing)
+*/
+Plume_cache*
+plume_cache_new(gsize max_bytes, double tolerance)
+{
+    Plume_cache* c = NULL;
+
+    eh_require(tolerance >= 0.);
+
+    if (max_bytes > 0) {
+        c = eh_new(Plume_cache, 1);
+
+        c->table     = g_hash_table_new(_plume_cache_entry_hash,
+                _plume_cache_entry_equal);
+        c->lru       = g_queue_new();
+        c->n_bytes   = 0;
+        c->max_bytes = max_bytes;
+        c->tolerance = MAX(tolerance, 0.);
+        c->n_hits    = 0;
+        c->n_misses  = 0;
+    }
+
+    return c;
+}
+
+Plume_cache*
+plume_cache_destroy(Plume_cache* c)
+{
+    if (c) {
+        Plume_cache_entry* e;
+
+        while ((e = (Plume_cache_entry*)g_queue_pop_head(c->lru))) {
+            _plume_cache_entry_destroy(e);
+        }
+
+        g_queue_free(c->lru);
+        g_hash_table_destroy(c->table);
+        eh_free(c);
+    }
+
+    return NULL;
+}
+
+/** Look for a plume deposit in a cache
+
+\param c   A Plume_cache
+\param key Values that went into the plume
+\param len Length of \a key
+
+\return The cached deposit grids (a NULL-terminated array), or NULL if the
+        deposit isn't in the cache.  The grids belong to the cache and are
+        only good until the next call to plume_cache_insert or
+        plume_cache_destroy.
+*/
+Eh_dbl_grid*
+plume_cache_lookup(Plume_cache* c, const double* key, gint len)
+{
+    Eh_dbl_grid* deposit = NULL;
+
+    if (c) {
+        Plume_cache_entry  e;
+        Plume_cache_entry* found;
+
+        _plume_cache_entry_set_key(&e, key, len, c->tolerance);
+
+        found = (Plume_cache_entry*)g_hash_table_lookup(c->table, &e);
+
+        if (found) {
+            g_queue_unlink(c->lru, found->link);
+            g_queue_push_head_link(c->lru, found->link);
+
+            deposit = found->deposit;
+
+            c->n_hits++;
+        } else {
+            c->n_misses++;
+        }
+
+        eh_free(e.key);
+    }
+
+    return deposit;
+}
+
+/* Remove the least recently used entry of a cache */
+static void
+_plume_cache_remove_last(Plume_cache* c)
+{
+    Plume_cache_entry* old = (Plume_cache_entry*)g_queue_pop_tail(c->lru);
+
+    g_hash_table_remove(c->table, old);
+    c->n_bytes -= old->n_bytes;
+    _plume_cache_entry_destroy(old);
+}
+
+/** Add a plume deposit to a cache
+
+The cache takes the deposit, rather than a copy of it.  Deposits that were
+used least recently are removed until the cache fits in its size.  A deposit
+that is bigger than the cache on its own is not added.
+
+\param c       A Plume_cache
+\param key     Values that went into the plume
+\param len     Length of \a key
+\param deposit NULL-terminated array of deposit grids
+
+\return TRUE if the cache took the deposit.  Otherwise the deposit still
+        belongs to the caller.
+*/
+gboolean
+plume_cache_insert(Plume_cache* c, const double* key, gint len,
+    Eh_dbl_grid* deposit)
+{
+    gboolean is_taken = FALSE;
+
+    eh_require(deposit);
+
+    if (c && deposit) {
+        const gsize n_bytes = _plume_cache_deposit_bytes(deposit);
+
+        if (n_bytes <= c->max_bytes) {
+            Plume_cache_entry* e = eh_new(Plume_cache_entry, 1);
+            Plume_cache_entry* found;
+
+            e->deposit = NULL;
+            e->link    = NULL;
+
+            _plume_cache_entry_set_key(e, key, len, c->tolerance);
+
+            found = (Plume_cache_entry*)g_hash_table_lookup(c->table, e);
+
+            if (found) {
+                _plume_cache_entry_destroy(e);
+
+                g_queue_unlink(c->lru, found->link);
+                g_queue_push_head_link(c->lru, found->link);
+
+                c->n_bytes -= found->n_bytes;
+                _plume_cache_destroy_deposit(found->deposit);
+
+                e = found;
+            } else {
+                g_queue_push_head(c->lru, e);
+                e->link = g_queue_peek_head_link(c->lru);
+
+                g_hash_table_insert(c->table, e, e);
+            }
+
+            e->deposit  = deposit;
+            e->n_bytes  = n_bytes;
+            c->n_bytes += n_bytes;
+
+            while (c->n_bytes > c->max_bytes) {
+                _plume_cache_remove_last(c);
+            }
+
+            is_taken = TRUE;
+        }
+    }
+
+    return is_taken;
+}
+
+gint
+plume_cache_size(const Plume_cache* c)
+{
+    return (c) ? g_queue_get_length(c->lru) : 0;
+}
+
+gsize
+plume_cache_n_bytes(const Plume_cache* c)
+{
+    return (c) ? c->n_bytes : 0;
+}
+
+gint
+plume_cache_n_hits(const Plume_cache* c)
+{
+    return (c) ? c->n_hits : 0;
+}
+
+gint
+plume_cache_n_misses(const Plume_cache* c)
+{
+    return (c) ? c->n_misses : 0;
+}
+
+/** Print the hit and miss counts of a cache
+
+\param fp A FILE to print to
+\param c  A Plume_cache
+
+\return The number of characters printed
+*/
+gint
+plume_cache_fprint(FILE* fp, const Plume_cache* c)
+{
+    gint n = 0;
+
+    if (c) {
+        const gint n_lookups = c->n_hits + c->n_misses;
+
+        n += fprintf(fp, "Plume cache entries  : %d (%lu of %lu bytes)\n",
+                plume_cache_size(c), (gulong)c->n_bytes, (gulong)c->max_bytes);
+        n += fprintf(fp, "Plume cache tolerance: %g\n", c->tolerance);
+        n += fprintf(fp, "Plume cache hits     : %d\n", c->n_hits);
+        n += fprintf(fp, "Plume cache misses   : %d\n", c->n_misses);
+        n += fprintf(fp, "Plume cache hit rate : %.1f%%\n",
+                (n_lookups > 0) ? 100. * c->n_hits / n_lookups : 0.);
+    }
+
+    return n;
+}
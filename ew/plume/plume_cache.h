@@ -0,0 +1,56 @@
+//---
+//
+// This file is part of sedflux.
+//
+// sedflux is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// sedflux is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with sedflux; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//---
+
+#if !defined(PLUME_CACHE_H)
+# define PLUME_CACHE_H
+
+#include <stdio.h>
+#include <glib.h>
+#include <utils/utils.h>
+
+G_BEGIN_DECLS
+
+typedef struct _Plume_cache Plume_cache;
+
+Plume_cache*
+plume_cache_new(gsize max_bytes, double tolerance);
+Plume_cache*
+plume_cache_destroy(Plume_cache* c);
+
+Eh_dbl_grid*
+plume_cache_lookup(Plume_cache* c, const double* key, gint len);
+gboolean
+plume_cache_insert(Plume_cache* c, const double* key, gint len,
+    Eh_dbl_grid* deposit);
+
+gint
+plume_cache_size(const Plume_cache* c);
+gsize
+plume_cache_n_bytes(const Plume_cache* c);
+gint
+plume_cache_n_hits(const Plume_cache* c);
+gint
+plume_cache_n_misses(const Plume_cache* c);
+gint
+plume_cache_fprint(FILE* fp, const Plume_cache* c);
+
+G_END_DECLS
+
+#endif /* plume_cache.h */
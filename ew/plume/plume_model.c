@@ -9,6 +9,7 @@
 
 #include "bmi.h"
 #include "plume_model.h"
+#include "plume_cache.h"
 
 #define YEARS_PER_SECOND (3.1709791983764586e-08)
 #define DAYS_PER_SECOND (1.1574074074074073e-05)
@@ -17,11 +18,15 @@
     #define LINE_MAX (2048)
 #endif
 
+/* Plume deposits are kept in a cache of up to this many bytes */
+#define PLUME_CACHE_BYTES (64 * 1024 * 1024)
+
 struct _PlumeModel {
     Plume_param_st* param;
     Sed_hydro flood_event;
 
     Eh_dbl_grid* deposit;
+    int deposit_is_cached; //< The deposit belongs to the cache
     double velocity;
     double width;
     double depth;
@@ -29,6 +34,7 @@ struct _PlumeModel {
     double qs;
 
     int cached;
+    Plume_cache* cache;
     int n_dim;
     int rotate;
     int verbose;
@@ -40,7 +46,7 @@ struct _PlumeModel {
 static void
 destroy_deposit_grids(PlumeModel* self)
 {
-    if (self && self->deposit) {
+    if (self && self->deposit && !self->deposit_is_cached) {
         Eh_dbl_grid* d = NULL;
 
         for (d = self->deposit; *d; d++) {
@@ -49,6 +55,34 @@ destroy_deposit_grids(PlumeModel* self)
 
         eh_free(self->deposit);
     }
+
+    if (self) {
+        self->deposit = NULL;
+        self->deposit_is_cached = FALSE;
+    }
+}
+
+
+/* Take a copy of a deposit that belongs to the cache, before the cache is
+   destroyed. */
+static void
+own_deposit_grids(PlumeModel* self)
+{
+    if (self->deposit && self->deposit_is_cached) {
+        Eh_dbl_grid* src = self->deposit;
+        int n, len;
+
+        for (len = 0; src[len]; len++);
+
+        self->deposit = eh_new(Eh_dbl_grid, len + 1);
+
+        for (n = 0; n < len; n++) {
+            self->deposit[n] = eh_grid_dup(src[n]);
+        }
+
+        self->deposit[len] = NULL;
+        self->deposit_is_cached = FALSE;
+    }
 }
 
 
@@ -153,6 +187,8 @@ plume_get_end_time(PlumeModel* self)
 }
 
 
+/* The deposit may be shared with the plume cache, so it must not be
+   written to. */
 double*
 plume_get_deposition_rate_buffer(PlumeModel* self)
 {
@@ -261,6 +297,61 @@ plume_get_grid_origin(PlumeModel* self, double origin[2])
 }
 
 
+/* Everything that the plume deposit depends on: the river, the ocean, and
+   the suspended grains. */
+static double*
+get_cache_key(PlumeModel* self, int* len)
+{
+    const Plume_param_st* p = self->param;
+    const int n_grains = sed_hydro_size(self->flood_event);
+    double* key = eh_new(double, 20 + 3 * n_grains);
+    int i = 0;
+    int n;
+
+    key[i++] = self->velocity;
+    key[i++] = self->width;
+    key[i++] = self->depth;
+    key[i++] = self->bedload;
+
+    key[i++] = p->r_dir;
+    key[i++] = p->r_angle;
+    key[i++] = p->latitude;
+    key[i++] = p->ocean_conc;
+    key[i++] = p->coastal_current;
+    key[i++] = p->coastal_current_dir;
+    key[i++] = p->coastal_current_width;
+    key[i++] = p->river_tracer;
+    key[i++] = p->ocean_tracer;
+    key[i++] = p->river_mouth_nodes;
+    key[i++] = p->aspect_ratio;
+    key[i++] = p->basin_width;
+    key[i++] = p->basin_len;
+    key[i++] = p->dx;
+    key[i++] = p->dy;
+    key[i++] = p->n_dim;
+
+    for (n = 0; n < n_grains; n++) {
+        key[i++] = sed_hydro_nth_concentration(self->flood_event, n);
+        key[i++] = p->bulk_density[n];
+        key[i++] = p->lambda[n];
+    }
+
+    *len = i;
+
+    return key;
+}
+
+
+void
+plume_set_cache_tolerance(PlumeModel* self, double tolerance)
+{
+    own_deposit_grids(self);
+
+    plume_cache_destroy(self->cache);
+    self->cache = plume_cache_new(PLUME_CACHE_BYTES, tolerance);
+}
+
+
 int
 plume_update_until(PlumeModel* self, double time)
 {
@@ -277,7 +368,8 @@ plume_update_until(PlumeModel* self, double time)
         /* If it is a different flood than the current one, run the new one */
         //if (event_index > self->current_event)
         if (!self->cached) {
-            int n_grains, len;
+            int n_grains, len, key_len;
+            double* key;
 
             sed_hydro_set_velocity(self->flood_event, self->velocity);
             sed_hydro_set_width(self->flood_event, self->width);
@@ -287,7 +379,23 @@ plume_update_until(PlumeModel* self, double time)
 
             destroy_deposit_grids(self);
 
-            self->deposit = plume_wrapper(self->flood_event, self->param, &len, &n_grains);
+            /* Floods that are like earlier ones are read from the cache */
+            key = get_cache_key(self, &key_len);
+
+            self->deposit = plume_cache_lookup(self->cache, key, key_len);
+            self->deposit_is_cached = (self->deposit != NULL);
+
+            if (!self->deposit) {
+                self->deposit = plume_wrapper(self->flood_event, self->param, &len, &n_grains);
+
+                if (self->deposit) {
+                    self->deposit_is_cached = plume_cache_insert(self->cache, key,
+                            key_len, self->deposit);
+                }
+            }
+
+            eh_free(key);
+
             self->cached = TRUE;
         }
 
@@ -329,6 +437,7 @@ plume_initialize(PlumeModel* self, const char* config_file)
         {
             self->time_in_days = 0.;
             self->cached = FALSE;
+            self->cache = plume_cache_new(PLUME_CACHE_BYTES, 0.);
 
             self->velocity = sed_hydro_velocity(self->flood_event);
             self->width = sed_hydro_width(self->flood_event);
@@ -339,6 +448,7 @@ plume_initialize(PlumeModel* self, const char* config_file)
             { /* Run the first event */
                 int len, n_grains;
                 self->deposit = NULL;
+                self->deposit_is_cached = FALSE;
                 plume_update(self);
                 self->time_in_days = plume_get_start_time(self);
             }
@@ -357,6 +467,10 @@ plume_finalize(PlumeModel* self)
 
         destroy_deposit_grids(self);
 
+        eh_message("Plume cache hits: %d, misses: %d",
+            plume_cache_n_hits(self->cache), plume_cache_n_misses(self->cache));
+        plume_cache_destroy(self->cache);
+
         g_free(self);
     }
 
@@ -5,6 +5,7 @@
 #include "plume_types.h"
 #include "plumeinput.h"
 #include "plume_approx.h"
+#include "plume_cache.h"
 
 gboolean
 plume3d(Plume_inputs* plume_const, Plume_river river,
@@ -261,6 +262,104 @@ START_TEST(test_approx_from_file)
 }
 END_TEST
 
+static Eh_dbl_grid*
+_plume_test_deposit(double val)
+{
+    Eh_dbl_grid* d = eh_new(Eh_dbl_grid, 2);
+
+    d[0] = eh_grid_new(double, 4, 3);
+    d[1] = NULL;
+
+    eh_dbl_grid_set(d[0], val);
+
+    return d;
+}
+
+static void
+_plume_test_deposit_destroy(Eh_dbl_grid* d)
+{
+    if (d) {
+        eh_grid_destroy(d[0], TRUE);
+        eh_free(d);
+    }
+}
+
+START_TEST(test_plume_cache)
+{
+    const gsize n_bytes = 4 * 3 * sizeof(double);
+    Plume_cache* c = plume_cache_new(2 * n_bytes, 0.);
+    double key_1[] = { 1., 10., 100. };
+    double key_2[] = { 2., 10., 100. };
+    double key_3[] = { 3., 10., 100. };
+    Eh_dbl_grid* d;
+
+    // The cache takes the deposits it is given.
+    fail_unless(plume_cache_insert(c, key_1, 3, _plume_test_deposit(1.)),
+        "Deposit should be taken by the cache");
+    fail_unless(plume_cache_insert(c, key_2, 3, _plume_test_deposit(2.)),
+        "Deposit should be taken by the cache");
+
+    fail_unless(plume_cache_size(c) == 2, "Cache should hold two deposits");
+    fail_unless(plume_cache_n_bytes(c) == 2 * n_bytes, "Wrong number of bytes");
+
+    d = plume_cache_lookup(c, key_1, 3);
+    fail_unless(d != NULL, "Deposit should be in the cache");
+    fail_unless(eh_dbl_grid_val(d[0], 2, 1) == 1., "Wrong deposit from the cache");
+    fail_unless(d[1] == NULL, "Deposit should be NULL-terminated");
+    fail_unless(d == plume_cache_lookup(c, key_1, 3),
+        "Lookups should return the cached deposit itself");
+
+    // key_2 is now the least recently used.
+    plume_cache_insert(c, key_3, 3, _plume_test_deposit(3.));
+
+    fail_unless(plume_cache_size(c) == 2, "Cache should not grow past its size");
+    fail_unless(plume_cache_n_bytes(c) == 2 * n_bytes, "Wrong number of bytes");
+
+    d = plume_cache_lookup(c, key_2, 3);
+    fail_unless(d == NULL, "Least recently used deposit should be removed");
+
+    d = plume_cache_lookup(c, key_1, 3);
+    fail_unless(d != NULL, "Recently used deposit should be kept");
+
+    key_1[1] = 10.001;
+    d = plume_cache_lookup(c, key_1, 3);
+    fail_unless(d == NULL, "Keys must match exactly with no tolerance");
+
+    fail_unless(plume_cache_n_hits(c) == 3, "Wrong number of cache hits");
+    fail_unless(plume_cache_n_misses(c) == 2, "Wrong number of cache misses");
+
+    plume_cache_destroy(c);
+
+    c = plume_cache_new(n_bytes, .01);
+
+    plume_cache_insert(c, key_3, 3, _plume_test_deposit(1.));
+
+    key_3[1] = 10.00001;
+    d = plume_cache_lookup(c, key_3, 3);
+    fail_unless(d != NULL, "Keys should match to within the tolerance");
+
+    key_3[1] = 20.;
+    d = plume_cache_lookup(c, key_3, 3);
+    fail_unless(d == NULL, "Keys should not match outside of the tolerance");
+
+    plume_cache_destroy(c);
+
+    // A deposit bigger than the cache is left with the caller.
+    c = plume_cache_new(n_bytes - 1, 0.);
+
+    d = _plume_test_deposit(1.);
+    fail_unless(!plume_cache_insert(c, key_1, 3, d),
+        "Deposit larger than the cache should not be taken");
+    fail_unless(plume_cache_size(c) == 0, "Cache should be empty");
+    fail_unless(plume_cache_n_bytes(c) == 0, "Cache should hold no bytes");
+    _plume_test_deposit_destroy(d);
+
+    plume_cache_destroy(c);
+
+    fail_unless(plume_cache_new(0, 0.) == NULL, "A cache of size zero is NULL");
+}
+END_TEST
+
 Suite*
 sed_plume_suite(void)
 {
@@ -284,6 +383,7 @@ sed_plume_suite(void)
        tcase_add_test( test_case_approx , test_approx_from_file  );
     */
     tcase_add_test(test_case_num, test_i_bar);
+    tcase_add_test(test_case_core, test_plume_cache);
 
     return s;
 }
@@ -1576,6 +1576,7 @@ sakura(double  u_riv, double  c_riv, double  h_riv, double* f_riv,
 {
     double** deposit = NULL;
     gboolean success = TRUE;
+    const gboolean debug = (g_getenv("SAKURA_DEBUG") != NULL);
 
     eh_require(u_riv > 0);
     eh_require(c_riv > 0);
@@ -1593,7 +1594,7 @@ sakura(double  u_riv, double  c_riv, double  h_riv, double* f_riv,
     eh_require(n_grains > 0);
     eh_require(c);
 
-    if (TRUE || g_getenv("SAKURA_DEBUG")) {
+    if (debug) {
         double       mass_in        = 0;
         const double vol_w          = u_riv * h_riv * w[0] * duration;
         gint n;
@@ -1681,7 +1682,7 @@ sakura(double  u_riv, double  c_riv, double  h_riv, double* f_riv,
         c->sub       *= 1e3;
         c->dep_start += x[0];
 
-        if (TRUE || g_getenv("SAKURA_DEBUG")) {
+        if (debug) {
             // Print input variables for debugging
             gint n;
 
@@ -1791,7 +1792,7 @@ sakura(double  u_riv, double  c_riv, double  h_riv, double* f_riv,
             }
         }
 
-        if (TRUE || g_getenv("SAKURA_DEBUG")) {
+        if (debug) {
             // Mass balance check
             gint         n;
             double       mass_in        = 0;
@@ -48,6 +48,8 @@ have a single number of sediment types that does not change.
 \param age      The average age of the sediemnt in the cell.
 \param pressure The excess porewater pressure in the cell.
 \param facies   The facies designation of the cell.
+\param in_block Set if the cell lives in a contiguous block of cells.
+\param pool     The Sed_cell_pool that the cell came from (or NULL).
 
 \see Sediment, sed_cell_new, sed_cell_destroy
 */
@@ -61,8 +63,49 @@ CLASS(Sed_cell)
     double     age;      ///< the average age of the sediemnt in the cell.
     double     pressure; ///< the excess porewater pressure in the cell.
     Sed_facies facies;   ///< the facies designation of the cell.
+    guint8     in_block; ///< the cell is owned by a block of cells.
+    Sed_cell_pool pool;  ///< the pool that owns the cell (or NULL).
 };
 
+/** \class Sed_cell_pool sed_cell.h ew/sed_cell.h
+
+\brief A slab allocator for Sed_cell's.
+
+Cells from a pool are carved out of large slabs.  The fractions of each cell
+are stored inline, directly after the cell, so that a cell costs no calls
+to the system allocator.  Destroyed cells are kept on a free list and are
+handed out again by the next call to sed_cell_pool_alloc.  All of the cells
+of a pool hold the same number of grain types.
+
+\param n_grains   The number of grain types of each cell.
+\param slab_len   The number of cells in each slab.
+\param slot_size  The number of bytes used by a cell and its fractions.
+\param slabs      The slabs of the pool.
+\param free_list  Cells that are available for reuse.
+\param mutex      Protects the pool.
+*/
+CLASS(Sed_cell_pool)
+{
+    gssize   n_grains;    ///< the number of grain types of each cell.
+    gssize   slab_len;    ///< the number of cells in a slab.
+    gsize    slot_size;   ///< bytes used by a cell and its fractions.
+    GSList*  slabs;       ///< the slabs of memory.
+    Sed_cell free_list;   ///< cells ready to be handed out (linked through f).
+    gint64   n_in_use;    ///< number of cells that are currently handed out.
+    gint64   n_peak;      ///< the largest number of cells handed out.
+    gint64   n_allocs;    ///< number of calls to sed_cell_pool_alloc.
+    gint64   n_reused;    ///< number of allocations served from the free list.
+    GMutex*  mutex;       ///< protects the pool.
+};
+
+static gboolean      __pools_enabled = FALSE;
+static GSList*       __pools         = NULL;
+static GStaticMutex  __pools_lock    = G_STATIC_MUTEX_INIT;
+static GStaticPrivate __thread_pool  = G_STATIC_PRIVATE_INIT;
+
+static Sed_cell_pool
+_sed_cell_thread_pool(gssize n_grains);
+
 #include <stdlib.h>
 
 /**
@@ -80,16 +123,24 @@ sed_cell_new(gssize n_grains)
     Sed_cell c = NULL;
 
     if (n_grains > 0) {
-        NEW_OBJECT(Sed_cell, c);
-
-        c->f = eh_new0(double, n_grains);
+        Sed_cell_pool pool = _sed_cell_thread_pool(n_grains);
 
-        c->n        = n_grains;
-        c->t_0      = 0.;
-        c->t        = 0.;
-        c->age      = 0.;
-        c->pressure = 0.;
-        c->facies   = S_FACIES_NOTHING;
+        if (pool) {
+            c = sed_cell_pool_alloc(pool);
+        } else {
+            NEW_OBJECT(Sed_cell, c);
+
+            c->f = eh_new0(double, n_grains);
+
+            c->n        = n_grains;
+            c->t_0      = 0.;
+            c->t        = 0.;
+            c->age      = 0.;
+            c->pressure = 0.;
+            c->facies   = S_FACIES_NOTHING;
+            c->in_block = FALSE;
+            c->pool     = NULL;
+        }
     }
 
     return c;
@@ -327,7 +378,9 @@ also freed.
 Sed_cell
 sed_cell_destroy(Sed_cell c)
 {
-    if (c) {
+    if (c && c->pool) {
+        sed_cell_pool_release(c);
+    } else if (c && !c->in_block) {
         eh_free(c->f);
         eh_free(c);
     }
@@ -335,6 +388,454 @@ sed_cell_destroy(Sed_cell c)
     return NULL;
 }
 
+#define SED_CELL_POOL_SLAB_LEN (1024)
+
+/** Create a new pool of Sed_cell's.
+
+\param n_grains The number of grain types held by cells of the pool.
+\param slab_len The number of cells to allocate at a time (if <= 0, use a
+                default).
+
+\return A new Sed_cell_pool, or NULL if n_grains is not positive.
+
+\see sed_cell_pool_alloc, sed_cell_pool_destroy
+*/
+Sed_cell_pool
+sed_cell_pool_new(gssize n_grains, gssize slab_len)
+{
+    Sed_cell_pool p = NULL;
+
+    if (n_grains > 0) {
+        NEW_OBJECT(Sed_cell_pool, p);
+
+        if (slab_len <= 0) {
+            slab_len = SED_CELL_POOL_SLAB_LEN;
+        }
+
+        p->n_grains  = n_grains;
+        p->slab_len  = slab_len;
+        p->slot_size = sizeof(struct tag_Sed_cell) + n_grains * sizeof(double);
+        p->slabs     = NULL;
+        p->free_list = NULL;
+        p->n_in_use  = 0;
+        p->n_peak    = 0;
+        p->n_allocs  = 0;
+        p->n_reused  = 0;
+        p->mutex     = g_mutex_new();
+    }
+
+    return p;
+}
+
+/** Destroy a pool of Sed_cell's.
+
+All of the memory used by the pool is freed, including any cells that have
+not been destroyed.  Those cells must no longer be used.
+
+\param p A Sed_cell_pool.
+
+\return NULL
+*/
+Sed_cell_pool
+sed_cell_pool_destroy(Sed_cell_pool p)
+{
+    if (p) {
+        GSList* link;
+
+        for (link = p->slabs ; link ; link = link->next) {
+            eh_free(link->data);
+        }
+
+        g_slist_free(p->slabs);
+        g_mutex_free(p->mutex);
+        eh_free(p);
+    }
+
+    return NULL;
+}
+
+/** Get a cell from a pool.
+
+The cell is cleared and holds the number of grain types of the pool.  When
+no longer needed, it should be destroyed with sed_cell_destroy, which
+returns the cell to its pool.
+
+\param p A Sed_cell_pool.
+
+\return A cleared Sed_cell.
+*/
+Sed_cell
+sed_cell_pool_alloc(Sed_cell_pool p)
+{
+    Sed_cell c = NULL;
+
+    eh_require(p);
+
+    if (p) {
+        g_mutex_lock(p->mutex);
+
+        if (!p->free_list) {
+            gssize i;
+            gchar* slab = (gchar*)eh_new(gchar, p->slab_len * p->slot_size);
+
+            p->slabs = g_slist_prepend(p->slabs, slab);
+
+            for (i = p->slab_len - 1 ; i >= 0 ; i--) {
+                Sed_cell slot = (Sed_cell)(slab + i * p->slot_size);
+
+                slot->f      = (double*)p->free_list;
+                p->free_list = slot;
+            }
+        } else {
+            p->n_reused += 1;
+        }
+
+        c            = p->free_list;
+        p->free_list = (Sed_cell)c->f;
+
+        p->n_allocs += 1;
+        p->n_in_use += 1;
+
+        if (p->n_in_use > p->n_peak) {
+            p->n_peak = p->n_in_use;
+        }
+
+        g_mutex_unlock(p->mutex);
+
+        c->f        = (double*)(c + 1);
+        c->n        = p->n_grains;
+        c->in_block = FALSE;
+        c->pool     = p;
+
+        sed_cell_clear(c);
+    }
+
+    return c;
+}
+
+/** Return a cell to the pool that it came from.
+
+This is called by sed_cell_destroy for cells that were allocated from a
+pool, and should not normally be called directly.
+
+\param c A Sed_cell that was allocated with sed_cell_pool_alloc.
+*/
+void
+sed_cell_pool_release(Sed_cell c)
+{
+    eh_require(c && c->pool);
+
+    if (c && c->pool) {
+        Sed_cell_pool p = c->pool;
+
+        g_mutex_lock(p->mutex);
+
+        c->f         = (double*)p->free_list;
+        c->pool      = NULL;
+        p->free_list = c;
+        p->n_in_use -= 1;
+
+        g_mutex_unlock(p->mutex);
+    }
+
+    return;
+}
+
+/** The number of grain types held by the cells of a pool.
+*/
+gssize
+sed_cell_pool_n_grains(Sed_cell_pool p)
+{
+    eh_require(p);
+    return p->n_grains;
+}
+
+/** The number of cells of a pool that are currently in use.
+*/
+gint64
+sed_cell_pool_n_in_use(Sed_cell_pool p)
+{
+    gint64 n;
+
+    eh_require(p);
+
+    g_mutex_lock(p->mutex);
+    n = p->n_in_use;
+    g_mutex_unlock(p->mutex);
+
+    return n;
+}
+
+/** The number of cells that a pool has room for without allocating a new slab.
+*/
+gint64
+sed_cell_pool_capacity(Sed_cell_pool p)
+{
+    gint64 n;
+
+    eh_require(p);
+
+    g_mutex_lock(p->mutex);
+    n = (gint64)g_slist_length(p->slabs) * p->slab_len;
+    g_mutex_unlock(p->mutex);
+
+    return n;
+}
+
+/** Print occupancy statistics for a pool of cells.
+
+\param fp A FILE to print to.
+\param p  A Sed_cell_pool.
+
+\return The number of bytes written.
+*/
+gint
+sed_cell_pool_fprint(FILE* fp, Sed_cell_pool p)
+{
+    gint n = 0;
+
+    eh_require(fp);
+
+    if (p) {
+        gint64 n_slabs;
+
+        g_mutex_lock(p->mutex);
+
+        n_slabs = g_slist_length(p->slabs);
+
+        n += fprintf(fp, "Grain types       : %ld\n", (glong)p->n_grains);
+        n += fprintf(fp, "Slabs             : %ld (%ld cells, %ld bytes)\n",
+                (glong)n_slabs, (glong)(n_slabs * p->slab_len),
+                (glong)(n_slabs * p->slab_len * p->slot_size));
+        n += fprintf(fp, "Cells in use      : %ld (%.1f%%)\n", (glong)p->n_in_use,
+                n_slabs > 0 ? p->n_in_use * 100. / (n_slabs * p->slab_len) : 0.);
+        n += fprintf(fp, "Peak cells in use : %ld\n", (glong)p->n_peak);
+        n += fprintf(fp, "Allocations       : %ld (%ld reused)\n",
+                (glong)p->n_allocs, (glong)p->n_reused);
+
+        g_mutex_unlock(p->mutex);
+    } else {
+        n += fprintf(fp, "( null )\n");
+    }
+
+    return n;
+}
+
+/** Allocate new cells from per-thread pools.
+
+When enabled, sed_cell_new hands out cells from a Sed_cell_pool that belongs
+to the calling thread.  Each thread creates its pool the first time that it
+needs one.  Cells may be destroyed from any thread.  Pools are never freed
+while they are enabled since cells from them may still be in use.
+
+\param enable TRUE to allocate cells from pools.
+*/
+void
+sed_cell_pool_enable(gboolean enable)
+{
+    __pools_enabled = enable;
+}
+
+/** Are new cells allocated from per-thread pools?
+*/
+gboolean
+sed_cell_pool_is_enabled(void)
+{
+    return __pools_enabled;
+}
+
+/** Print occupancy statistics for all of the per-thread pools.
+
+\param fp A FILE to print to.
+
+\return The number of bytes written.
+*/
+gint
+sed_cell_pools_fprint(FILE* fp)
+{
+    gint n = 0;
+
+    g_static_mutex_lock(&__pools_lock);
+    {
+        GSList* link;
+        gint i;
+
+        for (link = __pools, i = 0 ; link ; link = link->next, i++) {
+            n += fprintf(fp, "--- Sed_cell pool %d ---\n", i);
+            n += sed_cell_pool_fprint(fp, link->data);
+        }
+    }
+    g_static_mutex_unlock(&__pools_lock);
+
+    return n;
+}
+
+static Sed_cell_pool
+_sed_cell_thread_pool(gssize n_grains)
+{
+    Sed_cell_pool p = NULL;
+
+    if (__pools_enabled) {
+        p = g_static_private_get(&__thread_pool);
+
+        if (!p) {
+            p = sed_cell_pool_new(n_grains, 0);
+
+            g_static_private_set(&__thread_pool, p, NULL);
+
+            g_static_mutex_lock(&__pools_lock);
+            __pools = g_slist_prepend(__pools, p);
+            g_static_mutex_unlock(&__pools_lock);
+        }
+
+        if (p->n_grains != n_grains) {
+            p = NULL;
+        }
+    }
+
+    return p;
+}
+
+/** Create a contiguous block of cells.
+
+Allocate len Sed_cell's as a single array of cells.  The grain fractions of
+all of the cells are stored in a single len by n_grains matrix (one row per
+cell) so that walking through the cells of a block does not chase a pointer
+for each cell.  The cells of a block are regular Sed_cell's and can be used
+with any of the sed_cell_* functions.  They are owned by the block, though,
+and so sed_cell_destroy does nothing with them.  Use sed_cell_block_destroy
+to free the block.
+
+\param len      The number of cells in the block.
+\param n_grains The number of sediment types held in each cell.
+
+\return The first cell of the block, or NULL if len or n_grains is not positive.
+
+\see sed_cell_block_resize, sed_cell_block_destroy
+*/
+Sed_cell
+sed_cell_block_new(gssize len, gssize n_grains)
+{
+    Sed_cell block = NULL;
+
+    if (len > 0 && n_grains > 0) {
+        gssize i;
+        double* f = eh_new0(double, len * n_grains);
+
+        block = eh_new0(struct tag_Sed_cell, len);
+
+        for (i = 0 ; i < len ; i++) {
+            block[i].n        = n_grains;
+            block[i].f        = f + i * n_grains;
+            block[i].facies   = S_FACIES_NOTHING;
+            block[i].in_block = TRUE;
+        }
+    }
+
+    return block;
+}
+
+/** Change the number of cells in a block.
+
+Cells that are added to the block are cleared.  The block may be moved in
+memory and so any cells of the block that are held by the caller will no
+longer be valid.
+
+\param block   A block of cells created with sed_cell_block_new.
+\param len     The current number of cells in the block.
+\param new_len The new number of cells in the block.
+
+\return The (possibly moved) first cell of the block.
+*/
+Sed_cell
+sed_cell_block_resize(Sed_cell block, gssize len, gssize new_len)
+{
+    eh_require(block);
+    eh_require(new_len > 0);
+
+    if (block && new_len != len) {
+        const gssize n_grains = block[0].n;
+        double* f = eh_renew(double, block[0].f, new_len * n_grains);
+        gssize i;
+
+        block = eh_renew(struct tag_Sed_cell, block, new_len);
+
+        for (i = 0 ; i < new_len ; i++) {
+            block[i].f = f + i * n_grains;
+        }
+
+        for (i = len ; i < new_len ; i++) {
+            block[i].n        = n_grains;
+            block[i].in_block = TRUE;
+            block[i].pool     = NULL;
+            sed_cell_clear(block + i);
+        }
+    }
+
+    return block;
+}
+
+/** Destroy a block of cells.
+
+\param block A block of cells created with sed_cell_block_new.
+
+\return NULL
+*/
+Sed_cell
+sed_cell_block_destroy(Sed_cell block)
+{
+    if (block) {
+        eh_free(block[0].f);
+        eh_free(block);
+    }
+
+    return NULL;
+}
+
+/** Get the n-th cell of a block of cells.
+
+\param block A block of cells.
+\param n     Index of the cell.
+
+\return The n-th cell of the block.
+*/
+Sed_cell
+sed_cell_block_nth(Sed_cell block, gssize n)
+{
+    eh_require(block);
+    eh_require(n >= 0);
+    return block + n;
+}
+
+/** Get the fraction matrix of a block of cells.
+
+The grain fractions of the n-th cell of the block begin at the (n*n_grains)-th
+element of the returned array.  The array is owned by the block and should
+not be freed.
+
+\param block A block of cells.
+
+\return The fraction matrix of the block.
+*/
+double*
+sed_cell_block_fraction_data(Sed_cell block)
+{
+    eh_require(block);
+    return block ? block[0].f : NULL;
+}
+
+/** Is a cell part of a block of cells?
+
+\param c A Sed_cell.
+
+\return TRUE if the cell is owned by a block of cells.
+*/
+gboolean
+sed_cell_is_in_block(const Sed_cell c)
+{
+    return c && c->in_block;
+}
+
 /** Print the contents of a cell
 
 \param fp A FILE to print to which
@@ -2121,6 +2622,69 @@ sed_cell_read(FILE* fp)
     return c;
 }
 
+/** Copy a Sed_cell into a flat record of doubles.
+
+A cell record holds the fractions of each grain type followed by the initial
+thickness, thickness, age, pressure, and facies of the cell.  Records have a
+fixed length (SED_CELL_RECORD_LEN) so that they can be read in place from a
+memory-mapped file.
+
+\param c   The Sed_cell to copy
+\param rec Location for the record (or NULL)
+
+\return The record.  If \a rec is NULL, a newly-allocated record that should
+        be freed with eh_free.
+*/
+double*
+sed_cell_to_record(const Sed_cell c, double* rec)
+{
+    eh_require(c);
+
+    if (!rec) {
+        rec = eh_new(double, SED_CELL_RECORD_LEN(c->n));
+    }
+
+    memcpy(rec, c->f, sizeof(double)*c->n);
+
+    rec[c->n]     = c->t_0;
+    rec[c->n + 1] = c->t;
+    rec[c->n + 2] = c->age;
+    rec[c->n + 3] = c->pressure;
+    rec[c->n + 4] = c->facies;
+
+    return rec;
+}
+
+/** Copy a record that was written with sed_cell_to_record into a Sed_cell.
+
+\param c        The Sed_cell to copy into (or NULL)
+\param rec      A cell record
+\param n_grains The number of grain types in the record
+
+\return The Sed_cell.  If \a c is NULL, a newly-created Sed_cell.
+*/
+Sed_cell
+sed_cell_from_record(Sed_cell c, const double* rec, gssize n_grains)
+{
+    eh_require(rec);
+
+    if (!c) {
+        c = sed_cell_new(n_grains);
+    }
+
+    eh_require(c->n == n_grains);
+
+    memcpy(c->f, rec, sizeof(double)*n_grains);
+
+    c->t_0      = rec[n_grains];
+    c->t        = rec[n_grains + 1];
+    c->age      = rec[n_grains + 2];
+    c->pressure = rec[n_grains + 3];
+    c->facies   = (Sed_facies)rec[n_grains + 4];
+
+    return c;
+}
+
 /** \brief Change the size of a cell.
 
 Change the size of a Sed_cell .
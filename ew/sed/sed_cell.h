@@ -27,6 +27,7 @@
 G_BEGIN_DECLS
 
 new_handle(Sed_cell);
+new_handle(Sed_cell_pool);
 
 typedef double (*Sed_cell_property_func_0)(const Sed_cell);
 typedef double (*Sed_cell_property_func_1)(const Sed_cell, double);
@@ -91,6 +92,42 @@ sed_cell_copy(Sed_cell dest, Sed_cell src);
 Sed_cell
 sed_cell_destroy(Sed_cell c);
 
+Sed_cell
+sed_cell_block_new(gssize len, gssize n_grains);
+Sed_cell
+sed_cell_block_resize(Sed_cell block, gssize len, gssize new_len);
+Sed_cell
+sed_cell_block_destroy(Sed_cell block);
+Sed_cell
+sed_cell_block_nth(Sed_cell block, gssize n);
+double*
+sed_cell_block_fraction_data(Sed_cell block);
+gboolean
+sed_cell_is_in_block(const Sed_cell c);
+
+Sed_cell_pool
+sed_cell_pool_new(gssize n_grains, gssize slab_len);
+Sed_cell_pool
+sed_cell_pool_destroy(Sed_cell_pool p);
+Sed_cell
+sed_cell_pool_alloc(Sed_cell_pool p);
+void
+sed_cell_pool_release(Sed_cell c);
+gssize
+sed_cell_pool_n_grains(Sed_cell_pool p);
+gint64
+sed_cell_pool_n_in_use(Sed_cell_pool p);
+gint64
+sed_cell_pool_capacity(Sed_cell_pool p);
+gint
+sed_cell_pool_fprint(FILE* fp, Sed_cell_pool p);
+void
+sed_cell_pool_enable(gboolean enable);
+gboolean
+sed_cell_pool_is_enabled(void);
+gint
+sed_cell_pools_fprint(FILE* fp);
+
 Sed_cell
 sed_cell_clear(Sed_cell);
 Sed_cell
@@ -191,6 +228,14 @@ sed_cell_write_to_byte_order(FILE* fp, const Sed_cell c, int order);
 Sed_cell
 sed_cell_read(FILE*);
 
+/** Number of doubles in the record of a cell with n grain types */
+#define SED_CELL_RECORD_LEN( n ) ( (n) + 5 )
+
+double*
+sed_cell_to_record(const Sed_cell c, double* rec);
+Sed_cell
+sed_cell_from_record(Sed_cell c, const double* rec, gssize n_grains);
+
 Sed_cell*
 sed_cell_list_new(gssize len, gssize n);
 Sed_cell*
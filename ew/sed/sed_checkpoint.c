@@ -0,0 +1,993 @@
+//---
+//
+// This file is part of sedflux.
+//
+// sedflux is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// sedflux is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with sedflux; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//---
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include "utils/utils.h"
+
+#include "sed_sediment.h"
+#include "sed_checkpoint.h"
+
+/* A checkpoint file is laid out as,
+
+     header
+     name of the cube (padded to a multiple of 8 bytes)
+     name of the base checkpoint, for a delta (padded to 8 bytes)
+     column index: n_x*n_y+1 byte offsets (gint64) to each column record
+     column records (see sed_column_to_record)
+     process records (see sed_epoch_queue_dump)
+
+   Everything up to the process records is made of 8-byte words so that,
+   once the file is mapped into memory, a column can be read in place
+   without reading any of the columns that come before it.
+
+   A delta checkpoint holds only the columns that changed since its base
+   (a full checkpoint in the same directory) was written.  The record of
+   every other column is empty, that is, its offset is the same as that of
+   the next column.
+*/
+#define SED_CHECKPOINT_MAGIC "SEDCKPT"
+
+/* Process records are dumped to memory if the system has memory streams */
+#if defined(_POSIX_VERSION) && _POSIX_VERSION >= 200809L
+# define SED_CHECKPOINT_HAVE_MEMSTREAM
+#endif
+
+#define SED_CHECKPOINT_FLAG_DELTA (1<<0)
+
+typedef struct {
+    gchar  magic[8];     //< SED_CHECKPOINT_MAGIC
+    gint32 version;      //< SED_CHECKPOINT_VERSION
+    gint32 byte_order;   //< G_BYTE_ORDER of the machine that wrote the file
+    gint32 n_x;          //< Number of columns in the x-direction
+    gint32 n_y;          //< Number of columns in the y-direction
+    gint32 n_grains;     //< Number of grain types of each cell
+    gint32 flags;        //< SED_CHECKPOINT_FLAG_DELTA for a delta checkpoint
+    double age;
+    double time_step;
+    double sea_level;
+    double storm;
+    double quake;
+    double tidal_range;
+    double tidal_period;
+    double wave[3];
+    double x_res;
+    double y_res;
+    double z_res;
+    gint64 name_offset;  //< Offset to the name of the cube
+    gint64 name_len;     //< Length of the name (including the NUL)
+    gint64 base_offset;  //< Offset to the name of the base checkpoint
+    gint64 base_len;     //< Length of the base name (0 if not a delta)
+    gint64 index_offset; //< Offset to the column index
+    gint64 proc_offset;  //< Offset to the process records
+    gint64 file_len;     //< Length of the file
+}
+Sed_checkpoint_header;
+
+CLASS(Sed_checkpoint)
+{
+    gchar* file;
+    GMappedFile* map;
+    const gchar* data;
+    const Sed_checkpoint_header* header;
+    const gint64* index;
+    Sed_checkpoint base; //< Checkpoint that a delta is based on (or NULL)
+};
+
+GQuark
+sed_checkpoint_error_quark(void)
+{
+    return g_quark_from_static_string("sed-checkpoint-error-quark");
+}
+
+GQuark
+sed_checkpoint_epoch_queue_quark(void)
+{
+    return g_quark_from_static_string("sed-checkpoint-epoch-queue-quark");
+}
+
+/* Round a byte offset up to the next 8-byte word */
+#define _sed_checkpoint_align( n ) ( ((n) + 7) & ~((gint64)7) )
+
+static void
+_sed_checkpoint_mapped_file_free(GMappedFile* map)
+{
+#if GLIB_CHECK_VERSION(2,22,0)
+    g_mapped_file_unref(map);
+#else
+    g_mapped_file_free(map);
+#endif
+}
+
+/* Write len bytes of zeros so that the file is aligned to 8 bytes */
+static gint64
+_sed_checkpoint_pad(FILE* fp, gint64 offset)
+{
+    const gchar zeros[8] = { 0 };
+    const gint64 len = _sed_checkpoint_align(offset) - offset;
+
+    fwrite(zeros, sizeof(gchar), len, fp);
+
+    return offset + len;
+}
+
+/* Write the header, names, and (empty) column index of a checkpoint.  Return
+   the offset to the first column record.
+*/
+static gint64
+_sed_checkpoint_write_head(FILE* fp, Sed_checkpoint_header* h,
+    const gchar* name, const gchar* base)
+{
+    const gssize len = (gssize)h->n_x * h->n_y;
+    gint64* index = eh_new0(gint64, len + 1);
+
+    // The header is written again once the offsets are known.
+    fwrite(h, sizeof(Sed_checkpoint_header), 1, fp);
+
+    h->name_offset = sizeof(Sed_checkpoint_header);
+    h->name_len    = strlen(name) + 1;
+    fwrite(name, sizeof(gchar), h->name_len, fp);
+
+    h->base_offset = _sed_checkpoint_pad(fp, h->name_offset + h->name_len);
+
+    if (base) {
+        h->base_len = strlen(base) + 1;
+        fwrite(base, sizeof(gchar), h->base_len, fp);
+        h->flags |= SED_CHECKPOINT_FLAG_DELTA;
+    } else {
+        h->base_len = 0;
+        h->flags &= ~SED_CHECKPOINT_FLAG_DELTA;
+    }
+
+    h->index_offset = _sed_checkpoint_pad(fp, h->base_offset + h->base_len);
+    fwrite(index, sizeof(gint64), len + 1, fp);
+
+    eh_free(index);
+
+    return h->index_offset + (len + 1) * sizeof(gint64);
+}
+
+/* Patch the header and column index of a checkpoint and move it from its
+   temporary file to its final name.  The file is closed.
+*/
+static gboolean
+_sed_checkpoint_write_tail(FILE* fp, Sed_checkpoint_header* h,
+    const gint64* index, const gchar* tmp_file, const gchar* file,
+    GError** error)
+{
+    gboolean is_ok = FALSE;
+
+    h->file_len = ftell(fp);
+
+    fseek(fp, 0, SEEK_SET);
+    fwrite(h, sizeof(Sed_checkpoint_header), 1, fp);
+    fseek(fp, h->index_offset, SEEK_SET);
+    fwrite(index, sizeof(gint64), (gssize)h->n_x * h->n_y + 1, fp);
+
+    if (ferror(fp)) {
+        g_set_error(error, SED_CHECKPOINT_ERROR,
+            SED_CHECKPOINT_ERROR_WRITE_FILE,
+            "%s: Error writing checkpoint", tmp_file);
+        fclose(fp);
+    } else if (fclose(fp) != 0 || g_rename(tmp_file, file) != 0) {
+        eh_set_file_error_from_errno(error, file, errno);
+    } else {
+        is_ok = TRUE;
+    }
+
+    return is_ok;
+}
+
+static gboolean
+_sed_checkpoint_write(const gchar* file, const Sed_cube p, Sed_epoch_queue q,
+    const GByteArray* procs, const gchar* base, const gint* base_stamps,
+    GError** error)
+{
+    gboolean is_ok = FALSE;
+    gchar* tmp_file = g_strconcat(file, ".tmp", NULL);
+    FILE* fp = g_fopen(tmp_file, "wb");
+
+    if (!fp) {
+        eh_set_file_error_from_errno(error, tmp_file, errno);
+    } else {
+        const gssize len = sed_cube_size(p);
+        const gssize n_grains = sed_sediment_env_n_types();
+        Sed_checkpoint_header h;
+        gint64* index = eh_new0(gint64, len + 1);
+        gchar* name = sed_cube_name(p);
+        double* rec = NULL;
+        gssize rec_size = 0;
+        gint64 offset;
+        gssize id;
+
+        memset(&h, 0, sizeof(Sed_checkpoint_header));
+
+        strncpy(h.magic, SED_CHECKPOINT_MAGIC, 8);
+        h.version      = SED_CHECKPOINT_VERSION;
+        h.byte_order   = G_BYTE_ORDER;
+        h.n_x          = sed_cube_n_x(p);
+        h.n_y          = sed_cube_n_y(p);
+        h.n_grains     = n_grains;
+        h.age          = sed_cube_age(p);
+        h.time_step    = sed_cube_time_step(p);
+        h.sea_level    = sed_cube_sea_level(p);
+        h.storm        = sed_cube_storm(p);
+        h.quake        = sed_cube_quake(p);
+        h.tidal_range  = sed_cube_tidal_range(p);
+        h.tidal_period = sed_cube_tidal_period(p);
+        h.wave[0]      = sed_cube_wave_height(p);
+        h.wave[1]      = sed_cube_wave_period(p);
+        h.wave[2]      = sed_cube_wave_length(p);
+        h.x_res        = sed_cube_x_res(p);
+        h.y_res        = sed_cube_y_res(p);
+        h.z_res        = sed_cube_z_res(p);
+
+        offset = _sed_checkpoint_write_head(fp, &h, name, base);
+
+        for (id = 0 ; id < len ; id++) {
+            index[id] = offset;
+
+            if (!base_stamps || sed_cube_col_is_dirty(p, id, base_stamps[id])) {
+                const Sed_column col = sed_cube_col(p, id);
+                const gssize n = sed_column_record_len(col, n_grains);
+
+                if (n > rec_size) {
+                    rec_size = MAX(n, 2 * rec_size);
+                    eh_free(rec);
+                    rec = eh_new(double, rec_size);
+                }
+
+                sed_column_to_record(col, rec, n_grains);
+                fwrite(rec, sizeof(double), n, fp);
+
+                offset += n * sizeof(double);
+            }
+        }
+
+        index[len] = offset;
+
+        h.proc_offset = offset;
+
+        if (q) {
+            sed_epoch_queue_dump(q, fp);
+        } else if (procs) {
+            fwrite(procs->data, sizeof(guint8), procs->len, fp);
+        }
+
+        is_ok = _sed_checkpoint_write_tail(fp, &h, index, tmp_file, file, error);
+
+        eh_free(rec);
+        eh_free(name);
+        eh_free(index);
+    }
+
+    eh_free(tmp_file);
+
+    return is_ok;
+}
+
+/** Write a checkpoint of a sedflux run
+
+The state of the Sed_cube and of every process of the epoch queue is
+written to a file that can be used to restart the run (see
+sed_checkpoint_open and sed_checkpoint_restore).  The checkpoint is written
+to a temporary file that is renamed once it is complete, so that an
+earlier checkpoint of the same name is never left half-written.
+
+\param file  Name of the checkpoint file
+\param p     A Sed_cube
+\param q     The Sed_epoch_queue that is acting on the cube (or NULL)
+\param error A GError
+
+\return TRUE if the checkpoint was written, FALSE otherwise (and \a error is
+        set)
+*/
+gboolean
+sed_checkpoint_write(const gchar* file, const Sed_cube p, Sed_epoch_queue q,
+    GError** error)
+{
+    eh_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+    eh_require(file);
+    eh_require(p);
+
+    if (file && p) {
+        return _sed_checkpoint_write(file, p, q, NULL, NULL, NULL, error);
+    }
+
+    return FALSE;
+}
+
+/** Write a delta checkpoint of a sedflux run
+
+Only the columns that have changed since the full checkpoint, \a base,
+was written are saved; the rest are read from \a base when the delta is
+opened.  The stamps of the columns should have been recorded (with
+sed_cube_stamps) when \a base was written.  The base checkpoint must be
+kept in the same directory as the delta.
+
+\param file        Name of the checkpoint file
+\param p           A Sed_cube
+\param q           The Sed_epoch_queue that is acting on the cube (or NULL)
+\param base        Name of the full checkpoint that the delta is based on
+\param base_stamps Column stamps of the cube when \a base was written
+\param error       A GError
+
+\return TRUE if the checkpoint was written, FALSE otherwise (and \a error is
+        set)
+*/
+gboolean
+sed_checkpoint_write_delta(const gchar* file, const Sed_cube p,
+    Sed_epoch_queue q, const gchar* base, const gint* base_stamps,
+    GError** error)
+{
+    eh_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+    eh_require(file);
+    eh_require(p);
+    eh_require(base);
+    eh_require(base_stamps);
+
+    if (file && p && base && base_stamps) {
+        gchar* base_name = g_path_get_basename(base);
+        gboolean is_ok = _sed_checkpoint_write(file, p, q, NULL, base_name,
+                base_stamps, error);
+
+        eh_free(base_name);
+
+        return is_ok;
+    }
+
+    return FALSE;
+}
+
+/** Save the process records of an epoch queue
+
+Processes are dumped to memory so that a checkpoint of a snapshot of the
+cube (see sed_cube_snapshot) can be written after the processes have moved
+on.  The records are written to a memory stream, so the simulation doesn't
+wait on the disk.  On systems without memory streams they go through a
+temporary file.
+
+\param q The Sed_epoch_queue that is acting on the cube
+
+\return The process records as they would be written to a checkpoint (or
+        NULL on error).  Free with g_byte_array_free.
+*/
+GByteArray*
+sed_checkpoint_processes(Sed_epoch_queue q)
+{
+    GByteArray* procs = NULL;
+
+    eh_require(q);
+
+    if (q) {
+#if defined(SED_CHECKPOINT_HAVE_MEMSTREAM)
+        char* buf = NULL;
+        size_t len = 0;
+        FILE* fp = open_memstream(&buf, &len);
+
+        if (fp) {
+            sed_epoch_queue_dump(q, fp);
+
+            if (fclose(fp) == 0) {
+                procs = g_byte_array_sized_new(len);
+                g_byte_array_append(procs, (guint8*)buf, len);
+            }
+
+            free(buf);
+        }
+#else
+        FILE* fp = tmpfile();
+
+        if (fp) {
+            glong len;
+
+            sed_epoch_queue_dump(q, fp);
+
+            len = ftell(fp);
+
+            if (len >= 0) {
+                procs = g_byte_array_sized_new(len);
+                g_byte_array_set_size(procs, len);
+
+                rewind(fp);
+
+                if (fread(procs->data, sizeof(guint8), len, fp) != len) {
+                    g_byte_array_free(procs, TRUE);
+                    procs = NULL;
+                }
+            }
+
+            fclose(fp);
+        }
+#endif
+    }
+
+    return procs;
+}
+
+/** Write a checkpoint of a snapshot of a sedflux run
+
+Like sed_checkpoint_write and sed_checkpoint_write_delta but the process
+records are ones that were saved earlier with sed_checkpoint_processes.
+This lets a checkpoint be written by a thread other than the one that is
+running the processes.
+
+\param file        Name of the checkpoint file
+\param p           A snapshot of the Sed_cube
+\param procs       Process records (or NULL)
+\param base        Name of the full checkpoint that a delta is based on (or
+                   NULL to write a full checkpoint)
+\param base_stamps Column stamps of \a p when \a base was written
+\param error       A GError
+
+\return TRUE if the checkpoint was written, FALSE otherwise (and \a error is
+        set)
+*/
+gboolean
+sed_checkpoint_write_snapshot(const gchar* file, const Sed_cube p,
+    const GByteArray* procs, const gchar* base, const gint* base_stamps,
+    GError** error)
+{
+    eh_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+    eh_require(file);
+    eh_require(p);
+    eh_require(!base || base_stamps);
+
+    if (file && p && (!base || base_stamps)) {
+        gchar* base_name = (base) ? g_path_get_basename(base) : NULL;
+        gboolean is_ok = _sed_checkpoint_write(file, p, NULL, procs, base_name,
+                (base) ? base_stamps : NULL, error);
+
+        eh_free(base_name);
+
+        return is_ok;
+    }
+
+    return FALSE;
+}
+
+/** Merge a delta checkpoint with its base
+
+Write a full checkpoint that holds every column of \a c, taking those that
+are not in a delta from its base checkpoint.  Column and process records
+are copied as they are, without being decoded.
+
+\param c     A Sed_checkpoint
+\param file  Name of the new checkpoint file
+\param error A GError
+
+\return TRUE if the checkpoint was written, FALSE otherwise (and \a error is
+        set)
+*/
+gboolean
+sed_checkpoint_merge(const Sed_checkpoint c, const gchar* file, GError** error)
+{
+    gboolean is_ok = FALSE;
+
+    eh_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+    eh_require(c);
+    eh_require(file);
+
+    if (c && file) {
+        gchar* tmp_file = g_strconcat(file, ".tmp", NULL);
+        FILE* fp = g_fopen(tmp_file, "wb");
+
+        if (!fp) {
+            eh_set_file_error_from_errno(error, tmp_file, errno);
+        } else {
+            const gssize len = sed_checkpoint_size(c);
+            Sed_checkpoint_header h = *(c->header);
+            gint64* index = eh_new0(gint64, len + 1);
+            gint64 offset;
+            gssize id;
+
+            offset = _sed_checkpoint_write_head(fp, &h,
+                    c->data + c->header->name_offset, NULL);
+
+            for (id = 0 ; id < len ; id++) {
+                const Sed_checkpoint src = sed_checkpoint_has_column(c, id) ? c : c->base;
+                const gint64 n = src->index[id + 1] - src->index[id];
+
+                fwrite(src->data + src->index[id], sizeof(gchar), n, fp);
+
+                index[id] = offset;
+                offset += n;
+            }
+
+            index[len] = offset;
+
+            h.proc_offset = offset;
+
+            fwrite(c->data + c->header->proc_offset, sizeof(gchar),
+                c->header->file_len - c->header->proc_offset, fp);
+
+            is_ok = _sed_checkpoint_write_tail(fp, &h, index, tmp_file, file, error);
+
+            eh_free(index);
+        }
+
+        eh_free(tmp_file);
+    }
+
+    return is_ok;
+}
+
+/* Check that the header and column index of a mapped checkpoint make sense
+   before anything is read from it.
+*/
+static gboolean
+_sed_checkpoint_validate(const Sed_checkpoint c, gsize map_len, GError** error)
+{
+    const Sed_checkpoint_header* h = c->header;
+    gint code = -1;
+    gchar* msg = NULL;
+
+    if (map_len < sizeof(Sed_checkpoint_header)) {
+        code = SED_CHECKPOINT_ERROR_TRUNCATED;
+        msg  = g_strdup("File is too small to be a checkpoint");
+    } else if (strncmp(h->magic, SED_CHECKPOINT_MAGIC, 8) != 0) {
+        code = SED_CHECKPOINT_ERROR_BAD_MAGIC;
+        msg  = g_strdup("File is not a sedflux checkpoint");
+    } else if (h->byte_order != G_BYTE_ORDER) {
+        code = SED_CHECKPOINT_ERROR_BYTE_ORDER;
+        msg  = g_strdup("Checkpoint was written with a different byte order");
+    } else if (h->version != SED_CHECKPOINT_VERSION) {
+        code = SED_CHECKPOINT_ERROR_BAD_VERSION;
+        msg  = g_strdup_printf("Checkpoint version is %d (expected %d)",
+                h->version, SED_CHECKPOINT_VERSION);
+    } else if (h->file_len != map_len) {
+        code = SED_CHECKPOINT_ERROR_TRUNCATED;
+        msg  = g_strdup_printf("Checkpoint length is %ld (expected %ld)",
+                (glong)map_len, (glong)h->file_len);
+    } else if (h->n_x < 0 || h->n_y < 0 || h->n_grains <= 0
+        || h->name_len <= 0
+        || h->name_offset + h->name_len > h->base_offset
+        || h->base_len < 0
+        || ((h->flags & SED_CHECKPOINT_FLAG_DELTA) != 0) != (h->base_len > 0)
+        || h->base_offset + h->base_len > h->index_offset
+        || (h->base_len > 0 && c->data[h->base_offset + h->base_len - 1] != '\0')
+        || h->index_offset % 8 != 0
+        || h->index_offset + ((gint64)h->n_x * h->n_y + 1) * (gint64)sizeof(gint64)
+        > h->proc_offset
+        || h->proc_offset > h->file_len
+        || c->data[h->name_offset + h->name_len - 1] != '\0') {
+        code = SED_CHECKPOINT_ERROR_TRUNCATED;
+        msg  = g_strdup("Checkpoint header is corrupt");
+    } else {
+        const gssize len = (gssize)h->n_x * h->n_y;
+        const gint64 header_len = SED_COLUMN_RECORD_HEADER_LEN * sizeof(double);
+        const gboolean is_delta = h->flags & SED_CHECKPOINT_FLAG_DELTA;
+        gssize id;
+
+        // Only the index is checked here.  Each column record is checked as
+        // it is read so that opening a checkpoint doesn't touch every page.
+        for (id = 0 ; id < len && code < 0 ; id++) {
+            const gint64 start = c->index[id];
+            const gint64 end   = c->index[id + 1];
+
+            if (start % 8 != 0 || end > h->proc_offset
+                || (start + header_len > end && !(is_delta && start == end))) {
+                code = SED_CHECKPOINT_ERROR_TRUNCATED;
+                msg  = g_strdup_printf("Checkpoint index is corrupt (column %ld)",
+                        (glong)id);
+            }
+        }
+    }
+
+    if (code >= 0) {
+        g_set_error(error, SED_CHECKPOINT_ERROR, code, "%s: %s", c->file, msg);
+        eh_free(msg);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/* Open the full checkpoint that a delta checkpoint is based on.  It is
+   looked for in the directory of the delta.
+*/
+static Sed_checkpoint
+_sed_checkpoint_open_base(const Sed_checkpoint c, GError** error)
+{
+    Sed_checkpoint base = NULL;
+    GError* tmp_err = NULL;
+    gchar* dir = g_path_get_dirname(c->file);
+    gchar* file = g_build_filename(dir, c->data + c->header->base_offset, NULL);
+
+    base = sed_checkpoint_open(file, &tmp_err);
+
+    if (base) {
+        const Sed_checkpoint_header* h = base->header;
+
+        if (sed_checkpoint_is_delta(base)
+            || h->n_x != c->header->n_x || h->n_y != c->header->n_y
+            || h->n_grains != c->header->n_grains) {
+            g_set_error(&tmp_err, SED_CHECKPOINT_ERROR,
+                SED_CHECKPOINT_ERROR_BAD_BASE,
+                "%s: Checkpoint does not match its base (%s)", c->file, file);
+            base = sed_checkpoint_close(base);
+        }
+    }
+
+    if (tmp_err) {
+        g_propagate_error(error, tmp_err);
+    }
+
+    eh_free(file);
+    eh_free(dir);
+
+    return base;
+}
+
+/** Open a checkpoint file
+
+The file is mapped into memory; nothing is read from it until it is asked
+for, so that opening even a very large checkpoint is cheap.
+
+\param file  Name of a checkpoint file written by sed_checkpoint_write
+\param error A GError
+
+\return A new Sed_checkpoint that should be closed with sed_checkpoint_close,
+        or NULL on error (and \a error is set)
+*/
+Sed_checkpoint
+sed_checkpoint_open(const gchar* file, GError** error)
+{
+    Sed_checkpoint c = NULL;
+
+    eh_return_val_if_fail(error == NULL || *error == NULL, NULL);
+    eh_require(file);
+
+    if (file) {
+        GError* tmp_err = NULL;
+        GMappedFile* map = g_mapped_file_new(file, FALSE, &tmp_err);
+
+        if (map) {
+            NEW_OBJECT(Sed_checkpoint, c);
+
+            c->file   = g_strdup(file);
+            c->map    = map;
+            c->data   = g_mapped_file_get_contents(map);
+            c->header = (const Sed_checkpoint_header*)c->data;
+            c->index  = NULL;
+            c->base   = NULL;
+
+            if (g_mapped_file_get_length(map) >= sizeof(Sed_checkpoint_header)
+                && c->header->index_offset > 0
+                && c->header->index_offset < g_mapped_file_get_length(map)) {
+                c->index = (const gint64*)(c->data + c->header->index_offset);
+            }
+
+            if (!_sed_checkpoint_validate(c, g_mapped_file_get_length(map), &tmp_err)) {
+                c = sed_checkpoint_close(c);
+            } else if (sed_checkpoint_is_delta(c)) {
+                c->base = _sed_checkpoint_open_base(c, &tmp_err);
+
+                if (!c->base) {
+                    c = sed_checkpoint_close(c);
+                }
+            }
+        }
+
+        if (tmp_err) {
+            g_propagate_error(error, tmp_err);
+        }
+    }
+
+    return c;
+}
+
+/** Close a checkpoint file
+
+\param c A Sed_checkpoint
+
+\return NULL
+*/
+Sed_checkpoint
+sed_checkpoint_close(Sed_checkpoint c)
+{
+    if (c) {
+        sed_checkpoint_close(c->base);
+        _sed_checkpoint_mapped_file_free(c->map);
+        eh_free(c->file);
+        eh_free(c);
+    }
+
+    return NULL;
+}
+
+gint
+sed_checkpoint_version(const Sed_checkpoint c)
+{
+    eh_return_val_if_fail(c, 0);
+    return c->header->version;
+}
+
+gint
+sed_checkpoint_n_x(const Sed_checkpoint c)
+{
+    eh_return_val_if_fail(c, 0);
+    return c->header->n_x;
+}
+
+gint
+sed_checkpoint_n_y(const Sed_checkpoint c)
+{
+    eh_return_val_if_fail(c, 0);
+    return c->header->n_y;
+}
+
+gssize
+sed_checkpoint_size(const Sed_checkpoint c)
+{
+    eh_return_val_if_fail(c, 0);
+    return (gssize)c->header->n_x * c->header->n_y;
+}
+
+double
+sed_checkpoint_age(const Sed_checkpoint c)
+{
+    eh_return_val_if_fail(c, 0.);
+    return c->header->age;
+}
+
+gboolean
+sed_checkpoint_is_delta(const Sed_checkpoint c)
+{
+    eh_return_val_if_fail(c, FALSE);
+    return (c->header->flags & SED_CHECKPOINT_FLAG_DELTA) != 0;
+}
+
+/** Is a column stored in a checkpoint file
+
+\param c  A Sed_checkpoint
+\param id Id of the column
+
+\return TRUE if the column is in the file, FALSE if it is read from the base
+        of a delta checkpoint
+*/
+gboolean
+sed_checkpoint_has_column(const Sed_checkpoint c, gssize id)
+{
+    eh_return_val_if_fail(c, FALSE);
+    eh_return_val_if_fail(id >= 0 && id < sed_checkpoint_size(c), FALSE);
+    return c->index[id + 1] > c->index[id];
+}
+
+/** Read one column from a checkpoint
+
+The column is found through the column index of the checkpoint, so only the
+pages of the file that hold the column are read.
+
+\param c     A Sed_checkpoint
+\param id    Id of the column
+\param dest  Column to read into (or NULL)
+\param error A GError
+
+\return The column.  If \a dest is NULL, a newly-created Sed_column.  NULL if
+        the record of the column is corrupt (and \a error is set), in which
+        case \a dest is left as it was.
+*/
+Sed_column
+sed_checkpoint_column(const Sed_checkpoint c, gssize id, Sed_column dest,
+    GError** error)
+{
+    eh_return_val_if_fail(error == NULL || *error == NULL, NULL);
+    eh_return_val_if_fail(c, dest);
+    eh_return_val_if_fail(id >= 0 && id < sed_checkpoint_size(c), dest);
+
+    if (!sed_checkpoint_has_column(c, id)) {
+        dest = sed_checkpoint_column(c->base, id, dest, error);
+    } else {
+        const double* rec = (const double*)(c->data + c->index[id]);
+        const gint64 rec_len = (c->index[id + 1] - c->index[id]) / sizeof(double);
+        const gint64 n_cells = (gint64)rec[7];
+
+        if (n_cells < 0
+            || rec_len != SED_COLUMN_RECORD_HEADER_LEN
+            + n_cells * SED_CELL_RECORD_LEN(c->header->n_grains)) {
+            g_set_error(error, SED_CHECKPOINT_ERROR, SED_CHECKPOINT_ERROR_CORRUPT,
+                "%s: Checkpoint column %ld is corrupt", c->file, (glong)id);
+            dest = NULL;
+        } else {
+            dest = sed_column_from_record(dest, rec, c->header->n_grains);
+        }
+    }
+
+    return dest;
+}
+
+typedef struct {
+    Sed_checkpoint c;
+    GStaticMutex   lock;
+    GError*        error; //< Error of the first column that could not be read
+}
+Sed_checkpoint_restore_job;
+
+static void
+_sed_checkpoint_restore_column(Sed_cube p, gssize n, gssize id, Sed_worker w,
+    gpointer data)
+{
+    Sed_checkpoint_restore_job* job = (Sed_checkpoint_restore_job*)data;
+    GError* tmp_err = NULL;
+
+    if (!sed_checkpoint_column(job->c, id, sed_cube_col(p, id), &tmp_err)) {
+        g_static_mutex_lock(&job->lock);
+
+        if (!job->error) {
+            job->error = tmp_err;
+        } else {
+            g_error_free(tmp_err);
+        }
+
+        g_static_mutex_unlock(&job->lock);
+    }
+}
+
+/* Check that the columns of a checkpoint can be read into a cube */
+static gboolean
+_sed_checkpoint_check_cube(const Sed_checkpoint c, const Sed_cube p,
+    GError** error)
+{
+    if (c->header->n_x != sed_cube_n_x(p) || c->header->n_y != sed_cube_n_y(p)) {
+        g_set_error(error, SED_CHECKPOINT_ERROR, SED_CHECKPOINT_ERROR_SIZE_MISMATCH,
+            "%s: Checkpoint is %dx%d but the cube is %dx%d", c->file,
+            c->header->n_x, c->header->n_y, sed_cube_n_x(p), sed_cube_n_y(p));
+        return FALSE;
+    } else if (c->header->n_grains != sed_sediment_env_n_types()) {
+        g_set_error(error, SED_CHECKPOINT_ERROR, SED_CHECKPOINT_ERROR_SIZE_MISMATCH,
+            "%s: Checkpoint has %d grain types but the sediment has %d",
+            c->file, c->header->n_grains, sed_sediment_env_n_types());
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/** Read some of the columns of a checkpoint into a cube
+
+Each of the listed columns of the cube is replaced by the column of the
+checkpoint.  Columns are read in parallel (see sed_cube_n_threads).  If the
+record of any column is corrupt, the restore fails.  Other columns may
+already have been replaced by then, so the cube should not be used.
+
+\param c     A Sed_checkpoint
+\param p     A Sed_cube that is the same size as the checkpoint
+\param ids   Ids of the columns to read (or NULL for every column)
+\param len   Number of ids
+\param error A GError
+
+\return TRUE if the columns were read, FALSE otherwise (and \a error is set)
+*/
+gboolean
+sed_checkpoint_restore_columns(const Sed_checkpoint c, Sed_cube p,
+    const gssize* ids, gssize len, GError** error)
+{
+    eh_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+    eh_return_val_if_fail(c, FALSE);
+    eh_return_val_if_fail(p, FALSE);
+
+    if (!_sed_checkpoint_check_cube(c, p, error)) {
+        return FALSE;
+    }
+
+    if (!ids) {
+        len = sed_cube_size(p);
+    }
+
+    {
+        Sed_checkpoint_restore_job job;
+        gboolean is_ok;
+
+        job.c     = c;
+        job.error = NULL;
+        g_static_mutex_init(&job.lock);
+
+        is_ok = sed_cube_foreach_column_list_parallel(p, ids, len,
+                &_sed_checkpoint_restore_column, &job);
+
+        g_static_mutex_free(&job.lock);
+
+        if (job.error) {
+            g_propagate_error(error, job.error);
+            is_ok = FALSE;
+        }
+
+        return is_ok;
+    }
+}
+
+/** Restart a sedflux run from a checkpoint
+
+The cube and the epoch queue must already have been created from the same
+input files as the run that wrote the checkpoint.  The columns and scalar
+data of the cube are replaced with those of the checkpoint, as are the
+states of the processes of the epoch queue.  Running the epoch queue from
+the (restored) age of the cube then picks up the run where the checkpoint
+left it.
+
+Only processes with a load function get their user data back (see
+sed_process_load).  The others set themselves up again from the restored
+cube on their next run.
+
+\param c     A Sed_checkpoint
+\param p     A Sed_cube
+\param q     A Sed_epoch_queue (or NULL)
+\param error A GError
+
+\return TRUE if the run was restored, FALSE otherwise (and \a error is set)
+*/
+gboolean
+sed_checkpoint_restore(const Sed_checkpoint c, Sed_cube p, Sed_epoch_queue q,
+    GError** error)
+{
+    gboolean is_ok = FALSE;
+
+    eh_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+    eh_return_val_if_fail(c, FALSE);
+    eh_return_val_if_fail(p, FALSE);
+
+    {
+        GError* tmp_err = NULL;
+        const Sed_checkpoint_header* h = c->header;
+
+        if (sed_checkpoint_restore_columns(c, p, NULL, 0, &tmp_err)) {
+            sed_cube_set_name(p, (gchar*)(c->data + h->name_offset));
+            sed_cube_set_age(p, h->age);
+            sed_cube_set_time_step(p, h->time_step);
+            sed_cube_set_storm(p, h->storm);
+            sed_cube_set_quake(p, h->quake);
+            sed_cube_set_tidal_range(p, h->tidal_range);
+            sed_cube_set_tidal_period(p, h->tidal_period);
+            sed_cube_set_wave_height(p, h->wave[0]);
+            sed_cube_set_wave_period(p, h->wave[1]);
+            sed_cube_set_wave_length(p, h->wave[2]);
+            sed_cube_set_x_res(p, h->x_res);
+            sed_cube_set_y_res(p, h->y_res);
+            sed_cube_set_z_res(p, h->z_res);
+            sed_cube_set_sea_level(p, h->sea_level);
+        }
+
+        if (!tmp_err && q && h->proc_offset < h->file_len) {
+            FILE* fp = g_fopen(c->file, "rb");
+
+            if (!fp) {
+                eh_set_file_error_from_errno(&tmp_err, c->file, errno);
+            } else {
+                fseek(fp, h->proc_offset, SEEK_SET);
+                sed_epoch_queue_load(q, fp, &tmp_err);
+                fclose(fp);
+            }
+        }
+
+        if (tmp_err) {
+            g_propagate_error(error, tmp_err);
+        } else {
+            is_ok = TRUE;
+        }
+    }
+
+    return is_ok;
+}
@@ -0,0 +1,111 @@
+//---
+//
+// This file is part of sedflux.
+//
+// sedflux is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// sedflux is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with sedflux; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//---
+
+#if !defined(SED_CHECKPOINT_H)
+# define SED_CHECKPOINT_H
+
+#include <glib.h>
+
+#include "utils/utils.h"
+#include "sed_column.h"
+#include "sed_cube.h"
+#include "sed_epoch.h"
+
+G_BEGIN_DECLS
+
+/** Version of the checkpoint file layout */
+#define SED_CHECKPOINT_VERSION (2)
+
+new_handle(Sed_checkpoint);
+
+typedef enum {
+    SED_CHECKPOINT_ERROR_OPEN_FILE,
+    SED_CHECKPOINT_ERROR_WRITE_FILE,
+    SED_CHECKPOINT_ERROR_BAD_MAGIC,
+    SED_CHECKPOINT_ERROR_BAD_VERSION,
+    SED_CHECKPOINT_ERROR_BYTE_ORDER,
+    SED_CHECKPOINT_ERROR_TRUNCATED,
+    SED_CHECKPOINT_ERROR_SIZE_MISMATCH,
+    SED_CHECKPOINT_ERROR_BAD_BASE,
+    SED_CHECKPOINT_ERROR_CORRUPT
+}
+Sed_checkpoint_error;
+
+#define SED_CHECKPOINT_ERROR sed_checkpoint_error_quark()
+
+GQuark
+sed_checkpoint_error_quark(void);
+
+/** Key under which a process is provided the epoch queue to checkpoint */
+#define SED_CHECKPOINT_EPOCH_QUEUE sed_checkpoint_epoch_queue_quark()
+
+GQuark
+sed_checkpoint_epoch_queue_quark(void);
+
+gboolean
+sed_checkpoint_write(const gchar* file, const Sed_cube p, Sed_epoch_queue q,
+    GError** error);
+
+gboolean
+sed_checkpoint_write_delta(const gchar* file, const Sed_cube p,
+    Sed_epoch_queue q, const gchar* base, const gint* base_stamps,
+    GError** error);
+GByteArray*
+sed_checkpoint_processes(Sed_epoch_queue q);
+gboolean
+sed_checkpoint_write_snapshot(const gchar* file, const Sed_cube p,
+    const GByteArray* procs, const gchar* base, const gint* base_stamps,
+    GError** error);
+gboolean
+sed_checkpoint_merge(const Sed_checkpoint c, const gchar* file, GError** error);
+
+Sed_checkpoint
+sed_checkpoint_open(const gchar* file, GError** error);
+Sed_checkpoint
+sed_checkpoint_close(Sed_checkpoint c);
+
+gint
+sed_checkpoint_version(const Sed_checkpoint c);
+gint
+sed_checkpoint_n_x(const Sed_checkpoint c);
+gint
+sed_checkpoint_n_y(const Sed_checkpoint c);
+gssize
+sed_checkpoint_size(const Sed_checkpoint c);
+double
+sed_checkpoint_age(const Sed_checkpoint c);
+gboolean
+sed_checkpoint_is_delta(const Sed_checkpoint c);
+gboolean
+sed_checkpoint_has_column(const Sed_checkpoint c, gssize id);
+
+Sed_column
+sed_checkpoint_column(const Sed_checkpoint c, gssize id, Sed_column dest,
+    GError** error);
+gboolean
+sed_checkpoint_restore_columns(const Sed_checkpoint c, Sed_cube p,
+    const gssize* ids, gssize len, GError** error);
+gboolean
+sed_checkpoint_restore(const Sed_checkpoint c, Sed_cube p, Sed_epoch_queue q,
+    GError** error);
+
+G_END_DECLS
+
+#endif /* sed_checkpoint.h */
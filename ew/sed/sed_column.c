@@ -39,8 +39,58 @@ CLASS(Sed_column)
     double y;          ///< y-position of this column
     double age;        ///< age of this column
     double sl;         ///< sea level
+    Sed_cell block;    ///< Contiguous storage for the cells (or NULL)
+    double* load;      ///< Cumulative sediment load from the base (or NULL)
+    gssize load_len;   ///< Number of cells that load is valid for
+    gssize load_size;  ///< Number of elements allocated for load
+    gint load_stamp;   ///< Stamp of the column that load is valid for
+    gint stamp;        ///< Changes each time the column is modified
+    Sed_mass_ledger ledger; ///< Account of the sediment of the column (or NULL)
 };
 
+static Sed_column_storage __default_storage = SED_COLUMN_STORAGE_CELLS;
+static gboolean __load_cache = FALSE;
+static gint __stamp = 0;
+static gint __load_cache_calls = 0;
+static gint __load_cache_hits = 0;
+static gint __load_cache_cells = 0;
+
+/* Post the cells of a column to its ledger (f=1 to deposit, -1 to erode) */
+static void
+_sed_column_post_cells(Sed_column c, double f)
+{
+    if (c && c->ledger) {
+        gssize i;
+
+        for (i = 0 ; i < c->len ; i++) {
+            sed_mass_ledger_post_cell(c->ledger, c->cell[i], f);
+        }
+    }
+}
+
+/** Set the cell storage used for newly created columns.
+
+Columns created with sed_column_new will store their cells as described by
+storage.  Existing columns are not affected.
+
+@param storage The type of storage for new columns.
+*/
+void
+sed_column_set_default_storage(Sed_column_storage storage)
+{
+    __default_storage = storage;
+}
+
+/** The cell storage used for newly created columns.
+
+@return The type of storage used by sed_column_new.
+*/
+Sed_column_storage
+sed_column_default_storage(void)
+{
+    return __default_storage;
+}
+
 //@Include: sed_column.h
 
 /** Create a column of sediment
@@ -54,6 +104,34 @@ CLASS(Sed_column)
 */
 Sed_column
 sed_column_new(gssize n_bins)
+{
+    return sed_column_new_with_storage(n_bins, __default_storage);
+}
+
+/** Create a column of sediment that uses a particular cell storage
+
+With SED_COLUMN_STORAGE_CELLS each Sed_cell of the column is allocated
+separately.  With SED_COLUMN_STORAGE_CONTIGUOUS the cells of the column are
+kept in a single block of cells (see sed_cell_block_new) whose grain
+fractions form a single matrix.  The Sed_cell's of a contiguous column
+may move when the column grows so pointers to them should not be held
+across calls that add sediment to the column.
+
+Only the grain fractions are stored as a structure of arrays.  The scalar
+fields of the cells (thickness, age, pressure, facies) stay in an array of
+Sed_cell structs because every sed_cell_* function, and every caller that
+holds a Sed_cell of a column, reads them through the cell.  Use
+sed_column_fraction_data to read the fractions directly and
+sed_column_thickness_array to gather the cell thicknesses.
+
+@param n_bins  the number of Sed_cell's in the column.
+@param storage the type of storage to use for the cells.
+
+@return A newly created Sed_column.  NULL is returned if there was a problem
+        allocating memory.
+*/
+Sed_column
+sed_column_new_with_storage(gssize n_bins, Sed_column_storage storage)
 {
     Sed_column s = NULL;
 
@@ -61,8 +139,26 @@ sed_column_new(gssize n_bins)
         NEW_OBJECT(Sed_column, s);
 
         // use resize to allocate memory for the column in blocks.
-        s->size = 0;
-        s->cell = NULL;
+        s->size  = 0;
+        s->cell  = NULL;
+        s->block = NULL;
+
+        s->load      = NULL;
+        s->load_len  = 0;
+        s->load_size = 0;
+        s->load_stamp = 0;
+
+        s->ledger    = NULL;
+
+        sed_column_touch(s);
+
+        if (storage == SED_COLUMN_STORAGE_CONTIGUOUS) {
+            s->block = sed_cell_block_new(1, sed_sediment_env_n_types());
+            s->cell  = eh_new(Sed_cell, 1);
+            s->cell[0] = s->block;
+            s->size  = 1;
+        }
+
         sed_column_resize(s, n_bins);
 
         s->len = 0;
@@ -103,11 +199,16 @@ sed_column_destroy(Sed_column s)
     if (s) {
         gssize i;
 
-        for (i = 0; i < s->size; i++) {
-            sed_cell_destroy(s->cell[i]);
+        if (s->block) {
+            sed_cell_block_destroy(s->block);
+        } else {
+            for (i = 0; i < s->size; i++) {
+                sed_cell_destroy(s->cell[i]);
+            }
         }
 
         eh_free(s->cell);
+        eh_free(s->load);
 
         eh_free(s);
     }
@@ -125,12 +226,16 @@ sed_column_clear(Sed_column s)
     if (s) {
         gssize i;
 
+        _sed_column_post_cells(s, -1.);
+
         for (i = 0 ; i < s->len ; i++) {
             sed_cell_clear(s->cell[i]);
         }
 
         s->len = 0;
         s->t   = 0.;
+
+        sed_column_invalidate_load(s, 0);
     }
 
     return s;
@@ -159,9 +264,11 @@ sed_column_copy(Sed_column dest, const Sed_column src)
         gssize i;
 
         if (!dest) {
-            dest = sed_column_new(src->size);
+            dest = sed_column_new_with_storage(src->size, sed_column_storage(src));
         }
 
+        _sed_column_post_cells(dest, -1.);
+
         sed_column_resize(dest, src->size);
 
         dest->z   = src->z;
@@ -176,6 +283,10 @@ sed_column_copy(Sed_column dest, const Sed_column src)
         for (i = 0 ; i < src->size ; i++) {
             sed_cell_copy(dest->cell[i], src->cell[i]);
         }
+
+        _sed_column_post_cells(dest, 1.);
+
+        sed_column_invalidate_load(dest, 0);
     } else {
         dest = NULL;
     }
@@ -236,6 +347,8 @@ sed_column_copy_data(Sed_column dest, const Sed_column src)
         dest->y    = src->y;
         dest->age  = src->age;
         dest->sl   = src->sl;
+
+        sed_column_invalidate_load(dest, 0);
     }
 
     return dest;
@@ -272,6 +385,99 @@ sed_column_dup(const Sed_column src)
     return sed_column_copy(NULL, src);
 }
 
+/** The type of storage used for the cells of a Sed_column
+
+@param col A pointer to a Sed_column.
+
+@return The storage type of the column.
+*/
+Sed_column_storage
+sed_column_storage(const Sed_column col)
+{
+    eh_require(col);
+    return col->block ? SED_COLUMN_STORAGE_CONTIGUOUS : SED_COLUMN_STORAGE_CELLS;
+}
+
+/** Are the cells of a Sed_column stored contiguously?
+
+@param col A pointer to a Sed_column.
+
+@return TRUE if the column uses SED_COLUMN_STORAGE_CONTIGUOUS.
+*/
+gboolean
+sed_column_is_contiguous(const Sed_column col)
+{
+    return col && col->block;
+}
+
+/** Get the grain-fraction matrix of a contiguous Sed_column.
+
+For a column that stores its cells contiguously, the fractions of every
+cell are kept in a single matrix with one row of n_grains values for each
+cell (starting with the bottom cell).  Values of this matrix may be read
+and written directly but the matrix is owned by the column and may move
+if the column grows.
+
+@param col A pointer to a Sed_column.
+
+@return The fraction matrix, or NULL if the column does not use contiguous
+        storage.
+*/
+double*
+sed_column_fraction_data(const Sed_column col)
+{
+    double* f = NULL;
+
+    eh_require(col);
+
+    if (col && col->block) {
+        f = sed_cell_block_fraction_data(col->block);
+    }
+
+    return f;
+}
+
+/** Get the thickness of each cell of a Sed_column.
+
+The thicknesses are copied into \a t.  For a contiguous column this is a
+single pass over the block of cells.
+
+@param col    A pointer to a Sed_column.
+@param start  Index to the Sed_cell to begin at.
+@param n_bins The number of Sed_cell's (if <=0, go to the top of the column).
+@param t      Array to hold the thicknesses (or NULL to allocate a new one).
+
+@return An array of cell thicknesses.
+*/
+double*
+sed_column_thickness_array(const Sed_column col,
+    gssize start,
+    gssize n_bins,
+    double* t)
+{
+    eh_require(col);
+
+    if (col) {
+        gssize i;
+
+        eh_lower_bound(start, 0);
+
+        if (n_bins <= 0 || start + n_bins > col->len) {
+            n_bins = col->len - start;
+        }
+
+        if (!t) {
+            t = eh_new(double, MAX(n_bins, 1));
+        }
+
+        for (i = 0 ; i < n_bins ; i++) {
+            t[i] = sed_cell_size(col->cell[start + i]);
+        }
+    }
+
+    return t;
+}
+
 /** Get fraction information from a Sed_cell of a Sed_column.
 
 Get an array of fractions for each grain type contained within the specified
@@ -439,21 +645,33 @@ sed_column_set_age(Sed_column c, double age)
 Sed_column
 sed_column_set_sea_level(Sed_column c, double sl)
 {
-    c->sl = sl;
+    if (c->sl != sl) {
+        c->sl = sl;
+        sed_column_touch_keep_load(c);
+    }
+
     return c;
 }
 
 Sed_column
 sed_column_set_base_height(Sed_column c, double z)
 {
-    c->z = z;
+    if (c->z != z) {
+        c->z = z;
+        sed_column_touch_keep_load(c);
+    }
+
     return c;
 }
 
 Sed_column
 sed_column_adjust_base_height(Sed_column c, double dz)
 {
-    c->z += dz;
+    if (dz != 0.) {
+        c->z += dz;
+        sed_column_touch_keep_load(c);
+    }
+
     return c;
 }
 
@@ -573,6 +791,290 @@ sed_column_sediment_mass(const Sed_column s)
     return sum;
 }
 
+/** Cache the cumulative sediment load of the cells of columns.
+
+When enabled, each column keeps the cumulative sediment load of its cells,
+summed from the base of the column up.  The sums are only recomputed from the
+lowest cell that has changed since they were last used, so that the loads of
+a column that only gains or loses sediment at its top are found with work
+proportional to the number of cells that changed.  Functions of this file
+that change cells mark the cache as stale.  Code that changes the cells of a
+column in some other way (through sed_column_nth_cell, say) should call
+sed_column_invalidate_load.  The cache is only used while the stamp of the
+column is the one that it was made for, so a column that was changed and
+then only marked with sed_column_touch has all of its loads recomputed.
+
+@param enable TRUE to cache loads for all columns.
+
+@see sed_column_load , sed_column_load_cache_fprint
+*/
+void
+sed_column_set_load_cache(gboolean enable)
+{
+    __load_cache = enable;
+}
+
+/** Are the loads of columns cached?
+
+@return TRUE if loads are cached.
+*/
+gboolean
+sed_column_load_cache_is_enabled(void)
+{
+    return __load_cache;
+}
+
+/** Mark cells of a column as changed.
+
+The cached loads of the n-th cell of a column, and the cells above it, will
+be recomputed the next time that they are needed.
+
+@param c A pointer to a Sed_column.
+@param n Index of the lowest cell that has changed.
+*/
+void
+sed_column_invalidate_load(Sed_column c, gssize n)
+{
+    eh_require(c);
+
+    if (c) {
+        if (c->load_stamp != c->stamp) {
+            c->load_len = 0;
+        } else if (c->load_len > n) {
+            c->load_len = MAX(n, 0);
+        }
+
+        sed_column_touch(c);
+        c->load_stamp = c->stamp;
+    }
+}
+
+/** Mark a column as modified.
+
+Each column carries a stamp that is changed whenever the column is
+modified so that users of a column can tell if it has changed since they
+last looked at it.  Functions of this file that change a column update its
+stamp.  Code that changes the cells of a column in some other way (through
+sed_column_nth_cell, say) must call this function (or
+sed_column_invalidate_load, if they know which cells changed, or
+sed_column_touch_keep_load, if the sediment load did not change).  The
+cached loads of a touched column are all recomputed.
+
+Stamps are unique among all columns so that a new column never has the
+stamp of one that it replaces.
+
+@param c A pointer to a Sed_column.
+
+@see sed_column_stamp
+*/
+void
+sed_column_touch(Sed_column c)
+{
+    eh_require(c);
+
+    if (c) {
+        c->stamp = g_atomic_int_exchange_and_add(&__stamp, 1) + 1;
+    }
+}
+
+/** Mark a column as modified without changing the load of its sediment.
+
+Use this rather than sed_column_touch for changes that leave the sediment
+load of every cell as it was (porewater pressures, compaction, the base
+height or sea level of the column) so that the cached loads of the column
+are kept.
+
+@param c A pointer to a Sed_column.
+
+@see sed_column_touch, sed_column_invalidate_load
+*/
+void
+sed_column_touch_keep_load(Sed_column c)
+{
+    eh_require(c);
+
+    if (c) {
+        const gboolean load_is_valid = (c->load_stamp == c->stamp);
+
+        sed_column_touch(c);
+
+        if (load_is_valid) {
+            c->load_stamp = c->stamp;
+        }
+    }
+}
+
+/** The modification stamp of a column.
+
+@param c A pointer to a Sed_column.
+
+@return The current stamp of the column.
+
+@see sed_column_touch
+*/
+gint
+sed_column_stamp(const Sed_column c)
+{
+    eh_return_val_if_fail(c, 0);
+    return c->stamp;
+}
+
+/** Keep an account of the sediment of a column in a ledger.
+
+Sediment that is added to or removed from the column is posted to the
+ledger.  The sediment already in the column is moved from its old ledger
+(if any) to the new one.
+
+@param c A pointer to a Sed_column.
+@param l A Sed_mass_ledger (or NULL to stop keeping an account).
+
+@return The input Sed_column.
+
+@see sed_column_mass_ledger
+*/
+Sed_column
+sed_column_set_mass_ledger(Sed_column c, Sed_mass_ledger l)
+{
+    eh_require(c);
+
+    if (c && c->ledger != l) {
+        _sed_column_post_cells(c, -1.);
+        c->ledger = l;
+        _sed_column_post_cells(c, 1.);
+    }
+
+    return c;
+}
+
+/** The ledger that keeps an account of the sediment of a column.
+
+@param c A pointer to a Sed_column.
+
+@return The Sed_mass_ledger of the column, or NULL.
+*/
+Sed_mass_ledger
+sed_column_mass_ledger(const Sed_column c)
+{
+    eh_return_val_if_fail(c, NULL);
+    return c->ledger;
+}
+
+/** Print statistics of the load cache.
+
+The number of times that column loads were requested, the number of those
+requests that did not have to recompute any cell, and the number of cells
+that were recomputed.
+
+@param fp A FILE to print to.
+
+@return The number of bytes printed.
+*/
+gint
+sed_column_load_cache_fprint(FILE* fp)
+{
+    gint n = 0;
+
+    if (fp) {
+        gint calls = g_atomic_int_get(&__load_cache_calls);
+        gint hits  = g_atomic_int_get(&__load_cache_hits);
+        gint cells = g_atomic_int_get(&__load_cache_cells);
+
+        n += fprintf(fp, "Column load cache\n");
+        n += fprintf(fp, "  Requests         : %d\n", calls);
+        n += fprintf(fp, "  Hits             : %d\n", hits);
+        n += fprintf(fp, "  Cells recomputed : %d\n", cells);
+    }
+
+    return n;
+}
+
+/* The sediment load of each of the cells [start, end) of a contiguous column.
+
+This is sed_cell_sediment_load for each cell, but the grain fractions are
+read from the fraction matrix of the column and the grain properties are
+looked up once rather than once per cell.
+*/
+static void
+_sed_column_block_sediment_load(const Sed_column c, gssize start, gssize end,
+    double* load)
+{
+    const gssize n_grains = sed_sediment_env_n_types();
+    const double* f       = sed_column_fraction_data(c) + start * n_grains;
+    double*       rho     = sed_sediment_property(NULL, &sed_type_rho_grain);
+    double*       e_0     = sed_sediment_property(NULL, &sed_type_void_ratio);
+    const double  g       = sed_gravity();
+    gssize i, n;
+
+    for (i = start ; i < end ; i++, f += n_grains) {
+        const double t = sed_cell_size(c->cell[i]);
+        double rho_grain = 0.;
+        double e = 0.;
+
+        for (n = 0 ; n < n_grains ; n++) {
+            rho_grain += f[n] * rho[n];
+            e         += f[n] * e_0[n];
+        }
+
+        // The void ratio of the cell, as in sed_cell_void_ratio.
+        e = (t / sed_cell_size_0(c->cell[i])) * (1. + e) - 1.;
+
+        load[i - start] = rho_grain * (t / (e + 1)) * g;
+    }
+
+    eh_free(e_0);
+    eh_free(rho);
+}
+
+/* Bring the cumulative load of a column up to date.
+
+The returned array has sed_column_len(c)+1 elements.  The i-th element is
+the sediment load of the cells below the i-th cell so that the last element
+is the load of the whole column.
+*/
+static const double*
+_sed_column_load_sum(Sed_column c)
+{
+    gssize i;
+
+    if (c->load_size < c->len + 1) {
+        c->load_size = c->len + 1 + S_ADDBINS;
+        c->load      = eh_renew(double, c->load, c->load_size);
+    }
+
+    if (c->load_stamp != c->stamp) {
+        c->load_len = 0;
+    }
+
+    if (c->load_len == 0) {
+        c->load[0] = 0.;
+    }
+
+    g_atomic_int_inc(&__load_cache_calls);
+
+    if (c->load_len >= c->len) {
+        g_atomic_int_inc(&__load_cache_hits);
+    } else {
+        g_atomic_int_add(&__load_cache_cells, c->len - c->load_len);
+    }
+
+    if (c->block) {
+        _sed_column_block_sediment_load(c, c->load_len, c->len, c->load + c->load_len + 1);
+
+        for (i = c->load_len ; i < c->len ; i++) {
+            c->load[i + 1] += c->load[i];
+        }
+    } else {
+        for (i = c->load_len ; i < c->len ; i++) {
+            c->load[i + 1] = c->load[i] + sed_cell_sediment_load(c->cell[i]);
+        }
+    }
+
+    c->load_len   = c->len;
+    c->load_stamp = c->stamp;
+
+    return c->load;
+}
+
 /** Get the total load felt by each cell of sediment in a Sed_column.
 
 Get the load felt by each cell of sediment due to its overlying cells.
@@ -619,17 +1121,48 @@ sed_column_total_load(const Sed_column s,
             load = eh_new0(double, n_bins);
         }
 
-        for (i = col_len - 1 ; i >= start + n_bins - 1 ; i--) {
-            load0 += sed_cell_sediment_load(s->cell[i]);
-        }
+        if (__load_cache) {
+            // the load on a cell is the load of the whole column less the load
+            // of the cells below it.
+            const double* sum = _sed_column_load_sum(s);
 
-        load0 += overlying_load;
+            load0 = sum[col_len] + overlying_load;
 
-        // calculate the overlying load on each of the cells.
-        load[n_bins - 1] = load0;
+            for (i = 0 ; i < n_bins ; i++) {
+                load[i] = load0 - sum[i + start];
+            }
+        } else if (s->block) {
+            // cell_load[i] is the load of the (start+i)-th cell.
+            double* cell_load = eh_new(double, MAX(col_len - start, 1));
 
-        for (i = n_bins - 2 ; i >= 0 ; i--) {
-            load[i] = load[i + 1] + sed_cell_sediment_load(s->cell[i + start]);
+            _sed_column_block_sediment_load(s, start, col_len, cell_load);
+
+            for (i = col_len - 1 ; i >= start + n_bins - 1 ; i--) {
+                load0 += cell_load[i - start];
+            }
+
+            load0 += overlying_load;
+
+            load[n_bins - 1] = load0;
+
+            for (i = n_bins - 2 ; i >= 0 ; i--) {
+                load[i] = load[i + 1] + cell_load[i];
+            }
+
+            eh_free(cell_load);
+        } else {
+            for (i = col_len - 1 ; i >= start + n_bins - 1 ; i--) {
+                load0 += sed_cell_sediment_load(s->cell[i]);
+            }
+
+            load0 += overlying_load;
+
+            // calculate the overlying load on each of the cells.
+            load[n_bins - 1] = load0;
+
+            for (i = n_bins - 2 ; i >= 0 ; i--) {
+                load[i] = load[i + 1] + sed_cell_sediment_load(s->cell[i + start]);
+            }
         }
     } else {
         load = NULL;
@@ -1120,8 +1653,17 @@ sed_column_resize_cell(Sed_column s, gssize i, double new_t)
 
         eh_lower_bound(new_t, 0);
 
-        sed_cell_resize(s->cell[i], new_t);
+        // The sediment mass of a cell is proportional to its thickness.
+        if (old_t > 0) {
+            sed_mass_ledger_post_cell(s->ledger, s->cell[i], new_t / old_t - 1.);
+            sed_cell_resize(s->cell[i], new_t);
+        } else {
+            sed_cell_resize(s->cell[i], new_t);
+            sed_mass_ledger_post_cell(s->ledger, s->cell[i], 1.);
+        }
+
         sed_column_set_thickness(s, sed_column_thickness(s) + new_t - old_t);
+        sed_column_invalidate_load(s, i);
     }
 
     return s;
@@ -1149,8 +1691,13 @@ sed_column_compact_cell(Sed_column s, gssize i, double new_t)
 
     if (s && sed_column_is_get_index(s, i)) {
         double old_t = sed_cell_size(s->cell[i]);
+
+        // Compaction removes water, not sediment, so the cached loads (and
+        // the ledger) are still good.
         sed_cell_compact(s->cell[i], new_t);
         sed_column_set_thickness(s, sed_column_thickness(s) + new_t - old_t);
+
+        sed_column_touch_keep_load(s);
     }
 
     return s;
@@ -1190,6 +1737,10 @@ sed_column_add_cell_real(Sed_column col,
         amount_to_add = sed_cell_size(cell);
         left_to_add   = sed_cell_size(cell);
 
+        sed_mass_ledger_post_cell(col->ledger, cell, 1.);
+
+        sed_column_invalidate_load(col, col->len - 1);
+
         if (update_pressure) {
             gssize i;
             gssize len = sed_column_len(col);
@@ -1340,6 +1891,8 @@ sed_column_top_cell(const Sed_column col)
 /** Get the n-th cell from a column.
 
 Get a pointer to the Sed_cell that is n cells from the bottom of a Sed_column.
+If the contents of the cell are changed, call sed_column_invalidate_load so
+that the column's cached loads are recomputed.
 
 @param col A pointer to a Sed_column.
 @param n   The index of the cell.
@@ -1380,7 +1933,20 @@ sed_column_resize(Sed_column col, gssize n)
     {
         gssize i;
 
-        if (n > col->size) {
+        if (n > col->size && col->block) {
+            // Grow contiguous columns geometrically since the block of cells
+            // is moved each time that it grows.
+            gssize new_size = MAX(2 * col->size, n + S_ADDBINS);
+
+            col->block = sed_cell_block_resize(col->block, col->size, new_size);
+            col->cell  = eh_renew(Sed_cell, col->cell, new_size);
+
+            for (i = 0 ; i < new_size ; i++) {
+                col->cell[i] = sed_cell_block_nth(col->block, i);
+            }
+
+            col->size = new_size;
+        } else if (n > col->size) {
             // Add bins in blocks of S_ADDBINS
             gssize add_bins = ((n - col->size) / S_ADDBINS + 1) * S_ADDBINS;
             gssize new_size = col->size + add_bins;
@@ -1400,6 +1966,8 @@ sed_column_resize(Sed_column col, gssize n)
             for (i = n ; i < col->size ; i++) {
                 sed_cell_clear(col->cell[i]);
             }
+
+            sed_column_invalidate_load(col, n);
         }
     }
 
@@ -1467,12 +2035,17 @@ sed_column_remove_top_cell(Sed_column col, double f)
 
     if (col && !sed_column_is_empty(col)) {
         Sed_cell top_cell = sed_column_top_cell(col);
+
+        sed_mass_ledger_post_cell(col->ledger, top_cell, -f);
+
+        sed_column_invalidate_load(col, col->len - 1);
         sed_column_set_thickness(col,
             sed_column_thickness(col)
             - f * sed_cell_size(top_cell));
         sed_cell_resize(top_cell, sed_cell_size(top_cell) * (1. - f));
 
         if (sed_cell_size(top_cell) < 1e-12) {
+            sed_mass_ledger_post_cell(col->ledger, top_cell, -1.);
             sed_cell_clear(top_cell);
             (col->len)--;
 
@@ -1638,6 +2211,7 @@ sed_column_remove_top_erode(Sed_column col, double t)
 
         if (erode > 0) {
             col->z -= erode;
+            sed_column_touch_keep_load(col);
         }
     }
 
@@ -2048,6 +2622,16 @@ sed_column_read(FILE* fp)
 
         NEW_OBJECT(Sed_column, s);
 
+        s->block     = NULL;
+        s->load      = NULL;
+        s->load_len  = 0;
+        s->load_size = 0;
+        s->load_stamp = 0;
+
+        s->ledger    = NULL;
+
+        sed_column_touch(s);
+
         fread(&(s->z), sizeof(double), 1, fp);
         fread(&(s->t), sizeof(double), 1, fp);
         fread(&(len), sizeof(gint32), 1, fp);
@@ -2071,6 +2655,115 @@ sed_column_read(FILE* fp)
     return s;
 }
 
+/** The number of doubles needed to hold the record of a column.
+
+\param c        A pointer to a Sed_column.
+\param n_grains The number of grain types of each cell.
+
+\return The length of the record written by sed_column_to_record.
+*/
+gssize
+sed_column_record_len(const Sed_column c, gssize n_grains)
+{
+    eh_return_val_if_fail(c, 0);
+    return SED_COLUMN_RECORD_HEADER_LEN + c->len * SED_CELL_RECORD_LEN(n_grains);
+}
+
+/** Copy a Sed_column into a flat record of doubles.
+
+The record begins with the base height, thickness, cell height, position,
+age, sea level, and number of cells of the column, followed by a record
+(see sed_cell_to_record) for each of its filled cells.  Only filled cells are
+written.
+
+\param c        A pointer to a Sed_column.
+\param rec      Location for the record (or NULL).
+\param n_grains The number of grain types of each cell.
+
+\return The record.  If \a rec is NULL, a newly-allocated record that should
+        be freed with eh_free.
+*/
+double*
+sed_column_to_record(const Sed_column c, double* rec, gssize n_grains)
+{
+    eh_require(c);
+
+    if (!rec) {
+        rec = eh_new(double, sed_column_record_len(c, n_grains));
+    }
+
+    {
+        gssize i;
+        double* cell_rec = rec + SED_COLUMN_RECORD_HEADER_LEN;
+
+        rec[0] = c->z;
+        rec[1] = c->t;
+        rec[2] = c->dz;
+        rec[3] = c->x;
+        rec[4] = c->y;
+        rec[5] = c->age;
+        rec[6] = c->sl;
+        rec[7] = c->len;
+
+        for (i = 0 ; i < c->len ; i++, cell_rec += SED_CELL_RECORD_LEN(n_grains)) {
+            sed_cell_to_record(c->cell[i], cell_rec);
+        }
+    }
+
+    return rec;
+}
+
+/** Copy a record that was written with sed_column_to_record into a Sed_column.
+
+Any sediment in the destination column is replaced with the sediment of the
+record.  The cells of the record are read in place, so \a rec can point into
+a memory-mapped file.
+
+\param c        A pointer to a Sed_column (or NULL).
+\param rec      A column record.
+\param n_grains The number of grain types of each cell.
+
+\return The Sed_column.  If \a c is NULL, a newly-created Sed_column.
+*/
+Sed_column
+sed_column_from_record(Sed_column c, const double* rec, gssize n_grains)
+{
+    eh_require(rec);
+
+    if (!c) {
+        c = sed_column_new((gssize)rec[7] + 1);
+    }
+
+    {
+        const gssize len = (gssize)rec[7];
+        const double* cell_rec = rec + SED_COLUMN_RECORD_HEADER_LEN;
+        gssize i;
+
+        sed_column_clear(c);
+        sed_column_resize(c, len);
+
+        for (i = 0 ; i < len ; i++, cell_rec += SED_CELL_RECORD_LEN(n_grains)) {
+            sed_cell_from_record(c->cell[i], cell_rec, n_grains);
+        }
+
+        c->z   = rec[0];
+        c->t   = rec[1];
+        c->dz  = rec[2];
+        c->x   = rec[3];
+        c->y   = rec[4];
+        c->age = rec[5];
+        c->sl  = rec[6];
+        c->len = len;
+
+        _sed_column_post_cells(c, 1.);
+
+        sed_column_invalidate_load(c, 0);
+        sed_column_touch(c);
+    }
+
+    return c;
+}
+
 /** Get a column from a portion of another.
 
 Get a portion of one column from another.  The copy begins at an elevation,
@@ -2117,6 +2810,7 @@ sed_column_height_copy(const Sed_column src,
             if (dh > 0) {
                 sed_column_stack_cell(dest, src->cell[start]);
                 sed_cell_resize(dest->cell[0], dh);
+                sed_column_invalidate_load(dest, 0);
             }
 
             // Add the cells to be extracted.
@@ -2592,6 +3286,15 @@ sed_column_rebin(Sed_column col)
     return col;
 }
 
+/** Remove the top cell of a Sed_column.
+
+The caller owns the returned cell and should free it with sed_cell_destroy.
+For a contiguous column the cell is a copy of the top cell of the block.
+
+@param col A pointer to a Sed_column.
+
+@return The top cell of the column, or NULL if the column is empty.
+*/
 Sed_cell
 sed_column_extract_top_cell_loc(Sed_column col)
 {
@@ -2602,7 +3305,15 @@ sed_column_extract_top_cell_loc(Sed_column col)
     if (col && !sed_column_is_empty(col)) {
         gint n = sed_column_len(col) - 1;
 
-        c = col->cell[n];
+        if (col->block) {
+            c = sed_cell_dup(col->cell[n]);
+            sed_cell_clear(col->cell[n]);
+        } else {
+            c            = col->cell[n];
+            col->cell[n] = sed_cell_new_env();
+        }
+
+        sed_mass_ledger_post_cell(col->ledger, c, -1.);
 
         sed_column_set_thickness(col, sed_column_thickness(col) - sed_cell_size(c));
 
@@ -2701,8 +3412,16 @@ sed_column_extract_top_n_cells(Sed_column col, gint n_cells)
 
             for (i = 0, n = n_0 ; i < n_cells ; i++, n++) {
                 dz           += sed_cell_size(col->cell[n]);
-                cell_arr[i]   = col->cell[n];
-                col->cell[n]  = sed_cell_new_env();
+
+                sed_mass_ledger_post_cell(col->ledger, col->cell[n], -1.);
+
+                if (col->block) {
+                    cell_arr[i] = sed_cell_dup(col->cell[n]);
+                    sed_cell_clear(col->cell[n]);
+                } else {
+                    cell_arr[i]   = col->cell[n];
+                    col->cell[n]  = sed_cell_new_env();
+                }
             }
 
             sed_column_set_thickness(col, sed_column_thickness(col) - dz);
@@ -2772,7 +3491,9 @@ sed_column_stack_cell_real(Sed_column col, Sed_cell cell, gboolean update_pressu
         amount_to_add = sed_cell_size(cell);
 
         sed_column_resize(col, col->len + 1);
+        sed_column_invalidate_load(col, col->len);
         sed_cell_copy(col->cell[col->len], cell);
+        sed_mass_ledger_post_cell(col->ledger, cell, 1.);
         col->len += 1;
 
         sed_column_set_thickness(col, sed_column_thickness(col) + sed_cell_size(cell));
@@ -2813,10 +3534,21 @@ sed_column_stack_cell_loc_real(Sed_column col, Sed_cell cell, gboolean update_pr
         amount_to_add = sed_cell_size(cell);
 
         sed_column_resize(col, col->len + 1);
+        sed_column_invalidate_load(col, col->len);
+
+        if (col->block) {
+            // The cells of a contiguous column can not be replaced so take the
+            // contents of the cell instead.
+            sed_cell_copy(col->cell[col->len], cell);
+            sed_cell_destroy(cell);
+            cell = col->cell[col->len];
+        } else {
+            sed_cell_destroy(col->cell[col->len]);
+            col->cell[col->len] = cell;
+        }
 
-        sed_cell_destroy(col->cell[col->len]);
+        sed_mass_ledger_post_cell(col->ledger, cell, 1.);
 
-        col->cell[col->len] = cell;
         col->len += 1;
 
         sed_column_set_thickness(col, sed_column_thickness(col) + sed_cell_size(cell));
@@ -45,6 +45,7 @@ G_BEGIN_DECLS
 
 #include "sed_sediment.h"
 #include "sed_cell.h"
+#include "sed_mass_ledger.h"
 
 /** Sed_column
 
@@ -82,9 +83,24 @@ we'll need another coordinate.
 */
 new_handle(Sed_column);
 
+/** The ways that the Sed_cell's of a Sed_column can be stored.
+*/
+typedef enum {
+    SED_COLUMN_STORAGE_CELLS = 0, ///< Each cell is allocated separately
+    SED_COLUMN_STORAGE_CONTIGUOUS ///< The cells are held in one block
+}
+Sed_column_storage;
+
+void
+sed_column_set_default_storage(Sed_column_storage storage);
+Sed_column_storage
+sed_column_default_storage(void);
+
 Sed_column
 sed_column_new(gssize n);
 Sed_column
+sed_column_new_with_storage(gssize n, Sed_column_storage storage);
+Sed_column
 sed_column_new_filled(double t, Sed_size_class size);
 Sed_column
 sed_column_destroy(Sed_column c);
@@ -103,6 +119,16 @@ sed_column_copy_public_data(Sed_column d, const Sed_column s);
 Sed_column
 sed_column_dup(const Sed_column s);
 
+Sed_column_storage
+sed_column_storage(const Sed_column col);
+gboolean
+sed_column_is_contiguous(const Sed_column col);
+double*
+sed_column_fraction_data(const Sed_column col);
+double*
+sed_column_thickness_array(const Sed_column col, gssize start, gssize n_bins,
+    double* t);
+
 double*
 sed_column_cell_fraction(const Sed_column col, gint i);
 
@@ -110,6 +136,24 @@ double
 sed_column_mass(const Sed_column c);
 double
 sed_column_sediment_mass(const Sed_column c);
+void
+sed_column_set_load_cache(gboolean enable);
+gboolean
+sed_column_load_cache_is_enabled(void);
+void
+sed_column_invalidate_load(Sed_column c, gssize n);
+void
+sed_column_touch(Sed_column c);
+void
+sed_column_touch_keep_load(Sed_column c);
+gint
+sed_column_stamp(const Sed_column c);
+gint
+sed_column_load_cache_fprint(FILE* fp);
+Sed_column
+sed_column_set_mass_ledger(Sed_column c, Sed_mass_ledger l);
+Sed_mass_ledger
+sed_column_mass_ledger(const Sed_column c);
 double*
 sed_column_total_load(const Sed_column c,
     gssize start,
@@ -232,6 +276,16 @@ sed_column_write_to_byte_order(FILE* fp, const Sed_column s, gint order);
 Sed_column
 sed_column_read(FILE* fp);
 
+/** Number of doubles in the header of a column record */
+#define SED_COLUMN_RECORD_HEADER_LEN (8)
+
+gssize
+sed_column_record_len(const Sed_column c, gssize n_grains);
+double*
+sed_column_to_record(const Sed_column c, double* rec, gssize n_grains);
+Sed_column
+sed_column_from_record(Sed_column c, const double* rec, gssize n_grains);
+
 Sed_column
 sed_column_height_copy(const Sed_column, double, Sed_column);
 
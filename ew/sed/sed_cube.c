@@ -22,6 +22,7 @@
 
 #include "utils/utils.h"
 #include "sed_cube.h"
+#include "sed_profile.h"
 
 CLASS(Sed_cube)
 {
@@ -45,13 +46,19 @@ CLASS(Sed_cube)
     double dy; //< The spacing of the columns in the y-direction
     double sea_level; //< The current height of sea level.
     GList* river; //< Information for each of the river mouths.
-    GList* shore; //< A doubly liked list that defines the shore line.
+    gint* shore; //< Ids of the columns that make up the shore line.
+    gssize shore_len; //< The number of columns in the shore line.
+    guint8* shore_flags; //< Wet, shore, and visited flags for each column.
+    gint* shore_stamps; //< Column stamps when the shore flags were updated.
+    double shore_sea_level; //< Sea level when the shore flags were updated.
     double cell_height; //< Height of a cell of sediment.
     Sed_constants constants; //< The physical constants for the profile (g, rho_w, etc)
 
     double** discharge; //< Water discharge at each column
     double** bed_load_flux; //< Bed load flux at each column
     Sed_hydro external_river; //< River to be set by an external source
+    Sed_mass_ledger ledger; //< Account of the sediment in the columns (or NULL)
+    gboolean keeps_ledger; //< The cube owns its columns and so keeps a ledger
 };
 
 GQuark
@@ -105,6 +112,12 @@ sed_mode_is_3d(void)
     return __sedflux_mode == SEDFLUX_MODE_3D;
 }
 
+/* Flags kept for each column of a cube by the shoreline engine.
+*/
+#define SED_SHORE_WET     (1<<0)
+#define SED_SHORE_LAND    (1<<1)
+#define SED_SHORE_VISITED (1<<2)
+
 #define DEFAULT_BINS (16)
 
 Sed_cube
@@ -117,6 +130,10 @@ sed_cube_new(gssize n_x, gssize n_y)
     if (s) {
         gint i, j;
 
+        // the ledger is made when it is first asked for, as the sediment
+        // environment may not be set yet.
+        s->keeps_ledger = TRUE;
+
         for (i = 0; i < n_x; i++)
             for (j = 0; j < n_y; j++) {
                 s->col[i][j] = sed_column_new(DEFAULT_BINS);
@@ -174,10 +191,16 @@ sed_cube_new_empty(gssize n_x, gssize n_y)
     s->n_y          = n_y;
     s->river        = NULL;
     s->shore        = NULL;
+    s->shore_len    = 0;
+    s->shore_flags  = NULL;
+    s->shore_stamps = NULL;
+    s->shore_sea_level = 0.;
 
     s->discharge    = eh_new_2(double, n_x, n_y);
     s->bed_load_flux = eh_new_2(double, n_x, n_y);
     s->external_river = NULL;
+    s->ledger = NULL;
+    s->keeps_ledger = FALSE;
 
     return s;
 }
@@ -342,6 +365,7 @@ sed_cube_free(Sed_cube s, gboolean free_data)
         eh_free_2(s->discharge);
         eh_free_2(s->bed_load_flux);
         sed_hydro_destroy(s->external_river);
+        sed_mass_ledger_destroy(s->ledger);
 
         sed_cube_remove_all_trunks(s);
 
@@ -350,7 +374,9 @@ sed_cube_free(Sed_cube s, gboolean free_data)
 
         sed_cube_destroy_storm_list(s);
 
-        g_list_free(s->shore);
+        eh_free(s->shore);
+        eh_free(s->shore_flags);
+        eh_free(s->shore_stamps);
 
         g_free(s->name);
         eh_free(s);
@@ -908,16 +934,16 @@ sed_cube_shore_mask(const Sed_cube s)
     eh_require(s);
 
     {
-        gint i, j, id;
-        const gint nx = sed_cube_n_x(s);
-        const gint ny = sed_cube_n_y(s);
+        const gssize len = sed_cube_size(s);
+        gssize id;
 
-        mask = eh_new(gboolean, s->n_x * s->n_y);
+        sed_cube_set_shore(s);
 
-        for (i = 0, id = 0 ; i < nx ; i++)
-            for (j = 0 ; j < ny ; j++, id++) {
-                mask[id] = is_shore_cell(s, i, j);
-            }
+        mask = eh_new(gboolean, len);
+
+        for (id = 0 ; id < len ; id++) {
+            mask[id] = (s->shore_flags[id] & SED_SHORE_LAND) != 0;
+        }
     }
 
     return mask;
@@ -926,24 +952,24 @@ sed_cube_shore_mask(const Sed_cube s)
 gint*
 sed_cube_shore_ids(const Sed_cube s)
 {
-    gboolean* ids = NULL;
+    gint* ids = NULL;
 
     eh_require(s);
 
     {
-        gint i, j;
+        const gssize len = sed_cube_size(s);
         gint shore_count = 0;
-        const gint nx = sed_cube_n_x(s);
-        const gint ny = sed_cube_n_y(s);
+        gssize id;
 
-        ids = eh_new(gint, sed_cube_size(s) + 1);
+        sed_cube_set_shore(s);
 
-        for (i = 0 ; i < nx; i++)
-            for (j = 0 ; j < ny; j++)
-                if (is_shore_cell(s, i, j)) {
-                    ids[shore_count] = sed_cube_id(s, i, j);
-                    shore_count++;
-                }
+        ids = eh_new(gint, len + 1);
+
+        for (id = 0 ; id < len ; id++)
+            if (s->shore_flags[id] & SED_SHORE_LAND) {
+                ids[shore_count] = id;
+                shore_count++;
+            }
 
         ids[shore_count] = -1;
     }
@@ -1677,6 +1703,95 @@ sed_cube_sediment_mass(const Sed_cube p)
     return mass;
 }
 
+/** The ledger that keeps an account of the sediment in a cube
+
+Only cubes that own their columns keep a ledger.  Cubes that share the
+columns of another cube (see sed_cube_cols) have none, but sediment that
+is added to their columns is posted to the ledger of the owner.
+
+The ledger is made (from the sediment already in the columns) the first
+time it is asked for, once the sediment environment has been set.
+
+\param p A Sed_cube
+
+\return The Sed_mass_ledger of the cube, or NULL.
+*/
+Sed_mass_ledger
+sed_cube_mass_ledger(const Sed_cube p)
+{
+    eh_return_val_if_fail(p, NULL);
+
+    if (!p->ledger && p->keeps_ledger && sed_sediment_env_is_set()) {
+        gint i;
+        gint len = sed_cube_size(p);
+
+        p->ledger = sed_mass_ledger_new(sed_sediment_env_n_types());
+
+        for (i = 0 ; i < len ; i++) {
+            sed_column_set_mass_ledger(sed_cube_col(p, i), p->ledger);
+        }
+    }
+
+    return p->ledger;
+}
+
+/** The mass of sediment in a cube from its ledger
+
+This is the same as sed_cube_sediment_mass but does not visit the cells of
+the cube.  Cubes without a ledger are scanned.
+
+\param p A Sed_cube
+
+\return The mass of sediment grains (kg) in the cube.
+*/
+double
+sed_cube_ledger_mass(const Sed_cube p)
+{
+    double mass = 0.;
+    Sed_mass_ledger ledger = (p) ? sed_cube_mass_ledger(p) : NULL;
+
+    if (ledger) {
+        mass = sed_mass_ledger_mass(ledger) * sed_cube_x_res(p) * sed_cube_y_res(p);
+    } else if (p) {
+        mass = sed_cube_sediment_mass(p);
+    }
+
+    return mass;
+}
+
+/** The mass of sediment grains (kg) held in suspension by the rivers of a cube */
+double
+sed_cube_sediment_mass_in_suspension(const Sed_cube p)
+{
+    double mass = 0.;
+
+    if (p) {
+        Sed_riv* all_rivers = sed_cube_all_branches(p);
+
+        if (all_rivers) {
+            Sed_riv* r;
+
+            for (r = all_rivers ; *r ; r++) {
+                Sed_cell_grid in_susp = (Sed_cell_grid)g_dataset_id_get_data(*r,
+                        SED_CUBE_SUSP_GRID);
+                const gssize n_i = eh_grid_n_el(in_susp);
+                Sed_cell* c = (Sed_cell*)eh_grid_data_start(in_susp);
+                gssize i;
+
+                for (i = 0 ; i < n_i ; i++) {
+                    mass += sed_cell_sediment_mass(c[i]);
+                }
+            }
+
+            eh_free(all_rivers);
+        }
+
+        mass *= sed_cube_x_res(p) * sed_cube_y_res(p);
+    }
+
+    return mass;
+}
+
 double
 sed_cube_mass_in_suspension(const Sed_cube p)
 {
@@ -2429,107 +2544,342 @@ Sed_cube sed_cube_add_river( Sed_cube s , Sed_river *river )
 }
 */
 
-void
-sed_cube_set_shore(Sed_cube s)
+/* Is the column at i, j a land column that borders an ocean column?  This is
+   is_shore_cell, but using the wet bits of the shore flags rather than the
+   columns themselves.
+*/
+static gboolean
+_sed_cube_shore_flag_is_shore(const Sed_cube s, gint i, gint j)
 {
-    int i;
-    Eh_ind_2* pos;
-    GList* shore_list = NULL;
-    GList* list;
+    const guint8* f = s->shore_flags;
 
-    g_list_free(s->shore);
-    s->shore = NULL;
+    if (f[i * s->n_y + j] & SED_SHORE_WET) {
+        return FALSE;
+    } else {
+        const gint west  = MAX(j - 1, 0);
+        const gint east  = MIN(j + 1, s->n_y - 1);
+        const gint north = MAX(i - 1, 0);
+        const gint south = MIN(i + 1, s->n_x - 1);
 
-    //---
-    // Look for the shoreline along the first and last rows, then along the
-    // first and last columns.  If there are no shore cells along the boundaries
-    // then look in the interior.
-    //---
-    if ((pos = sed_cube_find_shore(s, 0, VARY_COLS))
-        || (pos = sed_cube_find_shore(s, s->n_x - 1, VARY_COLS))
-        || (pos = sed_cube_find_shore(s, 0, VARY_ROWS))
-        || (pos = sed_cube_find_shore(s, s->n_y - 1, VARY_ROWS))) {
-        shore_list = sed_cube_find_shore_line(s, pos);
+        return (f[i * s->n_y + west] & SED_SHORE_WET)
+            || (f[i * s->n_y + east] & SED_SHORE_WET)
+            || (f[north * s->n_y + j] & SED_SHORE_WET)
+            || (f[south * s->n_y + j] & SED_SHORE_WET);
+    }
+}
+
+/* Set the shore bit of a column from the wet bits of its neighbours.  Return
+   TRUE if the column joined or left the shore.
+*/
+static gboolean
+_sed_cube_shore_flag_update(Sed_cube s, gint i, gint j)
+{
+    guint8* f = s->shore_flags + i * s->n_y + j;
+    const guint8 old = *f;
+
+    if (_sed_cube_shore_flag_is_shore(s, i, j)) {
+        *f |= SED_SHORE_LAND;
     } else {
-        for (i = 1 ; pos == NULL && i < s->n_x - 1 ; i++) {
-            pos = sed_cube_find_shore(s, i, VARY_COLS);
+        *f &= ~SED_SHORE_LAND;
+    }
+
+    return *f != old;
+}
+
+/* Bring the shore flags of a cube up to date.  The wet bit of a column is
+   only recomputed if the column was modified (as recorded by its stamp) or
+   sea level moved.  Only columns whose wet bit flipped, and their
+   neighbours, are then checked for shore membership.  Return the number of
+   columns that joined or left the shore.
+*/
+static gssize
+_sed_cube_shore_flags_refresh(Sed_cube s)
+{
+    const gssize len = sed_cube_size(s);
+    gssize n_changed = 0;
+    gssize id;
+
+    if (len == 0) {
+        return 0;
+    }
+
+    if (!s->shore_flags || s->shore_sea_level != s->sea_level) {
+        if (!s->shore_flags) {
+            s->shore_flags = eh_new0(guint8, len);
         }
 
-        if (!pos) {
-            eh_message("There are no shore cells in the domain");
-        } else {
-            shore_list = sed_cube_find_shore_line(s, pos);
+        s->shore_stamps    = sed_cube_stamps(s, s->shore_stamps);
+        s->shore_sea_level = s->sea_level;
+
+        for (id = 0 ; id < len ; id++) {
+            if (sed_column_is_below(s->col[0][id], s->sea_level)) {
+                s->shore_flags[id] |= SED_SHORE_WET;
+            } else {
+                s->shore_flags[id] &= ~SED_SHORE_WET;
+            }
+        }
+
+        {
+            gint i, j;
+
+            for (i = 0 ; i < s->n_x ; i++)
+                for (j = 0 ; j < s->n_y ; j++) {
+                    n_changed += _sed_cube_shore_flag_update(s, i, j);
+                }
+        }
+    } else {
+        gint* flipped = NULL;
+        gssize n_flipped = 0;
+        gssize n;
+
+        for (id = 0 ; id < len ; id++)
+            if (sed_cube_col_is_dirty(s, id, s->shore_stamps[id])) {
+                const gboolean is_wet = sed_column_is_below(s->col[0][id],
+                        s->sea_level);
+
+                s->shore_stamps[id] = sed_cube_col_stamp(s, id);
+
+                if (is_wet ^ ((s->shore_flags[id] & SED_SHORE_WET) != 0)) {
+                    s->shore_flags[id] ^= SED_SHORE_WET;
+
+                    if (!flipped) {
+                        flipped = eh_new(gint, len);
+                    }
+
+                    flipped[n_flipped++] = id;
+                }
+            }
+
+        for (n = 0 ; n < n_flipped ; n++) {
+            const gint i = flipped[n] / s->n_y;
+            const gint j = flipped[n] % s->n_y;
+
+            n_changed += _sed_cube_shore_flag_update(s, i, j);
+
+            if (i > 0) {
+                n_changed += _sed_cube_shore_flag_update(s, i - 1, j);
+            }
+
+            if (i < s->n_x - 1) {
+                n_changed += _sed_cube_shore_flag_update(s, i + 1, j);
+            }
+
+            if (j > 0) {
+                n_changed += _sed_cube_shore_flag_update(s, i, j - 1);
+            }
+
+            if (j < s->n_y - 1) {
+                n_changed += _sed_cube_shore_flag_update(s, i, j + 1);
+            }
         }
+
+        eh_free(flipped);
     }
 
-    g_free(pos);
+    return n_changed;
+}
+
+/* Trace the shore line that passes through column id.  Shore columns that
+   touch (including along a diagonal) are followed with an explicit stack;
+   visited columns are marked in the shore flags so that each column is
+   looked at once.  The ids of the traced columns are written to line (which
+   must be large enough to hold every shore column) and the number of columns
+   is returned.
+*/
+static gssize
+_sed_cube_trace_shore(Sed_cube s, gint id, gint* line)
+{
+    const gint di[8] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+    const gint dj[8] = { -1, -1, -1, 0, 0, 1, 1, 1 };
+    guint8* f = s->shore_flags;
+    gint* stack;
+    gssize top = 0;
+    gssize len = 0;
+    gssize n;
+
+    if (!(f[id] & SED_SHORE_LAND)) {
+        return 0;
+    }
+
+    stack = eh_new(gint, sed_cube_size(s));
+
+    f[id] |= SED_SHORE_VISITED;
+    stack[top++] = id;
+
+    while (top > 0) {
+        const gint this_id = stack[--top];
+        const gint i = this_id / s->n_y;
+        const gint j = this_id % s->n_y;
+        gint k;
+
+        line[len++] = this_id;
+
+        for (k = 7 ; k >= 0 ; k--) {
+            const gint next_i = i + di[k];
+            const gint next_j = j + dj[k];
+
+            if (next_i >= 0 && next_i < s->n_x && next_j >= 0 && next_j < s->n_y) {
+                const gint next_id = next_i * s->n_y + next_j;
 
-    for (list = shore_list ; list ; list = list->next) {
-        fprintf(stderr, "shore : %d , %d\n",
-            ((Eh_ind_2*)(list->data))->i,
-            ((Eh_ind_2*)(list->data))->j);
+                if ((f[next_id] & (SED_SHORE_LAND | SED_SHORE_VISITED))
+                    == SED_SHORE_LAND) {
+                    f[next_id] |= SED_SHORE_VISITED;
+                    stack[top++] = next_id;
+                }
+            }
+        }
+    }
+
+    for (n = 0 ; n < len ; n++) {
+        f[line[n]] &= ~SED_SHORE_VISITED;
     }
 
-    s->shore = shore_list;
+    eh_free(stack);
+
+    return len;
 }
 
-GList*
-sed_cube_find_shore_line(Sed_cube s, Eh_ind_2* pos)
+/* Find the first shore column along the edges of a cube.  If there are no
+   shore columns along the edges, look in the interior.  Return -1 if there
+   are no shore columns.
+*/
+static gint
+_sed_cube_shore_start(const Sed_cube s)
 {
-    return sed_find_next_shore(NULL, s, pos, g_list_prepend(NULL, pos));
+    const guint8* f = s->shore_flags;
+    gint i, j;
+
+    for (j = 0 ; j < s->n_y ; j++)
+        if (f[j] & SED_SHORE_LAND) {
+            return j;
+        }
+
+    for (j = 0 ; j < s->n_y ; j++)
+        if (f[(s->n_x - 1) * s->n_y + j] & SED_SHORE_LAND) {
+            return (s->n_x - 1) * s->n_y + j;
+        }
+
+    for (i = 0 ; i < s->n_x ; i++)
+        if (f[i * s->n_y] & SED_SHORE_LAND) {
+            return i * s->n_y;
+        }
+
+    for (i = 0 ; i < s->n_x ; i++)
+        if (f[i * s->n_y + s->n_y - 1] & SED_SHORE_LAND) {
+            return i * s->n_y + s->n_y - 1;
+        }
+
+    for (i = 0 ; i < sed_cube_size(s) ; i++)
+        if (f[i] & SED_SHORE_LAND) {
+            return i;
+        }
+
+    return -1;
 }
 
-int
-eh_compare_ind_2(Eh_ind_2* a, Eh_ind_2* b);
+/** Update the shore line of a cube
 
-GList*
-sed_find_next_shore(GList* shore_list,
-    Sed_cube s,
-    Eh_ind_2* pos,
-    GList* ignore_list)
+Land columns that border an ocean column are kept in a cube-sized set of
+flags.  Only columns that have been modified since the last update (or every
+column, if sea level has moved) are checked to see if they went from land to
+ocean (or back again).  The shore line is only re-traced if a column joined
+or left the shore.
+
+The shore line is traced from the first shore column found along the edges
+of the domain, and is stored as an array of column ids (see
+sed_cube_shore_line).
+
+\param s A Sed_cube
+*/
+void
+sed_cube_set_shore(Sed_cube s)
 {
-    int i;
-    Eh_ind_2 shift[8] = { {-1, -1}, {0, -1}, {1, -1},
-        {-1, 0},          {1, 0},
-        {-1, 1}, {0, 1}, {1, 1}
-    };
-    GList* child_list = NULL;
-    GList* list;
-    Eh_ind_2 shift_pos;
-    Eh_ind_2* next_pos;
-
-    for (i = 0 ; i < 8 ; i++) {
-        shift_pos = eh_ind_2_create(pos->i + shift[i].i, pos->j + shift[i].j);
-
-        if (g_list_find_custom(ignore_list,
-                &shift_pos,
-                (GCompareFunc)&eh_compare_ind_2)
-            == NULL
-            && is_shore_cell(s, shift_pos.i, shift_pos.j)) {
-            next_pos = eh_ind_2_dup(&shift_pos, NULL);
-            child_list = g_list_prepend(child_list, next_pos);
+    eh_require(s);
+
+    if (s && sed_cube_size(s) > 0) {
+        const gssize n_changed = _sed_cube_shore_flags_refresh(s);
+
+        if (n_changed > 0 || !s->shore) {
+            const gint start = _sed_cube_shore_start(s);
+
+            if (!s->shore) {
+                s->shore = eh_new(gint, sed_cube_size(s));
+            }
+
+            if (start < 0) {
+                s->shore_len = 0;
+                eh_message("There are no shore cells in the domain");
+            } else {
+                s->shore_len = _sed_cube_trace_shore(s, start, s->shore);
+            }
         }
     }
+}
 
+/** The shore line of a cube
 
-    if (child_list) {
-        for (list = child_list ; list ; list = list->next)
-            ignore_list = g_list_prepend(ignore_list,
-                    eh_ind_2_dup((Eh_ind_2*)list->data,
-                        NULL));
+The shore line is brought up to date (see sed_cube_set_shore) before it is
+returned.  The array is owned by the cube and is valid until the cube is
+next modified.
 
-        for (list = child_list ; list ; list = list->next)
-            shore_list = sed_find_next_shore(shore_list, s,
-                    (Eh_ind_2*)list->data, ignore_list);
+\param s   A Sed_cube
+\param len Location to put the number of columns in the shore line (or NULL)
 
-        shore_list = g_list_prepend(shore_list, pos);
-    } else {
-        return g_list_prepend(shore_list, pos);
+\return Ids of the columns that make up the shore line, in the order that
+        they were traced.
+*/
+const gint*
+sed_cube_shore_line(const Sed_cube s, gssize* len)
+{
+    eh_return_val_if_fail(s, NULL);
+
+    sed_cube_set_shore(s);
+
+    if (len) {
+        *len = s->shore_len;
+    }
+
+    return s->shore;
+}
+
+/** Trace the shore line that passes through a column
+
+\param s   A Sed_cube
+\param pos Indices of a shore column
+
+\return A list of the indices (newly-allocated Eh_ind_2) of the shore columns
+        connected to \a pos.  The first element is \a pos itself.
+*/
+GList*
+sed_cube_find_shore_line(Sed_cube s, Eh_ind_2* pos)
+{
+    GList* shore_list = NULL;
+
+    eh_require(s);
+    eh_require(pos);
+
+    if (sed_cube_is_in_domain(s, pos->i, pos->j)) {
+        gint* line = eh_new(gint, sed_cube_size(s));
+        gssize len, n;
+
+        _sed_cube_shore_flags_refresh(s);
+
+        len = _sed_cube_trace_shore(s, sed_cube_id(s, pos->i, pos->j), line);
+
+        for (n = len - 1 ; n >= 0 ; n--) {
+            Eh_ind_2 sub = sed_cube_sub(s, line[n]);
+            shore_list = g_list_prepend(shore_list, eh_ind_2_dup(&sub, NULL));
+        }
+
+        eh_free(line);
     }
 
     return shore_list;
 }
 
+int
+eh_compare_ind_2(Eh_ind_2* a, Eh_ind_2* b);
+
 int
 eh_compare_ind_2(Eh_ind_2* a, Eh_ind_2* b)
 {
@@ -3078,6 +3428,9 @@ sed_cube_find_cross_shore_columns(Sed_cube s, gssize i, gssize j)
 
 /** Look for a transition from land to sea.
 
+The wet and dry columns are read from the cached shore flags of the cube
+rather than by comparing each column with sea level.
+
 \param s A pointer to a Sed_cube.
 \param n The row or column to look along.
 \param vary_dim The dimension along which to look.
@@ -3089,16 +3442,22 @@ sed_cube_find_shore(Sed_cube s, int n, int vary_dim)
 {
     int i, j;
     Eh_ind_2* pos = NULL;
+    const guint8* f;
+
+    _sed_cube_shore_flags_refresh(s);
+
+    f = s->shore_flags;
 
     if (vary_dim == VARY_COLS) {
         const int row = n;
 
-        for (j = 0 ; j < s->n_y - 1 && !pos ; j++)
-            if (sed_column_is_below(s->col[row][j], s->sea_level)
-                ^ sed_column_is_below(s->col[row][j + 1], s->sea_level)) {
+        for (j = 0 ; j < s->n_y - 1 && !pos ; j++) {
+            const gboolean is_wet = (f[row * s->n_y + j] & SED_SHORE_WET) != 0;
+
+            if (is_wet ^ ((f[row * s->n_y + j + 1] & SED_SHORE_WET) != 0)) {
                 pos = eh_new(Eh_ind_2, 1);
 
-                if (sed_column_is_below(s->col[row][j], s->sea_level)) {
+                if (is_wet) {
                     pos->j = j + 1;
                 } else {
                     pos->j = j;
@@ -3106,15 +3465,17 @@ sed_cube_find_shore(Sed_cube s, int n, int vary_dim)
 
                 pos->i = row;
             }
+        }
     } else {
         const int col = n;
 
-        for (i = 0 ; i < s->n_x - 1 && !pos ; i++)
-            if (sed_column_is_below(s->col[i][col], s->sea_level)
-                ^ sed_column_is_below(s->col[i + 1][col], s->sea_level)) {
+        for (i = 0 ; i < s->n_x - 1 && !pos ; i++) {
+            const gboolean is_wet = (f[i * s->n_y + col] & SED_SHORE_WET) != 0;
+
+            if (is_wet ^ ((f[(i + 1) * s->n_y + col] & SED_SHORE_WET) != 0)) {
                 pos = eh_new(Eh_ind_2, 1);
 
-                if (sed_column_is_below(s->col[i][col], s->sea_level)) {
+                if (is_wet) {
                     pos->i = i + 1;
                 } else {
                     pos->i = i;
@@ -3122,6 +3483,7 @@ sed_cube_find_shore(Sed_cube s, int n, int vary_dim)
 
                 pos->j = col;
             }
+        }
     }
 
     return pos;
@@ -4376,6 +4738,9 @@ sed_cube_read(FILE* fp)
             p->col[i] = p->col[i - 1] + p->n_y;
         }
 
+        p->ledger       = NULL;
+        p->keeps_ledger = TRUE;
+
         for (i = 0 ; i < p->n_x ; i++)
             for (j = 0 ; j < p->n_y ; j++) {
                 p->col[i][j] = sed_column_read(fp);
@@ -4825,6 +5190,159 @@ sed_cube_area_above(Sed_cube c, double h)
         * sed_cube_y_res(c);
 }
 
+/** The modification stamp of a column of a cube
+
+\param c  A Sed_cube
+\param id Index of the column
+
+\return The stamp of the column
+
+\see sed_column_stamp
+*/
+gint
+sed_cube_col_stamp(const Sed_cube c, gssize id)
+{
+    eh_return_val_if_fail(c, 0);
+    return sed_column_stamp(sed_cube_col(c, id));
+}
+
+/** Has a column of a cube changed?
+
+Compare the current stamp of a column with a stamp that was recorded
+earlier (with sed_cube_col_stamp or sed_cube_stamps).  Each user of a cube
+keeps its own stamps so that one user looking at a column does not hide a
+change from another.
+
+\param c     A Sed_cube
+\param id    Index of the column
+\param stamp Stamp of the column when it was last looked at
+
+\return TRUE if the column has been modified since the stamp was recorded
+*/
+gboolean
+sed_cube_col_is_dirty(const Sed_cube c, gssize id, gint stamp)
+{
+    eh_return_val_if_fail(c, TRUE);
+    return sed_column_stamp(sed_cube_col(c, id)) != stamp;
+}
+
+/** Record the modification stamps of each column of a cube
+
+\param c      A Sed_cube
+\param stamps An array to hold the stamps (or NULL)
+
+\return An array of sed_cube_size(c) stamps.  If \a stamps is NULL, a newly
+        allocated array that should be freed with eh_free.
+*/
+gint*
+sed_cube_stamps(const Sed_cube c, gint* stamps)
+{
+    eh_return_val_if_fail(c, stamps);
+
+    {
+        const gssize len = sed_cube_size(c);
+        gssize id;
+
+        if (!stamps) {
+            stamps = eh_new(gint, len);
+        }
+
+        for (id = 0 ; id < len ; id++) {
+            stamps[id] = sed_column_stamp(sed_cube_col(c, id));
+        }
+    }
+
+    return stamps;
+}
+
+/** Count the columns of a cube that have changed
+
+\param c      A Sed_cube
+\param stamps Stamps of each column recorded with sed_cube_stamps
+
+\return The number of columns modified since the stamps were recorded
+*/
+gssize
+sed_cube_n_dirty(const Sed_cube c, const gint* stamps)
+{
+    gssize n = 0;
+
+    eh_return_val_if_fail(c, 0);
+    eh_return_val_if_fail(stamps, sed_cube_size(c));
+
+    {
+        const gssize len = sed_cube_size(c);
+        gssize id;
+
+        for (id = 0 ; id < len ; id++) {
+            n += (sed_column_stamp(sed_cube_col(c, id)) != stamps[id]);
+        }
+    }
+
+    return n;
+}
+
+static void
+_sed_cube_snapshot_column(Sed_cube p, gssize n, gssize id, Sed_worker w,
+    gpointer data)
+{
+    sed_column_copy(sed_cube_col((Sed_cube)data, id), sed_cube_col(p, id));
+}
+
+/** Bring a snapshot of a cube up to date
+
+Copy a cube into a snapshot that can be read while the cube goes on
+changing.  Only the columns that have changed since \a stamps were
+recorded are copied so that a snapshot that is kept from one time step to
+the next is cheap to refresh.  The usual pattern is,
+\code
+   snap   = sed_cube_snapshot(snap, p, stamps);
+   stamps = sed_cube_stamps(p, stamps);
+\endcode
+Columns are copied in parallel (see sed_cube_n_threads).
+
+\param dest   The snapshot (or NULL to create one)
+\param src    The Sed_cube to copy
+\param stamps Stamps of the columns of \a src when \a dest was last
+              refreshed (or NULL to copy every column)
+
+\return The snapshot
+*/
+Sed_cube
+sed_cube_snapshot(Sed_cube dest, const Sed_cube src, const gint* stamps)
+{
+    eh_require(src);
+
+    if (!dest) {
+        dest   = sed_cube_new(src->n_x, src->n_y);
+        stamps = NULL;
+    }
+
+    eh_require(dest->n_x == src->n_x && dest->n_y == src->n_y);
+
+    sed_cube_copy_scalar_data(dest, src);
+
+    {
+        const gssize len = sed_cube_size(src);
+        gssize* ids = eh_new(gssize, len);
+        gssize n_dirty = 0;
+        gssize id;
+
+        for (id = 0 ; id < len ; id++) {
+            if (!stamps || sed_cube_col_is_dirty(src, id, stamps[id])) {
+                ids[n_dirty++] = id;
+            }
+        }
+
+        sed_cube_foreach_column_list_parallel(src, ids, n_dirty,
+            _sed_cube_snapshot_column, dest);
+
+        eh_free(ids);
+    }
+
+    return dest;
+}
+
 Sed_cube
 sed_cube_deposit(Sed_cube c, Sed_cell* dz)
 {
@@ -4931,3 +5449,465 @@ sed_cube_get_angle(const Sed_cube c, const int start[2], const int end[2])
     return angle;
 }
 
+
+#define SED_WORKER_N_SCRATCH (8)
+
+typedef struct {
+    Sed_cube p;
+    const gssize* ids;
+    gint len;
+    volatile gint next;
+    Sed_column_worker_func f;
+    gpointer user_data;
+    gchar* profile_path; //< Profile scopes open in the calling thread (or NULL)
+}
+Sed_foreach_job;
+
+CLASS(Sed_worker)
+{
+    gint id;                                    ///< Index of the worker
+    double* scratch[SED_WORKER_N_SCRATCH];      ///< Scratch buffers
+    gssize scratch_len[SED_WORKER_N_SCRATCH];   ///< Lengths of the buffers
+    gpointer data;                              ///< Data owned by the worker
+    GDestroyNotify data_destroy;                ///< Destroy function for data
+    Sed_foreach_job* job;                       ///< The job being worked on
+};
+
+static gint __n_threads = 1;
+
+/* Workers that are kept from one sed_cube_foreach_column_list_parallel
+   call to the next.  The calling thread is worker 0, and each of the other
+   workers has a thread of its own that sleeps until a job is posted.  Only
+   one call uses the pool at a time.
+*/
+static GStaticMutex __pool_busy  = G_STATIC_MUTEX_INIT; //< Held by the caller using the pool
+static GMutex*      __pool_lock  = NULL; //< Guards everything below
+static GCond*       __job_posted = NULL; //< A job was posted or the pool is quitting
+static GCond*       __job_done   = NULL; //< A worker finished its part of a job
+static Sed_worker*  __workers    = NULL; //< Workers of the pool
+static GThread**    __threads    = NULL; //< Thread of each worker (or NULL)
+static gint         __n_workers  = 0;
+static gint         __n_active   = 0;    //< Workers that take part in the job
+static gint         __n_busy     = 0;    //< Threads still working on the job
+static gint         __generation = 0;    //< Changes each time a job is posted
+static Sed_foreach_job* __job    = NULL;
+static gboolean     __pool_quit  = FALSE;
+
+static Sed_worker
+_sed_worker_new(gint id, Sed_foreach_job* job);
+static Sed_worker
+_sed_worker_destroy(Sed_worker w);
+static gpointer
+_sed_worker_run(gpointer data);
+
+/** Set the number of threads used to operate on the columns of a cube.
+
+The worker threads of a different number of threads are stopped.
+
+@param n The number of threads (if < 1, use one thread).
+
+@see sed_cube_foreach_column_parallel
+*/
+void
+sed_cube_set_n_threads(gint n)
+{
+    n = (n >= 1) ? n : 1;
+
+    if (n != __n_threads) {
+        sed_cube_workers_shutdown();
+        __n_threads = n;
+    }
+}
+
+/** The number of threads used to operate on the columns of a cube.
+*/
+gint
+sed_cube_n_threads(void)
+{
+    return __n_threads;
+}
+
+static gpointer
+_sed_worker_pool_thread(gpointer data)
+{
+    Sed_worker w = (Sed_worker)data;
+    gint generation = 0;
+
+    g_mutex_lock(__pool_lock);
+
+    for (;;) {
+        while (!__pool_quit && __generation == generation) {
+            g_cond_wait(__job_posted, __pool_lock);
+        }
+
+        if (__pool_quit) {
+            break;
+        }
+
+        generation = __generation;
+
+        if (w->id < __n_active) {
+            w->job = __job;
+
+            g_mutex_unlock(__pool_lock);
+            _sed_worker_run(w);
+            g_mutex_lock(__pool_lock);
+
+            __n_busy--;
+            g_cond_signal(__job_done);
+        }
+    }
+
+    g_mutex_unlock(__pool_lock);
+
+    return NULL;
+}
+
+/* Create the workers of the pool.  Workers whose thread can not be created
+   are left without one, and the other workers pick up their columns.
+*/
+static void
+_sed_worker_pool_init(gint n_workers)
+{
+    gint i;
+
+    if (!g_thread_supported()) {
+        g_thread_init(NULL);
+    }
+
+    __pool_lock  = g_mutex_new();
+    __job_posted = g_cond_new();
+    __job_done   = g_cond_new();
+    __workers    = eh_new(Sed_worker, n_workers);
+    __threads    = eh_new0(GThread*, n_workers);
+    __n_workers  = n_workers;
+    __generation = 0;
+    __pool_quit  = FALSE;
+
+    for (i = 0 ; i < n_workers ; i++) {
+        __workers[i] = _sed_worker_new(i, NULL);
+    }
+
+    for (i = 1 ; i < n_workers ; i++) {
+        GError* error = NULL;
+
+        __threads[i] = g_thread_create(_sed_worker_pool_thread, __workers[i], TRUE,
+                &error);
+
+        if (error) {
+            eh_warning("Unable to create worker thread: %s", error->message);
+            g_error_free(error);
+        }
+    }
+}
+
+/** Stop the threads that work on the columns of cubes.
+
+The threads are started again the next time that they are needed.  This
+must not be called from within sed_cube_foreach_column_parallel.
+*/
+void
+sed_cube_workers_shutdown(void)
+{
+    g_static_mutex_lock(&__pool_busy);
+
+    if (__pool_lock) {
+        gint i;
+
+        g_mutex_lock(__pool_lock);
+        __pool_quit = TRUE;
+        g_cond_broadcast(__job_posted);
+        g_mutex_unlock(__pool_lock);
+
+        for (i = 1 ; i < __n_workers ; i++) {
+            if (__threads[i]) {
+                g_thread_join(__threads[i]);
+            }
+        }
+
+        for (i = 0 ; i < __n_workers ; i++) {
+            _sed_worker_destroy(__workers[i]);
+        }
+
+        eh_free(__threads);
+        eh_free(__workers);
+        g_cond_free(__job_done);
+        g_cond_free(__job_posted);
+        g_mutex_free(__pool_lock);
+
+        __threads    = NULL;
+        __workers    = NULL;
+        __job_done   = NULL;
+        __job_posted = NULL;
+        __pool_lock  = NULL;
+        __n_workers  = 0;
+    }
+
+    g_static_mutex_unlock(&__pool_busy);
+}
+
+static Sed_worker
+_sed_worker_new(gint id, Sed_foreach_job* job)
+{
+    Sed_worker w = NULL;
+    gint i;
+
+    NEW_OBJECT(Sed_worker, w);
+
+    w->id           = id;
+    w->data         = NULL;
+    w->data_destroy = NULL;
+    w->job          = job;
+
+    for (i = 0 ; i < SED_WORKER_N_SCRATCH ; i++) {
+        w->scratch[i]     = NULL;
+        w->scratch_len[i] = 0;
+    }
+
+    return w;
+}
+
+static Sed_worker
+_sed_worker_destroy(Sed_worker w)
+{
+    if (w) {
+        gint i;
+
+        for (i = 0 ; i < SED_WORKER_N_SCRATCH ; i++) {
+            eh_free(w->scratch[i]);
+        }
+
+        if (w->data && w->data_destroy) {
+            (w->data_destroy)(w->data);
+        }
+
+        eh_free(w);
+    }
+
+    return NULL;
+}
+
+/** The index of a worker.
+
+Workers of a sed_cube_foreach_column_parallel call are numbered from 0 to
+one less than the number of threads.
+*/
+gint
+sed_worker_id(Sed_worker w)
+{
+    eh_require(w);
+    return w->id;
+}
+
+/** Get a scratch buffer of a worker.
+
+Each worker has SED_WORKER_N_SCRATCH buffers of doubles that belong to
+it alone.  A buffer is kept by the worker, and grows as needed, so that it
+can be reused from one column to the next and from one
+sed_cube_foreach_column_parallel call to the next.  The contents of the
+buffer are not initialized.
+
+@param w   A Sed_worker.
+@param i   Index of the buffer.
+@param len The number of doubles that the buffer must hold.
+
+@return A pointer to the buffer.
+*/
+double*
+sed_worker_scratch(Sed_worker w, gint i, gssize len)
+{
+    eh_require(w);
+    eh_require(i >= 0 && i < SED_WORKER_N_SCRATCH);
+
+    if (len > w->scratch_len[i]) {
+        w->scratch_len[i] = MAX(len, 2 * w->scratch_len[i]);
+        w->scratch[i]     = eh_renew(double, w->scratch[i], w->scratch_len[i]);
+    }
+
+    return w->scratch[i];
+}
+
+/** Data that a worker holds between columns (or NULL).
+*/
+gpointer
+sed_worker_data(Sed_worker w)
+{
+    eh_require(w);
+    return w->data;
+}
+
+/** Give data to a worker.
+
+The data are kept by the worker for the duration of a
+sed_cube_foreach_column_parallel call and then freed with destroy.
+
+@param w       A Sed_worker.
+@param data    The data to hold.
+@param destroy Function to free data with (or NULL).
+*/
+void
+sed_worker_set_data(Sed_worker w, gpointer data, GDestroyNotify destroy)
+{
+    eh_require(w);
+
+    if (w->data && w->data_destroy) {
+        (w->data_destroy)(w->data);
+    }
+
+    w->data         = data;
+    w->data_destroy = destroy;
+}
+
+static gpointer
+_sed_worker_run(gpointer data)
+{
+    Sed_worker w = (Sed_worker)data;
+    Sed_foreach_job* job = w->job;
+    gint n;
+
+    // Workers other than the calling thread record their time under the
+    // scope that the job was posted from.
+    if (w->id > 0) {
+        sed_profile_push_path(job->profile_path);
+    }
+
+    // Take columns one at a time from the job so that workers that get
+    // short columns go on to do more of them.
+    SED_PROFILE_BEGIN("column worker");
+
+    while ((n = g_atomic_int_exchange_and_add(&(job->next), 1)) < job->len) {
+        gssize id = (job->ids) ? job->ids[n] : n;
+
+        (job->f)(job->p, n, id, w, job->user_data);
+    }
+
+    SED_PROFILE_END();
+
+    if (w->id > 0) {
+        sed_profile_pop_path();
+    }
+
+    return NULL;
+}
+
+/** Call a function for each of a list of columns of a cube, in parallel.
+
+The function is called once for each of the len column ids.  The columns are
+handed out one at a time to sed_cube_n_threads() workers, as each worker
+finishes its last column, so that the work is shared evenly among the
+threads even though some columns take much longer than others.  The calling
+thread is one of the workers.  The function must only change data that
+belongs to the column that it is called for, or to its worker.
+
+@param p         A Sed_cube.
+@param ids       Array of column ids (or NULL for every column of the cube).
+@param len       Number of ids.
+@param f         The function to call.
+@param user_data Data to pass to f.
+
+@return TRUE if the function was called for every column.
+*/
+gboolean
+sed_cube_foreach_column_list_parallel(Sed_cube p,
+    const gssize* ids,
+    gssize len,
+    Sed_column_worker_func f,
+    gpointer user_data)
+{
+    gboolean success = FALSE;
+
+    eh_require(p);
+    eh_require(f);
+
+    if (p && f && len >= 0) {
+        Sed_foreach_job job;
+        gint n_workers = MIN(__n_threads, len);
+        gint i;
+
+        if (n_workers < 1) {
+            n_workers = 1;
+        }
+
+        SED_PROFILE_BEGIN("columns");
+
+        job.p            = p;
+        job.ids          = ids;
+        job.len          = len;
+        job.next         = 0;
+        job.f            = f;
+        job.user_data    = user_data;
+        job.profile_path = sed_profile_path();
+
+        if (n_workers > 1 && g_static_mutex_trylock(&__pool_busy)) {
+            if (!__pool_lock) {
+                _sed_worker_pool_init(__n_threads);
+            }
+
+            g_mutex_lock(__pool_lock);
+
+            __job      = &job;
+            __n_active = n_workers;
+            __n_busy   = 0;
+
+            for (i = 1 ; i < n_workers ; i++) {
+                if (__threads[i]) {
+                    __n_busy++;
+                }
+            }
+
+            __generation++;
+            g_cond_broadcast(__job_posted);
+
+            g_mutex_unlock(__pool_lock);
+
+            __workers[0]->job = &job;
+            _sed_worker_run(__workers[0]);
+
+            g_mutex_lock(__pool_lock);
+
+            while (__n_busy > 0) {
+                g_cond_wait(__job_done, __pool_lock);
+            }
+
+            __job = NULL;
+
+            g_mutex_unlock(__pool_lock);
+
+            for (i = 0 ; i < n_workers ; i++) {
+                sed_worker_set_data(__workers[i], NULL, NULL);
+            }
+
+            g_static_mutex_unlock(&__pool_busy);
+        } else {
+            // One thread, or the pool is in use (by a call from within one of
+            // its own jobs, say).  The calling thread does all of the work.
+            Sed_worker w = _sed_worker_new(0, &job);
+
+            _sed_worker_run(w);
+
+            _sed_worker_destroy(w);
+        }
+
+        eh_free(job.profile_path);
+
+        SED_PROFILE_END();
+
+        success = TRUE;
+    }
+
+    return success;
+}
+
+/** Call a function for each column of a cube, in parallel.
+
+@see sed_cube_foreach_column_list_parallel
+*/
+gboolean
+sed_cube_foreach_column_parallel(Sed_cube p,
+    Sed_column_worker_func f,
+    gpointer user_data)
+{
+    eh_require(p);
+    return sed_cube_foreach_column_list_parallel(p, NULL, sed_cube_size(p),
+            f, user_data);
+}
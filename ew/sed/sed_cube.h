@@ -290,6 +290,12 @@ double
 sed_cube_sediment_mass(const Sed_cube p);
 double
 sed_cube_mass_in_suspension(const Sed_cube p);
+Sed_mass_ledger
+sed_cube_mass_ledger(const Sed_cube p);
+double
+sed_cube_ledger_mass(const Sed_cube p);
+double
+sed_cube_sediment_mass_in_suspension(const Sed_cube p);
 Sed_cube
 sed_cube_set_sea_level(Sed_cube s, double new_sea_level);
 Sed_cube
@@ -441,18 +447,15 @@ sed_load_cube(FILE* fp);
 gssize
 sed_cube_column_id(const Sed_cube c, double x, double y);
 void
-sed_set_shore(Sed_cube s);
+sed_cube_set_shore(Sed_cube s);
+const gint*
+sed_cube_shore_line(const Sed_cube s, gssize* len);
 GList*
 sed_cube_find_shore_line(Sed_cube s, Eh_ind_2* pos);
 
 Sed_riv
 sed_cube_find_river_mouth(Sed_cube c, Sed_riv this_river);
 
-GList*
-sed_find_next_shore(GList* shore_list,
-    Sed_cube s,
-    Eh_ind_2* pos,
-    GList* ignore_list);
 gint*
 sed_cube_shore_normal_shift(Sed_cube s, gint i, gint j);
 double
@@ -645,6 +648,16 @@ sed_cube_count_above(Sed_cube c, double h);
 double
 sed_cube_area_above(Sed_cube c, double h);
 
+gint
+sed_cube_col_stamp(const Sed_cube c, gssize id);
+gboolean
+sed_cube_col_is_dirty(const Sed_cube c, gssize id, gint stamp);
+gint*
+sed_cube_stamps(const Sed_cube c, gint* stamps);
+gssize
+sed_cube_n_dirty(const Sed_cube c, const gint* stamps);
+Sed_cube
+sed_cube_snapshot(Sed_cube dest, const Sed_cube src, const gint* stamps);
 Sed_cube
 sed_cube_deposit(Sed_cube c, Sed_cell* dz);
 Sed_cube
@@ -658,6 +671,41 @@ sed_cube_col_deposit_equal_amounts(Sed_cube c, gint id, double t);
 
 double
 sed_cube_get_angle(const Sed_cube c, const int start[2], const int end[2]);
+
+new_handle(Sed_worker);
+
+/** Function called by sed_cube_foreach_column_parallel with the cube, the
+position of the column in the list of columns, the column id, the worker, and
+user data.
+*/
+typedef void (*Sed_column_worker_func)(Sed_cube, gssize, gssize, Sed_worker,
+    gpointer);
+
+void
+sed_cube_set_n_threads(gint n);
+gint
+sed_cube_n_threads(void);
+void
+sed_cube_workers_shutdown(void);
+gboolean
+sed_cube_foreach_column_parallel(Sed_cube p,
+    Sed_column_worker_func f,
+    gpointer user_data);
+gboolean
+sed_cube_foreach_column_list_parallel(Sed_cube p,
+    const gssize* ids,
+    gssize len,
+    Sed_column_worker_func f,
+    gpointer user_data);
+gint
+sed_worker_id(Sed_worker w);
+double*
+sed_worker_scratch(Sed_worker w, gint i, gssize len);
+gpointer
+sed_worker_data(Sed_worker w);
+void
+sed_worker_set_data(Sed_worker w, gpointer data, GDestroyNotify destroy);
+
 G_END_DECLS
 
 #endif
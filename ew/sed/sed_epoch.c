@@ -24,6 +24,7 @@
 
 #include "sed_epoch.h"
 #include "sed_signal.h"
+#include "sed_output.h"
 
 CLASS(Sed_epoch)
 {
@@ -909,7 +910,7 @@ sed_epoch_queue_pop(Sed_epoch_queue q)
 Sed_epoch
 sed_epoch_queue_nth(Sed_epoch_queue q, gssize n)
 {
-    Sed_epoch e;
+    Sed_epoch e = NULL;
 
     if (q && q->l) {
         e = (Sed_epoch)g_list_nth_data(q->l, n);
@@ -1101,9 +1102,11 @@ sed_epoch_queue_run(Sed_epoch_queue q, Sed_cube p)
         Sed_process_queue proc_q;
         Sed_epoch         epoch;
 
-        for (epoch = sed_epoch_queue_pop(q) ;
+        /* The epoch stays in the queue while it runs so that a checkpoint
+           written during the epoch includes its processes. */
+        for (epoch = sed_epoch_queue_first(q) ;
             epoch && !sed_signal_is_pending(SED_SIG_QUIT) ;
-            epoch = sed_epoch_queue_pop(q)) {
+            epoch = sed_epoch_queue_first(q)) {
             proc_q = sed_epoch_proc_queue(epoch);
 
             if (proc_q) {
@@ -1112,9 +1115,12 @@ sed_epoch_queue_run(Sed_epoch_queue q, Sed_cube p)
                 sed_process_queue_run_until(proc_q, p, sed_epoch_end(epoch));
                 sed_process_queue_run_at_end(proc_q, p);
 
+                // Output of the epoch is on disk before the next one starts.
+                sed_output_flush();
+
                 sed_process_queue_summary(stdout, proc_q);
 
-                sed_epoch_destroy(epoch);
+                sed_epoch_destroy(sed_epoch_queue_pop(q));
                 //            sed_cube_free_river      ( p      );
             } else {
                 eh_require_not_reached();
@@ -1154,6 +1160,7 @@ sed_epoch_queue_tic(Sed_epoch_queue   epoch_q,
 
         if (t_stop > sed_epoch_end(epoch)) {
             sed_process_queue_run_at_end(proc_q, p);
+            sed_output_flush();
 
             sed_process_queue_summary(stdout, proc_q);
 
@@ -1215,6 +1222,7 @@ sed_epoch_queue_run_until(Sed_epoch_queue   epoch_q,
 
                     if (sed_cube_age_in_years(p) > sed_epoch_end(epoch)) {
                         sed_process_queue_run_at_end(proc_q, p);
+                        sed_output_flush();
                         sed_process_queue_summary(stdout, proc_q);
                     }
                 } else {
@@ -1232,3 +1240,118 @@ sed_epoch_queue_run_until(Sed_epoch_queue   epoch_q,
     return epoch_q;
 }
 
+/** Write the state of the processes of each epoch to a checkpoint
+
+Epochs that have already been run are no longer in the queue and so are not
+written.  Each epoch is identified by its start time.
+
+\param q  A Sed_epoch_queue
+\param fp An open checkpoint file
+
+\return The number of bytes written
+*/
+gssize
+sed_epoch_queue_dump(Sed_epoch_queue q, FILE* fp)
+{
+    gssize n = 0;
+
+    eh_require(q);
+    eh_require(fp);
+
+    if (q && fp) {
+        gint32 len = sed_epoch_queue_length(q);
+        GList* link;
+
+        n += fwrite(&len, sizeof(gint32), 1, fp) * sizeof(gint32);
+
+        for (link = q->l ; link ; link = link->next) {
+            double start = sed_epoch_start(link->data);
+
+            n += fwrite(&start, sizeof(double), 1, fp) * sizeof(double);
+            n += sed_process_queue_dump(sed_epoch_proc_queue(link->data), fp);
+        }
+    }
+
+    return n;
+}
+
+/** Read the state of the processes of each epoch from a checkpoint
+
+The epoch queue must have been created from the same input files as the
+queue that was written with sed_epoch_queue_dump.  Epochs that are not in
+the checkpoint had already been run when it was written and are removed
+from the queue.
+
+\param q     A Sed_epoch_queue
+\param fp    An open checkpoint file
+\param error A GError
+
+\return TRUE if the processes were read, FALSE otherwise (and \a error is
+        set)
+*/
+gboolean
+sed_epoch_queue_load(Sed_epoch_queue q, FILE* fp, GError** error)
+{
+    gboolean is_ok = TRUE;
+
+    eh_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+    if (q && fp) {
+        GError* tmp_err = NULL;
+        GList*  loaded  = NULL;
+        gint32  len     = -1;
+        gint32  i;
+
+        if (fread(&len, sizeof(gint32), 1, fp) != 1 || len < 0
+            || len > sed_epoch_queue_length(q)) {
+            g_set_error(&tmp_err, SED_EPOCH_ERROR, SED_EPOCH_ERROR_BAD_CHECKPOINT,
+                "Checkpoint holds more epochs than the epoch file (%d > %d)",
+                len, (gint)sed_epoch_queue_length(q));
+        }
+
+        for (i = 0 ; !tmp_err && i < len ; i++) {
+            double start;
+            GList* link = NULL;
+
+            if (fread(&start, sizeof(double), 1, fp) == 1) {
+                for (link = q->l ; link ; link = link->next) {
+                    if (eh_compare_dbl(sed_epoch_start(link->data), start, 1e-12)) {
+                        break;
+                    }
+                }
+            }
+
+            if (link) {
+                sed_process_queue_load(sed_epoch_proc_queue(link->data), fp, &tmp_err);
+                loaded = g_list_prepend(loaded, link->data);
+            } else
+                g_set_error(&tmp_err, SED_EPOCH_ERROR, SED_EPOCH_ERROR_BAD_CHECKPOINT,
+                    "Checkpoint holds an epoch that is not in the epoch file");
+        }
+
+        if (!tmp_err) {
+            /* Drop the epochs that had finished before the checkpoint */
+            GList* link = q->l;
+
+            while (link) {
+                GList* next = link->next;
+
+                if (!g_list_find(loaded, link->data)) {
+                    sed_epoch_destroy(link->data);
+                    q->l = g_list_delete_link(q->l, link);
+                }
+
+                link = next;
+            }
+        }
+
+        g_list_free(loaded);
+
+        if (tmp_err) {
+            g_propagate_error(error, tmp_err);
+            is_ok = FALSE;
+        }
+    }
+
+    return is_ok;
+}
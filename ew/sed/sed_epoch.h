@@ -36,7 +36,8 @@ typedef enum {
     SED_EPOCH_ERROR_BAD_TIME_STEP,
     SED_EPOCH_ERROR_NEGATIVE_TIME_STEP,
     SED_EPOCH_ERROR_NEGATIVE_DURATION,
-    SED_EPOCH_ERROR_BAD_PREFIX
+    SED_EPOCH_ERROR_BAD_PREFIX,
+    SED_EPOCH_ERROR_BAD_CHECKPOINT
 }
 Sed_epoch_error;
 
@@ -181,6 +182,11 @@ sed_epoch_queue_tic(Sed_epoch_queue epoch_q, Sed_cube p);
 Sed_epoch_queue
 sed_epoch_queue_run_until(Sed_epoch_queue epoch_q, Sed_cube p, double t_in_years);
 
+gssize
+sed_epoch_queue_dump(Sed_epoch_queue q, FILE* fp);
+gboolean
+sed_epoch_queue_load(Sed_epoch_queue q, FILE* fp, GError** error);
+
 G_END_DECLS
 
 #endif /* sed_epoch.h */
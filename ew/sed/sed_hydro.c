@@ -54,6 +54,28 @@ CLASS(Sed_hydro_file)
     Sed_hydrotrend_header* hdr;
     Hydro_read_record_func read_record;
     Hydro_read_header_func read_hdr;
+
+    GQueue* stream;                ///< Records pushed by a model (SED_HYDRO_STREAM)
+    GMutex* stream_lock;           ///< Guards the stream and its flags
+    GCond* stream_cond;            ///< A record was pushed or popped, or the stream closed
+    gint stream_max_len;           ///< Producer blocks when this many records are queued
+    gboolean stream_is_closed;     ///< The producer will push no more records
+    gboolean stream_is_cancelled;  ///< The reader is gone; producer should stop
+
+    Sed_hydrotrend_map map;        ///< A mapped HydroTrend file (or NULL)
+    Sed_hydrotrend_block* block;   ///< The most recently decoded records of map
+    gint rec_cur;                  ///< Index of the next record of map
+
+    GThread* prefetch_thread;      ///< Reads and eventizes buffers ahead of time
+    GMutex* prefetch_lock;         ///< Guards the prefetched buffers and the counts
+    GCond* prefetch_cond;          ///< A buffer was prefetched or taken
+    GQueue* prefetched;            ///< Eventized buffers that are ready to be used
+    gint prefetch_max;             ///< Number of buffers to read ahead
+    gboolean prefetch_is_done;     ///< The prefetcher has reached the end of a stream
+    gboolean prefetch_stop;        ///< Tell the prefetcher to stop
+    gint n_fills;                  ///< Number of times the buffer was refilled
+    gint n_waits;                  ///< Number of refills that had to wait
+    GTimer* wait_timer;            ///< Time spent waiting for buffers
 };
 
 GQuark
@@ -72,6 +94,10 @@ static Sed_hydro
 _hydro_read_hydrotrend_record(Sed_hydro_file fp);
 static Sed_hydro
 _hydro_read_hydrotrend_record_buffer(Sed_hydro_file fp);
+static Sed_hydro
+_hydro_read_stream_record(Sed_hydro_file fp);
+static Sed_hydro
+_hydro_file_next_record(Sed_hydro_file fp);
 
 void
 sed_hydro_fprint_default_inline_file(FILE* fp)
@@ -430,6 +456,7 @@ const gchar __hydro_inline_type_s[]        = "Inline";
 const gchar __hydro_hydrotrend_type_s[]    = "Hydrotrend";
 const gchar __hydro_hydrotrend_be_type_s[] = "Hydrotrend (big-endian)";
 const gchar __hydro_hydrotrend_le_type_s[] = "Hydrotrend (little-endian)";
+const gchar __hydro_stream_type_s[]        = "Model";
 
 const gchar*
 sed_hydro_type_to_s(Sed_hydro_file_type t)
@@ -453,6 +480,10 @@ sed_hydro_type_to_s(Sed_hydro_file_type t)
             s = __hydro_hydrotrend_le_type_s ;
             break;
 
+        case SED_HYDRO_STREAM        :
+            s = __hydro_stream_type_s ;
+            break;
+
         default                      :
             s = __hydro_unknown_type_s;
     }
@@ -475,6 +506,9 @@ sed_hydro_str_to_type(const gchar* type_s)
             t = SED_HYDRO_HYDROTREND;
         } else if (g_ascii_strcasecmp(type_s, "EXTERNAL") == 0) {
             t = SED_HYDRO_EXTERNAL;
+        } else if (g_ascii_strcasecmp(type_s, "MODEL") == 0
+            || g_ascii_strcasecmp(type_s, "STREAM") == 0) {
+            t = SED_HYDRO_STREAM;
         }
     }
 
@@ -519,7 +553,11 @@ sed_hydro_file_guess_type(const gchar* file, GError** error)
 
                 if (arr) {
                     type = SED_HYDRO_HYDROTREND_BE;
-                } else {
+                } else if (g_error_matches(tmp_err, SED_HYDROTREND_ERROR,
+                        SED_HYDROTREND_ERROR_BAD_HEADER)) {
+                    // not big-endian; if it isn't little-endian either, report that.
+                    g_clear_error(&tmp_err);
+
                     arr = sed_hydrotrend_read_n_recs(file, 10, G_LITTLE_ENDIAN, NULL, &tmp_err);
 
                     if (arr) {
@@ -1372,8 +1410,6 @@ typedef struct {
 }
 Hydro_sort_st;
 
-gint
-cmp_hydro_sort_vals(Hydro_sort_st* a, Hydro_sort_st* b) G_GNUC_INTERNAL;
 gint
 cmp_hydro_sort_inds(Hydro_sort_st* a, Hydro_sort_st* b) G_GNUC_INTERNAL;
 
@@ -1468,6 +1504,50 @@ sed_hydro_array_eventize_conc(Sed_hydro* rec_a, double c)
     return event_a;
 }
 
+static void
+_hydro_max_heap_sift_down(double* heap, gssize len, gssize i)
+{
+    const double top = heap[i];
+    gssize child;
+
+    for (child = 2 * i + 1 ; child < len ; i = child, child = 2 * i + 1) {
+        if (child + 1 < len && heap[child + 1] > heap[child]) {
+            child++;
+        }
+
+        if (heap[child] <= top) {
+            break;
+        }
+
+        heap[i] = heap[child];
+    }
+
+    heap[i] = top;
+}
+
+/* The number of the largest values that must be added (largest first) to
+   reach threshold.  The values are reordered.
+*/
+static gssize
+_hydro_n_largest_to_threshold(double* val, gssize len, double threshold)
+{
+    gssize n = 0;
+    gssize i;
+    double sum;
+
+    for (i = len / 2 - 1 ; i >= 0 ; i--) {
+        _hydro_max_heap_sift_down(val, len, i);
+    }
+
+    for (sum = 0. ; len > 0 && sum < threshold ; n++) {
+        sum   += val[0];
+        val[0] = val[--len];
+        _hydro_max_heap_sift_down(val, len, 0);
+    }
+
+    return n;
+}
+
 /** Reduce a Sed_hydro array to a number of events based on fraction of total sediment load
 
 \param rec_a              A NULL-terminated Sed_hydro array
@@ -1485,26 +1565,24 @@ sed_hydro_array_eventize(Sed_hydro* rec_a, double f, gboolean insert_mean_values
         if (eh_compare_dbl(f, 1., 1e-12)) {
             event_a = sed_hydro_array_dup(rec_a);
         } else if (f > 0) {
-            gssize     n_events  = 0;
-            double     load      = sed_hydro_array_suspended_load(rec_a);
-            double     threshold = load * f;
-            Sed_hydro* sorted_a  = sed_hydro_array_sort_by_suspended_load(rec_a);
-            Sed_hydro* r;
-            double     sum;
+            const gssize len  = g_strv_length((gchar**)rec_a);
+            double*      load = eh_new(double, len);
+            double       threshold;
+            gssize       n_events;
+            gssize       i;
+
+            for (i = 0, threshold = 0. ; i < len ; i++) {
+                load[i]    = sed_hydro_suspended_load(rec_a[i]);
+                threshold += load[i];
+            }
 
-            eh_require(sorted_a);
+            threshold *= f;
 
-            for (r = sorted_a, sum = 0. ; *r && sum < threshold ; r++) {
-                sum += sed_hydro_suspended_load(*r);
-                n_events++;
-            }
+            n_events = _hydro_n_largest_to_threshold(load, len, threshold);
 
-            eh_free(sorted_a);
+            eh_free(load);
 
-            event_a = sed_hydro_process_records(rec_a,
-                    g_strv_length((gchar**)rec_a),
-                    n_events,
-                    insert_mean_values);
+            event_a = sed_hydro_process_records(rec_a, len, n_events, insert_mean_values);
         }
     }
 
@@ -1624,6 +1702,190 @@ sed_hydro_array_sort_by_total_load(Sed_hydro* arr)
     return sed_hydro_array_sort(arr, (GCompareFunc)sed_hydro_cmp_total_load);
 }
 
+/* Running sums of the quantities averaged by sed_hydro_average_records */
+typedef enum {
+    HYDRO_SUM_VELOCITY,
+    HYDRO_SUM_DEPTH,
+    HYDRO_SUM_BEDLOAD,
+    HYDRO_SUM_DURATION,
+    HYDRO_SUM_WATER,      ///< water flux times duration
+    HYDRO_SUM_LOAD        ///< the first of n_grains concentration times water flux
+}
+Hydro_sum_type;
+
+/* Prefix sums over a buffer of records: sum[i*n_vals+k] is the sum of
+   quantity k over records 0 to i-1.  With these the mean of any run of
+   records is found without looking at the records again.
+*/
+typedef struct {
+    gint    n_grains;
+    gint    n_vals;
+    double* sum;
+}
+Hydro_prefix_sums;
+
+static void
+_hydro_prefix_sums_init(Hydro_prefix_sums* p, Sed_hydro* rec, gssize n_recs)
+{
+    const gint n_grains = rec[0]->n_grains;
+    const gint n_vals   = HYDRO_SUM_LOAD + n_grains;
+    double* last;
+    double* this;
+    gssize i;
+    gint j;
+
+    p->n_grains = n_grains;
+    p->n_vals   = n_vals;
+    p->sum      = eh_new0(double, (n_recs + 1) * n_vals);
+
+    for (i = 0, last = p->sum, this = p->sum + n_vals ; i < n_recs ;
+        i++, last = this, this += n_vals) {
+        const Sed_hydro r = rec[i];
+        const double    q = sed_hydro_water_flux(r);
+
+        this[HYDRO_SUM_VELOCITY] = last[HYDRO_SUM_VELOCITY] + r->velocity;
+        this[HYDRO_SUM_DEPTH]    = last[HYDRO_SUM_DEPTH]    + r->depth;
+        this[HYDRO_SUM_BEDLOAD]  = last[HYDRO_SUM_BEDLOAD]  + r->bedload;
+        this[HYDRO_SUM_DURATION] = last[HYDRO_SUM_DURATION] + r->duration;
+        this[HYDRO_SUM_WATER]    = last[HYDRO_SUM_WATER]    + q * r->duration;
+
+        for (j = 0 ; j < n_grains ; j++) {
+            this[HYDRO_SUM_LOAD + j] = last[HYDRO_SUM_LOAD + j] + r->conc[j] * q;
+        }
+    }
+}
+
+/* The same record as sed_hydro_average_records( rec+i_0 , i_1-i_0 ) */
+static Sed_hydro
+_hydro_prefix_sums_mean(const Hydro_prefix_sums* p, Sed_hydro* rec, gssize i_0, gssize i_1)
+{
+    const gssize n_recs = i_1 - i_0;
+    Sed_hydro mean_rec;
+
+    eh_require(n_recs > 0);
+
+    if (n_recs == 1) {
+        mean_rec = sed_hydro_dup(rec[i_0]);
+    } else {
+        const double* s_0 = p->sum + i_0 * p->n_vals;
+        const double* s_1 = p->sum + i_1 * p->n_vals;
+        const double  total_q = s_1[HYDRO_SUM_WATER] - s_0[HYDRO_SUM_WATER];
+        gint j;
+
+        mean_rec = sed_hydro_new(p->n_grains);
+
+        mean_rec->velocity = (s_1[HYDRO_SUM_VELOCITY] - s_0[HYDRO_SUM_VELOCITY]) / (double)n_recs;
+        mean_rec->depth    = (s_1[HYDRO_SUM_DEPTH] - s_0[HYDRO_SUM_DEPTH]) / (double)n_recs;
+        mean_rec->bedload  = (s_1[HYDRO_SUM_BEDLOAD] - s_0[HYDRO_SUM_BEDLOAD]) / (double)n_recs;
+        mean_rec->duration = s_1[HYDRO_SUM_DURATION] - s_0[HYDRO_SUM_DURATION];
+
+        // adjust the mean width to conserve the amount of water, and the
+        // concentrations to conserve the amount of each sediment type.
+        mean_rec->width = total_q / mean_rec->duration / (mean_rec->velocity * mean_rec->depth);
+
+        for (j = 0 ; j < p->n_grains ; j++) {
+            mean_rec->conc[j] = (s_1[HYDRO_SUM_LOAD + j] - s_0[HYDRO_SUM_LOAD + j]) / total_q;
+        }
+    }
+
+    return mean_rec;
+}
+
+/* Order for the heap of the largest events.  The root is the smallest value
+   and, of equal values, the latest record, so that the earliest of equal
+   records are the ones that are kept.
+*/
+static gboolean
+_hydro_sort_st_is_less(const Hydro_sort_st* a, const Hydro_sort_st* b)
+{
+    return a->val < b->val || (a->val == b->val && a->ind > b->ind);
+}
+
+static void
+_hydro_heap_sift_down(Hydro_sort_st* heap, gint len, gint i)
+{
+    const Hydro_sort_st top = heap[i];
+    gint child;
+
+    for (child = 2 * i + 1 ; child < len ; i = child, child = 2 * i + 1) {
+        if (child + 1 < len && _hydro_sort_st_is_less(heap + child + 1, heap + child)) {
+            child++;
+        }
+
+        if (!_hydro_sort_st_is_less(heap + child, &top)) {
+            break;
+        }
+
+        heap[i] = heap[child];
+    }
+
+    heap[i] = top;
+}
+
+static void
+_hydro_heap_sift_up(Hydro_sort_st* heap, gint i)
+{
+    const Hydro_sort_st bottom = heap[i];
+    gint parent;
+
+    for (parent = (i - 1) / 2 ; i > 0 && _hydro_sort_st_is_less(&bottom, heap + parent) ;
+        i = parent, parent = (i - 1) / 2) {
+        heap[i] = heap[parent];
+    }
+
+    heap[i] = bottom;
+}
+
+/* Find the (at most) n_sig_values records with the largest suspended flux.
+   Records with no suspended flux are never chosen.  The chosen records are
+   written to top_n in the order they occur.
+
+   Returns the number of records chosen.
+*/
+static gint
+_hydro_select_top_n(Sed_hydro* rec, gssize n_recs, gssize n_sig_values, Hydro_sort_st* top_n)
+{
+    gint n_top = 0;
+    gssize i;
+
+    for (i = 0 ; i < n_recs ; i++) {
+        const double val = sed_hydro_suspended_flux(rec[i]);
+
+        if (val > G_MINDOUBLE) {
+            if (n_top < n_sig_values) {
+                top_n[n_top].val = val;
+                top_n[n_top].ind = i;
+                _hydro_heap_sift_up(top_n, n_top++);
+            } else if (val > top_n[0].val) {
+                top_n[0].val = val;
+                top_n[0].ind = i;
+                _hydro_heap_sift_down(top_n, n_top, 0);
+            }
+        }
+    }
+
+    qsort(top_n, n_top, sizeof(Hydro_sort_st),
+        (int (*)(const void*, const void*))cmp_hydro_sort_inds);
+
+    return n_top;
+}
+
+/** Reduce a buffer of records to its largest events
+
+The n_sig_values records with the largest suspended sediment flux are kept.
+If \a insert_mean_values is TRUE, the records that fall between them are
+replaced by their mean (see sed_hydro_average_records).
+
+The largest events are found with a heap of n_sig_values entries and the
+means with prefix sums, so the cost is about n_recs*log(n_sig_values).
+
+\param rec                 An array of records
+\param n_recs              The number of records in \a rec
+\param n_sig_values        The number of events to keep
+\param insert_mean_values  If TRUE, keep the mean of the records between events
+
+\return A newly-allocated, NULL-terminated Sed_hydro array
+*/
 Sed_hydro*
 sed_hydro_process_records(Sed_hydro* rec,
     gssize n_recs,
@@ -1639,112 +1901,54 @@ sed_hydro_process_records(Sed_hydro* rec,
         Sed_hydro mean_rec = sed_hydro_average_records(rec, n_recs);
         eh_strv_append((gchar***)&return_ptr, (gchar*)mean_rec);
     } else {
-        GSList*    top_n   = NULL;
-        GPtrArray* new_rec = NULL;
-
-        // Create a list to record the top n events
-        {
-            Hydro_sort_st* new_val;
-            gint           i;
-
-            for (i = 0 ; i < n_sig_values ; i++) {
-                new_val      = eh_new(Hydro_sort_st, 1);
-                new_val->val = G_MINDOUBLE;
-                new_val->ind = -1;
+        Hydro_sort_st* top_n = eh_new(Hydro_sort_st, MAX(n_sig_values, 1));
+        Hydro_prefix_sums sums;
+        gint n_top, n_new;
 
-                top_n        = g_slist_append(top_n, new_val);
-            }
-        }
+        n_top = _hydro_select_top_n(rec, n_recs, MAX(n_sig_values, 0), top_n);
 
-        // Insert to top n events into the list
-        if (n_sig_values != 0) {
-            Hydro_sort_st* lowest_val;
-            Hydro_sort_st* new_val;
-            gint           i;
-            double         val;
-
-            lowest_val = (Hydro_sort_st*)g_slist_nth_data(top_n, 0);
-
-            for (i = 0 ; i < n_recs ; i++) {
-                val = sed_hydro_suspended_flux(rec[i]);
-
-                if (val > lowest_val->val) {
-                    new_val = eh_new(Hydro_sort_st, 1);
-                    new_val->val = val;
-                    new_val->ind = i;
-                    top_n = g_slist_insert_sorted(top_n,
-                            new_val,
-                            (GCompareFunc)cmp_hydro_sort_vals);
-                    top_n = g_slist_remove(top_n, lowest_val);
-                    eh_free(lowest_val);
-                    lowest_val = (Hydro_sort_st*)g_slist_nth_data(top_n, 0);
-                }
-            }
+        if (insert_mean_values) {
+            _hydro_prefix_sums_init(&sums, rec, n_recs);
         }
 
-        // sort these records by time (or index)
-        top_n = g_slist_sort(top_n, (GCompareFunc)cmp_hydro_sort_inds);
-
-        new_rec = g_ptr_array_new();
+        // at most one mean record before each event and one at the end.
+        return_ptr = eh_new(Sed_hydro, 2 * n_top + 2);
 
         // Create the new list of records with mean values put in between the
         // largest events.
         {
-            gint      j;
-            gint      ind;
-            gint      ind_last;
-            Sed_hydro mean_rec;
-            Sed_hydro real_rec;
+            gint j;
+            gint ind;
+            gint ind_last;
 
-            for (j = 0, ind = 0, ind_last = -1 ; j < n_sig_values ; j++, ind_last = ind) {
-                ind = ((Hydro_sort_st*)g_slist_nth_data(top_n, j))->ind;
+            for (j = 0, n_new = 0, ind = 0, ind_last = -1 ; j < n_top ; j++, ind_last = ind) {
+                ind = top_n[j].ind;
 
                 if (insert_mean_values && ind != ind_last + 1) {
-                    mean_rec = sed_hydro_average_records(&(rec[ind_last + 1]), ind - ind_last - 1);
-
-                    // Add the mean record.
-                    g_ptr_array_add(new_rec, mean_rec);
+                    return_ptr[n_new++] = _hydro_prefix_sums_mean(&sums, rec, ind_last + 1, ind);
                 }
 
-                real_rec = sed_hydro_dup(rec[ind]);
-
-                // Add the real record.
-                g_ptr_array_add(new_rec, real_rec);
+                return_ptr[n_new++] = sed_hydro_dup(rec[ind]);
             }
 
-            if (insert_mean_values && ind < n_recs - 1) {
-                ind = n_recs;
-                mean_rec = sed_hydro_average_records(&(rec[ind_last + 1]), ind - ind_last - 1);
-
-                // Add the mean record.
-                g_ptr_array_add(new_rec, mean_rec);
+            if (insert_mean_values && ind_last < n_recs - 1) {
+                return_ptr[n_new++] = _hydro_prefix_sums_mean(&sums, rec, ind_last + 1, n_recs);
             }
 
             // Create a NULL-terminated array
-            g_ptr_array_add(new_rec, NULL);
+            return_ptr[n_new] = NULL;
         }
 
-        return_ptr = (Sed_hydro*)g_ptr_array_free(new_rec, FALSE);
+        if (insert_mean_values) {
+            eh_free(sums.sum);
+        }
 
-        g_slist_foreach(top_n, &eh_free_slist_data, NULL);
-        g_slist_free(top_n);
+        eh_free(top_n);
     }
 
     return return_ptr;
 }
 
-gint
-cmp_hydro_sort_vals(Hydro_sort_st* a, Hydro_sort_st* b)
-{
-    if (a->val < b->val) {
-        return -1;
-    } else if (a->val > b->val) {
-        return 1;
-    } else {
-        return 0;
-    }
-}
-
 gint
 cmp_hydro_sort_inds(Hydro_sort_st* a, Hydro_sort_st* b)
 {
@@ -1768,10 +1972,22 @@ Sed_hydro_file
 sed_hydro_file_set_buffer_length(Sed_hydro_file fp, gssize len)
 {
     int whence = fp->buf_cur - fp->buf_set;
+    gssize i;
+
+    eh_require(fp->prefetch_thread == NULL);
+
+    for (i = len ; i < fp->buffer_len ; i++) {
+        fp->buf_set[i] = sed_hydro_destroy(fp->buf_set[i]);
+    }
 
     fp->buf_set      = g_renew(Sed_hydro, fp->buf_set, len + 1);
+
+    for (i = fp->buffer_len ; i < len ; i++) {
+        fp->buf_set[i] = NULL;
+    }
+
     fp->buf_set[len] = NULL;
-    fp->buf_cur      = fp->buf_set + whence;
+    fp->buf_cur      = fp->buf_set + MIN(whence, len);
     fp->buffer_len   = len;
 
     return fp;
@@ -1780,6 +1996,8 @@ sed_hydro_file_set_buffer_length(Sed_hydro_file fp, gssize len)
 Sed_hydro_file
 sed_hydro_file_set_sig_values(Sed_hydro_file fp, int n_sig_values)
 {
+    eh_require(fp->prefetch_thread == NULL);
+
     fp->n_sig_values = n_sig_values;
     return fp;
 }
@@ -1796,6 +2014,36 @@ sed_hydro_file_read_record(Sed_hydro_file fp)
     return (*(fp->read_record))(fp);
 }
 
+static void
+_hydro_file_init_prefetch(Sed_hydro_file fp)
+{
+    fp->prefetch_thread  = NULL;
+    fp->prefetch_lock    = NULL;
+    fp->prefetch_cond    = NULL;
+    fp->prefetched       = NULL;
+    fp->prefetch_max     = 0;
+    fp->prefetch_is_done = FALSE;
+    fp->prefetch_stop    = FALSE;
+    fp->n_fills          = 0;
+    fp->n_waits          = 0;
+    fp->wait_timer       = NULL;
+}
+
+/* A copy of the header of a mapped hydrotrend file */
+static Sed_hydrotrend_header*
+_hydro_map_header(Sed_hydrotrend_map map)
+{
+    const Sed_hydrotrend_header* h = sed_hydrotrend_map_header(map);
+    Sed_hydrotrend_header* hdr = eh_new(Sed_hydrotrend_header, 1);
+
+    hdr->n_grains  = h->n_grains;
+    hdr->n_seasons = h->n_seasons;
+    hdr->n_samples = h->n_samples;
+    hdr->comment   = g_strdup(h->comment);
+
+    return hdr;
+}
+
 /** Create a new Sed_hydro_file
 
 \param filename       The name of the Sed_hydro_file
@@ -1822,13 +2070,33 @@ sed_hydro_file_new(const char*         filename,
 
         NEW_OBJECT(Sed_hydro_file, fp);
 
+        fp->fp     = NULL;
+        fp->map    = NULL;
+        fp->block  = NULL;
+
+        fp->stream              = NULL;
+        fp->stream_lock         = NULL;
+        fp->stream_cond         = NULL;
+        fp->stream_max_len      = 0;
+        fp->stream_is_closed    = FALSE;
+        fp->stream_is_cancelled = FALSE;
+
+        _hydro_file_init_prefetch(fp);
+
         // the 'b' (binary) option for fopen is supposed to be ignored.  however,
-        // on some windows machines, it seems to be necessary.
+        // on some windows machines, it seems to be necessary.  hydrotrend files
+        // are mapped into memory rather than read.
         if (strcmp(filename, "-") == 0) {
             fp->fp = stdin;
         } else {
             if (type == SED_HYDRO_INLINE) {
                 fp->fp = eh_fopen_error(filename, "r", &tmp_err);
+            } else if (type == SED_HYDRO_HYDROTREND) {
+                fp->map = sed_hydrotrend_map_new(filename, 0, &tmp_err);
+            } else if (type == SED_HYDRO_HYDROTREND_BE) {
+                fp->map = sed_hydrotrend_map_new(filename, G_BIG_ENDIAN, &tmp_err);
+            } else if (type == SED_HYDRO_HYDROTREND_LE) {
+                fp->map = sed_hydrotrend_map_new(filename, G_LITTLE_ENDIAN, &tmp_err);
             } else {
                 fp->fp = eh_fopen_error(filename, "rb", &tmp_err);
             }
@@ -1874,9 +2142,18 @@ sed_hydro_file_new(const char*         filename,
                     fp->read_record  = (Hydro_read_record_func)&_hydro_read_hydrotrend_record;
                 }
 
-                fp->header_start = ftell(fp->fp);
-                fp->hdr          = (*(fp->read_hdr))(fp);
-                fp->data_start   = ftell(fp->fp);
+                if (fp->map) {
+                    fp->header_start = 0;
+                    fp->hdr          = _hydro_map_header(fp->map);
+                    fp->data_start   = sed_hydrotrend_map_data_start(fp->map);
+                    fp->block        = sed_hydrotrend_block_new(fp->hdr->n_grains,
+                            HYDRO_BLOCK_LEN);
+                    fp->rec_cur      = 0;
+                } else {
+                    fp->header_start = ftell(fp->fp);
+                    fp->hdr          = (*(fp->read_hdr))(fp);
+                    fp->data_start   = ftell(fp->fp);
+                }
 
             } else if (type == SED_HYDRO_EXTERNAL) {
                 fp->buf_set = NULL;
@@ -1904,6 +2181,142 @@ sed_hydro_file_new(const char*         filename,
     return fp;
 }
 
+/** Create a Sed_hydro_file that is fed by a running model
+
+Rather than being read from a file, records are pushed into the stream (with
+sed_hydro_file_push_record) by a model that is running in another thread. The
+model must call sed_hydro_file_close_stream when it is done, or when a push
+fails because the stream was destroyed.
+
+When reading, a NULL record means that the stream was closed and all of
+its records have been read. A stream can not be rewound.
+
+\param n_grains      The number of grain sizes of each record
+\param max_len       The producer blocks once this many records are queued
+\param buffer_is_on  TRUE if records are to be buffered (and eventized)
+
+\return A new Sed_hydro_file.  Use sed_hydro_file_destroy to free.
+*/
+Sed_hydro_file
+sed_hydro_file_new_stream(gint n_grains, gint max_len, gboolean buffer_is_on)
+{
+    Sed_hydro_file fp;
+
+    eh_require(n_grains > 0);
+
+    if (!g_thread_supported()) {
+        g_thread_init(NULL);
+    }
+
+    NEW_OBJECT(Sed_hydro_file, fp);
+
+    fp->fp    = NULL;
+    fp->file  = NULL;
+    fp->type  = SED_HYDRO_STREAM;
+    fp->map   = NULL;
+    fp->block = NULL;
+
+    _hydro_file_init_prefetch(fp);
+
+    fp->hdr            = eh_new(Sed_hydrotrend_header, 1);
+    fp->hdr->n_grains  = n_grains;
+    fp->hdr->n_seasons = 0;
+    fp->hdr->n_samples = 0;
+    fp->hdr->comment   = NULL;
+    fp->read_hdr       = NULL;
+
+    if (buffer_is_on) {
+        fp->buf_set      = eh_new0(Sed_hydro, HYDRO_BUFFER_LEN + 1);
+        fp->buf_cur      = fp->buf_set;
+        fp->buffer_len   = HYDRO_BUFFER_LEN;
+        fp->n_sig_values = HYDRO_N_SIG_VALUES;
+        fp->read_record  = (Hydro_read_record_func)&_hydro_read_hydrotrend_record_buffer;
+    } else {
+        fp->buf_set      = NULL;
+        fp->buf_cur      = NULL;
+        fp->buffer_len   = 0;
+        fp->n_sig_values = 0;
+        fp->read_record  = (Hydro_read_record_func)&_hydro_read_stream_record;
+    }
+
+    fp->header_start = 0;
+    fp->data_start   = 0;
+    fp->data_size    = sizeof(float);
+    fp->wrap_is_on   = FALSE;
+
+    fp->stream              = g_queue_new();
+    fp->stream_lock         = g_mutex_new();
+    fp->stream_cond         = g_cond_new();
+    fp->stream_max_len      = MAX(max_len, 1);
+    fp->stream_is_closed    = FALSE;
+    fp->stream_is_cancelled = FALSE;
+
+    return fp;
+}
+
+/** Push a record onto a stream
+
+Called by the model feeding the stream.  The stream takes ownership of
+\a rec. If the stream is full, block until the reader has caught up.
+
+\param fp   A Sed_hydro_file created with sed_hydro_file_new_stream
+\param rec  The next record
+
+\return FALSE if the stream has been destroyed (and \a rec was freed),
+         in which case the model should stop.
+*/
+gboolean
+sed_hydro_file_push_record(Sed_hydro_file fp, Sed_hydro rec)
+{
+    gboolean is_ok;
+
+    eh_require(fp);
+    eh_require(fp->stream);
+    eh_require(rec);
+
+    g_mutex_lock(fp->stream_lock);
+
+    while (!fp->stream_is_cancelled
+        && g_queue_get_length(fp->stream) >= fp->stream_max_len) {
+        g_cond_wait(fp->stream_cond, fp->stream_lock);
+    }
+
+    is_ok = !fp->stream_is_cancelled;
+
+    if (is_ok) {
+        g_queue_push_tail(fp->stream, rec);
+        g_cond_broadcast(fp->stream_cond);
+    }
+
+    g_mutex_unlock(fp->stream_lock);
+
+    if (!is_ok) {
+        sed_hydro_destroy(rec);
+    }
+
+    return is_ok;
+}
+
+/** Mark the end of a stream
+
+The model feeding the stream must call this once, when it is done pushing
+records (whether or not it finished), after which it must no longer use
+\a fp.
+
+\param fp   A Sed_hydro_file created with sed_hydro_file_new_stream
+*/
+void
+sed_hydro_file_close_stream(Sed_hydro_file fp)
+{
+    eh_require(fp);
+    eh_require(fp->stream);
+
+    g_mutex_lock(fp->stream_lock);
+    fp->stream_is_closed = TRUE;
+    g_cond_broadcast(fp->stream_cond);
+    g_mutex_unlock(fp->stream_lock);
+}
+
 /** Destroy a Sed_hydro_file
 
 \param fp A Sed_hydro_file to destroy
@@ -1916,7 +2329,66 @@ sed_hydro_file_destroy(Sed_hydro_file fp)
     eh_return_val_if_fail(fp, NULL);
 
     if (fp) {
-        fclose(fp->fp);
+        if (fp->prefetch_thread) {
+            g_mutex_lock(fp->prefetch_lock);
+            fp->prefetch_stop = TRUE;
+            g_cond_broadcast(fp->prefetch_cond);
+            g_mutex_unlock(fp->prefetch_lock);
+        }
+
+        if (fp->stream) {
+            // tell the producer to stop and wait until it has let go of the
+            // stream before freeing it.
+            g_mutex_lock(fp->stream_lock);
+            fp->stream_is_cancelled = TRUE;
+            g_cond_broadcast(fp->stream_cond);
+
+            while (!fp->stream_is_closed) {
+                g_cond_wait(fp->stream_cond, fp->stream_lock);
+            }
+
+            g_mutex_unlock(fp->stream_lock);
+        }
+
+        // the prefetcher finishes the buffer it is reading (a cancelled
+        // stream soon runs dry) and then quits.
+        if (fp->prefetch_thread) {
+            Sed_hydro* buf;
+
+            g_thread_join(fp->prefetch_thread);
+
+            while ((buf = (Sed_hydro*)g_queue_pop_head(fp->prefetched))) {
+                sed_hydro_array_destroy(buf);
+            }
+
+            g_queue_free(fp->prefetched);
+            g_cond_free(fp->prefetch_cond);
+            g_mutex_free(fp->prefetch_lock);
+        }
+
+        if (fp->wait_timer) {
+            g_timer_destroy(fp->wait_timer);
+        }
+
+        if (fp->stream) {
+            Sed_hydro rec;
+
+            while ((rec = (Sed_hydro)g_queue_pop_head(fp->stream))) {
+                sed_hydro_destroy(rec);
+            }
+
+            g_queue_free(fp->stream);
+            g_cond_free(fp->stream_cond);
+            g_mutex_free(fp->stream_lock);
+        }
+
+        if (fp->fp) {
+            fclose(fp->fp);
+        }
+
+        sed_hydrotrend_map_destroy(fp->map);
+        sed_hydrotrend_block_destroy(fp->block);
+
         eh_free(fp->file);
 
         if (fp->buf_set) {
@@ -1996,6 +2468,10 @@ _hydro_read_hydrotrend_record(Sed_hydro_file fp)
 {
     Sed_hydro rec;
 
+    if (fp->map) {
+        return _hydro_file_next_record(fp);
+    }
+
     // read the record using the appropriate function.  if we encounter the end of
     // the file, start reading from the beginning of the data.  if wrap is off,
     // return with an error.
@@ -2017,57 +2493,234 @@ _hydro_read_hydrotrend_record(Sed_hydro_file fp)
 Sed_hydro
 _hydro_read_hydrotrend_record_buffer(Sed_hydro_file fp)
 {
+    Sed_hydro rec;
+
     // if we are at the end of the buffer we must create a new buffer.
-    // otherwise just return the next record in the buffer.
+    // otherwise just return the next record in the buffer.  a stream that
+    // has run dry leaves the new buffer empty.
     if (*(fp->buf_cur) == NULL) {
         sed_hydro_file_fill_buffer(fp);
+
+        if (*(fp->buf_cur) == NULL) {
+            return NULL;
+        }
     }
 
+    // the buffer is refilled before it is looked at again, so hand over the
+    // record rather than copy it.
     fp->buf_cur += 1;
 
-    return sed_hydro_dup(fp->buf_cur[-1]);
+    rec = fp->buf_cur[-1];
+
+    fp->buf_cur[-1] = NULL;
+
+    return rec;
 }
 
-Sed_hydro*
-sed_hydro_file_fill_buffer(Sed_hydro_file fp)
+/* Pop the next record from a stream.  Block until the model has pushed one
+   or closed the stream.  NULL once the stream is closed and empty.
+*/
+static Sed_hydro
+_hydro_read_stream_record(Sed_hydro_file fp)
 {
-    int i;
-    int buffer_len         = fp->buffer_len;
-    int n_sig_values       = fp->n_sig_values;
-    Sed_hydro* temp_buffer = eh_new(Sed_hydro, buffer_len);
-    Sed_hydro* buf_set;
+    Sed_hydro rec;
 
-    for (i = 0 ; i < buffer_len ; i++) {
-        fp->buf_set[i] = sed_hydro_destroy(fp->buf_set[i]);
+    g_mutex_lock(fp->stream_lock);
+
+    while (g_queue_is_empty(fp->stream) && !fp->stream_is_closed) {
+        g_cond_wait(fp->stream_cond, fp->stream_lock);
     }
 
-    for (i = 0 ; i < buffer_len ; i++) {
-        temp_buffer[i] = sed_hydrotrend_read_next_rec(fp->fp, fp->hdr->n_grains);
+    rec = (Sed_hydro)g_queue_pop_head(fp->stream);
 
-        if (feof(fp->fp)) {
-            if (fp->wrap_is_on) {
-                clearerr(fp->fp);
-                fseek(fp->fp, fp->data_start, SEEK_SET);
-                temp_buffer[i] = sed_hydrotrend_read_next_rec(fp->fp, fp->hdr->n_grains);
+    if (rec) {
+        g_cond_broadcast(fp->stream_cond);
+    }
+
+    g_mutex_unlock(fp->stream_lock);
+
+    return rec;
+}
+
+/* The next raw record of a hydrotrend file or stream, used to fill the
+   buffer.  NULL only at the end of a stream.
+*/
+static Sed_hydro
+_hydro_file_next_record(Sed_hydro_file fp)
+{
+    Sed_hydro rec;
+
+    if (fp->stream) {
+        return _hydro_read_stream_record(fp);
+    }
+
+    if (fp->map) {
+        Sed_hydrotrend_block* b = fp->block;
+
+        if (fp->rec_cur >= sed_hydrotrend_map_n_recs(fp->map)) {
+            if (fp->wrap_is_on && sed_hydrotrend_map_n_recs(fp->map) > 0) {
+                fp->rec_cur = 0;
             } else {
                 eh_error("Encountered end of the file");
             }
         }
+
+        // decode the next block of records if this one isn't in the current one
+        if (fp->rec_cur < b->rec_0 || fp->rec_cur >= b->rec_0 + b->n_recs) {
+            sed_hydrotrend_map_decode(fp->map, fp->rec_cur, b->max_recs, b);
+        }
+
+        rec = sed_hydrotrend_block_record(b, fp->rec_cur - b->rec_0);
+
+        fp->rec_cur++;
+
+        return rec;
     }
 
-    buf_set = sed_hydro_process_records(temp_buffer, buffer_len, n_sig_values, TRUE);
+    rec = sed_hydrotrend_read_next_rec(fp->fp, fp->hdr->n_grains);
 
-    for (i = 0 ; buf_set[i] ; i++) {
-        fp->buf_set[i] = buf_set[i];
+    if (feof(fp->fp)) {
+        if (fp->wrap_is_on) {
+            clearerr(fp->fp);
+            fseek(fp->fp, fp->data_start, SEEK_SET);
+            rec = sed_hydrotrend_read_next_rec(fp->fp, fp->hdr->n_grains);
+        } else {
+            eh_error("Encountered end of the file");
+        }
     }
 
-    fp->buf_set[i] = NULL;
+    return rec;
+}
+
+/* Read the next buffer_len records and reduce them to their significant
+   events.  The new array is empty at the end of a stream.
+*/
+static Sed_hydro*
+_hydro_file_next_buffer(Sed_hydro_file fp)
+{
+    const gint buffer_len  = fp->buffer_len;
+    Sed_hydro* temp_buffer = eh_new(Sed_hydro, buffer_len);
+    Sed_hydro* buf_set;
+    gint i, n_recs;
+
+    for (i = 0, n_recs = 0 ; i < buffer_len ; i++, n_recs++) {
+        temp_buffer[i] = _hydro_file_next_record(fp);
+
+        if (!temp_buffer[i]) {
+            break;
+        }
+    }
+
+    if (n_recs > 0) {
+        buf_set = sed_hydro_process_records(temp_buffer, n_recs,
+                MIN(fp->n_sig_values, n_recs), TRUE);
+    } else {
+        buf_set = eh_new0(Sed_hydro, 1);
+    }
 
-    for (i = 0 ; i < buffer_len ; i++) {
+    for (i = 0 ; i < n_recs ; i++) {
         temp_buffer[i] = sed_hydro_destroy(temp_buffer[i]);
     }
 
     eh_free(temp_buffer);
+
+    return buf_set;
+}
+
+static gpointer
+_hydro_file_prefetch(gpointer data)
+{
+    Sed_hydro_file fp = (Sed_hydro_file)data;
+    gboolean is_done = FALSE;
+
+    while (!is_done) {
+        Sed_hydro* buf;
+
+        g_mutex_lock(fp->prefetch_lock);
+
+        while (!fp->prefetch_stop
+            && g_queue_get_length(fp->prefetched) >= fp->prefetch_max) {
+            g_cond_wait(fp->prefetch_cond, fp->prefetch_lock);
+        }
+
+        is_done = fp->prefetch_stop;
+
+        g_mutex_unlock(fp->prefetch_lock);
+
+        if (!is_done) {
+            buf = _hydro_file_next_buffer(fp);
+
+            // an empty buffer means the stream ran dry; it is passed on to
+            // the reader all the same.
+            is_done = (buf[0] == NULL);
+
+            g_mutex_lock(fp->prefetch_lock);
+            g_queue_push_tail(fp->prefetched, buf);
+            fp->prefetch_is_done = is_done;
+            g_cond_broadcast(fp->prefetch_cond);
+            g_mutex_unlock(fp->prefetch_lock);
+        }
+    }
+
+    return NULL;
+}
+
+/* The next eventized buffer from the prefetcher, waiting for it if need be */
+static Sed_hydro*
+_hydro_file_take_prefetched(Sed_hydro_file fp)
+{
+    Sed_hydro* buf;
+
+    g_mutex_lock(fp->prefetch_lock);
+
+    if (g_queue_is_empty(fp->prefetched) && !fp->prefetch_is_done) {
+        fp->n_waits++;
+
+        g_timer_continue(fp->wait_timer);
+
+        while (g_queue_is_empty(fp->prefetched) && !fp->prefetch_is_done) {
+            g_cond_wait(fp->prefetch_cond, fp->prefetch_lock);
+        }
+
+        g_timer_stop(fp->wait_timer);
+    }
+
+    buf = (Sed_hydro*)g_queue_pop_head(fp->prefetched);
+
+    g_cond_broadcast(fp->prefetch_cond);
+    g_mutex_unlock(fp->prefetch_lock);
+
+    if (!buf) {
+        buf = eh_new0(Sed_hydro, 1);
+    }
+
+    return buf;
+}
+
+Sed_hydro*
+sed_hydro_file_fill_buffer(Sed_hydro_file fp)
+{
+    Sed_hydro* buf_set;
+    int i;
+
+    for (i = 0 ; i < fp->buffer_len ; i++) {
+        fp->buf_set[i] = sed_hydro_destroy(fp->buf_set[i]);
+    }
+
+    if (fp->prefetch_thread) {
+        buf_set = _hydro_file_take_prefetched(fp);
+    } else {
+        buf_set = _hydro_file_next_buffer(fp);
+    }
+
+    fp->n_fills++;
+
+    for (i = 0 ; buf_set[i] ; i++) {
+        fp->buf_set[i] = buf_set[i];
+    }
+
+    fp->buf_set[i] = NULL;
+
     eh_free(buf_set);
 
     fp->buf_cur = fp->buf_set;
@@ -2075,3 +2728,92 @@ sed_hydro_file_fill_buffer(Sed_hydro_file fp)
     return fp->buf_set;
 }
 
+/** Read and eventize buffers of a Sed_hydro_file in the background
+
+A thread reads the next \a n_buffers buffers ahead of the one being used.
+It wraps the file as needed, so that refilling the buffer only has to wait
+if the thread has fallen behind.  This only applies to buffered HydroTrend
+files and streams, and must be set before the first record is read.
+
+\param fp         A Sed_hydro_file
+\param n_buffers  The number of buffers to read ahead (0 to read them as
+                  they are needed)
+
+\return TRUE if the prefetcher was started.
+*/
+gboolean
+sed_hydro_file_set_prefetch(Sed_hydro_file fp, gint n_buffers)
+{
+    gboolean is_started = FALSE;
+
+    eh_require(fp);
+    eh_require(fp->prefetch_thread == NULL);
+
+    if (fp && fp->buf_set && n_buffers > 0
+        && fp->read_record == (Hydro_read_record_func)&_hydro_read_hydrotrend_record_buffer) {
+        GError* error = NULL;
+
+        if (!g_thread_supported()) {
+            g_thread_init(NULL);
+        }
+
+        fp->prefetch_lock    = g_mutex_new();
+        fp->prefetch_cond    = g_cond_new();
+        fp->prefetched       = g_queue_new();
+        fp->prefetch_max     = n_buffers;
+        fp->prefetch_is_done = FALSE;
+        fp->prefetch_stop    = FALSE;
+
+        if (!fp->wait_timer) {
+            fp->wait_timer = g_timer_new();
+            g_timer_stop(fp->wait_timer);
+        }
+
+        fp->prefetch_thread = g_thread_create(_hydro_file_prefetch, fp, TRUE, &error);
+
+        if (error) {
+            eh_warning("Unable to start river prefetch thread: %s", error->message);
+            g_error_free(error);
+
+            g_queue_free(fp->prefetched);
+            g_cond_free(fp->prefetch_cond);
+            g_mutex_free(fp->prefetch_lock);
+
+            _hydro_file_init_prefetch(fp);
+        } else {
+            is_started = TRUE;
+        }
+    }
+
+    return is_started;
+}
+
+/** Number of times the buffer of a Sed_hydro_file has been refilled */
+gint
+sed_hydro_file_n_fills(Sed_hydro_file fp)
+{
+    return (fp) ? fp->n_fills : 0;
+}
+
+/** Number of buffer refills that had to wait for the prefetcher */
+gint
+sed_hydro_file_n_waits(Sed_hydro_file fp)
+{
+    gint n = 0;
+
+    if (fp && fp->prefetch_thread) {
+        g_mutex_lock(fp->prefetch_lock);
+        n = fp->n_waits;
+        g_mutex_unlock(fp->prefetch_lock);
+    }
+
+    return n;
+}
+
+/** Time (in seconds) spent waiting for the prefetcher */
+double
+sed_hydro_file_wait_time(Sed_hydro_file fp)
+{
+    return (fp && fp->wait_timer) ? g_timer_elapsed(fp->wait_timer, NULL) : 0.;
+}
+
@@ -69,6 +69,7 @@ Sed_hydro_error;
 //#define HYDRO_USE_BUFFER    (1<<2)
 #define HYDRO_BUFFER_LEN    (365)
 #define HYDRO_N_SIG_VALUES  (10)
+#define HYDRO_BLOCK_LEN     (4096)
 
 typedef enum {
     SED_HYDRO_INLINE,
@@ -76,6 +77,7 @@ typedef enum {
     SED_HYDRO_HYDROTREND_BE,
     SED_HYDRO_HYDROTREND_LE,
     SED_HYDRO_EXTERNAL,
+    SED_HYDRO_STREAM,
     SED_HYDRO_UNKNOWN
 }
 Sed_hydro_file_type;
@@ -279,9 +281,23 @@ sed_hydro_file_new(const char*         filename,
     gboolean            wrap_is_on,
     GError** error);
 Sed_hydro_file
+sed_hydro_file_new_stream(gint n_grains, gint max_len, gboolean buffer_is_on);
+gboolean
+sed_hydro_file_push_record(Sed_hydro_file fp, Sed_hydro rec);
+void
+sed_hydro_file_close_stream(Sed_hydro_file fp);
+Sed_hydro_file
 sed_hydro_file_destroy(Sed_hydro_file fp);
 Sed_hydro*
 sed_hydro_file_fill_buffer(Sed_hydro_file fp);
+gboolean
+sed_hydro_file_set_prefetch(Sed_hydro_file fp, gint n_buffers);
+gint
+sed_hydro_file_n_fills(Sed_hydro_file fp);
+gint
+sed_hydro_file_n_waits(Sed_hydro_file fp);
+double
+sed_hydro_file_wait_time(Sed_hydro_file fp);
 
 G_END_DECLS
 
@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <string.h>
 #include <glib.h>
 
 #include "utils/utils.h"
@@ -11,6 +12,30 @@ sed_hydrotrend_error_quark(void)
     return g_quark_from_static_string("sed-hydrorend-error-quark");
 }
 
+/* Records with up to this many grains are read into a buffer on the stack */
+#define SED_HYDROTREND_STACK_GRAINS (32)
+
+/* A Sed_hydro from the values of a HydroTrend record: velocity, width, depth,
+   bedload and then the concentration of each grain.
+*/
+static Sed_hydro
+_sed_hydrotrend_values_to_hydro(const float* fval, gint n_grains)
+{
+    Sed_hydro rec = sed_hydro_new(n_grains);
+    gint i;
+
+    sed_hydro_set_velocity(rec, fval[0]);
+    sed_hydro_set_width(rec, fval[1]);
+    sed_hydro_set_depth(rec, fval[2]);
+    sed_hydro_set_bedload(rec, fval[3]);
+
+    for (i = 0 ; i < n_grains ; i++) {
+        sed_hydro_set_nth_concentration(rec, i, fval[i + 4]);
+    }
+
+    return rec;
+}
+
 // Functions to read/write a standard HydroTrend output file.
 /** Read the header of a HydroTrend file.
 
@@ -314,7 +339,8 @@ Sed_hydro
 sed_hydrotrend_read_next_rec_from_byte_order(FILE* fp, int n_grains, gint order)
 {
     int n;
-    float* fval = eh_new(float, 4 + n_grains);
+    float buf[4 + SED_HYDROTREND_STACK_GRAINS];
+    float* fval = (n_grains <= SED_HYDROTREND_STACK_GRAINS) ? buf : eh_new(float, 4 + n_grains);
     Sed_hydro rec = NULL;
 
     if (order == G_BYTE_ORDER) {
@@ -324,21 +350,12 @@ sed_hydrotrend_read_next_rec_from_byte_order(FILE* fp, int n_grains, gint order)
     }
 
     if (n == 4 + n_grains) {
-        gint i;
-
-        rec = sed_hydro_new(n_grains);
-
-        sed_hydro_set_velocity(rec, fval[0]);
-        sed_hydro_set_width(rec, fval[1]);
-        sed_hydro_set_depth(rec, fval[2]);
-        sed_hydro_set_bedload(rec, fval[3]);
-
-        for (i = 0 ; i < n_grains ; i++) {
-            sed_hydro_set_nth_concentration(rec, i, fval[i + 4]);
-        }
+        rec = _sed_hydrotrend_values_to_hydro(fval, n_grains);
     }
 
-    eh_free(fval);
+    if (fval != buf) {
+        eh_free(fval);
+    }
 
     return rec;
 }
@@ -473,42 +490,34 @@ sed_hydrotrend_read_n_recs(const gchar* file, gint n_recs, gint byte_order,
     eh_return_val_if_fail(error == NULL || *error == NULL, NULL);
 
     if (file && n_recs != 0) {
-        GError* err    = NULL;
-        FILE*   fp     = eh_fopen_error(file, "r", &err);
+        GError* err = NULL;
+        Sed_hydrotrend_map m = sed_hydrotrend_map_new(file, byte_order, &err);
 
-        if (!err) {
-            Sed_hydrotrend_header* h = NULL;
+        if (m) {
+            const Sed_hydrotrend_header* h = sed_hydrotrend_map_header(m);
+            gint n_read;
 
-            h = sed_hydrotrend_read_header_from_byte_order(fp, byte_order);
-
-            if (h) {
-                if (n_recs < 0) {
-                    n_recs = h->n_samples;
-                } else if (n_recs > h->n_samples) {
-                    n_recs = h->n_samples;
-                }
+            if (n_recs < 0) {
+                n_recs = h->n_samples;
+            } else if (n_recs > h->n_samples) {
+                n_recs = h->n_samples;
+            }
 
-                arr = sed_hydrotrend_read_recs(fp, 0, n_recs, byte_order, &err);
+            n_read = MIN(n_recs, sed_hydrotrend_map_n_recs(m));
 
-                if (n_seasons) {
-                    *n_seasons = h->n_seasons;
-                }
+            arr = sed_hydrotrend_map_read_recs(m, 0, n_read);
 
-                if (!err) {
-                    gint n_read = g_strv_length((gchar**)arr);
-
-                    if (n_read != n_recs) {
-                        eh_warning("Number of items read does not match number of items in header");
-                        eh_debug("Number of items in header : %d", h->n_samples);
-                        eh_debug("Number of items read      : %d", n_read);
-                    }
-                } else {
-                    g_propagate_error(error, err);
-                }
+            if (n_seasons) {
+                *n_seasons = h->n_seasons;
+            }
 
-                eh_free(h->comment);
-                eh_free(h);
+            if (n_read != n_recs) {
+                eh_warning("Number of items read does not match number of items in header");
+                eh_debug("Number of items in header : %d", h->n_samples);
+                eh_debug("Number of items read      : %d", n_read);
             }
+
+            sed_hydrotrend_map_destroy(m);
         } else {
             g_propagate_error(error, err);
         }
@@ -743,3 +752,410 @@ sed_hydrotrend_data_start(FILE* fp, gint byte_order, Sed_hydrotrend_header* h)
     return n;
 }
 
+
+CLASS(Sed_hydrotrend_map)
+{
+    gchar*                 file;
+    GMappedFile*           map;
+    const guint8*          data;       ///< The first record
+    gint                   byte_order;
+    gint                   rec_len;    ///< Number of values in a record
+    gint                   n_recs;
+    Sed_hydrotrend_header* hdr;
+};
+
+static void
+_sed_hydrotrend_mapped_file_free(GMappedFile* map)
+{
+#if GLIB_CHECK_VERSION(2,22,0)
+    g_mapped_file_unref(map);
+#else
+    g_mapped_file_free(map);
+#endif
+}
+
+static gint32
+_sed_hydrotrend_get_int32(const guint8* p, gboolean swap)
+{
+    gint32 val;
+
+    memcpy(&val, p, sizeof(gint32));
+
+    return swap ? GINT32_SWAP_LE_BE(val) : val;
+}
+
+/* Parse the header at the start of a mapped HydroTrend file.  NULL if it
+   isn't a valid header for the byte order, otherwise set the length of the
+   header.
+*/
+static Sed_hydrotrend_header*
+_sed_hydrotrend_parse_header(const guint8* data, gsize len, gint order, gsize* hdr_len)
+{
+    Sed_hydrotrend_header* hdr = NULL;
+    const gboolean swap = (order != G_BYTE_ORDER);
+
+    if (data && len >= sizeof(gint32)) {
+        const gint32 n = _sed_hydrotrend_get_int32(data, swap);
+
+        if (n >= 0 && n < 2048 && len >= sizeof(gint32) * 4 + n) {
+            const guint8* p = data + sizeof(gint32) + n;
+
+            hdr = eh_new(Sed_hydrotrend_header, 1);
+
+            hdr->n_grains  = _sed_hydrotrend_get_int32(p, swap);
+            hdr->n_seasons = _sed_hydrotrend_get_int32(p + sizeof(gint32), swap);
+            hdr->n_samples = _sed_hydrotrend_get_int32(p + 2 * sizeof(gint32), swap);
+            hdr->comment   = NULL;
+
+            if (hdr->n_grains <= 0 || hdr->n_seasons <= 0 || hdr->n_samples <= 0) {
+                eh_free(hdr);
+                hdr = NULL;
+            } else {
+                gchar* str = g_strndup((const gchar*)data + sizeof(gint32), n);
+
+                hdr->comment = g_strescape(str, "\\");
+                eh_free(str);
+
+                *hdr_len = sizeof(gint32) * 4 + n;
+            }
+        }
+    }
+
+    return hdr;
+}
+
+/** Memory-map a HydroTrend file
+
+The records of the file are decoded only as they are asked for, either one at
+a time (with sed_hydrotrend_map_record) or in blocks (with
+sed_hydrotrend_map_decode).
+
+\param file        The HydroTrend file
+\param byte_order  The byte order of the file, or 0 to guess
+\param error       A GError
+
+\return A new Sed_hydrotrend_map.  Use sed_hydrotrend_map_destroy to free.
+*/
+Sed_hydrotrend_map
+sed_hydrotrend_map_new(const gchar* file, gint byte_order, GError** error)
+{
+    Sed_hydrotrend_map m = NULL;
+
+    eh_return_val_if_fail(error == NULL || *error == NULL, NULL);
+    eh_require(file);
+
+    if (file) {
+        GError* tmp_err = NULL;
+        GMappedFile* map = g_mapped_file_new(file, FALSE, &tmp_err);
+
+        if (map) {
+            const guint8* data = (const guint8*)g_mapped_file_get_contents(map);
+            const gsize   len  = g_mapped_file_get_length(map);
+            gsize hdr_len = 0;
+            Sed_hydrotrend_header* hdr = NULL;
+
+            if (byte_order == G_BIG_ENDIAN || byte_order == G_LITTLE_ENDIAN) {
+                hdr = _sed_hydrotrend_parse_header(data, len, byte_order, &hdr_len);
+            } else {
+                byte_order = G_BYTE_ORDER;
+                hdr = _sed_hydrotrend_parse_header(data, len, byte_order, &hdr_len);
+
+                if (!hdr) {
+                    byte_order = (G_BYTE_ORDER == G_BIG_ENDIAN) ? G_LITTLE_ENDIAN : G_BIG_ENDIAN;
+                    hdr = _sed_hydrotrend_parse_header(data, len, byte_order, &hdr_len);
+                }
+            }
+
+            if (hdr) {
+                NEW_OBJECT(Sed_hydrotrend_map, m);
+
+                m->file       = g_strdup(file);
+                m->map        = map;
+                m->data       = data + hdr_len;
+                m->byte_order = byte_order;
+                m->rec_len    = 4 + hdr->n_grains;
+                m->n_recs     = (len - hdr_len) / (m->rec_len * sizeof(float));
+                m->hdr        = hdr;
+            } else {
+                g_set_error(&tmp_err, SED_HYDROTREND_ERROR, SED_HYDROTREND_ERROR_BAD_HEADER,
+                    "%s: Not a HydroTrend file (or not of the given byte order)", file);
+                _sed_hydrotrend_mapped_file_free(map);
+            }
+        }
+
+        if (tmp_err) {
+            g_propagate_error(error, tmp_err);
+        }
+    }
+
+    return m;
+}
+
+Sed_hydrotrend_map
+sed_hydrotrend_map_destroy(Sed_hydrotrend_map m)
+{
+    if (m) {
+        _sed_hydrotrend_mapped_file_free(m->map);
+        sed_hydrotrend_header_destroy(m->hdr);
+        eh_free(m->file);
+        eh_free(m);
+    }
+
+    return NULL;
+}
+
+const Sed_hydrotrend_header*
+sed_hydrotrend_map_header(Sed_hydrotrend_map m)
+{
+    eh_require(m);
+    return m->hdr;
+}
+
+/** The number of (complete) records in the file
+
+This is found from the file size, which need not agree with the number of
+samples given in the header.
+*/
+gint
+sed_hydrotrend_map_n_recs(Sed_hydrotrend_map m)
+{
+    eh_require(m);
+    return m->n_recs;
+}
+
+gint
+sed_hydrotrend_map_n_grains(Sed_hydrotrend_map m)
+{
+    eh_require(m);
+    return m->hdr->n_grains;
+}
+
+gint
+sed_hydrotrend_map_byte_order(Sed_hydrotrend_map m)
+{
+    eh_require(m);
+    return m->byte_order;
+}
+
+/** The offset (in bytes) from the start of the file to the first record */
+gsize
+sed_hydrotrend_map_data_start(Sed_hydrotrend_map m)
+{
+    eh_require(m);
+    return m->data - (const guint8*)g_mapped_file_get_contents(m->map);
+}
+
+/* Copy n_vals values from the map into vals, swapping bytes if needed. */
+static void
+_sed_hydrotrend_map_copy(Sed_hydrotrend_map m, float* vals, const guint8* src, gsize n_vals)
+{
+    if (m->byte_order == G_BYTE_ORDER) {
+        memcpy(vals, src, n_vals * sizeof(float));
+    } else {
+        eh_swap_int32_array(vals, src, n_vals);
+    }
+}
+
+/** Read a record from a mapped HydroTrend file
+
+\param m   A Sed_hydrotrend_map
+\param i   Index of the record (starting from 0)
+
+\return A newly-created Sed_hydro, or NULL if there is no such record.
+*/
+Sed_hydro
+sed_hydrotrend_map_record(Sed_hydrotrend_map m, gint i)
+{
+    Sed_hydro rec = NULL;
+
+    eh_require(m);
+
+    if (i >= 0 && i < m->n_recs) {
+        float buf[4 + SED_HYDROTREND_STACK_GRAINS];
+        float* fval = (m->rec_len <= 4 + SED_HYDROTREND_STACK_GRAINS) ? buf : eh_new(float, m->rec_len);
+
+        _sed_hydrotrend_map_copy(m, fval, m->data + (gsize)i * m->rec_len * sizeof(float),
+            m->rec_len);
+
+        rec = _sed_hydrotrend_values_to_hydro(fval, m->hdr->n_grains);
+
+        if (fval != buf) {
+            eh_free(fval);
+        }
+    }
+
+    return rec;
+}
+
+/** Read a series of records from a mapped HydroTrend file
+
+\param m       A Sed_hydrotrend_map
+\param rec_0   Index of the first record to read
+\param n_recs  Number of records to read (or -1 to read to the end)
+
+\return A newly-allocated, NULL-terminated Sed_hydro array
+*/
+Sed_hydro*
+sed_hydrotrend_map_read_recs(Sed_hydrotrend_map m, gint rec_0, gint n_recs)
+{
+    Sed_hydro* rec_a;
+    Sed_hydrotrend_block* b;
+    gint n, i;
+
+    eh_require(m);
+    eh_require(rec_0 >= 0);
+
+    if (n_recs < 0 || n_recs > m->n_recs - rec_0) {
+        n_recs = MAX(m->n_recs - rec_0, 0);
+    }
+
+    rec_a = eh_new(Sed_hydro, n_recs + 1);
+    b     = sed_hydrotrend_block_new(m->hdr->n_grains, MIN(MAX(n_recs, 1), 4096));
+
+    for (n = 0 ; n < n_recs ; ) {
+        const gint len = sed_hydrotrend_map_decode(m, rec_0 + n, n_recs - n, b);
+
+        for (i = 0 ; i < len ; i++, n++) {
+            rec_a[n] = sed_hydrotrend_block_record(b, i);
+        }
+    }
+
+    rec_a[n_recs] = NULL;
+
+    sed_hydrotrend_block_destroy(b);
+
+    return rec_a;
+}
+
+/** Create a block to decode HydroTrend records into
+
+\param n_grains  The number of suspended grains of each record
+\param max_recs  The number of records the block can hold
+
+\return A new Sed_hydrotrend_block.  Use sed_hydrotrend_block_destroy to free.
+*/
+Sed_hydrotrend_block*
+sed_hydrotrend_block_new(gint n_grains, gint max_recs)
+{
+    Sed_hydrotrend_block* b = eh_new(Sed_hydrotrend_block, 1);
+    gint n;
+
+    eh_require(n_grains > 0);
+    eh_require(max_recs > 0);
+
+    b->rec_0    = 0;
+    b->n_recs   = 0;
+    b->n_grains = n_grains;
+    b->max_recs = max_recs;
+
+    // one array for all of the values, and one for the records as they are in
+    // the file.
+    b->velocity = eh_new(float, 2 * (gsize)(4 + n_grains) * max_recs);
+    b->width    = b->velocity + max_recs;
+    b->depth    = b->width    + max_recs;
+    b->bedload  = b->depth    + max_recs;
+    b->conc     = eh_new(float*, n_grains);
+    b->raw      = b->velocity + (gsize)(4 + n_grains) * max_recs;
+
+    for (n = 0 ; n < n_grains ; n++) {
+        b->conc[n] = b->bedload + (gsize)(n + 1) * max_recs;
+    }
+
+    return b;
+}
+
+Sed_hydrotrend_block*
+sed_hydrotrend_block_destroy(Sed_hydrotrend_block* b)
+{
+    if (b) {
+        eh_free(b->velocity);
+        eh_free(b->conc);
+        eh_free(b);
+    }
+
+    return NULL;
+}
+
+/** Decode a series of records from a mapped HydroTrend file
+
+Records are byte swapped (if need be) in one pass and then split into the
+arrays of the block.
+
+\param m       A Sed_hydrotrend_map
+\param rec_0   Index of the first record to decode
+\param n_recs  The number of records to decode
+\param b       The block to decode into
+
+\return The number of records decoded.  This is less than \a n_recs if the
+         block is too small or the end of the file is reached.
+*/
+gint
+sed_hydrotrend_map_decode(Sed_hydrotrend_map m, gint rec_0, gint n_recs,
+    Sed_hydrotrend_block* b)
+{
+    gint i, n;
+
+    eh_require(m);
+    eh_require(b);
+    eh_require(b->n_grains == m->hdr->n_grains);
+    eh_require(rec_0 >= 0);
+
+    n_recs = MIN(n_recs, MIN(b->max_recs, m->n_recs - rec_0));
+    n_recs = MAX(n_recs, 0);
+
+    _sed_hydrotrend_map_copy(m, b->raw, m->data + (gsize)rec_0 * m->rec_len * sizeof(float),
+        (gsize)n_recs * m->rec_len);
+
+    for (i = 0 ; i < n_recs ; i++) {
+        const float* r = b->raw + (gsize)i * m->rec_len;
+
+        b->velocity[i] = r[0];
+        b->width[i]    = r[1];
+        b->depth[i]    = r[2];
+        b->bedload[i]  = r[3];
+    }
+
+    for (n = 0 ; n < b->n_grains ; n++) {
+        const float* r = b->raw + 4 + n;
+        float* c = b->conc[n];
+
+        for (i = 0 ; i < n_recs ; i++) {
+            c[i] = r[(gsize)i * m->rec_len];
+        }
+    }
+
+    b->rec_0  = rec_0;
+    b->n_recs = n_recs;
+
+    return n_recs;
+}
+
+/** A Sed_hydro from the i-th record of a block
+
+\param b   A Sed_hydrotrend_block
+\param i   Index into the block (not the file)
+
+\return A newly-created Sed_hydro.
+*/
+Sed_hydro
+sed_hydrotrend_block_record(const Sed_hydrotrend_block* b, gint i)
+{
+    Sed_hydro rec;
+    gint n;
+
+    eh_require(b);
+    eh_require(i >= 0 && i < b->n_recs);
+
+    rec = sed_hydro_new(b->n_grains);
+
+    sed_hydro_set_velocity(rec, b->velocity[i]);
+    sed_hydro_set_width(rec, b->width[i]);
+    sed_hydro_set_depth(rec, b->depth[i]);
+    sed_hydro_set_bedload(rec, b->bedload[i]);
+
+    for (n = 0 ; n < b->n_grains ; n++) {
+        sed_hydro_set_nth_concentration(rec, n, b->conc[n][i]);
+    }
+
+    return rec;
+}
@@ -43,6 +43,27 @@ Sed_hydrotrend_error;
 
 #include <sed/sed_hydro.h>
 
+new_handle(Sed_hydrotrend_map);
+
+/** HydroTrend records decoded into one array per variable
+
+The arrays are all of length max_recs, of which the first n_recs hold
+records rec_0, rec_0+1, ... of the file.
+*/
+typedef struct {
+    gint    rec_0;     ///< Index of the first record of the block
+    gint    n_recs;    ///< Number of records in the block
+    gint    n_grains;  ///< Number of suspended grain sizes
+    gint    max_recs;  ///< Number of records the block can hold
+    float*  velocity;  ///< River velocity (m/s)
+    float*  width;     ///< River width (m)
+    float*  depth;     ///< River depth (m)
+    float*  bedload;   ///< Bedload flux (kg/s)
+    float** conc;      ///< conc[n] is the concentration of grain n (kg/m^3)
+    float*  raw;       ///< Records as they are in the file
+}
+Sed_hydrotrend_block;
+
 // Read and write HydroTend header information.
 Sed_hydrotrend_header*
 sed_hydrotrend_read_header(FILE* fp);
@@ -107,6 +128,36 @@ sed_hydro_array_write_hydrotrend_records_to_byte_order(FILE* fp, Sed_hydro* rec_
 gssize
 sed_hydro_array_write_hydrotrend_records(FILE* fp, Sed_hydro* rec_a);
 
+// Memory-mapped HydroTrend files
+Sed_hydrotrend_map
+sed_hydrotrend_map_new(const gchar* file, gint byte_order, GError** error);
+Sed_hydrotrend_map
+sed_hydrotrend_map_destroy(Sed_hydrotrend_map m);
+const Sed_hydrotrend_header*
+sed_hydrotrend_map_header(Sed_hydrotrend_map m);
+gint
+sed_hydrotrend_map_n_recs(Sed_hydrotrend_map m);
+gint
+sed_hydrotrend_map_n_grains(Sed_hydrotrend_map m);
+gint
+sed_hydrotrend_map_byte_order(Sed_hydrotrend_map m);
+gsize
+sed_hydrotrend_map_data_start(Sed_hydrotrend_map m);
+Sed_hydro
+sed_hydrotrend_map_record(Sed_hydrotrend_map m, gint i);
+Sed_hydro*
+sed_hydrotrend_map_read_recs(Sed_hydrotrend_map m, gint rec_0, gint n_recs);
+gint
+sed_hydrotrend_map_decode(Sed_hydrotrend_map m, gint rec_0, gint n_recs,
+    Sed_hydrotrend_block* b);
+
+Sed_hydrotrend_block*
+sed_hydrotrend_block_new(gint n_grains, gint max_recs);
+Sed_hydrotrend_block*
+sed_hydrotrend_block_destroy(Sed_hydrotrend_block* b);
+Sed_hydro
+sed_hydrotrend_block_record(const Sed_hydrotrend_block* b, gint i);
+
 gint
 sed_hydrotrend_fseek(FILE* fp, gint offset, gint whence, gint byte_order);
 gint
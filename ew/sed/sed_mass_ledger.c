@@ -0,0 +1,216 @@
+//---
+//
+// This file is part of sedflux.
+//
+// sedflux is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// sedflux is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with sedflux; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//---
+
+#include "sed_mass_ledger.h"
+#include "sed_sediment.h"
+
+CLASS(Sed_mass_ledger)
+{
+    gint    n_grains;        ///< Number of grain types
+    double* rho_grain;       ///< Grain density of each type
+    double* w;               ///< Work space for the masses of a cell
+    double* mass;            ///< Mass of each type held by the columns
+    double* deposited;       ///< Mass of each type ever deposited
+    double* eroded;          ///< Mass of each type ever eroded
+    double  total_deposited; ///< Sum of deposited
+    double  total_eroded;    ///< Sum of eroded
+};
+
+/** Create a new mass ledger
+
+The ledger starts out empty.  Columns that already hold sediment post it
+when they are attached to the ledger.
+
+\param n_grains The number of grain types of the sediment environment.
+
+\return A new Sed_mass_ledger.
+*/
+Sed_mass_ledger
+sed_mass_ledger_new(gint n_grains)
+{
+    Sed_mass_ledger l = NULL;
+
+    eh_require(n_grains > 0);
+
+    if (n_grains > 0) {
+        gint n;
+
+        NEW_OBJECT(Sed_mass_ledger, l);
+
+        l->n_grains  = n_grains;
+        l->rho_grain = eh_new(double, n_grains);
+        l->w         = eh_new(double, n_grains);
+        l->mass      = eh_new0(double, n_grains);
+        l->deposited = eh_new0(double, n_grains);
+        l->eroded    = eh_new0(double, n_grains);
+
+        l->total_deposited = 0.;
+        l->total_eroded    = 0.;
+
+        for (n = 0 ; n < n_grains ; n++) {
+            l->rho_grain[n] = sed_type_rho_grain(sed_sediment_type(NULL, n));
+        }
+    }
+
+    return l;
+}
+
+Sed_mass_ledger
+sed_mass_ledger_destroy(Sed_mass_ledger l)
+{
+    if (l) {
+        eh_free(l->rho_grain);
+        eh_free(l->w);
+        eh_free(l->mass);
+        eh_free(l->deposited);
+        eh_free(l->eroded);
+        eh_free(l);
+    }
+
+    return NULL;
+}
+
+/** Post part of the sediment of a cell to a ledger
+
+A positive \a f records that a fraction \a f of the sediment of \a c was
+deposited, and a negative \a f that it was eroded.  The sediment mass of the
+cell is divided between its grain types in proportion to the mass of grains
+of each type.
+
+\param l  A Sed_mass_ledger (or NULL)
+\param c  A Sed_cell
+\param f  The fraction of the cell that was added to (or removed from) the
+          columns of the ledger.
+
+\return The Sed_mass_ledger.
+*/
+Sed_mass_ledger
+sed_mass_ledger_post_cell(Sed_mass_ledger l, const Sed_cell c, double f)
+{
+    if (l && c && f != 0. && !sed_cell_is_empty(c)) {
+        const gint n_grains = MIN(l->n_grains, sed_cell_n_types(c));
+        double m = f * sed_cell_sediment_mass(c);
+        double total = 0.;
+        gint n;
+
+        for (n = 0 ; n < n_grains ; n++) {
+            l->w[n] = sed_cell_fraction(c, n) * l->rho_grain[n];
+            total  += l->w[n];
+        }
+
+        if (total > 0.) {
+            m /= total;
+
+            for (n = 0 ; n < n_grains ; n++) {
+                const double dm = l->w[n] * m;
+
+                l->mass[n] += dm;
+
+                if (dm > 0.) {
+                    l->deposited[n] += dm;
+                    l->total_deposited += dm;
+                } else {
+                    l->eroded[n] -= dm;
+                    l->total_eroded -= dm;
+                }
+            }
+        }
+    }
+
+    return l;
+}
+
+gint
+sed_mass_ledger_n_grains(const Sed_mass_ledger l)
+{
+    eh_return_val_if_fail(l, 0);
+    return l->n_grains;
+}
+
+/** The mass of sediment held by the columns of a ledger (kg/m^2) */
+double
+sed_mass_ledger_mass(const Sed_mass_ledger l)
+{
+    double mass = 0.;
+
+    if (l) {
+        gint n;
+
+        for (n = 0 ; n < l->n_grains ; n++) {
+            mass += l->mass[n];
+        }
+    }
+
+    return mass;
+}
+
+double
+sed_mass_ledger_nth_mass(const Sed_mass_ledger l, gint n)
+{
+    eh_return_val_if_fail(l && n >= 0 && n < l->n_grains, 0.);
+    return l->mass[n];
+}
+
+/** The mass of sediment ever deposited onto the columns of a ledger */
+double
+sed_mass_ledger_deposited(const Sed_mass_ledger l)
+{
+    return (l) ? l->total_deposited : 0.;
+}
+
+double
+sed_mass_ledger_nth_deposited(const Sed_mass_ledger l, gint n)
+{
+    eh_return_val_if_fail(l && n >= 0 && n < l->n_grains, 0.);
+    return l->deposited[n];
+}
+
+/** The mass of sediment ever eroded from the columns of a ledger */
+double
+sed_mass_ledger_eroded(const Sed_mass_ledger l)
+{
+    return (l) ? l->total_eroded : 0.;
+}
+
+double
+sed_mass_ledger_nth_eroded(const Sed_mass_ledger l, gint n)
+{
+    eh_return_val_if_fail(l && n >= 0 && n < l->n_grains, 0.);
+    return l->eroded[n];
+}
+
+gint
+sed_mass_ledger_fprint(FILE* fp, const Sed_mass_ledger l)
+{
+    gint n = 0;
+
+    if (fp && l) {
+        gint i;
+
+        n += fprintf(fp, "Grain | Mass (kg/m^2) | Deposited (kg/m^2) | Eroded (kg/m^2)\n");
+
+        for (i = 0 ; i < l->n_grains ; i++) {
+            n += fprintf(fp, "%5d | %13g | %18g | %15g\n", i, l->mass[i],
+                    l->deposited[i], l->eroded[i]);
+        }
+    }
+
+    return n;
+}
@@ -0,0 +1,70 @@
+//---
+//
+// This file is part of sedflux.
+//
+// sedflux is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// sedflux is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with sedflux; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//---
+
+#if !defined(SED_MASS_LEDGER_H)
+# define SED_MASS_LEDGER_H
+
+#include <stdio.h>
+#include <glib.h>
+#include "utils/utils.h"
+
+G_BEGIN_DECLS
+
+#include "sed_cell.h"
+
+/** Sed_mass_ledger
+
+A running account of the sediment held by a set of columns.  Columns that
+are attached to a ledger (see sed_column_set_mass_ledger) post the mass of
+each grain type that is deposited onto them or eroded from them, so that the
+mass of sediment in the columns is known without visiting their cells.
+
+Masses are of sediment grains (not pore water) per unit area (kg/m^2) so that
+compaction does not change them.  Columns that share a ledger must not have
+sediment added or removed by more than one thread at a time.
+*/
+new_handle(Sed_mass_ledger);
+
+Sed_mass_ledger
+sed_mass_ledger_new(gint n_grains);
+Sed_mass_ledger
+sed_mass_ledger_destroy(Sed_mass_ledger l);
+Sed_mass_ledger
+sed_mass_ledger_post_cell(Sed_mass_ledger l, const Sed_cell c, double f);
+gint
+sed_mass_ledger_n_grains(const Sed_mass_ledger l);
+double
+sed_mass_ledger_mass(const Sed_mass_ledger l);
+double
+sed_mass_ledger_nth_mass(const Sed_mass_ledger l, gint n);
+double
+sed_mass_ledger_deposited(const Sed_mass_ledger l);
+double
+sed_mass_ledger_nth_deposited(const Sed_mass_ledger l, gint n);
+double
+sed_mass_ledger_eroded(const Sed_mass_ledger l);
+double
+sed_mass_ledger_nth_eroded(const Sed_mass_ledger l, gint n);
+gint
+sed_mass_ledger_fprint(FILE* fp, const Sed_mass_ledger l);
+
+G_END_DECLS
+
+#endif /* sed_mass_ledger.h */
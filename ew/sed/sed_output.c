@@ -0,0 +1,355 @@
+//---
+//
+// This file is part of sedflux.
+//
+// sedflux is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// sedflux is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with sedflux; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//---
+
+#include <stdio.h>
+#include <glib.h>
+#include "utils/utils.h"
+#include "sed_output.h"
+
+/** \file sed_output.c
+
+Output that would otherwise block the simulation is handed to a pool of
+writer threads.  An output process takes a snapshot of whatever it needs
+to write, pushes a job that writes the snapshot, and carries on.  Jobs
+that are pushed for the same stream (a file, say, or the process that
+owns the snapshot) are written one at a time and in the order they were
+pushed; jobs for different streams may be written at the same time.
+
+The queue of jobs is bounded so that a simulation that outruns its
+writers is slowed to their pace rather than using up memory.  With no
+writer threads (the default), jobs are written as they are pushed.
+*/
+
+typedef struct {
+    gconstpointer   stream;
+    Sed_output_func f;
+    gpointer        data;
+    GDestroyNotify  destroy;
+}
+Sed_output_job;
+
+static GStaticMutex __init_lock   = G_STATIC_MUTEX_INIT;
+static GMutex*      __lock        = NULL; //< Guards everything below
+static GCond*       __job_pushed  = NULL; //< A job was pushed or a stream freed
+static GCond*       __job_done    = NULL; //< A job was written
+static GQueue*      __jobs        = NULL; //< Jobs waiting to be written
+static GHashTable*  __busy        = NULL; //< Streams that are being written
+static GThread**    __threads     = NULL;
+static gint         __n_threads   = 0;
+static gint         __n_running   = 0;
+static gint         __max_pending = 16;
+static gboolean     __quit        = FALSE;
+
+static void
+_sed_output_init(void)
+{
+    g_static_mutex_lock(&__init_lock);
+
+    if (!__lock) {
+        if (!g_thread_supported()) {
+            g_thread_init(NULL);
+        }
+
+        __job_pushed = g_cond_new();
+        __job_done   = g_cond_new();
+        __jobs       = g_queue_new();
+        __busy       = g_hash_table_new(g_direct_hash, g_direct_equal);
+        __lock       = g_mutex_new();
+    }
+
+    g_static_mutex_unlock(&__init_lock);
+}
+
+static void
+_sed_output_run_job(Sed_output_job* job)
+{
+    (job->f)(job->data);
+
+    if (job->destroy) {
+        (job->destroy)(job->data);
+    }
+
+    eh_free(job);
+}
+
+/* Remove the first job of the queue whose stream isn't being written.  The
+   lock must be held.
+*/
+static Sed_output_job*
+_sed_output_next_job(void)
+{
+    GList* link;
+
+    for (link = __jobs->head ; link ; link = link->next) {
+        Sed_output_job* job = (Sed_output_job*)link->data;
+
+        if (!job->stream || !g_hash_table_lookup(__busy, job->stream)) {
+            g_queue_delete_link(__jobs, link);
+            return job;
+        }
+    }
+
+    return NULL;
+}
+
+/* Does a stream have a job that is waiting or being written.  The lock must
+   be held.
+*/
+static gboolean
+_sed_output_stream_is_pending(gconstpointer stream)
+{
+    GList* link;
+
+    if (g_hash_table_lookup(__busy, stream)) {
+        return TRUE;
+    }
+
+    for (link = __jobs->head ; link ; link = link->next) {
+        if (((Sed_output_job*)link->data)->stream == stream) {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+static gpointer
+_sed_output_writer(gpointer data)
+{
+    g_mutex_lock(__lock);
+
+    for (;;) {
+        Sed_output_job* job = _sed_output_next_job();
+
+        if (job) {
+            gconstpointer stream = job->stream;
+
+            if (stream) {
+                g_hash_table_insert(__busy, (gpointer)stream, GINT_TO_POINTER(TRUE));
+            }
+
+            __n_running++;
+
+            g_mutex_unlock(__lock);
+            _sed_output_run_job(job);
+            g_mutex_lock(__lock);
+
+            if (stream) {
+                g_hash_table_remove(__busy, stream);
+            }
+
+            __n_running--;
+
+            g_cond_broadcast(__job_done);
+            g_cond_broadcast(__job_pushed);
+        } else if (__quit) {
+            break;
+        } else {
+            g_cond_wait(__job_pushed, __lock);
+        }
+    }
+
+    g_mutex_unlock(__lock);
+
+    return NULL;
+}
+
+/** Set the number of threads that write output
+
+Any output that is waiting to be written is written before the writers
+are replaced.
+
+If fewer threads can be created than were asked for, output is written by
+those that were (or as it is pushed, if none were).
+
+\param n_threads Number of writer threads (0 to write output as it is
+                 pushed)
+*/
+void
+sed_output_set_n_threads(gint n_threads)
+{
+    gint i;
+
+    sed_output_shutdown();
+
+    if (n_threads > 0) {
+        _sed_output_init();
+
+        __quit      = FALSE;
+        __n_threads = 0;
+        __threads   = eh_new0(GThread*, n_threads);
+
+        for (i = 0 ; i < n_threads ; i++) {
+            GError* error = NULL;
+            GThread* t = g_thread_create(_sed_output_writer, NULL, TRUE, &error);
+
+            if (t) {
+                __threads[__n_threads++] = t;
+            } else {
+                eh_warning("Unable to create output thread: %s",
+                    (error) ? error->message : "unknown error");
+                g_clear_error(&error);
+            }
+        }
+
+        // Without any writers, output is written as it is pushed.
+        if (__n_threads == 0) {
+            eh_free(__threads);
+            __threads = NULL;
+        }
+    }
+}
+
+gint
+sed_output_n_threads(void)
+{
+    return __n_threads;
+}
+
+/** Set the number of jobs that can wait to be written
+
+Once this many jobs are waiting, sed_output_push blocks until one of them
+has been written.
+
+\param n_jobs Maximum number of waiting jobs
+*/
+void
+sed_output_set_max_pending(gint n_jobs)
+{
+    eh_require(n_jobs > 0);
+
+    if (__lock) {
+        g_mutex_lock(__lock);
+    }
+
+    __max_pending = MAX(n_jobs, 1);
+
+    if (__lock) {
+        g_cond_broadcast(__job_done);
+        g_mutex_unlock(__lock);
+    }
+}
+
+/** Write some output in the background
+
+The function \a f is called with \a data by one of the writer threads and
+\a data is then freed with \a destroy.  \a data should hold a snapshot of
+everything that \a f needs, since the simulation carries on while it is
+written.  Jobs for the same \a stream are written in the order they were
+pushed.
+
+\param stream  Key that orders the jobs (or NULL if the job needs no order)
+\param f       Function that writes the output
+\param data    Data to pass to \a f
+\param destroy Function that frees \a data (or NULL)
+*/
+void
+sed_output_push(gconstpointer stream, Sed_output_func f, gpointer data,
+    GDestroyNotify destroy)
+{
+    Sed_output_job* job;
+
+    eh_require(f);
+
+    job          = eh_new(Sed_output_job, 1);
+    job->stream  = stream;
+    job->f       = f;
+    job->data    = data;
+    job->destroy = destroy;
+
+    if (__n_threads == 0) {
+        _sed_output_run_job(job);
+    } else {
+        g_mutex_lock(__lock);
+
+        while (g_queue_get_length(__jobs) >= __max_pending) {
+            g_cond_wait(__job_done, __lock);
+        }
+
+        g_queue_push_tail(__jobs, job);
+        g_cond_broadcast(__job_pushed);
+
+        g_mutex_unlock(__lock);
+    }
+}
+
+/** Wait for the output of a stream to be written
+
+Call this before changing anything that a pushed job of the stream uses.
+
+\param stream Key of the jobs to wait for (or NULL to wait for every job)
+*/
+void
+sed_output_wait(gconstpointer stream)
+{
+    if (__n_threads > 0) {
+        g_mutex_lock(__lock);
+
+        if (stream) {
+            while (_sed_output_stream_is_pending(stream)) {
+                g_cond_wait(__job_done, __lock);
+            }
+        } else {
+            while (!g_queue_is_empty(__jobs) || __n_running > 0) {
+                g_cond_wait(__job_done, __lock);
+            }
+        }
+
+        g_mutex_unlock(__lock);
+    }
+}
+
+/** Wait for all of the output to be written
+*/
+void
+sed_output_flush(void)
+{
+    sed_output_wait(NULL);
+}
+
+/** Write any waiting output and stop the writer threads
+
+Output pushed after this is written as it is pushed.
+*/
+void
+sed_output_shutdown(void)
+{
+    if (__n_threads > 0) {
+        gint i;
+
+        sed_output_flush();
+
+        g_mutex_lock(__lock);
+        __quit = TRUE;
+        g_cond_broadcast(__job_pushed);
+        g_mutex_unlock(__lock);
+
+        for (i = 0 ; i < __n_threads ; i++) {
+            if (__threads[i]) {
+                g_thread_join(__threads[i]);
+            }
+        }
+
+        eh_free(__threads);
+
+        __threads   = NULL;
+        __n_threads = 0;
+    }
+}
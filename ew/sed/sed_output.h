@@ -0,0 +1,50 @@
+//---
+//
+// This file is part of sedflux.
+//
+// sedflux is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// sedflux is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with sedflux; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//---
+
+#if !defined( SED_OUTPUT_H )
+#define SED_OUTPUT_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/** Function that writes one piece of output */
+typedef void (*Sed_output_func)(gpointer data);
+
+void
+sed_output_set_n_threads(gint n_threads);
+gint
+sed_output_n_threads(void);
+void
+sed_output_set_max_pending(gint n_jobs);
+
+void
+sed_output_push(gconstpointer stream, Sed_output_func f, gpointer data,
+    GDestroyNotify destroy);
+void
+sed_output_wait(gconstpointer stream);
+void
+sed_output_flush(void);
+void
+sed_output_shutdown(void);
+
+G_END_DECLS
+
+#endif /* SED_OUTPUT_H */
@@ -20,6 +20,7 @@
 
 #include "sed_process.h"
 #include "sed_signal.h"
+#include "sed_profile.h"
 
 typedef struct {
     // Public
@@ -32,6 +33,8 @@ typedef struct {
     double mass_after;
     double mass_total_added;
     double mass_total_lost;
+    double mass_deposited;   ///< Sediment the process put into the cube (from the ledger)
+    double mass_eroded;      ///< Sediment the process took from the cube (from the ledger)
 
     GTimer* timer;
     double  secs;
@@ -531,6 +534,8 @@ sed_process_queue_push(Sed_process_queue q, Sed_process_init_t init)
         __Sed_process_link* new_link = eh_new(__Sed_process_link, 1);
 
         new_link->p = sed_process_create(init.name, init.init_f, init.run_f, init.destroy_f);
+        new_link->p->f_dump = init.dump_f;
+        new_link->p->f_load = init.load_f;
         new_link->obj_list = NULL;
 
         sed_process_queue_append(q, new_link);
@@ -594,6 +599,32 @@ sed_process_queue_delete(Sed_process_queue q, const gchar* name)
     return q;
 }
 
+/** Move a process to the end of a queue
+
+The process is then run after every other process of a time step.
+
+\param q    A Sed_process_queue
+\param name Name of the process
+
+\return The input Sed_process_queue
+*/
+Sed_process_queue
+sed_process_queue_move_to_end(Sed_process_queue q, const gchar* name)
+{
+    if (q && name) {
+        GList* link = sed_process_queue_find(q, name);
+
+        if (link) {
+            __Sed_process_link* data = (__Sed_process_link*)link->data;
+
+            q->l = g_list_delete_link(q->l, link);
+            q->l = g_list_append(q->l, data);
+        }
+    }
+
+    return q;
+}
+
 Sed_process_queue
 sed_process_queue_run(Sed_process_queue q, Sed_cube p)
 {
@@ -840,6 +871,9 @@ sed_process_copy(Sed_process d, Sed_process s)
 
         d->logging  = s->logging;
         d->interval = s->interval;
+
+        d->f_dump   = s->f_dump;
+        d->f_load   = s->f_load;
     }
 
     return d;
@@ -987,35 +1021,88 @@ sed_process_run_at_end(Sed_process a, Sed_cube p)
     return rtn_val;
 }
 
+/** Run a process now
+
+If the environment variable SED_TRACK_MASS is set, the mass of sediment in
+the cube (and in suspension) is found before and after the process runs
+and checked against the mass that the process says it added and lost (see
+Sed_process_info).  The results are written to mass_balance.txt.
+
+The masses that are compared are of sediment grains, without their pore
+water (see sed_cell_sediment_mass), as these are not changed by compaction.
+Processes must report the mass they add and lose in the same way.  The
+mass of the cube is taken from its ledger (see sed_cube_mass_ledger) unless
+SED_TRACK_MASS is "scan", in which case every cell is visited.
+
+\param a A Sed_process
+\param p The Sed_cube to run the process on
+
+\return FALSE if a mass balance error was detected.
+*/
 gboolean
 sed_process_run_now(Sed_process a, Sed_cube p)
 {
     gboolean rtn_val = TRUE;
 
     if (a && a->f_run && a->is_set) {
-        const gchar* log_name;
         Sed_process_info info;
         gulong           u_secs = 0;
+        const gchar*     track  = g_getenv("SED_TRACK_MASS");
+        const gboolean   track_mass    = (track != NULL);
+        const gboolean   track_by_scan = (track && g_ascii_strcasecmp(track, "scan") == 0);
+        Sed_mass_ledger  ledger = sed_cube_mass_ledger(p);
 
         //eh_message ("*** %s: Running", sed_process_name (a));
 
-        g_timer_start(a->info->timer);
-
-        if (a->logging) {
-            log_name = a->name;
-        } else {
-            log_name = "/dev/null";
-        }
+        SED_PROFILE_BEGIN(a->name);
 
-        eh_redirect_log(log_name, DEFAULT_LOG);
+        g_timer_start(a->info->timer);
 
         if (eh_get_verbosity_level() >= 3)
             fprintf(stderr,
                 "%7g years [ Running process: %-25s]\r",
                 sed_cube_age_in_years(p), a->name);
 
-        if (g_getenv("SED_TRACK_MASS")) {
-            double mass_before = sed_cube_mass(p) + sed_cube_mass_in_suspension(p);
+        if (ledger && !track_by_scan) {
+            // The ledger of the cube gives the sediment that the process
+            // moved, and the mass of the cube, without visiting every cell.
+            // Only the (plan view) grids of suspended sediment are scanned.
+            const double area      = sed_cube_x_res(p) * sed_cube_y_res(p);
+            const double deposited = sed_mass_ledger_deposited(ledger);
+            const double eroded    = sed_mass_ledger_eroded(ledger);
+            double mass_before     = 0.;
+
+            if (track_mass) {
+                mass_before = sed_mass_ledger_mass(ledger) * area
+                    + sed_cube_sediment_mass_in_suspension(p);
+            }
+
+            info = a->f_run(a, p);
+
+            a->info->mass_deposited   += (sed_mass_ledger_deposited(ledger) - deposited) * area;
+            a->info->mass_eroded      += (sed_mass_ledger_eroded(ledger) - eroded) * area;
+
+            a->info->mass_total_added += info.mass_added;
+            a->info->mass_total_lost  += info.mass_lost;
+
+            if (track_mass) {
+                a->info->mass_added  = info.mass_added;
+                a->info->mass_lost   = info.mass_lost;
+                a->info->error       = info.error;
+
+                a->info->mass_before = mass_before;
+                a->info->mass_after  = sed_mass_ledger_mass(ledger) * area
+                    + sed_cube_sediment_mass_in_suspension(p);
+
+                sed_process_fprint_info(info_fp, a);
+
+                if (sed_process_error(a)) {
+                    eh_warning("A mass balance error was detected (%s).", a->name);
+                    rtn_val = FALSE;
+                }
+            }
+        } else if (track_mass) {
+            double mass_before = sed_cube_sediment_mass(p) + sed_cube_sediment_mass_in_suspension(p);
 
             info = a->f_run(a, p);
 
@@ -1024,7 +1111,8 @@ sed_process_run_now(Sed_process a, Sed_cube p)
             a->info->error             = info.error;
 
             a->info->mass_before       = mass_before;
-            a->info->mass_after        = sed_cube_mass(p) + sed_cube_mass_in_suspension(p);
+            a->info->mass_after        = sed_cube_sediment_mass(p)
+                + sed_cube_sediment_mass_in_suspension(p);
 
             a->info->mass_total_added += info.mass_added;
             a->info->mass_total_lost  += info.mass_lost;
@@ -1044,13 +1132,13 @@ sed_process_run_now(Sed_process a, Sed_cube p)
             a->info->mass_total_lost  += info.mass_lost;
         }
 
-        eh_reset_log(DEFAULT_LOG);
-
         a->info->secs   += g_timer_elapsed(a->info->timer, NULL);
         a->info->u_secs += u_secs;
 
         a->run_count++;
 
+        SED_PROFILE_END();
+
         //eh_message ("*** %s: Done", sed_process_name (a));
     }
 
@@ -1257,7 +1345,7 @@ sed_process_queue_summary(FILE* fp, Sed_process_queue q)
         GList* this_link;
         GList* this_obj;
 
-        n += fprintf(fp, "             Name | Mass Added | Mass Removed | Time\n");
+        n += fprintf(fp, "             Name | Mass Added | Mass Removed |  Deposited |     Eroded | Time\n");
 
         for (this_link = q->l ; this_link ; this_link = this_link->next) {
             link = (__Sed_process_link*)this_link->data;
@@ -1579,10 +1667,12 @@ sed_process_summary(FILE* fp, Sed_process p)
         double t = p->info->secs + p->info->u_secs / 1.e6;
         gchar* t_str = eh_render_time_str(t);
 
-        n += fprintf(fp, "%18s | %10.3g | %10.3g | %s\n",
+        n += fprintf(fp, "%18s | %10.3g | %12.3g | %10.3g | %10.3g | %s\n",
                 p->name,
                 p->info->mass_total_added,
                 p->info->mass_total_lost,
+                p->info->mass_deposited,
+                p->info->mass_eroded,
                 t_str);
     }
 
@@ -1623,6 +1713,10 @@ sed_process_fprint_info(FILE* fp, Sed_process p)
                 info->mass_total_added);
         n += fprintf(fp, "Total mass of sediment lost (kg)         : %g\n",
                 info->mass_total_lost);
+        n += fprintf(fp, "Total mass deposited by process (kg)     : %g\n",
+                info->mass_deposited);
+        n += fprintf(fp, "Total mass eroded by process (kg)        : %g\n",
+                info->mass_eroded);
         n += fprintf(fp, "Error                                    : %d\n",
                 info->error);
     }
@@ -1653,6 +1747,35 @@ sed_process_error(Sed_process p)
     return error;
 }
 
+/** Sediment (kg) that a process has deposited into the cube
+
+This is taken from the mass ledger of the cube and so includes sediment
+that the process moved from one part of the cube to another.
+
+\param p A Sed_process
+
+\return The total mass deposited over all of the runs of the process.
+*/
+double
+sed_process_mass_deposited(Sed_process p)
+{
+    eh_return_val_if_fail(p, 0.);
+    return p->info->mass_deposited;
+}
+
+/** Sediment (kg) that a process has eroded from the cube
+
+\param p A Sed_process
+
+\return The total mass eroded over all of the runs of the process.
+*/
+double
+sed_process_mass_eroded(Sed_process p)
+{
+    eh_return_val_if_fail(p, 0.);
+    return p->info->mass_eroded;
+}
+
 int
 sed_process_queue_check_item(Sed_process_queue q, const gchar* p_name)
 {
@@ -1982,3 +2105,220 @@ sed_process_queue_validate(Sed_process_queue q, Sed_process_check check[],
     return is_valid;
 }
 
+
+/** Write the state of a process to a checkpoint
+
+The run count, event times, and mass totals of the process are written,
+followed by its user data (written by the process's dump function).  The
+user data are preceded by their length so that a reader without a load
+function can skip over them.
+
+\param p  A Sed_process
+\param fp An open checkpoint file
+
+\return The number of bytes written
+*/
+gssize
+sed_process_dump(Sed_process p, FILE* fp)
+{
+    gssize n = 0;
+
+    eh_require(p);
+    eh_require(fp);
+
+    if (p && fp) {
+        gint32 len = strlen(p->name) + 1;
+        gint32 run_count = p->run_count;
+        gint32 n_events = p->next_event->len;
+        gint64 data_len = 0;
+        long data_pos;
+
+        n += fwrite(&len, sizeof(gint32), 1, fp) * sizeof(gint32);
+        n += fwrite(p->name, sizeof(gchar), len, fp);
+        n += fwrite(&run_count, sizeof(gint32), 1, fp) * sizeof(gint32);
+        n += fwrite(&n_events, sizeof(gint32), 1, fp) * sizeof(gint32);
+        n += fwrite(p->next_event->data, sizeof(double), n_events, fp) * sizeof(double);
+        n += fwrite(&p->info->mass_total_added, sizeof(double), 1, fp) * sizeof(double);
+        n += fwrite(&p->info->mass_total_lost, sizeof(double), 1, fp) * sizeof(double);
+
+        data_pos = ftell(fp);
+        n += fwrite(&data_len, sizeof(gint64), 1, fp) * sizeof(gint64);
+
+        if (p->f_dump && p->data) {
+            long end_pos;
+
+            p->f_dump(p->data, fp);
+
+            end_pos  = ftell(fp);
+            data_len = end_pos - data_pos - sizeof(gint64);
+
+            fseek(fp, data_pos, SEEK_SET);
+            fwrite(&data_len, sizeof(gint64), 1, fp);
+            fseek(fp, end_pos, SEEK_SET);
+
+            n += data_len;
+        }
+    }
+
+    return n;
+}
+
+/** Read the state of a process from a checkpoint
+
+The process must already have been initialized from its input file.  Its
+user data are read with the process's load function.  If the process has
+no load function, its user data are skipped and its run count is reset so
+that any data it sets up on its first run are rebuilt from the restored
+Sed_cube.
+
+\param p     A Sed_process
+\param fp    An open checkpoint file, positioned at a record written with
+             sed_process_dump
+\param error A GError
+
+\return TRUE if the record was read, FALSE otherwise (and \a error is set)
+*/
+gboolean
+sed_process_load(Sed_process p, FILE* fp, GError** error)
+{
+    gboolean is_ok = FALSE;
+
+    eh_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+    eh_require(p);
+    eh_require(fp);
+
+    if (p && fp) {
+        gint32 len, run_count, n_events;
+        gint64 data_len;
+        gchar* name;
+
+        if (fread(&len, sizeof(gint32), 1, fp) != 1 || len <= 0 || len > 1024) {
+            g_set_error(error, SED_PROC_ERROR, SED_PROC_ERROR_BAD_CHECKPOINT,
+                "%s: Bad process record in checkpoint", p->name);
+            return FALSE;
+        }
+
+        name = eh_new(gchar, len);
+
+        if (fread(name, sizeof(gchar), len, fp) != len || name[len - 1] != '\0'
+            || g_ascii_strcasecmp(name, p->name) != 0) {
+            g_set_error(error, SED_PROC_ERROR, SED_PROC_ERROR_BAD_CHECKPOINT,
+                "%s: Checkpoint process does not match", p->name);
+        } else if (fread(&run_count, sizeof(gint32), 1, fp) != 1
+            || fread(&n_events, sizeof(gint32), 1, fp) != 1
+            || n_events < 0) {
+            g_set_error(error, SED_PROC_ERROR, SED_PROC_ERROR_BAD_CHECKPOINT,
+                "%s: Bad process record in checkpoint", p->name);
+        } else {
+            g_array_set_size(p->next_event, n_events);
+
+            if (fread(p->next_event->data, sizeof(double), n_events, fp) != n_events
+                || fread(&p->info->mass_total_added, sizeof(double), 1, fp) != 1
+                || fread(&p->info->mass_total_lost, sizeof(double), 1, fp) != 1
+                || fread(&data_len, sizeof(gint64), 1, fp) != 1) {
+                g_set_error(error, SED_PROC_ERROR, SED_PROC_ERROR_BAD_CHECKPOINT,
+                    "%s: Checkpoint is truncated", p->name);
+            } else {
+                const long data_pos = ftell(fp);
+                gboolean data_is_loaded = FALSE;
+
+                if (data_len > 0 && p->f_load && p->data) {
+                    data_is_loaded = p->f_load(p->data, fp);
+                }
+
+                fseek(fp, data_pos + data_len, SEEK_SET);
+
+                p->run_count = data_is_loaded ? run_count : 0;
+
+                is_ok = TRUE;
+            }
+        }
+
+        eh_free(name);
+    }
+
+    return is_ok;
+}
+
+/** Write the state of each process of a queue to a checkpoint
+
+\param q  A Sed_process_queue
+\param fp An open checkpoint file
+
+\return The number of bytes written
+*/
+gssize
+sed_process_queue_dump(Sed_process_queue q, FILE* fp)
+{
+    gssize n = 0;
+
+    if (q && fp) {
+        GList* link;
+        GList* obj;
+        gint32 n_procs = 0;
+
+        for (link = q->l ; link ; link = link->next) {
+            n_procs += g_list_length(SED_PROCESS_LINK(link->data)->obj_list);
+        }
+
+        n += fwrite(&n_procs, sizeof(gint32), 1, fp) * sizeof(gint32);
+
+        for (link = q->l ; link ; link = link->next)
+            for (obj = SED_PROCESS_LINK(link->data)->obj_list ; obj ; obj = obj->next) {
+                n += sed_process_dump(SED_PROCESS(obj->data), fp);
+            }
+    }
+
+    return n;
+}
+
+/** Read the state of each process of a queue from a checkpoint
+
+The queue must have been created from the same input files as the queue that
+was written with sed_process_queue_dump.
+
+\param q     A Sed_process_queue
+\param fp    An open checkpoint file
+\param error A GError
+
+\return TRUE if the processes were read, FALSE otherwise (and \a error is
+        set)
+*/
+gboolean
+sed_process_queue_load(Sed_process_queue q, FILE* fp, GError** error)
+{
+    gboolean is_ok = TRUE;
+
+    eh_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+    if (q && fp) {
+        GError* tmp_err = NULL;
+        GList* link;
+        GList* obj;
+        gint32 n_procs = 0;
+        gint32 n_saved = -1;
+
+        for (link = q->l ; link ; link = link->next) {
+            n_procs += g_list_length(SED_PROCESS_LINK(link->data)->obj_list);
+        }
+
+        if (fread(&n_saved, sizeof(gint32), 1, fp) != 1 || n_saved != n_procs) {
+            g_set_error(&tmp_err, SED_PROC_ERROR, SED_PROC_ERROR_BAD_CHECKPOINT,
+                "Checkpoint holds a different number of processes (%d != %d)",
+                n_saved, n_procs);
+        }
+
+        for (link = q->l ; !tmp_err && link ; link = link->next)
+            for (obj = SED_PROCESS_LINK(link->data)->obj_list ; !tmp_err && obj ;
+                obj = obj->next) {
+                sed_process_load(SED_PROCESS(obj->data), fp, &tmp_err);
+            }
+
+        if (tmp_err) {
+            g_propagate_error(error, tmp_err);
+            is_ok = FALSE;
+        }
+    }
+
+    return is_ok;
+}
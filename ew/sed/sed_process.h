@@ -60,8 +60,8 @@ new_handle(Sed_process_queue);
 
 typedef struct {
     // Public
-    double   mass_added;
-    double   mass_lost;
+    double   mass_added; ///< Sediment grains (kg) brought into the model
+    double   mass_lost;  ///< Sediment grains (kg) taken out of the model
     gboolean error;
 }
 Sed_process_info;
@@ -103,13 +103,16 @@ typedef struct {
     init_func    init_f;    //< Function that initialize the process
     run_func     run_f;     //< Function that runs the process
     destroy_func destroy_f; //< Function that destroys the process
+    dump_func    dump_f;    //< Function that writes the user data (or NULL)
+    load_func    load_f;    //< Function that reads the user data (or NULL)
 }
 Sed_process_init_t;
 
 typedef enum {
     SED_PROC_ERROR_BAD_INIT_FILE,
     SED_PROC_ERROR_NOT_FOUND,
-    SED_PROC_ERROR_MISSING_PARENT
+    SED_PROC_ERROR_MISSING_PARENT,
+    SED_PROC_ERROR_BAD_CHECKPOINT
 }
 Sed_process_error;
 
@@ -211,6 +214,10 @@ gssize
 sed_process_summary(FILE* fp, Sed_process p);
 gboolean
 sed_process_error(Sed_process p);
+double
+sed_process_mass_deposited(Sed_process p);
+double
+sed_process_mass_eroded(Sed_process p);
 
 int
 sed_process_queue_check_item(Sed_process_queue, const gchar*);
@@ -248,6 +255,8 @@ sed_process_queue_remove(Sed_process_queue, gchar*);
 Sed_process_queue
 sed_process_queue_delete(Sed_process_queue, const gchar*);
 Sed_process_queue
+sed_process_queue_move_to_end(Sed_process_queue q, const gchar* name);
+Sed_process_queue
 sed_process_queue_run(Sed_process_queue, Sed_cube);
 Sed_process_queue
 sed_process_queue_run_until(Sed_process_queue q, Sed_cube p, double t_total);
@@ -281,6 +290,15 @@ gboolean
 sed_process_queue_validate(Sed_process_queue q, Sed_process_check check[],
     GError** error);
 
+gssize
+sed_process_dump(Sed_process p, FILE* fp);
+gboolean
+sed_process_load(Sed_process p, FILE* fp, GError** error);
+gssize
+sed_process_queue_dump(Sed_process_queue q, FILE* fp);
+gboolean
+sed_process_queue_load(Sed_process_queue q, FILE* fp, GError** error);
+
 #define sed_process_new(name,type,f_init,f_run) ( \
     sed_process_create( name , sizeof(type) , f_init , f_run ) )
 #define sed_process_data_val(p,member,type) ( ((type*)(sed_process_data(p)))->member )
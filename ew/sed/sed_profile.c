@@ -0,0 +1,636 @@
+//---
+//
+// This file is part of sedflux.
+//
+// sedflux is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// sedflux is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with sedflux; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//---
+
+#include <math.h>
+#include <string.h>
+#include "sed_profile.h"
+
+typedef struct _Sed_profile_scope Sed_profile_scope;
+
+struct _Sed_profile_scope {
+    gchar*             name;     ///< name of the scope (or its path, once merged).
+    gint               depth;    ///< number of enclosing scopes.
+    Sed_profile_scope* parent;   ///< the enclosing scope.
+    GHashTable*        children; ///< sub-steps, keyed by name.
+    GPtrArray*         order;    ///< sub-steps, in the order they were first seen.
+    gint64             n_calls;  ///< number of times the scope was closed.
+    double             total;    ///< seconds spent in the scope.
+    double             self;     ///< seconds spent in the scope but not in a sub-step.
+    double             min;      ///< shortest call (seconds).
+    double             max;      ///< longest call (seconds).
+    gint64             bin[SED_PROFILE_N_BINS]; ///< latency histogram of the calls.
+};
+
+typedef struct {
+    Sed_profile_scope* scope;
+    double             start;    ///< when the scope was opened (seconds).
+    double             child;    ///< seconds spent in sub-steps so far.
+    gboolean           borrowed; ///< opened by sed_profile_push_path, and not recorded.
+}
+Sed_profile_frame;
+
+typedef struct {
+    const gchar* name;
+    double       start;
+    double       dur;
+}
+Sed_profile_event;
+
+typedef struct {
+    gint               tid;       ///< lane of the trace that the thread writes to.
+    Sed_profile_scope* root;      ///< top of the scope tree of the thread.
+    GArray*            frames;    ///< scopes that are open.
+    GArray*            events;    ///< closed scopes, for the trace.
+    gint64             n_dropped; ///< events not kept because events was full.
+}
+Sed_profile_thread;
+
+gboolean               __sed_profile_enabled = FALSE;
+static GTimer*         __clock   = NULL;
+static GSList*         __threads = NULL;
+static GSList*         __idle    = NULL;
+static gint            __n_tids  = 0;
+static GStaticMutex    __threads_lock  = G_STATIC_MUTEX_INIT;
+static GStaticPrivate  __thread_profile = G_STATIC_PRIVATE_INIT;
+
+static Sed_profile_scope*
+_sed_profile_scope_new(const gchar* name, Sed_profile_scope* parent)
+{
+    Sed_profile_scope* s = eh_new0(Sed_profile_scope, 1);
+
+    s->name     = g_strdup(name);
+    s->depth    = (parent) ? parent->depth + 1 : -1;
+    s->parent   = parent;
+    s->children = g_hash_table_new(&g_str_hash, &g_str_equal);
+    s->order    = g_ptr_array_new();
+    s->n_calls  = 0;
+    s->total    = 0.;
+    s->self     = 0.;
+    s->min      = G_MAXDOUBLE;
+    s->max      = 0.;
+
+    return s;
+}
+
+static Sed_profile_scope*
+_sed_profile_scope_child(Sed_profile_scope* s, const gchar* name)
+{
+    Sed_profile_scope* child = g_hash_table_lookup(s->children, name);
+
+    if (!child) {
+        child = _sed_profile_scope_new(name, s);
+
+        g_hash_table_insert(s->children, child->name, child);
+        g_ptr_array_add(s->order, child);
+    }
+
+    return child;
+}
+
+static gint
+_sed_profile_bin(double secs)
+{
+    const double u_secs = secs * 1e6;
+    gint bin = 0;
+
+    if (u_secs >= 1.) {
+        frexp(u_secs, &bin);
+    }
+
+    return MIN(bin, SED_PROFILE_N_BINS - 1);
+}
+
+/* Add the calls of scope s to those of scope d. */
+static void
+_sed_profile_scope_add(Sed_profile_scope* d, const Sed_profile_scope* s)
+{
+    gint n;
+
+    d->n_calls += s->n_calls;
+    d->total   += s->total;
+    d->self    += s->self;
+    d->min      = MIN(d->min, s->min);
+    d->max      = MAX(d->max, s->max);
+
+    for (n = 0 ; n < SED_PROFILE_N_BINS ; n++) {
+        d->bin[n] += s->bin[n];
+    }
+}
+
+/* Threads created with g_thread_create hand their profile back when they
+   exit so that the next new thread writes to the same lane of the trace. */
+static void
+_sed_profile_thread_release(gpointer data)
+{
+    Sed_profile_thread* t = (Sed_profile_thread*)data;
+
+    g_array_set_size(t->frames, 0);
+
+    g_static_mutex_lock(&__threads_lock);
+    __idle = g_slist_prepend(__idle, t);
+    g_static_mutex_unlock(&__threads_lock);
+}
+
+static Sed_profile_thread*
+_sed_profile_thread(void)
+{
+    Sed_profile_thread* t = g_static_private_get(&__thread_profile);
+
+    if (!t) {
+        g_static_mutex_lock(&__threads_lock);
+
+        if (__idle) {
+            t      = __idle->data;
+            __idle = g_slist_delete_link(__idle, __idle);
+        } else {
+            t = eh_new(Sed_profile_thread, 1);
+
+            t->tid       = __n_tids++;
+            t->root      = _sed_profile_scope_new("", NULL);
+            t->frames    = g_array_new(FALSE, FALSE, sizeof(Sed_profile_frame));
+            t->events    = g_array_new(FALSE, FALSE, sizeof(Sed_profile_event));
+            t->n_dropped = 0;
+
+            __threads = g_slist_append(__threads, t);
+        }
+
+        g_static_mutex_unlock(&__threads_lock);
+
+        g_static_private_set(&__thread_profile, t, &_sed_profile_thread_release);
+    }
+
+    return t;
+}
+
+/** Turn the profiler on or off.
+
+While it is on, every SED_PROFILE_BEGIN/SED_PROFILE_END pair records the time
+spent in its scope.  Turn it on before any scopes are opened, and do not turn
+it off while any are open.
+
+\param enable TRUE to profile.
+*/
+void
+sed_profile_enable(gboolean enable)
+{
+    if (enable && !__clock) {
+        __clock = g_timer_new();
+    }
+
+    __sed_profile_enabled = enable;
+}
+
+/** Is the profiler on?
+*/
+gboolean
+sed_profile_is_enabled(void)
+{
+    return __sed_profile_enabled;
+}
+
+/** Open a profiling scope on the calling thread.
+
+Use SED_PROFILE_BEGIN rather than calling this directly.
+
+\param name Name of the scope.  It is copied.
+*/
+void
+sed_profile_push(const gchar* name)
+{
+    Sed_profile_thread* t = _sed_profile_thread();
+    Sed_profile_frame   f;
+
+    eh_require(name);
+
+    if (t->frames->len > 0) {
+        f.scope = g_array_index(t->frames, Sed_profile_frame, t->frames->len - 1).scope;
+    } else {
+        f.scope = t->root;
+    }
+
+    f.scope    = _sed_profile_scope_child(f.scope, name);
+    f.child    = 0.;
+    f.start    = g_timer_elapsed(__clock, NULL);
+    f.borrowed = FALSE;
+
+    g_array_append_val(t->frames, f);
+}
+
+/** Close the innermost profiling scope of the calling thread.
+
+Use SED_PROFILE_END rather than calling this directly.  Nothing happens if the
+thread has no open scopes (other than those of sed_profile_push_path).
+*/
+void
+sed_profile_pop(void)
+{
+    Sed_profile_thread* t = _sed_profile_thread();
+
+    if (t->frames->len > 0
+        && !g_array_index(t->frames, Sed_profile_frame, t->frames->len - 1).borrowed) {
+        const double       now = g_timer_elapsed(__clock, NULL);
+        Sed_profile_frame* f   = &g_array_index(t->frames, Sed_profile_frame,
+                t->frames->len - 1);
+        Sed_profile_scope* s   = f->scope;
+        const double       dur = now - f->start;
+
+        s->n_calls += 1;
+        s->total   += dur;
+        s->self    += dur - f->child;
+        s->min      = MIN(s->min, dur);
+        s->max      = MAX(s->max, dur);
+        s->bin[_sed_profile_bin(dur)] += 1;
+
+        if (t->events->len < SED_PROFILE_MAX_EVENTS) {
+            Sed_profile_event e;
+
+            e.name  = s->name;
+            e.start = f->start;
+            e.dur   = dur;
+
+            g_array_append_val(t->events, e);
+        } else {
+            t->n_dropped += 1;
+        }
+
+        g_array_set_size(t->frames, t->frames->len - 1);
+
+        if (t->frames->len > 0) {
+            g_array_index(t->frames, Sed_profile_frame, t->frames->len - 1).child += dur;
+        }
+    }
+}
+
+/** The path of the scopes that are open on the calling thread.
+
+The path is the names of the open scopes, outermost first, separated by '/'.
+Pass it to sed_profile_push_path to carry on the scopes of one thread in
+another.
+
+\return The path (free it with eh_free), or NULL if the profiler is off or
+        the thread has no open scopes.
+*/
+gchar*
+sed_profile_path(void)
+{
+    gchar* path = NULL;
+
+    if (__sed_profile_enabled) {
+        Sed_profile_thread* t = _sed_profile_thread();
+
+        if (t->frames->len > 0) {
+            gchar** names = eh_new0(gchar*, t->frames->len + 1);
+            guint   i;
+
+            for (i = 0 ; i < t->frames->len ; i++) {
+                names[i] = g_array_index(t->frames, Sed_profile_frame, i).scope->name;
+            }
+
+            path = g_strjoinv("/", names);
+
+            eh_free(names);
+        }
+    }
+
+    return path;
+}
+
+/** Open the scopes of a path on the calling thread without recording them.
+
+Scopes opened on this thread until the matching sed_profile_pop_path are
+counted as sub-steps of the last scope of the path, as though they had been
+opened on the thread that the path was taken from.  The scopes of the path
+themselves are not counted again.  This lets a worker thread record its time
+under the scope of the thread that handed it its work.
+
+\param path A path from sed_profile_path (or NULL).
+*/
+void
+sed_profile_push_path(const gchar* path)
+{
+    if (__sed_profile_enabled && path) {
+        Sed_profile_thread* t     = _sed_profile_thread();
+        gchar**             names = g_strsplit(path, "/", -1);
+        Sed_profile_frame   f;
+        gchar**             name;
+
+        if (t->frames->len > 0) {
+            f.scope = g_array_index(t->frames, Sed_profile_frame, t->frames->len - 1).scope;
+        } else {
+            f.scope = t->root;
+        }
+
+        f.child    = 0.;
+        f.start    = g_timer_elapsed(__clock, NULL);
+        f.borrowed = TRUE;
+
+        for (name = names ; *name ; name++) {
+            f.scope = _sed_profile_scope_child(f.scope, *name);
+            g_array_append_val(t->frames, f);
+        }
+
+        g_strfreev(names);
+    }
+}
+
+/** Close the scopes opened by sed_profile_push_path on the calling thread.
+*/
+void
+sed_profile_pop_path(void)
+{
+    if (__sed_profile_enabled) {
+        Sed_profile_thread* t = _sed_profile_thread();
+
+        while (t->frames->len > 0
+            && g_array_index(t->frames, Sed_profile_frame, t->frames->len - 1).borrowed) {
+            g_array_set_size(t->frames, t->frames->len - 1);
+        }
+    }
+}
+
+static gint
+_sed_profile_fprint_json_string(FILE* fp, const gchar* s)
+{
+    gint n = 0;
+
+    n += fprintf(fp, "\"");
+
+    for (; *s ; s++) {
+        if (*s == '"' || *s == '\\') {
+            n += fprintf(fp, "\\%c", *s);
+        } else if ((guchar) * s < 0x20) {
+            n += fprintf(fp, "\\u%04x", (guchar) * s);
+        } else {
+            n += fprintf(fp, "%c", *s);
+        }
+    }
+
+    n += fprintf(fp, "\"");
+
+    return n;
+}
+
+/** Print the recorded scopes as a Chrome trace.
+
+The trace is in the trace event format read by chrome://tracing and Perfetto.
+Each closed scope is a complete ("X") event.  Threads are numbered in the
+order that they first opened a scope; worker threads that have exited give
+their number to the next new thread.  Call this only once no other thread has
+open scopes.
+
+\param fp A FILE to print to.
+
+\return The number of bytes written.
+*/
+gint
+sed_profile_fprint_trace(FILE* fp)
+{
+    gint n = 0;
+
+    eh_require(fp);
+
+    g_static_mutex_lock(&__threads_lock);
+    {
+        GSList* link;
+
+        n += fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        n += fprintf(fp, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,"
+                "\"args\":{\"name\":\"sedflux\"}}");
+
+        for (link = __threads ; link ; link = link->next) {
+            Sed_profile_thread* t = link->data;
+            guint i;
+
+            n += fprintf(fp, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+                    "\"tid\":%d,\"args\":{\"name\":\"thread %d\"}}", t->tid, t->tid);
+
+            for (i = 0 ; i < t->events->len ; i++) {
+                Sed_profile_event* e = &g_array_index(t->events, Sed_profile_event, i);
+
+                n += fprintf(fp, ",\n{\"name\":");
+                n += _sed_profile_fprint_json_string(fp, e->name);
+                n += fprintf(fp, ",\"cat\":\"sedflux\",\"ph\":\"X\",\"ts\":%.3f,"
+                        "\"dur\":%.3f,\"pid\":1,\"tid\":%d}",
+                        e->start * 1e6, e->dur * 1e6, t->tid);
+            }
+
+            if (t->n_dropped > 0) {
+                eh_warning("Profile of thread %d is missing %ld trace events",
+                    t->tid, (glong)t->n_dropped);
+            }
+        }
+
+        n += fprintf(fp, "\n]}\n");
+    }
+    g_static_mutex_unlock(&__threads_lock);
+
+    return n;
+}
+
+static gint
+_sed_profile_fprint_csv_string(FILE* fp, const gchar* s)
+{
+    gint n = 0;
+
+    n += fprintf(fp, "\"");
+
+    for (; *s ; s++) {
+        if (*s == '"') {
+            n += fprintf(fp, "\"\"");
+        } else {
+            n += fprintf(fp, "%c", *s);
+        }
+    }
+
+    n += fprintf(fp, "\"");
+
+    return n;
+}
+
+static void
+_sed_profile_merge(const Sed_profile_scope* s, const gchar* path,
+    GHashTable* merged, GPtrArray* order)
+{
+    guint i;
+
+    for (i = 0 ; i < s->order->len ; i++) {
+        Sed_profile_scope* child = g_ptr_array_index(s->order, i);
+        gchar* child_path = (*path) ? g_strconcat(path, "/", child->name, NULL)
+            : g_strdup(child->name);
+        Sed_profile_scope* m = g_hash_table_lookup(merged, child_path);
+
+        if (!m) {
+            m = _sed_profile_scope_new(child_path, NULL);
+            m->depth = child->depth;
+
+            g_hash_table_insert(merged, m->name, m);
+            g_ptr_array_add(order, m);
+        }
+
+        _sed_profile_scope_add(m, child);
+        _sed_profile_merge(child, child_path, merged, order);
+
+        eh_free(child_path);
+    }
+}
+
+/* Estimate a quantile of the calls of a scope from its histogram.  This is
+   the upper edge of the bin that holds the quantile. */
+static double
+_sed_profile_quantile(const Sed_profile_scope* s, double q)
+{
+    double  val = 0.;
+
+    if (s->n_calls > 0) {
+        gint64 n_below = 0;
+        gint   n;
+
+        for (n = 0 ; n < SED_PROFILE_N_BINS - 1 ; n++) {
+            n_below += s->bin[n];
+
+            if (n_below >= q * s->n_calls) {
+                break;
+            }
+        }
+
+        val = (n < SED_PROFILE_N_BINS - 1) ? ldexp(1., n) * 1e-6 : s->max;
+        val = MAX(MIN(val, s->max), s->min);
+    }
+
+    return val;
+}
+
+/** Print a summary of the recorded scopes as CSV.
+
+There is one row for each scope.  Scopes are named by their path (the names
+of the scopes that enclose them and their own name, separated by '/') and
+the calls of all threads to a scope with the same path are added together.
+Times are in seconds.  Self time excludes time spent in sub-steps.  The
+quantiles are estimated from the latency histogram, whose bins (us_lt_X) count
+the calls that took less than X microseconds (and at least as long as the
+previous bin).
+
+\param fp A FILE to print to.
+
+\return The number of bytes written.
+*/
+gint
+sed_profile_fprint_summary(FILE* fp)
+{
+    gint n = 0;
+
+    eh_require(fp);
+
+    g_static_mutex_lock(&__threads_lock);
+    {
+        GHashTable* merged = g_hash_table_new(&g_str_hash, &g_str_equal);
+        GPtrArray*  order  = g_ptr_array_new();
+        GSList*     link;
+        guint       i;
+        gint        b;
+
+        for (link = __threads ; link ; link = link->next) {
+            _sed_profile_merge(((Sed_profile_thread*)link->data)->root, "", merged, order);
+        }
+
+        n += fprintf(fp, "scope,depth,calls,total_s,self_s,mean_s,min_s,max_s,"
+                "p50_s,p90_s,p99_s");
+
+        for (b = 0 ; b < SED_PROFILE_N_BINS - 1 ; b++) {
+            n += fprintf(fp, ",us_lt_%.0f", ldexp(1., b));
+        }
+
+        n += fprintf(fp, ",us_ge_%.0f\n", ldexp(1., SED_PROFILE_N_BINS - 2));
+
+        for (i = 0 ; i < order->len ; i++) {
+            Sed_profile_scope* s = g_ptr_array_index(order, i);
+            n += _sed_profile_fprint_csv_string(fp, s->name);
+            n += fprintf(fp, ",%d,%ld,%g,%g,%g,%g,%g,%g,%g,%g", s->depth, (glong)s->n_calls, s->total, s->self,
+                    (s->n_calls > 0) ? s->total / s->n_calls : 0.,
+                    (s->n_calls > 0) ? s->min : 0., s->max,
+                    _sed_profile_quantile(s, .50),
+                    _sed_profile_quantile(s, .90),
+                    _sed_profile_quantile(s, .99));
+
+            for (b = 0 ; b < SED_PROFILE_N_BINS ; b++) {
+                n += fprintf(fp, ",%ld", (glong)s->bin[b]);
+            }
+
+            n += fprintf(fp, "\n");
+
+            g_hash_table_destroy(s->children);
+            g_ptr_array_free(s->order, TRUE);
+            eh_free(s->name);
+            eh_free(s);
+        }
+
+        g_ptr_array_free(order, TRUE);
+        g_hash_table_destroy(merged);
+    }
+    g_static_mutex_unlock(&__threads_lock);
+
+    return n;
+}
+
+/** Write the profile to a trace file and a summary file.
+
+The Chrome trace goes to prefix.json (see sed_profile_fprint_trace) and the
+CSV summary to prefix.csv (see sed_profile_fprint_summary).
+
+\param prefix Path to the output files, without their extensions.
+\param error  A GError.
+
+\return TRUE if both files were written.
+*/
+gboolean
+sed_profile_write(const gchar* prefix, GError** error)
+{
+    gboolean rtn_val = TRUE;
+
+    eh_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+    eh_require(prefix);
+
+    {
+        GError* tmp_err    = NULL;
+        gchar*  trace_file = g_strconcat(prefix, ".json", NULL);
+        gchar*  csv_file   = g_strconcat(prefix, ".csv", NULL);
+        FILE*   fp;
+
+        if ((fp = eh_fopen_error(trace_file, "w", &tmp_err))) {
+            sed_profile_fprint_trace(fp);
+            fclose(fp);
+        }
+
+        if (!tmp_err && (fp = eh_fopen_error(csv_file, "w", &tmp_err))) {
+            sed_profile_fprint_summary(fp);
+            fclose(fp);
+        }
+
+        if (tmp_err) {
+            g_propagate_error(error, tmp_err);
+            rtn_val = FALSE;
+        }
+
+        eh_free(trace_file);
+        eh_free(csv_file);
+    }
+
+    return rtn_val;
+}
@@ -0,0 +1,86 @@
+//---
+//
+// This file is part of sedflux.
+//
+// sedflux is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// sedflux is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with sedflux; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//---
+
+#if !defined(SED_PROFILE_H)
+# define SED_PROFILE_H
+
+#include <stdio.h>
+#include <glib.h>
+#include "utils/utils.h"
+
+G_BEGIN_DECLS
+
+/** Number of bins of the latency histogram of a scope.
+
+Bin 0 counts calls that took less than 1 microsecond, bin n calls that took
+from 2^(n-1) up to 2^n microseconds, and the last bin every call that took
+longer than that.
+*/
+#define SED_PROFILE_N_BINS (32)
+
+/** Largest number of trace events that are kept for each thread.
+
+Once a thread has recorded this many events, later ones are only counted in
+the summary.
+*/
+#define SED_PROFILE_MAX_EVENTS (1 << 20)
+
+/** Open a named profiling scope.
+
+Scopes nest: a scope opened while another is open on the same thread is
+counted as a sub-step of it.  Every SED_PROFILE_BEGIN must be matched by a
+SED_PROFILE_END on the same thread.  When the profiler is disabled this costs
+a test of a global flag.
+*/
+#define SED_PROFILE_BEGIN(name) G_STMT_START {                    \
+    if (G_UNLIKELY(__sed_profile_enabled)) sed_profile_push(name); \
+} G_STMT_END
+
+/** Close the innermost profiling scope of the calling thread. */
+#define SED_PROFILE_END() G_STMT_START {                          \
+    if (G_UNLIKELY(__sed_profile_enabled)) sed_profile_pop();      \
+} G_STMT_END
+
+extern gboolean __sed_profile_enabled;
+
+void
+sed_profile_enable(gboolean enable);
+gboolean
+sed_profile_is_enabled(void);
+void
+sed_profile_push(const gchar* name);
+void
+sed_profile_pop(void);
+gchar*
+sed_profile_path(void);
+void
+sed_profile_push_path(const gchar* path);
+void
+sed_profile_pop_path(void);
+gint
+sed_profile_fprint_trace(FILE* fp);
+gint
+sed_profile_fprint_summary(FILE* fp);
+gboolean
+sed_profile_write(const gchar* prefix, GError** error);
+
+G_END_DECLS
+
+#endif /* sed_profile.h */
@@ -9,6 +9,9 @@
 //#define ROCK_VALUE (9999)
 //#define WATER_VALUE (-9999)
 
+// Number of values held in memory while writing property files.
+#define SED_PROPERTY_FILE_CHUNK_LEN (1<<22)
+
 CLASS(Sed_property_file_attr)
 {
     Sed_get_val_func get_val;
@@ -173,10 +176,6 @@ sed_property_file_header_destroy(Sed_property_file_header h)
 
 gssize
 sed_property_file_header_fprint(FILE* fp, Sed_property_file_header hdr);
-Sed_property_file_header
-sed_property_file_header_new(const Sed_cube p,
-    Eh_ndgrid g,
-    Sed_property property);
 double
 sed_cube_min_height(Sed_cube p, gssize** col_id);
 double
@@ -195,47 +194,6 @@ sed_cube_property_subgrid(Sed_cube p,
     double upper_right[3],
     double resolution[3]);
 
-gssize
-sed_property_file_write(Sed_property_file sed_fp, Sed_cube p)
-{
-    gssize n = 0;
-
-    eh_require(sed_fp);
-    eh_require(p);
-
-    if (sed_fp && p) {
-        Eh_ndgrid g;
-        double    lower_left[3];
-        double    upper_right[3];
-        double    resolution[3];
-
-        lower_left[0]  = sed_fp->attr->x_lim[0];
-        lower_left[1]  = sed_fp->attr->y_lim[0];
-        lower_left[2]  = sed_fp->attr->z_lim[0];
-        upper_right[0] = sed_fp->attr->x_lim[1];
-        upper_right[1] = sed_fp->attr->y_lim[1];
-        upper_right[2] = sed_fp->attr->z_lim[1];
-        resolution[0]  = sed_fp->attr->x_res;
-        resolution[1]  = sed_fp->attr->y_res;
-        resolution[2]  = sed_fp->attr->z_res;
-
-        g = sed_cube_property_subgrid(p,
-                sed_fp->p,
-                lower_left,
-                upper_right,
-                resolution);
-
-        sed_fp->h = sed_property_file_header_new(p, g, sed_fp->p);
-
-        n += sed_property_file_header_fprint(sed_fp->fp, sed_fp->h);
-        n += eh_ndgrid_write(sed_fp->fp, g);
-
-        eh_ndgrid_destroy(g, TRUE);
-    }
-
-    return n;
-}
-
 gssize
 sed_property_file_header_fprint(FILE* fp, Sed_property_file_header hdr)
 {
@@ -292,67 +250,33 @@ sed_property_file_header_fprint(FILE* fp, Sed_property_file_header hdr)
     return n;
 }
 
-Sed_property_file_header
-sed_property_file_header_new(const Sed_cube p,
-    Eh_ndgrid g,
-    Sed_property property)
-{
-    Sed_property_file_header hdr = NULL;
-
-    eh_require(p);
-    eh_require(g);
-    eh_require(property);
-
-    if (p && g && property) {
-        NEW_OBJECT(Sed_property_file_header, hdr);
-
-        hdr->n_rows       = eh_ndgrid_n(g, 2);
-        hdr->n_y_cols     = eh_ndgrid_n(g, 1);
-        hdr->n_x_cols     = eh_ndgrid_n(g, 0);
-        hdr->cell_dx      = sed_cube_x_res(p);
-        hdr->cell_dy      = sed_cube_y_res(p);
-        hdr->cell_dz      = sed_cube_z_res(p);
-        hdr->property     = property;
-        hdr->sea_level    = sed_cube_sea_level(p);
-        hdr->ref_z        = eh_ndgrid_x(g, 2)[0];
-        hdr->ref_y        = eh_ndgrid_x(g, 1)[0];
-        hdr->ref_x        = eh_ndgrid_x(g, 0)[0];
-        hdr->byte_order   = G_BYTE_ORDER;
-        hdr->element_size = sizeof(double);
-        hdr->rock_value   =  ROCK_VALUE;
-        hdr->water_value  =  WATER_VALUE;
-    }
-
-    return hdr;
+/* Geometry of the grid that a cube is sampled onto for a property file.
+   Columns are listed with y varying fastest.
+*/
+typedef struct {
+    gssize* cols;
+    gssize n_cols;
+    gssize n_x_cols;
+    gssize n_y_cols;
+    gssize n_rows;
+    double lower_left[3];
+    double res[3];
 }
+Sed_subgrid_geometry;
 
-Eh_ndgrid
-sed_cube_property_subgrid(Sed_cube p,
-    Sed_property property,
+static void
+_sed_cube_subgrid_geometry(Sed_cube p,
     double lower_left[3],
     double upper_right[3],
-    double resolution[3])
+    double resolution[3],
+    Sed_subgrid_geometry* geom)
 {
-    gssize i, j, k, n, id;
-    double bottom, top;
+    gssize i, j, n;
     double dx, dy, dz;
-    double hydro_static;
-    double* load;
-    gssize sediment_rows, rock_rows, water_rows;
-    gssize top_sed, bot_sed;
-    Sed_column col_temp;
-    Eh_dbl_grid g;
-    Eh_ndgrid g_3;
     double lower_left_x, lower_left_y, lower_left_z;
     double upper_right_x, upper_right_y, upper_right_z;
     gssize* cols, *x_cols, *y_cols;
-    gssize n_rows, n_x_cols, n_y_cols;
-    gboolean with_load, excess_pressure;
-
-    excess_pressure = sed_property_is_named(property, "EXCESS PRESSURE");
-    with_load = sed_property_is_named(property, "EXCESS PRESSURE")
-        | sed_property_is_named(property, "COHESION")
-        | sed_property_is_named(property, "SHEAR STRENGTH");
+    gssize n_x_cols, n_y_cols;
 
     lower_left_x = sed_cube_col_x(p, 0);
     lower_left_y = sed_cube_col_y(p, 0);
@@ -403,89 +327,522 @@ sed_cube_property_subgrid(Sed_cube p,
     eh_free(x_cols);
     eh_free(y_cols);
 
-    n_rows = sed_cube_n_rows_between(p, dz, lower_left_z, upper_right_z, cols);
-    g_3    = eh_ndgrid_malloc(3, sizeof(double), n_x_cols, n_y_cols, n_rows);
-    g      = eh_ndgrid_to_grid(g_3);
+    geom->cols          = cols;
+    geom->n_cols        = n_x_cols * n_y_cols;
+    geom->n_x_cols      = n_x_cols;
+    geom->n_y_cols      = n_y_cols;
+    geom->n_rows        = sed_cube_n_rows_between(p, dz, lower_left_z,
+            upper_right_z, cols);
+    geom->lower_left[0] = lower_left_x;
+    geom->lower_left[1] = lower_left_y;
+    geom->lower_left[2] = lower_left_z;
+    geom->res[0]        = dx;
+    geom->res[1]        = dy;
+    geom->res[2]        = dz;
+}
 
-    eh_dbl_array_grid(eh_ndgrid_x(g_3, 0), eh_ndgrid_n(g_3, 0), lower_left_x, dx);
-    eh_dbl_array_grid(eh_ndgrid_x(g_3, 1), eh_ndgrid_n(g_3, 1), lower_left_y, dy);
-    eh_dbl_array_grid(eh_ndgrid_x(g_3, 2), eh_ndgrid_n(g_3, 2), lower_left_z, dz);
+static Sed_property_file_header
+_sed_property_file_header_new(const Sed_cube p,
+    const Sed_subgrid_geometry* geom,
+    Sed_property property)
+{
+    Sed_property_file_header hdr = NULL;
 
-    col_temp = sed_column_dup(sed_cube_col(p, cols[0]));
+    NEW_OBJECT(Sed_property_file_header, hdr);
+
+    hdr->n_rows       = geom->n_rows;
+    hdr->n_y_cols     = geom->n_y_cols;
+    hdr->n_x_cols     = geom->n_x_cols;
+    hdr->cell_dx      = sed_cube_x_res(p);
+    hdr->cell_dy      = sed_cube_y_res(p);
+    hdr->cell_dz      = sed_cube_z_res(p);
+    hdr->property     = property;
+    hdr->sea_level    = sed_cube_sea_level(p);
+    hdr->ref_z        = geom->lower_left[2];
+    hdr->ref_y        = geom->lower_left[1];
+    hdr->ref_x        = geom->lower_left[0];
+    hdr->byte_order   = G_BYTE_ORDER;
+    hdr->element_size = sizeof(double);
+    hdr->rock_value   =  ROCK_VALUE;
+    hdr->water_value  =  WATER_VALUE;
 
-    top    = lower_left_z + n_rows * dz;
-    bottom = lower_left_z;
+    return hdr;
+}
 
-    for (i = 0, id = cols[0], n = 0 ; cols[n] >= 0 ; i++, id = cols[++n]) {
-        sed_column_copy(col_temp, sed_cube_col(p, id));
+typedef struct {
+    Sed_property* property;
+    gint n_properties;
+    gboolean* with_load;
+    gboolean* excess_pressure;
+    gboolean any_load;
+    double dz;
+    gssize n_rows;
+    double top;
+    double bottom;
+    double** data;
+}
+Sed_subgrid_job;
 
-        sed_column_set_z_res(col_temp, dz);
-        sed_column_rebin(col_temp);
-        sed_column_strip(col_temp, bottom, top);
+/* Set up a job that measures n properties.  The values for the i-th column
+   of the job's list of columns go to data[n] + i*n_rows.
+*/
+static void
+_sed_subgrid_job_init(Sed_subgrid_job* job, Sed_property* property, gint n,
+    const Sed_subgrid_geometry* geom, double** data)
+{
+    gint k;
+
+    job->property        = property;
+    job->n_properties    = n;
+    job->with_load       = eh_new(gboolean, n);
+    job->excess_pressure = eh_new(gboolean, n);
+    job->any_load        = FALSE;
+    job->dz              = geom->res[2];
+    job->n_rows          = geom->n_rows;
+    job->top             = geom->lower_left[2] + geom->n_rows * geom->res[2];
+    job->bottom          = geom->lower_left[2];
+    job->data            = data;
+
+    for (k = 0 ; k < n ; k++) {
+        job->excess_pressure[k] = sed_property_is_named(property[k],
+                "EXCESS PRESSURE");
+        job->with_load[k] = sed_property_is_named(property[k], "EXCESS PRESSURE")
+            | sed_property_is_named(property[k], "COHESION")
+            | sed_property_is_named(property[k], "SHEAR STRENGTH");
+
+        job->any_load |= job->with_load[k];
+    }
+}
+
+static void
+_sed_subgrid_job_clear(Sed_subgrid_job* job)
+{
+    eh_free(job->with_load);
+    eh_free(job->excess_pressure);
+}
+
+/* Rebin column id once and fill its rows with the values of each of the
+   job's properties.
+*/
+static void
+_sed_cube_property_subgrid_column(Sed_cube p, gssize i, gssize id, Sed_worker w,
+    gpointer data)
+{
+    Sed_subgrid_job* job = (Sed_subgrid_job*)data;
+    const double dz      = job->dz;
+    const gssize n_rows  = job->n_rows;
+    Sed_column col_temp  = (Sed_column)sed_worker_data(w);
+    double* load         = NULL;
+    double hydro_static  = 0.;
+    gssize sediment_rows, rock_rows, water_rows;
+    gssize top_sed, bot_sed;
+    gssize j, k;
+    gint n;
+
+    if (!col_temp) {
+        col_temp = sed_column_dup(sed_cube_col(p, id));
+        sed_worker_set_data(w, col_temp, (GDestroyNotify)&sed_column_destroy);
+    }
 
-        water_rows = eh_round((lower_left_z
-                    + n_rows * dz
-                    - sed_column_top_height(col_temp))
-                / dz,
-                1.);
+    sed_column_copy(col_temp, sed_cube_col(p, id));
 
-        if (water_rows < 0) {
-            water_rows = 0;
+    sed_column_set_z_res(col_temp, dz);
+    sed_column_rebin(col_temp);
+    sed_column_strip(col_temp, job->bottom, job->top);
+
+    water_rows = eh_round((job->top - sed_column_top_height(col_temp)) / dz, 1.);
+
+    if (water_rows < 0) {
+        water_rows = 0;
+    }
+
+    sediment_rows = sed_column_len(col_temp);
+    rock_rows     = n_rows - sediment_rows - water_rows;
+    top_sed       = sediment_rows - 1;
+    bot_sed       = 0;
+
+    if (rock_rows < 0) {
+        rock_rows = 0;
+        sediment_rows = n_rows - water_rows;
+        bot_sed = top_sed - sediment_rows + 1;
+
+        if (sediment_rows <= 0) {
+            sediment_rows = 0;
+            water_rows = n_rows;
+            top_sed = -1;
+            bot_sed = 0;
         }
+    }
 
-        sediment_rows = sed_column_len(col_temp);
-        rock_rows     = n_rows - sediment_rows - water_rows;
-        top_sed       = sediment_rows - 1;
-        bot_sed       = 0;
-
-        if (rock_rows < 0) {
-            rock_rows = 0;
-            sediment_rows = n_rows - water_rows;
-            bot_sed = top_sed - sediment_rows + 1;
-
-            if (sediment_rows <= 0) {
-                sediment_rows = 0;
-                water_rows = n_rows;
-                top_sed = -1;
-                bot_sed = 0;
-            }
+    if (job->any_load) {
+        // sed_column_load runs to the top of the column if sediment_rows is 0.
+        load = sed_worker_scratch(w, 0, sed_column_len(col_temp) + 1);
+        sed_column_load(col_temp, bot_sed, sediment_rows, load);
+
+        hydro_static = sed_column_water_pressure(col_temp);
+    }
+
+    for (n = 0 ; n < job->n_properties ; n++) {
+        Sed_property property = job->property[n];
+        double* row = job->data[n] + i * n_rows;
+
+        for (j = 0, k = 0 ; j < water_rows; j++, k++) {
+            row[k] = WATER_VALUE;
         }
 
-        if (with_load) {
-            load = sed_column_load(col_temp, bot_sed, sediment_rows, NULL);
+        if (job->excess_pressure[n]) {
+            for (j = top_sed ; j >= bot_sed ; j--, k++)
+                row[k] = sed_property_measure(property,
+                        sed_column_nth_cell(col_temp, j), hydro_static);
+        } else if (job->with_load[n]) {
+            for (j = top_sed ; j >= bot_sed ; j--, k++)
+                row[k] = sed_property_measure(property,
+                        sed_column_nth_cell(col_temp, j), load[j - bot_sed]);
+        } else {
+            for (j = top_sed ; j >= bot_sed ; j--, k++)
+                row[k] = sed_property_measure(property,
+                        sed_column_nth_cell(col_temp, j), -1);
         }
 
-        if (excess_pressure) {
-            hydro_static = sed_column_water_pressure(col_temp);
+        for (j = 0; j < rock_rows; j++, k++) {
+            row[k] = ROCK_VALUE;
+        }
+    }
+}
 
-            for (j = top_sed ; j >= bot_sed ; j--) {
-                load[j - bot_sed] = hydro_static;
-            }
+Eh_ndgrid
+sed_cube_property_subgrid(Sed_cube p,
+    Sed_property property,
+    double lower_left[3],
+    double upper_right[3],
+    double resolution[3])
+{
+    Eh_ndgrid g_3;
+    Sed_subgrid_geometry geom;
+    Sed_subgrid_job job;
+    double* data;
+
+    _sed_cube_subgrid_geometry(p, lower_left, upper_right, resolution, &geom);
+
+    g_3 = eh_ndgrid_malloc(3, sizeof(double), geom.n_x_cols, geom.n_y_cols,
+            geom.n_rows);
+
+    eh_dbl_array_grid(eh_ndgrid_x(g_3, 0), eh_ndgrid_n(g_3, 0), geom.lower_left[0],
+        geom.res[0]);
+    eh_dbl_array_grid(eh_ndgrid_x(g_3, 1), eh_ndgrid_n(g_3, 1), geom.lower_left[1],
+        geom.res[1]);
+    eh_dbl_array_grid(eh_ndgrid_x(g_3, 2), eh_ndgrid_n(g_3, 2), geom.lower_left[2],
+        geom.res[2]);
+
+    // The grid is stored column by column so the columns can be filled in place.
+    data = eh_ndgrid_start(g_3);
+
+    _sed_subgrid_job_init(&job, &property, 1, &geom, &data);
+
+    sed_cube_foreach_column_list_parallel(p, geom.cols, geom.n_cols,
+        &_sed_cube_property_subgrid_column, &job);
+
+    _sed_subgrid_job_clear(&job);
+
+    eh_free(geom.cols);
+
+    return g_3;
+}
+
+/* Run-length encoder that writes a stream of doubles in the format of
+   eh_dbl_array_write but a piece at a time.  Runs of equal values are held
+   as a count.  Runs of unequal values are written as they arrive and the
+   size of their record is filled in once the run ends.  A run may span
+   any number of pieces so the output is the same as writing the whole
+   array at once.
+*/
+typedef enum {
+    SED_RLE_EMPTY,
+    SED_RLE_ONE,
+    SED_RLE_EQUAL,
+    SED_RLE_UNEQUAL
+}
+Sed_rle_state;
+
+#define SED_RLE_BUFFER_LEN (4096)
+
+typedef struct {
+    FILE* fp;
+    Sed_rle_state state;
+    double val;
+    gint n;
+    long pos;
+    double buf[SED_RLE_BUFFER_LEN];
+    gint buf_len;
+    gssize bytes;
+}
+Sed_rle_writer;
+
+static void
+_sed_rle_writer_init(Sed_rle_writer* w, FILE* fp)
+{
+    w->fp      = fp;
+    w->state   = SED_RLE_EMPTY;
+    w->val     = 0.;
+    w->n       = 0;
+    w->pos     = 0;
+    w->buf_len = 0;
+    w->bytes   = 0;
+}
+
+static void
+_sed_rle_flush_buffer(Sed_rle_writer* w)
+{
+    if (w->buf_len > 0) {
+        w->bytes += fwrite(w->buf, sizeof(double), w->buf_len, w->fp)
+            * sizeof(double);
+        w->buf_len = 0;
+    }
+}
+
+static void
+_sed_rle_write_val(Sed_rle_writer* w, double val)
+{
+    w->buf[w->buf_len++] = val;
+
+    if (w->buf_len == SED_RLE_BUFFER_LEN) {
+        _sed_rle_flush_buffer(w);
+    }
+}
+
+static void
+_sed_rle_write_equal(Sed_rle_writer* w)
+{
+    gint el_size = sizeof(double);
+
+    w->bytes += fwrite(&el_size, sizeof(int), 1, w->fp) * sizeof(int);
+    w->bytes += fwrite(&(w->n), sizeof(int), 1, w->fp) * sizeof(int);
+    w->bytes += fwrite(&(w->val), sizeof(double), 1, w->fp) * sizeof(double);
+}
+
+static void
+_sed_rle_begin_unequal(Sed_rle_writer* w)
+{
+    gint size = 0, one = 1;
+
+    w->pos    = ftell(w->fp);
+    w->bytes += fwrite(&size, sizeof(int), 1, w->fp) * sizeof(int);
+    w->bytes += fwrite(&one, sizeof(int), 1, w->fp) * sizeof(int);
+}
+
+static void
+_sed_rle_end_unequal(Sed_rle_writer* w)
+{
+    gint size = w->n * sizeof(double);
+    long end;
+
+    _sed_rle_flush_buffer(w);
+
+    end = ftell(w->fp);
+
+    fseek(w->fp, w->pos, SEEK_SET);
+    fwrite(&size, sizeof(int), 1, w->fp);
+    fseek(w->fp, end, SEEK_SET);
+}
+
+static void
+_sed_rle_writer_push(Sed_rle_writer* w, const double* x, gssize len)
+{
+    gssize i;
+
+    for (i = 0 ; i < len ; i++) {
+        const double val = x[i];
+
+        switch (w->state) {
+            case SED_RLE_EMPTY:
+                w->val   = val;
+                w->n     = 1;
+                w->state = SED_RLE_ONE;
+                break;
+
+            case SED_RLE_ONE:
+                if (val == w->val) {
+                    w->n     = 2;
+                    w->state = SED_RLE_EQUAL;
+                } else {
+                    _sed_rle_begin_unequal(w);
+                    _sed_rle_write_val(w, w->val);
+                    w->val   = val;
+                    w->n     = 1;
+                    w->state = SED_RLE_UNEQUAL;
+                }
+
+                break;
+
+            case SED_RLE_EQUAL:
+                if (val == w->val) {
+                    w->n++;
+                } else {
+                    _sed_rle_write_equal(w);
+                    w->val   = val;
+                    w->n     = 1;
+                    w->state = SED_RLE_ONE;
+                }
+
+                break;
+
+            case SED_RLE_UNEQUAL:
+                // The last value is held back; it starts a run if the next
+                // value is the same.
+                if (val != w->val) {
+                    _sed_rle_write_val(w, w->val);
+                    w->val = val;
+                    w->n++;
+                } else {
+                    _sed_rle_end_unequal(w);
+                    w->n     = 2;
+                    w->state = SED_RLE_EQUAL;
+                }
+
+                break;
         }
+    }
+}
 
-        for (j = 0, k = 0 ; j < water_rows; j++, k++) {
-            eh_dbl_grid_set_val(g, i, k, WATER_VALUE);
+static gssize
+_sed_rle_writer_finish(Sed_rle_writer* w)
+{
+    switch (w->state) {
+        case SED_RLE_EMPTY:
+            break;
+
+        case SED_RLE_ONE:
+        case SED_RLE_EQUAL:
+            _sed_rle_write_equal(w);
+            break;
+
+        case SED_RLE_UNEQUAL:
+            _sed_rle_write_val(w, w->val);
+            w->n++;
+            _sed_rle_end_unequal(w);
+            break;
+    }
+
+    w->state = SED_RLE_EMPTY;
+
+    return w->bytes;
+}
+
+/** Write a set of property files for a cube in one pass.
+
+Each column of the cube is rebinned once and every property is measured
+from the rebinned column.  Columns are processed in chunks by the column
+worker pool (see sed_cube_foreach_column_list_parallel) and each chunk is
+appended to the files before the next one is computed, so the memory
+needed is bounded by SED_PROPERTY_FILE_CHUNK_LEN values rather than the
+size of the cube.  The files are identical to those written one at a time
+by sed_property_file_write.
+
+The limits and resolution are taken from the attributes of the first file.
+
+\param f A NULL-terminated array of Sed_property_file's
+\param p A Sed_cube
+
+\return The total number of bytes written to all of the files.
+*/
+gssize
+sed_property_file_write_all(Sed_property_file* f, Sed_cube p)
+{
+    gssize n = 0;
+
+    eh_require(f);
+    eh_require(p);
+
+    if (f && f[0] && p) {
+        Sed_subgrid_geometry geom;
+        Sed_subgrid_job job;
+        Sed_property* property;
+        Sed_rle_writer* rle;
+        double** data;
+        double lower_left[3];
+        double upper_right[3];
+        double resolution[3];
+        gssize n_files, n_chunk, start;
+        gint k;
+
+        for (n_files = 0 ; f[n_files] ; n_files++);
+
+        lower_left[0]  = f[0]->attr->x_lim[0];
+        lower_left[1]  = f[0]->attr->y_lim[0];
+        lower_left[2]  = f[0]->attr->z_lim[0];
+        upper_right[0] = f[0]->attr->x_lim[1];
+        upper_right[1] = f[0]->attr->y_lim[1];
+        upper_right[2] = f[0]->attr->z_lim[1];
+        resolution[0]  = f[0]->attr->x_res;
+        resolution[1]  = f[0]->attr->y_res;
+        resolution[2]  = f[0]->attr->z_res;
+
+        _sed_cube_subgrid_geometry(p, lower_left, upper_right, resolution, &geom);
+
+        n_chunk = SED_PROPERTY_FILE_CHUNK_LEN / MAX(n_files * geom.n_rows, 1);
+        eh_clamp(n_chunk, 1, MAX(geom.n_cols, 1));
+
+        property = eh_new(Sed_property, n_files);
+        data     = eh_new(double*, n_files);
+        rle      = eh_new(Sed_rle_writer, n_files);
+
+        for (k = 0 ; k < n_files ; k++) {
+            property[k] = f[k]->p;
+            data[k]     = eh_new(double, n_chunk * geom.n_rows);
+            f[k]->h     = _sed_property_file_header_new(p, &geom, f[k]->p);
+
+            n += sed_property_file_header_fprint(f[k]->fp, f[k]->h);
+
+            _sed_rle_writer_init(rle + k, f[k]->fp);
         }
 
-        for (j = top_sed ; j >= bot_sed ; j--, k++)
-            eh_dbl_grid_set_val(g, i, k, sed_property_measure(property,
-                    sed_column_nth_cell(col_temp, j),
-                    (with_load) ? (load[j - bot_sed]) : (-1)));
+        _sed_subgrid_job_init(&job, property, n_files, &geom, data);
 
-        for (j = 0; j < rock_rows; j++, k++) {
-            eh_dbl_grid_set_val(g, i, k, ROCK_VALUE);
+        for (start = 0 ; start < geom.n_cols ; start += n_chunk) {
+            const gssize len = MIN(n_chunk, geom.n_cols - start);
+
+            sed_cube_foreach_column_list_parallel(p, geom.cols + start, len,
+                &_sed_cube_property_subgrid_column, &job);
+
+            for (k = 0 ; k < n_files ; k++) {
+                _sed_rle_writer_push(rle + k, data[k], len * geom.n_rows);
+            }
         }
 
-        if (with_load) {
-            eh_free(load);
+        for (k = 0 ; k < n_files ; k++) {
+            n += _sed_rle_writer_finish(rle + k);
+            eh_free(data[k]);
         }
+
+        _sed_subgrid_job_clear(&job);
+
+        eh_free(rle);
+        eh_free(data);
+        eh_free(property);
+        eh_free(geom.cols);
     }
 
-    eh_free(cols);
-    sed_column_destroy(col_temp);
-    eh_grid_destroy(g, FALSE);
+    return n;
+}
 
-    return g_3;
+gssize
+sed_property_file_write(Sed_property_file sed_fp, Sed_cube p)
+{
+    gssize n = 0;
+
+    eh_require(sed_fp);
+    eh_require(p);
+
+    if (sed_fp && p) {
+        Sed_property_file f[2];
+
+        f[0] = sed_fp;
+        f[1] = NULL;
+
+        n = sed_property_file_write_all(f, p);
+    }
+
+    return n;
 }
 
 double
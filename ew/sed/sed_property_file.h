@@ -28,6 +28,8 @@ Sed_property_file
 sed_property_file_destroy(Sed_property_file f);
 gssize
 sed_property_file_write(Sed_property_file sed_fp, Sed_cube p);
+gssize
+sed_property_file_write_all(Sed_property_file* f, Sed_cube p);
 
 Sed_property_file_attr
 sed_property_file_attr_new();
@@ -37,9 +37,12 @@
 #include "sed_tripod.h"
 #include "sed_property_file.h"
 #include "sed_process.h"
+#include "sed_profile.h"
 #include "sed_epoch.h"
+#include "sed_checkpoint.h"
 #include "sed_river.h"
 #include "sed_signal.h"
+#include "sed_output.h"
 #include "sed_diag.h"
 
 #endif
@@ -3,6 +3,7 @@
 #include <string.h>
 
 #include "sed_tripod.h"
+#include "sed_output.h"
 
 CLASS(Sed_measurement)
 {
@@ -109,6 +110,10 @@ sed_tripod_destroy(Sed_tripod t)
         sed_tripod_attr_destroy(t->attr);
         sed_tripod_header_destroy(t->h);
         sed_measurement_destroy(t->x);
+
+        // Records may still be waiting to be written to the file.
+        sed_output_wait(t);
+
         fclose(t->fp);
         eh_free(t);
     }
@@ -157,6 +162,41 @@ sed_tripod_attr_dup(Sed_tripod_attr src)
     return sed_tripod_attr_copy(NULL, src);
 }
 
+typedef struct {
+    Sed_tripod t;
+    Eh_pt_2* pos;
+    double* data;
+    volatile gint n_out; ///< Number of positions outside of the cube
+}
+Sed_tripod_job;
+
+static void
+_sed_tripod_measure_worker(Sed_cube c, gssize n, gssize id, Sed_worker w,
+    gpointer user_data)
+{
+    Sed_tripod_job* job = (Sed_tripod_job*)user_data;
+    Sed_tripod t        = job->t;
+
+    if (job->pos) {
+        gssize i_measure, j_measure;
+        double x_0 = sed_cube_col_x(c, 0);
+        double y_0 = sed_cube_col_y(c, 0);
+
+        i_measure = (gssize)((job->pos[n].x - x_0) / sed_cube_x_res(c));
+        j_measure = (gssize)((job->pos[n].y - y_0) / sed_cube_y_res(c));
+
+        // Workers don't log; the caller reports positions out of the domain.
+        if (!sed_cube_is_in_domain(c, i_measure, j_measure)) {
+            g_atomic_int_inc(&(job->n_out));
+            job->data[n] = eh_nan();
+        } else {
+            job->data[n] = (t->x->f)(c, i_measure, j_measure);
+        }
+    } else {
+        job->data[n] = (t->x->f)(c, 0, id);
+    }
+}
+
 double*
 sed_tripod_measure(Sed_tripod t, Sed_cube c, Eh_pt_2* pos, double* data, gssize len)
 {
@@ -164,32 +204,23 @@ sed_tripod_measure(Sed_tripod t, Sed_cube c, Eh_pt_2* pos, double* data, gssize
     eh_require(c);
 
     if (t && c) {
+        Sed_tripod_job job;
 
         eh_require(t->x);
         eh_require(t->x->f);
 
-        if (pos) {
-            gssize i, i_measure, j_measure;
-            double x_0 = sed_cube_col_x(c, 0);
-            double y_0 = sed_cube_col_y(c, 0);
-
-            for (i = 0 ; i < len ; i++) {
-                i_measure = (gssize)((pos[i].x - x_0) / sed_cube_x_res(c));
-                j_measure = (gssize)((pos[i].y - y_0) / sed_cube_y_res(c));
-
-                if (!sed_cube_is_in_domain(c, i_measure, j_measure)) {
-                    eh_message("OUT OF DOMAIN");
-                    data[i] = eh_nan();
-                } else {
-                    data[i] = (t->x->f)(c, i_measure, j_measure);
-                }
-            }
-        } else {
-            gssize id;
+        job.t     = t;
+        job.pos   = pos;
+        job.data  = data;
+        job.n_out = 0;
 
-            for (id = 0 ; id < len ; id++) {
-                data[id] = (t->x->f)(c, 0, id);
-            }
+        // Each measuring point is either a position or, without positions, a
+        // column id.
+        sed_cube_foreach_column_list_parallel(c, NULL, len,
+            &_sed_tripod_measure_worker, &job);
+
+        if (job.n_out > 0) {
+            eh_message("OUT OF DOMAIN (%d of %d positions)", job.n_out, (gint)len);
         }
     } else {
         data = NULL;
@@ -685,6 +716,48 @@ sed_tripod_header_fprint(FILE* fp, Sed_tripod_header h)
     return n;
 }
 
+typedef struct {
+    FILE*    fp;
+    double   time;
+    Eh_pt_2* location;
+    double*  measurement;
+    gint     len;
+}
+Sed_tripod_record;
+
+static void
+_sed_tripod_record_write(gpointer data)
+{
+    Sed_tripod_record* r = (Sed_tripod_record*)data;
+
+    fwrite(&(r->time), sizeof(double), 1, r->fp);
+    fwrite(r->location, sizeof(Eh_pt_2), r->len, r->fp);
+    fwrite(r->measurement, sizeof(double), r->len, r->fp);
+
+    fflush(r->fp);
+}
+
+static void
+_sed_tripod_record_destroy(gpointer data)
+{
+    Sed_tripod_record* r = (Sed_tripod_record*)data;
+
+    eh_free(r->measurement);
+    eh_free(r->location);
+    eh_free(r);
+}
+
+/** Measure a cube and write the measurements to a tripod file
+
+The measurements are made right away but they are written by the output
+threads (see sed_output_push) so the value that is returned is the
+number of items that will be written.
+
+\param t    A Sed_tripod
+\param cube The Sed_cube to measure
+
+\return The number of items written
+*/
 gssize
 sed_tripod_write(Sed_tripod t, Sed_cube cube)
 {
@@ -695,12 +768,12 @@ sed_tripod_write(Sed_tripod t, Sed_cube cube)
 
     if (t && cube) {
         gssize i;
-        double time;
         double* measurement;
         Eh_pt_2* location;
         int n_measurements;
         gint32 rec_len;
         Sed_tripod_header h = t->h;
+        Sed_tripod_record* r;
 
         //---
         // Set up the positions where a measurement will be made.  The positions
@@ -752,16 +825,16 @@ sed_tripod_write(Sed_tripod t, Sed_cube cube)
         // then the x-y positions of the measurements, the the measuremnts
         // themselves.  The locations are written as x-y pairs of doubles.
         //---
-        time = sed_cube_age_in_years(cube);
-
-        n += fwrite(&time, sizeof(double), 1, t->fp);
-        n += fwrite(location, sizeof(Eh_pt_2), n_measurements, t->fp);
-        n += fwrite(measurement, sizeof(double), n_measurements, t->fp);
+        r              = eh_new(Sed_tripod_record, 1);
+        r->fp          = t->fp;
+        r->time        = sed_cube_age_in_years(cube);
+        r->location    = location;
+        r->measurement = measurement;
+        r->len         = n_measurements;
 
-        fflush(t->fp);
+        n += 1 + 2 * n_measurements;
 
-        eh_free(measurement);
-        eh_free(location);
+        sed_output_push(t, _sed_tripod_record_write, r, _sed_tripod_record_destroy);
     }
 
     return n;
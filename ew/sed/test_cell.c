@@ -580,6 +580,58 @@ test_cell_array_delete_empty(void)
     sed_cell_array_free(a);
 }
 
+void
+test_cell_pool(void)
+{
+    Sed_cell_pool p = sed_cell_pool_new(4, 8);
+    Sed_cell c[20];
+    gint i;
+
+    g_assert(p != NULL);
+    g_assert(sed_cell_pool_new(0, 8) == NULL);
+
+    for (i = 0 ; i < 20 ; i++) {
+        c[i] = sed_cell_pool_alloc(p);
+
+        g_assert(c[i] != NULL);
+        g_assert_cmpint(sed_cell_n_types(c[i]), ==, 4);
+        g_assert(sed_cell_is_clear(c[i]));
+    }
+
+    g_assert_cmpint(sed_cell_pool_n_in_use(p), ==, 20);
+    g_assert_cmpint(sed_cell_pool_capacity(p), ==, 24);
+
+    sed_cell_add_equal_amounts(c[0], 1.);
+    sed_cell_add_equal_amounts(c[19], 2.);
+    g_assert(eh_compare_dbl(sed_cell_size(c[0]), 4., 1e-12));
+    g_assert(eh_compare_dbl(sed_cell_size(c[19]), 8., 1e-12));
+    g_assert(eh_compare_dbl(sed_cell_fraction(c[0], 3), .25, 1e-12));
+
+    for (i = 0 ; i < 10 ; i++) {
+        c[i] = sed_cell_destroy(c[i]);
+    }
+
+    g_assert_cmpint(sed_cell_pool_n_in_use(p), ==, 10);
+
+    { /* Freed cells are reused before new slabs are added */
+        Sed_cell d = sed_cell_pool_alloc(p);
+
+        g_assert(sed_cell_is_clear(d));
+        g_assert_cmpint(sed_cell_pool_capacity(p), ==, 24);
+
+        sed_cell_destroy(d);
+    }
+
+    for (i = 10 ; i < 20 ; i++) {
+        sed_cell_destroy(c[i]);
+    }
+
+    g_assert_cmpint(sed_cell_pool_n_in_use(p), ==, 0);
+
+    p = sed_cell_pool_destroy(p);
+    g_assert(p == NULL);
+}
+
 int
 main(int argc, char* argv[])
 {
@@ -609,6 +661,7 @@ main(int argc, char* argv[])
     g_test_add_func("/libsed/sed_cell/separate_fraction", &test_cell_separate_fraction);
     g_test_add_func("/libsed/sed_cell/is_valid", &test_cell_is_valid);
     g_test_add_func("/libsed/sed_cell/array_delete", &test_cell_array_delete_empty);
+    g_test_add_func("/libsed/sed_cell/pool", &test_cell_pool);
 
     g_test_run();
 }
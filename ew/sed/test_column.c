@@ -330,6 +330,104 @@ test_sed_column_add_cell(void)
 }
 
 
+void
+test_sed_column_contiguous(void)
+{
+    Sed_column c = sed_column_new_with_storage(5, SED_COLUMN_STORAGE_CONTIGUOUS);
+    Sed_column d = sed_column_new_with_storage(5, SED_COLUMN_STORAGE_CELLS);
+    Sed_cell s = sed_cell_new_classed(NULL, 1., S_SED_TYPE_SAND | S_SED_TYPE_CLAY);
+    const gssize n_grains = sed_sediment_env_n_types();
+    double* f;
+    gssize i, n;
+
+    g_assert(sed_column_is_contiguous(c));
+    g_assert(!sed_column_is_contiguous(d));
+    g_assert(sed_column_fraction_data(d) == NULL);
+
+    sed_column_add_cell(c, s);
+    sed_column_add_cell(d, s);
+
+    sed_cell_resize(s, 1023.5);
+    sed_column_add_cell(c, s);
+    sed_column_add_cell(d, s);
+
+    g_assert(sed_column_len(c) == 1025);
+    g_assert(sed_column_is_same(c, d));
+    g_assert(fabs(sed_column_mass(c) - sed_column_mass(d)) < 1e-6);
+
+    f = sed_column_fraction_data(c);
+    g_assert(f != NULL);
+
+    for (i = 0 ; i < sed_column_len(c) ; i++)
+        for (n = 0 ; n < n_grains ; n++) {
+            g_assert(fabs(f[i * n_grains + n]
+                    - sed_cell_fraction(sed_column_nth_cell(d, i), n)) < 1e-12);
+        }
+
+    { /* Loads read from the fraction matrix match those of the cells */
+        double* load_c = sed_column_total_load(c, 0, -1, 0., NULL);
+        double* load_d = sed_column_total_load(d, 0, -1, 0., NULL);
+
+        for (i = 0 ; i < sed_column_len(c) ; i++) {
+            g_assert(fabs(load_c[i] - load_d[i]) <= 1e-12 * fabs(load_d[i]));
+        }
+
+        eh_free(load_d);
+        eh_free(load_c);
+    }
+
+    { /* Thicknesses are gathered from the block */
+        double* t = sed_column_thickness_array(c, 1, -1, NULL);
+
+        for (i = 1 ; i < sed_column_len(c) ; i++) {
+            g_assert(fabs(t[i - 1] - sed_cell_size(sed_column_nth_cell(d, i))) < 1e-12);
+        }
+
+        eh_free(t);
+    }
+
+    { /* The extracted top cell is owned by the caller */
+        Sed_cell top = sed_column_extract_top_cell_loc(c);
+
+        g_assert(sed_column_len(c) == 1024);
+        g_assert(!sed_cell_is_in_block(top));
+        g_assert(sed_cell_is_same(top, sed_column_top_cell(d)));
+
+        sed_column_add_cell(c, top);
+        sed_cell_destroy(top);
+
+        g_assert(sed_column_is_same(c, d));
+    }
+
+    { /* Cells stacked by location are copied into the block */
+        Sed_cell* top = sed_column_extract_top_n_cells(c, 3);
+
+        g_assert(sed_column_len(c) == 1022);
+        g_assert(!sed_cell_is_in_block(top[0]));
+
+        sed_column_stack_cells_loc(c, top);
+
+        g_assert(sed_column_len(c) == 1025);
+        g_assert(sed_column_is_same(c, d));
+
+        eh_free(top);
+    }
+
+    { /* Copies keep the storage of the source column */
+        Sed_column e = sed_column_dup(c);
+
+        g_assert(sed_column_is_contiguous(e));
+        g_assert(sed_column_is_same(c, e));
+
+        sed_column_destroy(e);
+    }
+
+    sed_cell_destroy(s);
+    sed_column_destroy(c);
+    sed_column_destroy(d);
+}
+
+
 void
 test_sed_column_add_cell_empty(void)
 {
@@ -780,6 +878,161 @@ test_sed_column_load_null(void)
 }
 
 
+void
+test_sed_column_load_cache(void)
+{
+    Sed_column c  = sed_column_new(15);
+    Sed_cell cell = sed_cell_new_classed(NULL, 26., S_SED_TYPE_SILT);
+    double* load_0;
+    double* load_1;
+    gssize i;
+
+    sed_column_add_cell(c, cell);
+
+    load_0 = sed_column_load(c, 0, -1, NULL);
+
+    sed_column_set_load_cache(TRUE);
+    load_1 = sed_column_load(c, 0, -1, NULL);
+
+    for (i = 0 ; i < sed_column_len(c) ; i++) {
+        g_assert(eh_compare_dbl(load_0[i], load_1[i], 1e-9));
+    }
+
+    eh_free(load_1);
+
+    // The cache must follow sediment that is added to and removed from the top.
+    sed_column_remove_top(c, 5.5);
+    sed_column_resize_cell(c, 3, .5);
+    sed_column_add_cell(c, cell);
+
+    load_1 = sed_column_load(c, 2, -1, NULL);
+
+    sed_column_set_load_cache(FALSE);
+    eh_free(load_0);
+    load_0 = sed_column_load(c, 2, -1, NULL);
+
+    for (i = 0 ; i < sed_column_len(c) - 2 ; i++) {
+        g_assert(eh_compare_dbl(load_0[i], load_1[i], 1e-9));
+    }
+
+    eh_free(load_1);
+    eh_free(load_0);
+
+    // A cell changed without sed_column_invalidate_load is caught by the stamp.
+    sed_column_set_load_cache(TRUE);
+    load_0 = sed_column_load(c, 0, -1, NULL);
+
+    sed_cell_resize(sed_column_nth_cell(c, 0), .25);
+    sed_column_touch(c);
+
+    load_1 = sed_column_load(c, 0, -1, NULL);
+
+    sed_column_set_load_cache(FALSE);
+    eh_free(load_0);
+    load_0 = sed_column_load(c, 0, -1, NULL);
+
+    for (i = 0 ; i < sed_column_len(c) ; i++) {
+        g_assert(eh_compare_dbl(load_0[i], load_1[i], 1e-9));
+    }
+
+    eh_free(load_1);
+    eh_free(load_0);
+    sed_cell_destroy(cell);
+    sed_column_destroy(c);
+}
+
+void
+test_sed_column_stamp(void)
+{
+    Sed_column c   = sed_column_new(15);
+    Sed_column d   = sed_column_new(15);
+    Sed_cell cell  = sed_cell_new_classed(NULL, 26., S_SED_TYPE_SILT);
+    gint stamp;
+
+    g_assert_cmpint(sed_column_stamp(c), !=, sed_column_stamp(d));
+
+    stamp = sed_column_stamp(c);
+    sed_column_add_cell(c, cell);
+    g_assert_cmpint(sed_column_stamp(c), !=, stamp);
+
+    // Looking at a column does not change it.
+    stamp = sed_column_stamp(c);
+    sed_column_top_height(c);
+    sed_column_mass(c);
+    g_assert_cmpint(sed_column_stamp(c), ==, stamp);
+
+    sed_column_remove_top(c, 1.);
+    g_assert_cmpint(sed_column_stamp(c), !=, stamp);
+
+    stamp = sed_column_stamp(c);
+    sed_column_compact_cell(c, 0, .5);
+    g_assert_cmpint(sed_column_stamp(c), !=, stamp);
+
+    stamp = sed_column_stamp(c);
+    sed_column_set_base_height(c, sed_column_base_height(c));
+    g_assert_cmpint(sed_column_stamp(c), ==, stamp);
+    sed_column_set_base_height(c, sed_column_base_height(c) - 1.);
+    g_assert_cmpint(sed_column_stamp(c), !=, stamp);
+
+    stamp = sed_column_stamp(c);
+    sed_column_touch(c);
+    g_assert_cmpint(sed_column_stamp(c), !=, stamp);
+
+    stamp = sed_column_stamp(c);
+    sed_column_touch_keep_load(c);
+    g_assert_cmpint(sed_column_stamp(c), !=, stamp);
+
+    sed_cell_destroy(cell);
+    sed_column_destroy(d);
+    sed_column_destroy(c);
+}
+
+
+void
+test_sed_column_mass_ledger(void)
+{
+    Sed_mass_ledger l = sed_mass_ledger_new(sed_sediment_env_n_types());
+    Sed_column c      = sed_column_new(15);
+    Sed_cell cell     = sed_cell_new_classed(NULL, 26., S_SED_TYPE_SILT);
+    Sed_cell* top;
+    double mass;
+
+    // Sediment already in the column is posted when it is attached.
+    sed_column_add_cell(c, cell);
+    sed_column_set_mass_ledger(c, l);
+    g_assert(sed_column_mass_ledger(c) == l);
+    g_assert(eh_compare_dbl(sed_mass_ledger_mass(l), sed_column_sediment_mass(c), 1e-9));
+    g_assert(eh_compare_dbl(sed_mass_ledger_deposited(l), sed_column_sediment_mass(c), 1e-9));
+
+    sed_column_add_cell(c, cell);
+    sed_column_remove_top(c, 5.5);
+    sed_column_resize_cell(c, 3, .5);
+    sed_column_stack_cell(c, cell);
+    top = sed_column_extract_top_n_cells(c, 2);
+    g_assert(eh_compare_dbl(sed_mass_ledger_mass(l), sed_column_sediment_mass(c), 1e-9));
+
+    // Compaction squeezes out water but not sediment.
+    mass = sed_mass_ledger_mass(l);
+    sed_column_compact_cell(c, 0, .5);
+    g_assert(eh_compare_dbl(sed_mass_ledger_mass(l), mass, 1e-12));
+    g_assert(eh_compare_dbl(sed_mass_ledger_mass(l), sed_column_sediment_mass(c), 1e-9));
+
+    g_assert(eh_compare_dbl(sed_mass_ledger_deposited(l) - sed_mass_ledger_eroded(l),
+            sed_mass_ledger_mass(l), 1e-9));
+
+    sed_column_clear(c);
+    g_assert(fabs(sed_mass_ledger_mass(l)) < 1e-9);
+
+    sed_column_add_cell(c, cell);
+    sed_column_set_mass_ledger(c, NULL);
+    g_assert(fabs(sed_mass_ledger_mass(l)) < 1e-9);
+
+    sed_cell_array_free(top);
+    sed_cell_destroy(cell);
+    sed_column_destroy(c);
+    sed_mass_ledger_destroy(l);
+}
+
 void
 test_sed_column_top_index(void)
 {
@@ -1971,6 +2224,7 @@ main(int argc, char* argv[])
     g_test_add_func("/libsed/sed_column/add_cell", &test_sed_column_add_cell);
     g_test_add_func("/libsed/sed_column/add_cell_small", &test_sed_column_add_cell_small);
     g_test_add_func("/libsed/sed_column/add_cell_large", &test_sed_column_add_cell_large);
+    g_test_add_func("/libsed/sed_column/contiguous", &test_sed_column_contiguous);
     g_test_add_func("/libsed/sed_column/stack_cell", &test_sed_column_stack_cell);
     g_test_add_func("/libsed/sed_column/resize_cell", &test_sed_column_resize_cell);
     g_test_add_func("/libsed/sed_column/compact_cell", &test_sed_column_compact_cell);
@@ -1980,6 +2234,9 @@ main(int argc, char* argv[])
     g_test_add_func("/libsed/sed_column/load", &test_sed_column_load);
     g_test_add_func("/libsed/sed_column/load_at", &test_sed_column_load_at);
     g_test_add_func("/libsed/sed_column/total_load", &test_sed_column_total_load);
+    g_test_add_func("/libsed/sed_column/load_cache", &test_sed_column_load_cache);
+    g_test_add_func("/libsed/sed_column/stamp", &test_sed_column_stamp);
+    g_test_add_func("/libsed/sed_column/mass_ledger", &test_sed_column_mass_ledger);
     g_test_add_func("/libsed/sed_column/top_index", &test_sed_column_top_index);
     g_test_add_func("/libsed/sed_column/is_valid_index", &test_sed_column_is_valid_index);
     g_test_add_func("/libsed/sed_column/is_get_index", &test_sed_column_is_get_index);
@@ -1,4 +1,6 @@
+#include <string.h>
 #include <glib.h>
+#include <glib/gstdio.h>
 #include <sed_sedflux.h>
 #include <sed_cube.h>
 
@@ -78,6 +80,62 @@ test_sed_cube_destroy(void)
     g_assert(c == NULL);
 }
 
+void
+test_cube_mass_ledger(void)
+{
+    { /* A cube made before there is a sediment environment */
+        Sed_cube c;
+
+        sed_sediment_unset_env();
+
+        c = sed_cube_new(2, 5);
+
+        g_assert(c != NULL);
+        g_assert(sed_cube_mass_ledger(c) == NULL);
+        g_assert(eh_compare_dbl(sed_cube_ledger_mass(c), 0., 1e-12));
+
+        sed_cube_destroy(c);
+
+        // Put back the environment for the rest of the tests
+        if (!sed_test_setup_sediment("sediment")) {
+            eh_exit(EXIT_FAILURE);
+        }
+    }
+
+    { /* The ledger is made from the sediment already in the cube */
+        Sed_cube c = sed_cube_new(3, 4);
+        Sed_cell* dz = eh_new(Sed_cell, 12);
+        Sed_mass_ledger l;
+        gint i;
+
+        for (i = 0 ; i < 12 ; i++) {
+            dz[i] = sed_cell_new_env();
+            sed_cell_set_equal_fraction(dz[i]);
+            sed_cell_resize(dz[i], i + 1.);
+        }
+
+        sed_cube_deposit(c, dz);
+
+        l = sed_cube_mass_ledger(c);
+
+        g_assert(l != NULL);
+        g_assert(sed_cube_mass_ledger(c) == l);
+        g_assert(eh_compare_dbl(sed_cube_ledger_mass(c), sed_cube_sediment_mass(c), 1e-9));
+
+        // and then kept up to date
+        sed_cube_deposit(c, dz);
+
+        g_assert(eh_compare_dbl(sed_cube_ledger_mass(c), sed_cube_sediment_mass(c), 1e-9));
+
+        for (i = 0 ; i < 12 ; i++) {
+            sed_cell_destroy(dz[i]);
+        }
+
+        eh_free(dz);
+        sed_cube_destroy(c);
+    }
+}
+
 gchar* test_seqfile[] = {
     " # Begin the first record\n",
     "[ TiMe: 1 ] /* Label is case insensitive*/\n",
@@ -737,6 +795,144 @@ test_shore_ids()
     sed_cube_destroy(p);
 }
 
+/* Check the shore flags of a cube against is_shore_cell and check that the
+   shore line visits each shore column once.
+*/
+static void
+_check_shore_line(Sed_cube p)
+{
+    const gint len = sed_cube_size(p);
+    gboolean* mask = sed_cube_shore_mask(p);
+    gboolean* seen = eh_new0(gboolean, len);
+    const gint* line;
+    gssize line_len;
+    gint id, n_shore = 0;
+
+    for (id = 0; id < len; id++) {
+        g_assert(mask[id] == is_shore_cell_id(p, id));
+        n_shore += mask[id];
+    }
+
+    line = sed_cube_shore_line(p, &line_len);
+
+    g_assert_cmpint(line_len, ==, n_shore);
+
+    for (id = 0; id < line_len; id++) {
+        g_assert(mask[line[id]]);
+        g_assert(!seen[line[id]]);
+        seen[line[id]] = TRUE;
+    }
+
+    eh_free(seen);
+    eh_free(mask);
+}
+
+void
+test_shore_line(void)
+{
+    const gint nx = 2000;
+    const gint ny = 50;
+    Sed_cube p = sed_cube_new(nx, ny);
+    gint i, j;
+
+    /* A comb-shaped coast: a strip of land along the first two columns with a
+       tooth of land along every fourth row.
+    */
+    for (i = 0; i < nx; i++)
+        for (j = 0; j < ny; j++)
+            if (j < 2 || (i % 4 == 0 && j < ny - 2)) {
+                sed_cube_set_base_height(p, i, j, 1);
+            } else {
+                sed_cube_set_base_height(p, i, j, -1);
+            }
+
+    _check_shore_line(p);
+
+    /* Flood the tips of some teeth and fill in some bays */
+    for (i = 0; i < nx; i += 40) {
+        sed_cube_set_base_height(p, i, ny - 3, -1);
+        sed_cube_set_base_height(p, i + 2, 2, 1);
+    }
+
+    _check_shore_line(p);
+
+    sed_cube_set_sea_level(p, 2.);
+    _check_shore_line(p);
+
+    sed_cube_set_sea_level(p, 0.);
+    _check_shore_line(p);
+
+    sed_cube_destroy(p);
+}
+
+/* The first land/sea transition along row i of a cube, found from the
+   columns themselves.
+*/
+static gint
+_find_shore_by_hand(Sed_cube p, gint i)
+{
+    const gint ny = sed_cube_n_y(p);
+    const double z = sed_cube_sea_level(p);
+    gint j;
+
+    for (j = 0; j < ny - 1; j++) {
+        const gboolean is_wet = sed_cube_top_height(p, i, j) < z;
+
+        if (is_wet ^ (sed_cube_top_height(p, i, j + 1) < z)) {
+            return is_wet ? j + 1 : j;
+        }
+    }
+
+    return -1;
+}
+
+void
+test_find_shore(void)
+{
+    const gint nx = 20;
+    const gint ny = 30;
+    Sed_cube p = sed_cube_new(nx, ny);
+    gint i, j;
+
+    for (i = 0; i < nx; i++)
+        for (j = 0; j < ny; j++) {
+            sed_cube_set_base_height(p, i, j, (i % 7 + 2) - j);
+        }
+
+    for (i = 0; i < nx; i++) {
+        Eh_ind_2* pos = sed_cube_find_shore(p, i, VARY_COLS);
+
+        g_assert(pos);
+        g_assert_cmpint(pos->i, ==, i);
+        g_assert_cmpint(pos->j, ==, _find_shore_by_hand(p, i));
+
+        eh_free(pos);
+    }
+
+    /* Move the shore by raising sea level and by building up a row */
+    sed_cube_set_sea_level(p, 3.5);
+
+    for (j = 0; j < ny; j++) {
+        sed_cube_set_base_height(p, 4, j, 10 - j);
+    }
+
+    for (i = 0; i < nx; i++) {
+        Eh_ind_2* pos = sed_cube_find_shore(p, i, VARY_COLS);
+        const gint j_shore = _find_shore_by_hand(p, i);
+
+        if (j_shore < 0) {
+            g_assert(pos == NULL);
+        } else {
+            g_assert(pos);
+            g_assert_cmpint(pos->j, ==, j_shore);
+        }
+
+        eh_free(pos);
+    }
+
+    sed_cube_destroy(p);
+}
+
 void
 test_cube_river_north(void)
 {
@@ -1126,6 +1322,671 @@ test_cube_grid_elevation_some(void)
     sed_cube_destroy(p);
 }
 
+static void
+_count_column(Sed_cube p, gssize n, gssize id, Sed_worker w, gpointer data)
+{
+    gint* count = (gint*)data;
+    double* x   = sed_worker_scratch(w, 0, id + 1);
+
+    x[id] = id;
+
+    g_assert_cmpint(sed_worker_id(w), >=, 0);
+    g_assert_cmpint(sed_worker_id(w), <, sed_cube_n_threads());
+    g_assert_cmpint(n, ==, id);
+
+    g_atomic_int_add(&(count[id]), (gint)x[id] + 1);
+}
+
+static void
+_count_id(Sed_cube p, gssize n, gssize id, Sed_worker w, gpointer data)
+{
+    g_assert_cmpint(sed_worker_id(w), ==, 0);
+    g_atomic_int_add(&(((gint*)data)[id]), (gint)id + 1);
+}
+
+static void
+_count_column_nested(Sed_cube p, gssize n, gssize id, Sed_worker w, gpointer data)
+{
+    gssize ids[2];
+
+    ids[0] = id;
+    ids[1] = id;
+
+    // A call from within a job is run by the calling worker alone.
+    g_assert(sed_cube_foreach_column_list_parallel(p, ids, 2, &_count_id, data));
+}
+
+void
+test_cube_foreach_column_parallel(void)
+{
+    Sed_cube p = sed_cube_new(20, 50);
+    const gint len = sed_cube_size(p);
+    gint* count = eh_new0(gint, len);
+    gint i;
+
+    sed_cube_set_n_threads(4);
+    g_assert(sed_cube_foreach_column_parallel(p, &_count_column, count));
+
+    for (i = 0 ; i < len ; i++) {
+        g_assert_cmpint(count[i], ==, i + 1);
+    }
+
+    // The workers are kept from one call to the next.
+    for (i = 0 ; i < 10 ; i++) {
+        g_assert(sed_cube_foreach_column_parallel(p, &_count_column, count));
+    }
+
+    g_assert(sed_cube_foreach_column_parallel(p, &_count_column_nested, count));
+
+    for (i = 0 ; i < len ; i++) {
+        g_assert_cmpint(count[i], ==, 13 * (i + 1));
+    }
+
+    sed_cube_workers_shutdown();
+    sed_cube_set_n_threads(1);
+
+    eh_free(count);
+    sed_cube_destroy(p);
+}
+
+void
+test_cube_profile(void)
+{
+    Sed_cube p      = sed_cube_new(20, 50);
+    gint*    count  = eh_new0(gint, sed_cube_size(p));
+    gchar*   tmpdir = g_build_filename(g_get_tmp_dir(), "XXXXXX", NULL);
+    gchar*   prefix;
+    gchar*   file;
+    gchar*   contents;
+    GError*  error  = NULL;
+    gint i;
+
+    mkdtemp(tmpdir);
+    prefix = g_build_filename(tmpdir, "profile", NULL);
+
+    sed_profile_enable(TRUE);
+    sed_cube_set_n_threads(4);
+
+    for (i = 0 ; i < 3 ; i++) {
+        SED_PROFILE_BEGIN("test");
+        g_assert(sed_cube_foreach_column_parallel(p, &_count_column, count));
+        SED_PROFILE_END();
+    }
+
+    sed_cube_set_n_threads(1);
+    sed_profile_enable(FALSE);
+
+    g_assert(sed_profile_write(prefix, &error));
+    g_assert(error == NULL);
+
+    file = g_strconcat(prefix, ".csv", NULL);
+    g_assert(g_file_get_contents(file, &contents, NULL, NULL));
+    g_assert(g_str_has_prefix(contents, "scope,depth,calls,"));
+    g_assert(strstr(contents, "\n\"test\",0,3,") != NULL);
+    g_assert(strstr(contents, "\n\"test/columns\",1,3,") != NULL);
+    // Each of the four workers runs once per call, and nests under the caller.
+    g_assert(strstr(contents, "\n\"test/columns/column worker\",2,12,") != NULL);
+    g_assert(strstr(contents, "\n\"column worker\",") == NULL);
+    g_free(contents);
+    g_remove(file);
+    g_free(file);
+
+    file = g_strconcat(prefix, ".json", NULL);
+    g_assert(g_file_get_contents(file, &contents, NULL, NULL));
+    g_assert(g_str_has_prefix(contents, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+    g_assert(strstr(contents, "{\"name\":\"columns\",\"cat\":\"sedflux\",\"ph\":\"X\"")
+        != NULL);
+    g_free(contents);
+    g_remove(file);
+    g_free(file);
+
+    g_rmdir(tmpdir);
+
+    g_free(prefix);
+    g_free(tmpdir);
+    eh_free(count);
+    sed_cube_destroy(p);
+}
+
+void
+test_cube_dirty_columns(void)
+{
+    Sed_cube p    = sed_cube_new(5, 10);
+    Sed_cell cell = sed_cell_new_classed(NULL, 1., S_SED_TYPE_SAND);
+    gint* stamps  = sed_cube_stamps(p, NULL);
+    gint stamp    = sed_cube_col_stamp(p, 12);
+
+    g_assert_cmpint(sed_cube_n_dirty(p, stamps), ==, 0);
+
+    sed_column_add_cell(sed_cube_col(p, 12), cell);
+    sed_column_add_cell(sed_cube_col(p, 31), cell);
+    sed_column_remove_top(sed_cube_col(p, 31), .5);
+
+    g_assert_cmpint(sed_cube_n_dirty(p, stamps), ==, 2);
+    g_assert(sed_cube_col_is_dirty(p, 12, stamp));
+    g_assert(!sed_cube_col_is_dirty(p, 13, stamps[13]));
+
+    sed_cube_stamps(p, stamps);
+    g_assert_cmpint(sed_cube_n_dirty(p, stamps), ==, 0);
+
+    eh_free(stamps);
+    sed_cell_destroy(cell);
+    sed_cube_destroy(p);
+}
+
+/* Return the data section of a property file or NULL if there is none.
+*/
+static gchar*
+_property_file_data(const gchar* file, gsize* len)
+{
+    gchar* contents = NULL;
+    gchar* data = NULL;
+
+    if (g_file_get_contents(file, &contents, len, NULL)) {
+        const gchar* mark = "--- data ---\n";
+        gchar* start = g_strstr_len(contents, *len, mark);
+
+        if (start) {
+            start += strlen(mark);
+            *len  -= start - contents;
+            data   = g_memdup(start, *len);
+        }
+
+        g_free(contents);
+    }
+
+    return data;
+}
+
+void
+test_cube_property_file_write_all(void)
+{
+    const gchar* names[] = { "grain", "density", "sand", NULL };
+    const gint n_files   = 3;
+    Sed_cube p           = sed_cube_new(4, 6);
+    Sed_property_file* f = eh_new0(Sed_property_file, n_files + 1);
+    gchar* tmpdir        = g_build_filename(g_get_tmp_dir(), "XXXXXX", NULL);
+    gchar** file         = eh_new0(gchar*, n_files + 1);
+    gint i, n;
+
+    mkdtemp(tmpdir);
+
+    for (i = 0 ; i < sed_cube_size(p) ; i++) {
+        Sed_cell c = sed_cell_new_classed(NULL, 1.,
+                (i % 2) ? S_SED_TYPE_SAND : S_SED_TYPE_CLAY);
+
+        sed_column_set_base_height(sed_cube_col(p, i), -10. - i);
+
+        for (n = 0 ; n <= i % 5 ; n++) {
+            sed_column_add_cell(sed_cube_col(p, i), c);
+        }
+
+        sed_cell_destroy(c);
+    }
+
+    for (i = 0 ; i < n_files ; i++) {
+        file[i] = g_build_filename(tmpdir, names[i], NULL);
+        f[i]    = sed_property_file_new(file[i], sed_property_new(names[i]), NULL);
+    }
+
+    sed_cube_set_n_threads(3);
+    g_assert(sed_property_file_write_all(f, p) > 0);
+    sed_cube_set_n_threads(1);
+
+    for (i = 0 ; i < n_files ; i++) {
+        sed_property_file_destroy(f[i]);
+    }
+
+    for (i = 0 ; i < n_files ; i++) {
+        Sed_property property = sed_property_new(names[i]);
+        Eh_ndgrid g = sed_cube_property_subgrid(p, property, NULL, NULL, NULL);
+        gchar* ref_file = g_strconcat(file[i], ".ref", NULL);
+        gchar* data;
+        gchar* ref;
+        gsize len, ref_len;
+
+        {
+            FILE* fp = fopen(ref_file, "wb");
+            fprintf(fp, "--- data ---\n");
+            eh_ndgrid_write(fp, g);
+            fclose(fp);
+        }
+
+        data = _property_file_data(file[i], &len);
+        ref  = _property_file_data(ref_file, &ref_len);
+
+        g_assert(data != NULL);
+        g_assert(ref != NULL);
+        g_assert_cmpint(len, ==, ref_len);
+        g_assert(memcmp(data, ref, len) == 0);
+
+        g_remove(ref_file);
+        g_remove(file[i]);
+
+        g_free(data);
+        g_free(ref);
+        g_free(ref_file);
+        eh_ndgrid_destroy(g, TRUE);
+        sed_property_destroy(property);
+    }
+
+    g_rmdir(tmpdir);
+
+    g_strfreev(file);
+    g_free(tmpdir);
+    eh_free(f);
+    sed_cube_destroy(p);
+}
+
+void
+test_cube_checkpoint(void)
+{
+    Sed_cube p      = sed_cube_new(6, 7);
+    Sed_cube q      = sed_cube_new(6, 7);
+    gchar*   tmpdir = g_build_filename(g_get_tmp_dir(), "XXXXXX", NULL);
+    gchar*   file;
+    GError*  error  = NULL;
+    Sed_checkpoint c;
+    gint i, n;
+
+    mkdtemp(tmpdir);
+    file = g_build_filename(tmpdir, "test.cpr", NULL);
+
+    for (i = 0 ; i < sed_cube_size(p) ; i++) {
+        Sed_cell cell = sed_cell_new_classed(NULL, 1. + i * .1,
+                (i % 2) ? S_SED_TYPE_SAND : S_SED_TYPE_CLAY);
+
+        sed_column_set_base_height(sed_cube_col(p, i), -5. - i);
+
+        for (n = 0 ; n <= i % 4 ; n++) {
+            sed_column_add_cell(sed_cube_col(p, i), cell);
+        }
+
+        sed_cell_destroy(cell);
+    }
+
+    sed_cube_set_name(p, "checkpoint");
+    sed_cube_set_age(p, 1250.);
+    sed_cube_set_sea_level(p, -2.5);
+
+    g_assert(sed_checkpoint_write(file, p, NULL, &error));
+    g_assert(error == NULL);
+
+    c = sed_checkpoint_open(file, &error);
+
+    g_assert(c != NULL);
+    g_assert(error == NULL);
+    g_assert_cmpint(sed_checkpoint_version(c), ==, SED_CHECKPOINT_VERSION);
+    g_assert_cmpint(sed_checkpoint_n_x(c), ==, 6);
+    g_assert_cmpint(sed_checkpoint_n_y(c), ==, 7);
+    g_assert(eh_compare_dbl(sed_checkpoint_age(c), 1250., 1e-12));
+
+    { /* Columns are read individually from the mapped file */
+        Sed_column col = sed_checkpoint_column(c, 17, NULL, &error);
+
+        g_assert(col != NULL);
+        g_assert(error == NULL);
+        g_assert(sed_column_is_same(col, sed_cube_col(p, 17)));
+
+        sed_column_destroy(col);
+    }
+
+    sed_cube_set_n_threads(3);
+    g_assert(sed_checkpoint_restore(c, q, NULL, &error));
+    sed_cube_set_n_threads(1);
+    g_assert(error == NULL);
+
+    sed_checkpoint_close(c);
+
+    g_assert(eh_compare_dbl(sed_cube_age(q), 1250., 1e-12));
+    g_assert(eh_compare_dbl(sed_cube_sea_level(q), -2.5, 1e-12));
+
+    for (i = 0 ; i < sed_cube_size(p) ; i++) {
+        g_assert(sed_column_is_same(sed_cube_col(q, i), sed_cube_col(p, i)));
+    }
+
+    { /* A checkpoint of a different size is rejected */
+        Sed_cube r = sed_cube_new(7, 6);
+
+        c = sed_checkpoint_open(file, &error);
+        g_assert(!sed_checkpoint_restore(c, r, NULL, &error));
+        g_assert(error != NULL);
+        g_assert_cmpint(error->code, ==, SED_CHECKPOINT_ERROR_SIZE_MISMATCH);
+
+        g_clear_error(&error);
+        sed_checkpoint_close(c);
+        sed_cube_destroy(r);
+    }
+
+    g_remove(file);
+    g_rmdir(tmpdir);
+
+    g_free(file);
+    g_free(tmpdir);
+    sed_cube_destroy(q);
+    sed_cube_destroy(p);
+}
+
+void
+test_cube_checkpoint_corrupt(void)
+{
+    Sed_cube p      = sed_cube_new(3, 4);
+    Sed_cell cell   = sed_cell_new_classed(NULL, 1., S_SED_TYPE_SAND);
+    gchar*   tmpdir = g_build_filename(g_get_tmp_dir(), "XXXXXX", NULL);
+    const double mark = 98765.4321;
+    gchar*   file;
+    gchar*   contents;
+    gsize    len;
+    GError*  error  = NULL;
+    Sed_checkpoint c;
+    gint i;
+
+    mkdtemp(tmpdir);
+    file = g_build_filename(tmpdir, "corrupt.cpr", NULL);
+
+    for (i = 0 ; i < sed_cube_size(p) ; i++) {
+        sed_column_set_base_height(sed_cube_col(p, i), -1. * i);
+        sed_column_add_cell(sed_cube_col(p, i), cell);
+    }
+
+    sed_column_set_base_height(sed_cube_col(p, 5), mark);
+
+    g_assert(sed_checkpoint_write(file, p, NULL, &error));
+    g_assert(g_file_get_contents(file, &contents, &len, &error));
+
+    { /* Give column 5 more cells than its record holds */
+        double* rec = NULL;
+        gsize n;
+
+        for (n = 0 ; n + 8 * sizeof(double) <= len && !rec ; n += sizeof(double))
+            if (*(double*)(contents + n) == mark) {
+                rec = (double*)(contents + n);
+            }
+
+        g_assert(rec != NULL);
+        rec[7] += 3;
+
+        g_assert(g_file_set_contents(file, contents, len, &error));
+    }
+
+    c = sed_checkpoint_open(file, &error);
+    g_assert(c != NULL);
+
+    {
+        Sed_column col = sed_checkpoint_column(c, 4, NULL, &error);
+
+        g_assert(col != NULL);
+        sed_column_destroy(col);
+    }
+
+    g_assert(sed_checkpoint_column(c, 5, NULL, &error) == NULL);
+    g_assert(error != NULL);
+    g_assert_cmpint(error->code, ==, SED_CHECKPOINT_ERROR_CORRUPT);
+    g_clear_error(&error);
+
+    {
+        Sed_cube q = sed_cube_new(3, 4);
+
+        sed_cube_set_n_threads(3);
+        g_assert(!sed_checkpoint_restore(c, q, NULL, &error));
+        sed_cube_set_n_threads(1);
+
+        g_assert(error != NULL);
+        g_assert_cmpint(error->code, ==, SED_CHECKPOINT_ERROR_CORRUPT);
+        g_clear_error(&error);
+
+        sed_cube_destroy(q);
+    }
+
+    sed_checkpoint_close(c);
+
+    g_remove(file);
+    g_rmdir(tmpdir);
+
+    g_free(contents);
+    g_free(file);
+    g_free(tmpdir);
+    sed_cell_destroy(cell);
+    sed_cube_destroy(p);
+}
+
+static Sed_process_info
+_test_process_run(Sed_process proc, Sed_cube p)
+{
+    return SED_EMPTY_INFO;
+}
+
+/* A process without a load function keeps none of its user data through a
+   checkpoint.  Its run count is reset so that the data are set up again on
+   its first run after the restart.  The process record is still skipped so
+   that the records that follow it can be read.
+*/
+void
+test_cube_checkpoint_process(void)
+{
+    Sed_cube    p    = sed_cube_new(2, 2);
+    Sed_process a    = sed_process_create("stateless", NULL, &_test_process_run, NULL);
+    Sed_process b    = sed_process_create("stateless", NULL, &_test_process_run, NULL);
+    Sed_process c    = sed_process_create("stateless", NULL, &_test_process_run, NULL);
+    FILE*       fp   = tmpfile();
+    GError*     error = NULL;
+    gint i;
+
+    sed_process_init(a, NULL, NULL);
+    sed_process_init(b, NULL, NULL);
+    sed_process_init(c, NULL, NULL);
+
+    for (i = 0; i < 3; i++) {
+        sed_process_run_now(a, p);
+    }
+
+    g_assert_cmpint(sed_process_run_count(a), ==, 3);
+
+    sed_process_dump(a, fp);
+    sed_process_dump(a, fp);
+    rewind(fp);
+
+    g_assert(sed_process_load(b, fp, &error));
+    g_assert(error == NULL);
+    g_assert_cmpint(sed_process_run_count(b), ==, 0);
+
+    g_assert(sed_process_load(c, fp, &error));
+    g_assert(error == NULL);
+    g_assert_cmpint(sed_process_run_count(c), ==, 0);
+
+    fclose(fp);
+
+    sed_process_destroy(c);
+    sed_process_destroy(b);
+    sed_process_destroy(a);
+    sed_cube_destroy(p);
+}
+
+void
+test_cube_checkpoint_delta(void)
+{
+    Sed_cube p      = sed_cube_new(5, 8);
+    Sed_cube q      = sed_cube_new(5, 8);
+    Sed_cell cell   = sed_cell_new_classed(NULL, 1., S_SED_TYPE_SAND);
+    gchar*   tmpdir = g_build_filename(g_get_tmp_dir(), "XXXXXX", NULL);
+    gint     dirty[] = { 3, 17, 39 };
+    gchar*   base_file;
+    gchar*   delta_file;
+    gchar*   merged_file;
+    gint*    stamps;
+    GError*  error  = NULL;
+    Sed_checkpoint c;
+    gint i;
+
+    mkdtemp(tmpdir);
+    base_file   = g_build_filename(tmpdir, "base.cpr", NULL);
+    delta_file  = g_build_filename(tmpdir, "delta.cpr", NULL);
+    merged_file = g_build_filename(tmpdir, "merged.cpr", NULL);
+
+    for (i = 0 ; i < sed_cube_size(p) ; i++) {
+        sed_column_set_base_height(sed_cube_col(p, i), -1. * i);
+        sed_column_add_cell(sed_cube_col(p, i), cell);
+    }
+
+    g_assert(sed_checkpoint_write(base_file, p, NULL, &error));
+    stamps = sed_cube_stamps(p, NULL);
+
+    for (i = 0 ; i < 3 ; i++) {
+        sed_column_add_cell(sed_cube_col(p, dirty[i]), cell);
+    }
+
+    sed_cube_set_age(p, 10.);
+
+    g_assert(sed_checkpoint_write_delta(delta_file, p, NULL, base_file, stamps,
+            &error));
+    g_assert(error == NULL);
+
+    c = sed_checkpoint_open(delta_file, &error);
+
+    g_assert(c != NULL);
+    g_assert(error == NULL);
+    g_assert(sed_checkpoint_is_delta(c));
+
+    for (i = 0 ; i < sed_cube_size(p) ; i++) {
+        g_assert(sed_checkpoint_has_column(c, i)
+            == (i == dirty[0] || i == dirty[1] || i == dirty[2]));
+    }
+
+    g_assert(sed_checkpoint_restore(c, q, NULL, &error));
+    g_assert(eh_compare_dbl(sed_cube_age(q), 10., 1e-12));
+
+    for (i = 0 ; i < sed_cube_size(p) ; i++) {
+        g_assert(sed_column_is_same(sed_cube_col(q, i), sed_cube_col(p, i)));
+    }
+
+    g_assert(sed_checkpoint_merge(c, merged_file, &error));
+    sed_checkpoint_close(c);
+
+    { /* The merged checkpoint stands on its own */
+        Sed_cube r = sed_cube_new(5, 8);
+
+        g_remove(base_file);
+
+        c = sed_checkpoint_open(delta_file, &error);
+        g_assert(c == NULL);
+        g_assert(error != NULL);
+        g_clear_error(&error);
+
+        c = sed_checkpoint_open(merged_file, &error);
+        g_assert(c != NULL);
+        g_assert(!sed_checkpoint_is_delta(c));
+        g_assert(sed_checkpoint_restore(c, r, NULL, &error));
+
+        for (i = 0 ; i < sed_cube_size(p) ; i++) {
+            g_assert(sed_checkpoint_has_column(c, i));
+            g_assert(sed_column_is_same(sed_cube_col(r, i), sed_cube_col(p, i)));
+        }
+
+        sed_checkpoint_close(c);
+        sed_cube_destroy(r);
+    }
+
+    g_remove(delta_file);
+    g_remove(merged_file);
+    g_rmdir(tmpdir);
+
+    g_free(merged_file);
+    g_free(delta_file);
+    g_free(base_file);
+    g_free(tmpdir);
+    eh_free(stamps);
+    sed_cell_destroy(cell);
+    sed_cube_destroy(q);
+    sed_cube_destroy(p);
+}
+
+static void
+_test_output_append(gpointer data)
+{
+    GArray* a = (GArray*)((gpointer*)data)[0];
+    gint    n = GPOINTER_TO_INT(((gpointer*)data)[1]);
+
+    g_array_append_val(a, n);
+}
+
+void
+test_cube_snapshot(void)
+{
+    Sed_cube p     = sed_cube_new(5, 8);
+    Sed_cell cell  = sed_cell_new_classed(NULL, 1., S_SED_TYPE_SAND);
+    gint     dirty[] = { 3, 17, 39 };
+    Sed_cube snap;
+    gint*    stamps;
+    gint*    snap_stamps;
+    gint i;
+
+    for (i = 0 ; i < sed_cube_size(p) ; i++) {
+        sed_column_set_base_height(sed_cube_col(p, i), -1. * i);
+        sed_column_add_cell(sed_cube_col(p, i), cell);
+    }
+
+    sed_cube_set_age(p, 5.);
+
+    snap   = sed_cube_snapshot(NULL, p, NULL);
+    stamps = sed_cube_stamps(p, NULL);
+
+    for (i = 0 ; i < sed_cube_size(p) ; i++) {
+        g_assert(sed_column_is_same(sed_cube_col(snap, i), sed_cube_col(p, i)));
+    }
+
+    for (i = 0 ; i < 3 ; i++) {
+        sed_column_add_cell(sed_cube_col(p, dirty[i]), cell);
+    }
+
+    sed_cube_set_age(p, 10.);
+
+    snap_stamps = sed_cube_stamps(snap, NULL);
+    snap        = sed_cube_snapshot(snap, p, stamps);
+
+    g_assert(eh_compare_dbl(sed_cube_age(snap), 10., 1e-12));
+    g_assert(sed_cube_n_dirty(snap, snap_stamps) == 3);
+
+    for (i = 0 ; i < sed_cube_size(p) ; i++) {
+        g_assert(sed_column_is_same(sed_cube_col(snap, i), sed_cube_col(p, i)));
+    }
+
+    { /* Jobs of a stream are written in order by the output threads */
+        const gint len = 100;
+        GArray* a = g_array_new(FALSE, FALSE, sizeof(gint));
+        gpointer* jobs = eh_new(gpointer, 2 * len);
+
+        sed_output_set_n_threads(4);
+        sed_output_set_max_pending(8);
+
+        for (i = 0 ; i < len ; i++) {
+            jobs[2 * i]     = a;
+            jobs[2 * i + 1] = GINT_TO_POINTER(i);
+
+            sed_output_push(a, _test_output_append, jobs + 2 * i, NULL);
+        }
+
+        sed_output_flush();
+
+        g_assert_cmpint(a->len, ==, len);
+
+        for (i = 0 ; i < len ; i++) {
+            g_assert_cmpint(g_array_index(a, gint, i), ==, i);
+        }
+
+        sed_output_shutdown();
+        g_assert_cmpint(sed_output_n_threads(), ==, 0);
+
+        eh_free(jobs);
+        g_array_free(a, TRUE);
+    }
+
+    eh_free(snap_stamps);
+    eh_free(stamps);
+    sed_cell_destroy(cell);
+    sed_cube_destroy(snap);
+    sed_cube_destroy(p);
+}
+
 int
 main(int argc, char* argv[])
 {
@@ -1139,6 +2000,7 @@ main(int argc, char* argv[])
 
     g_test_add_func("/libsed/sed_cube/new", &test_sed_cube_new);
     g_test_add_func("/libsed/sed_cube/destroy", &test_sed_cube_destroy);
+    g_test_add_func("/libsed/sed_cube/mass_ledger", &test_cube_mass_ledger);
 
     g_test_add_func("/libsed/sed_cube/sequence_2", &test_sequence_2);
     g_test_add_func("/libsed/sed_cube/to_cell", &test_cube_to_cell);
@@ -1146,6 +2008,20 @@ main(int argc, char* argv[])
     g_test_add_func("/libsed/sed_cube/erode", &test_cube_erode);
     g_test_add_func("/libsed/sed_cube/deposit", &test_cube_deposit);
     g_test_add_func("/libsed/sed_cube/base_height", &test_cube_base_height);
+    g_test_add_func("/libsed/sed_cube/foreach_column_parallel",
+        &test_cube_foreach_column_parallel);
+    g_test_add_func("/libsed/sed_cube/profile", &test_cube_profile);
+    g_test_add_func("/libsed/sed_cube/dirty_columns", &test_cube_dirty_columns);
+    g_test_add_func("/libsed/sed_cube/property_file_write_all",
+        &test_cube_property_file_write_all);
+    g_test_add_func("/libsed/sed_cube/checkpoint", &test_cube_checkpoint);
+    g_test_add_func("/libsed/sed_cube/checkpoint_corrupt",
+        &test_cube_checkpoint_corrupt);
+    g_test_add_func("/libsed/sed_cube/checkpoint_process",
+        &test_cube_checkpoint_process);
+    g_test_add_func("/libsed/sed_cube/checkpoint_delta",
+        &test_cube_checkpoint_delta);
+    g_test_add_func("/libsed/sed_cube/snapshot", &test_cube_snapshot);
     g_test_add_func("/libsed/sed_cube/add_river", &test_cube_river_add);
     g_test_add_func("/libsed/sed_cube/add_river_mouth",
         &test_cube_add_river_mouth);
@@ -1159,6 +2035,8 @@ main(int argc, char* argv[])
         &test_is_boundary_cell);
     g_test_add_func("/libsed/sed_cube/shore_mask", &test_shore_mask);
     g_test_add_func("/libsed/sed_cube/shore_ids", &test_shore_ids);
+    g_test_add_func("/libsed/sed_cube/shore_line", &test_shore_line);
+    g_test_add_func("/libsed/sed_cube/find_shore", &test_find_shore);
 
     g_test_add_func("/libsed/sed_cube/river_path/ray",
         &test_cube_river_path_ray);
@@ -2,6 +2,7 @@
 
 #include "utils/utils.h"
 #include "sed_hydro.h"
+#include "sed_hydrotrend.h"
 #include "sed_input_files.h"
 
 #include "test_sed.h"
@@ -387,6 +388,829 @@ test_sed_hydro_file_new_buffer(void)
     g_assert(eh_compare_dbl(a_load, b_load, 1e-12));
 }
 
+#define STREAM_N_GRAINS (3)
+
+typedef struct {
+    Sed_hydro_file fp;
+    gint           n_recs;     // Push this many records (-1 until a push fails)
+    gint           n_pushed;   // Records pushed so far
+    gboolean       push_failed;
+}
+Stream_test_job;
+
+/* A model that pushes records numbered by their velocity and then closes
+   the stream. */
+static gpointer
+_stream_push_records(gpointer data)
+{
+    Stream_test_job* job = (Stream_test_job*)data;
+    gint i;
+
+    for (i = 0 ; job->n_recs < 0 || i < job->n_recs ; i++) {
+        Sed_hydro rec = sed_hydro_new(STREAM_N_GRAINS);
+
+        sed_hydro_set_velocity(rec, i);
+
+        if (!sed_hydro_file_push_record(job->fp, rec)) {
+            job->push_failed = TRUE;
+            break;
+        }
+
+        g_atomic_int_inc(&job->n_pushed);
+    }
+
+    sed_hydro_file_close_stream(job->fp);
+
+    return NULL;
+}
+
+static GThread*
+_stream_start(Stream_test_job* job, gint max_len, gint n_recs)
+{
+    GThread* t;
+
+    job->fp          = sed_hydro_file_new_stream(STREAM_N_GRAINS, max_len, FALSE);
+    job->n_recs      = n_recs;
+    job->n_pushed    = 0;
+    job->push_failed = FALSE;
+
+    g_assert(job->fp != NULL);
+
+    t = g_thread_create(_stream_push_records, job, TRUE, NULL);
+    g_assert(t != NULL);
+
+    return t;
+}
+
+void
+test_sed_hydro_file_stream_push(void)
+{
+    Stream_test_job job;
+    GThread* t = _stream_start(&job, 8, 100);
+    Sed_hydro rec;
+    gint i;
+
+    for (i = 0 ; i < 100 ; i++) {
+        rec = sed_hydro_file_read_record(job.fp);
+
+        g_assert(rec != NULL);
+        g_assert_cmpint(sed_hydro_size(rec), ==, STREAM_N_GRAINS);
+        g_assert(eh_compare_dbl(sed_hydro_velocity(rec), i, 1e-12));
+
+        sed_hydro_destroy(rec);
+    }
+
+    g_assert(sed_hydro_file_read_record(job.fp) == NULL);
+
+    g_thread_join(t);
+    g_assert(!job.push_failed);
+
+    sed_hydro_file_destroy(job.fp);
+}
+
+void
+test_sed_hydro_file_stream_bounded(void)
+{
+    const gint max_len = 4;
+    Stream_test_job job;
+    GThread* t = _stream_start(&job, max_len, 20);
+    Sed_hydro rec;
+    gint i;
+
+    // The producer must wait for the reader once the stream is full.
+    g_usleep(100000);
+    g_assert_cmpint(g_atomic_int_get(&job.n_pushed), ==, max_len);
+
+    for (i = 0 ; i < 20 ; i++) {
+        rec = sed_hydro_file_read_record(job.fp);
+
+        g_assert(rec != NULL);
+        g_assert(eh_compare_dbl(sed_hydro_velocity(rec), i, 1e-12));
+        sed_hydro_destroy(rec);
+
+        g_assert_cmpint(g_atomic_int_get(&job.n_pushed), <=, i + 1 + max_len);
+    }
+
+    g_assert(sed_hydro_file_read_record(job.fp) == NULL);
+
+    g_thread_join(t);
+    sed_hydro_file_destroy(job.fp);
+}
+
+void
+test_sed_hydro_file_stream_close(void)
+{
+    {
+        Sed_hydro_file fp = sed_hydro_file_new_stream(STREAM_N_GRAINS, 4, FALSE);
+
+        sed_hydro_file_close_stream(fp);
+
+        g_assert(sed_hydro_file_read_record(fp) == NULL);
+        g_assert(sed_hydro_file_read_record(fp) == NULL);
+
+        sed_hydro_file_destroy(fp);
+    }
+
+    {
+        Sed_hydro_file fp = sed_hydro_file_new_stream(STREAM_N_GRAINS, 4, FALSE);
+        Sed_hydro rec;
+        gint i;
+
+        for (i = 0 ; i < 3 ; i++) {
+            rec = sed_hydro_new(STREAM_N_GRAINS);
+            sed_hydro_set_velocity(rec, i);
+            g_assert(sed_hydro_file_push_record(fp, rec));
+        }
+
+        sed_hydro_file_close_stream(fp);
+
+        // records pushed before the close are still read
+        for (i = 0 ; i < 3 ; i++) {
+            rec = sed_hydro_file_read_record(fp);
+
+            g_assert(rec != NULL);
+            g_assert(eh_compare_dbl(sed_hydro_velocity(rec), i, 1e-12));
+            sed_hydro_destroy(rec);
+        }
+
+        g_assert(sed_hydro_file_read_record(fp) == NULL);
+
+        sed_hydro_file_destroy(fp);
+    }
+}
+
+void
+test_sed_hydro_file_stream_cancel(void)
+{
+    Stream_test_job job;
+    GThread* t = _stream_start(&job, 2, -1);
+    Sed_hydro rec;
+    gint i;
+
+    for (i = 0 ; i < 10 ; i++) {
+        rec = sed_hydro_file_read_record(job.fp);
+        g_assert(rec != NULL);
+        sed_hydro_destroy(rec);
+    }
+
+    // Destroying the stream stops a producer that is blocked on a full
+    // stream, and waits for it to close the stream.
+    g_usleep(10000);
+    sed_hydro_file_destroy(job.fp);
+
+    g_thread_join(t);
+    g_assert(job.push_failed);
+    g_assert_cmpint(job.n_pushed, >=, 10);
+}
+
+/* The values of the i-th record of a test HydroTrend file. */
+static Sed_hydro
+_hydrotrend_test_record(gint i, gint n_grains)
+{
+    Sed_hydro rec = sed_hydro_new(n_grains);
+    gint n;
+
+    sed_hydro_set_velocity(rec, 1. + i);
+    sed_hydro_set_width(rec, 100. + .5 * i);
+    sed_hydro_set_depth(rec, 2. + .25 * i);
+    sed_hydro_set_bedload(rec, -3. - i);
+
+    for (n = 0 ; n < n_grains ; n++) {
+        sed_hydro_set_nth_concentration(rec, n, .125 * n + i);
+    }
+
+    return rec;
+}
+
+static gboolean
+_hydrotrend_test_is_same(Sed_hydro a, Sed_hydro b)
+{
+    gint n;
+
+    if (!sed_hydro_is_same(a, b)) {
+        return FALSE;
+    }
+
+    for (n = 0 ; n < sed_hydro_size(a) ; n++)
+        if (sed_hydro_nth_concentration(a, n) != sed_hydro_nth_concentration(b, n)) {
+            return FALSE;
+        }
+
+    return TRUE;
+}
+
+/* Write a HydroTrend file of n_recs records in the given byte order. */
+static gchar*
+_hydrotrend_test_file(gint n_grains, gint n_recs, gint order)
+{
+    gchar* name = NULL;
+    FILE* fp = eh_open_temp_file(NULL, &name);
+    gint i;
+
+    g_assert(fp != NULL);
+
+    sed_hydrotrend_write_header_to_byte_order(fp, n_grains, 365, n_recs,
+        "Round trip test", order);
+
+    for (i = 0 ; i < n_recs ; i++) {
+        Sed_hydro rec = _hydrotrend_test_record(i, n_grains);
+
+        sed_hydrotrend_write_record_to_byte_order(fp, rec, order);
+        sed_hydro_destroy(rec);
+    }
+
+    fclose(fp);
+
+    return name;
+}
+
+static void
+_hydrotrend_test_round_trip(gint n_grains, gint order)
+{
+    const gint n_recs = 50;
+    const gint other = (order == G_BIG_ENDIAN) ? G_LITTLE_ENDIAN : G_BIG_ENDIAN;
+    gchar* name = _hydrotrend_test_file(n_grains, n_recs, order);
+    gint orders[2];
+    gint j;
+
+    orders[0] = order;
+    orders[1] = 0;
+
+    for (j = 0 ; j < 2 ; j++) {
+        GError* error = NULL;
+        Sed_hydrotrend_map m = sed_hydrotrend_map_new(name, orders[j], &error);
+        const Sed_hydrotrend_header* h;
+        Sed_hydrotrend_block* b;
+        gint i, rec_0;
+
+        g_assert(m != NULL);
+        g_assert(error == NULL);
+
+        h = sed_hydrotrend_map_header(m);
+        g_assert_cmpint(h->n_grains, ==, n_grains);
+        g_assert_cmpint(h->n_seasons, ==, 365);
+        g_assert_cmpint(h->n_samples, ==, n_recs);
+        g_assert_cmpstr(h->comment, ==, "Round trip test");
+        g_assert_cmpint(sed_hydrotrend_map_byte_order(m), ==, order);
+        g_assert_cmpint(sed_hydrotrend_map_n_recs(m), ==, n_recs);
+
+        for (i = 0 ; i < n_recs ; i++) {
+            Sed_hydro a = _hydrotrend_test_record(i, n_grains);
+            Sed_hydro rec = sed_hydrotrend_map_record(m, i);
+
+            g_assert(_hydrotrend_test_is_same(rec, a));
+
+            sed_hydro_destroy(rec);
+            sed_hydro_destroy(a);
+        }
+
+        g_assert(sed_hydrotrend_map_record(m, n_recs) == NULL);
+
+        // a block that doesn't divide the file, so the last one is short.
+        b = sed_hydrotrend_block_new(n_grains, 7);
+
+        for (rec_0 = 0 ; rec_0 < n_recs ; rec_0 += b->n_recs) {
+            g_assert_cmpint(sed_hydrotrend_map_decode(m, rec_0, 7, b), ==,
+                MIN(7, n_recs - rec_0));
+            g_assert_cmpint(b->rec_0, ==, rec_0);
+
+            for (i = 0 ; i < b->n_recs ; i++) {
+                Sed_hydro a = _hydrotrend_test_record(rec_0 + i, n_grains);
+                Sed_hydro rec = sed_hydrotrend_block_record(b, i);
+
+                g_assert(_hydrotrend_test_is_same(rec, a));
+                g_assert_cmpfloat(b->velocity[i], ==, sed_hydro_velocity(a));
+                g_assert_cmpfloat(b->conc[n_grains - 1][i], ==,
+                    sed_hydro_nth_concentration(a, n_grains - 1));
+
+                sed_hydro_destroy(rec);
+                sed_hydro_destroy(a);
+            }
+        }
+
+        g_assert_cmpint(sed_hydrotrend_map_decode(m, n_recs, 7, b), ==, 0);
+
+        sed_hydrotrend_block_destroy(b);
+        sed_hydrotrend_map_destroy(m);
+    }
+
+    {
+        GError* error = NULL;
+        gint n_seasons = 0;
+        Sed_hydro* arr = sed_hydrotrend_read_n_recs(name, -1, order, &n_seasons, &error);
+
+        g_assert(arr != NULL);
+        g_assert(error == NULL);
+        g_assert_cmpint(g_strv_length((gchar**)arr), ==, n_recs);
+        g_assert_cmpint(n_seasons, ==, 365);
+
+        sed_hydro_array_destroy(arr);
+
+        // the other byte order is reported as a bad header
+        arr = sed_hydrotrend_read_n_recs(name, -1, other, NULL, &error);
+
+        g_assert(arr == NULL);
+        g_assert_error(error, SED_HYDROTREND_ERROR, SED_HYDROTREND_ERROR_BAD_HEADER);
+
+        g_error_free(error);
+    }
+
+    {
+        GError* error = NULL;
+
+        g_assert(sed_hydrotrend_map_new(name, other, &error) == NULL);
+        g_assert_error(error, SED_HYDROTREND_ERROR, SED_HYDROTREND_ERROR_BAD_HEADER);
+
+        g_error_free(error);
+    }
+
+    remove(name);
+    g_free(name);
+}
+
+void
+test_sed_hydrotrend_big_endian(void)
+{
+    _hydrotrend_test_round_trip(5, G_BIG_ENDIAN);
+    _hydrotrend_test_round_trip(40, G_BIG_ENDIAN);
+}
+
+void
+test_sed_hydrotrend_little_endian(void)
+{
+    _hydrotrend_test_round_trip(5, G_LITTLE_ENDIAN);
+    _hydrotrend_test_round_trip(40, G_LITTLE_ENDIAN);
+}
+
+/* A record whose values are picked from a few choices, so that many records
+   have the same suspended flux.  About a third have no suspended flux. */
+static Sed_hydro
+_hydro_test_random_record(GRand* r, gint n_grains)
+{
+    Sed_hydro rec = sed_hydro_new(n_grains);
+    const gboolean is_dry = g_rand_int_range(r, 0, 3) == 0;
+    gint n;
+
+    sed_hydro_set_velocity(rec, g_rand_int_range(r, 1, 3));
+    sed_hydro_set_width(rec, 10. * g_rand_int_range(r, 1, 3));
+    sed_hydro_set_depth(rec, g_rand_int_range(r, 1, 3));
+    sed_hydro_set_bedload(rec, g_rand_int_range(r, 0, 4));
+    sed_hydro_set_duration(rec, g_rand_int_range(r, 1, 3));
+
+    for (n = 0 ; n < n_grains ; n++) {
+        sed_hydro_set_nth_concentration(rec, n, is_dry ? 0. : .5 * g_rand_int_range(r, 0, 3));
+    }
+
+    return rec;
+}
+
+static Sed_hydro*
+_hydro_test_random_records(GRand* r, gint n_recs, gint n_grains)
+{
+    Sed_hydro* rec = eh_new(Sed_hydro, n_recs + 1);
+    gint i;
+
+    for (i = 0 ; i < n_recs ; i++) {
+        rec[i] = _hydro_test_random_record(r, n_grains);
+    }
+
+    rec[n_recs] = NULL;
+
+    return rec;
+}
+
+/* sed_hydro_process_records the slow way.  A record is an event if it has
+   suspended flux and fewer than n_sig_values records come before it when
+   they are ranked by flux (the earlier of equal records first).  The
+   records between events are averaged with sed_hydro_average_records.
+*/
+static Sed_hydro*
+_hydro_reference_process_records(Sed_hydro* rec, gint n_recs, gint n_sig_values,
+    gboolean insert_mean_values)
+{
+    gboolean* is_event = eh_new0(gboolean, n_recs);
+    GPtrArray* out = g_ptr_array_new();
+    gint i, j, i_0;
+
+    for (i = 0 ; i < n_recs ; i++) {
+        const double q_i = sed_hydro_suspended_flux(rec[i]);
+        gint rank = 0;
+
+        if (q_i > G_MINDOUBLE) {
+            for (j = 0 ; j < n_recs ; j++) {
+                const double q_j = sed_hydro_suspended_flux(rec[j]);
+
+                if (q_j > q_i || (q_j == q_i && j < i)) {
+                    rank++;
+                }
+            }
+
+            is_event[i] = rank < n_sig_values;
+        }
+    }
+
+    for (i = 0, i_0 = 0 ; i <= n_recs ; i++) {
+        if (i == n_recs || is_event[i]) {
+            if (insert_mean_values && i > i_0) {
+                g_ptr_array_add(out, sed_hydro_average_records(rec + i_0, i - i_0));
+            }
+
+            if (i < n_recs) {
+                g_ptr_array_add(out, sed_hydro_dup(rec[i]));
+            }
+
+            i_0 = i + 1;
+        }
+    }
+
+    g_ptr_array_add(out, NULL);
+
+    eh_free(is_event);
+
+    return (Sed_hydro*)g_ptr_array_free(out, FALSE);
+}
+
+static gboolean
+_hydro_test_is_close(Sed_hydro a, Sed_hydro b)
+{
+    const double eps = 1e-12;
+    gint n;
+
+    if (sed_hydro_size(a) != sed_hydro_size(b)
+        || !eh_compare_dbl(sed_hydro_velocity(a), sed_hydro_velocity(b), eps)
+        || !eh_compare_dbl(sed_hydro_width(a), sed_hydro_width(b), eps)
+        || !eh_compare_dbl(sed_hydro_depth(a), sed_hydro_depth(b), eps)
+        || !eh_compare_dbl(sed_hydro_bedload(a), sed_hydro_bedload(b), eps)
+        || !eh_compare_dbl(sed_hydro_duration(a), sed_hydro_duration(b), eps)) {
+        return FALSE;
+    }
+
+    for (n = 0 ; n < sed_hydro_size(a) ; n++)
+        if (!eh_compare_dbl(sed_hydro_nth_concentration(a, n),
+                sed_hydro_nth_concentration(b, n), eps)) {
+            return FALSE;
+        }
+
+    return TRUE;
+}
+
+static void
+_hydro_test_arrays_are_close(Sed_hydro* a, Sed_hydro* b)
+{
+    gint i;
+
+    g_assert(a != NULL);
+    g_assert(b != NULL);
+    g_assert_cmpint(g_strv_length((gchar**)a), ==, g_strv_length((gchar**)b));
+
+    for (i = 0 ; a[i] ; i++) {
+        g_assert(_hydro_test_is_close(a[i], b[i]));
+    }
+}
+
+static void
+_hydro_test_process_records(Sed_hydro* rec, gint n_recs, gint n_sig_values)
+{
+    gint k;
+
+    for (k = 0 ; k < 2 ; k++) {
+        const gboolean insert_mean_values = (k == 1);
+        Sed_hydro* a = sed_hydro_process_records(rec, n_recs, n_sig_values, insert_mean_values);
+        Sed_hydro* b = _hydro_reference_process_records(rec, n_recs, n_sig_values,
+                insert_mean_values);
+
+        _hydro_test_arrays_are_close(a, b);
+
+        sed_hydro_array_destroy(b);
+        sed_hydro_array_destroy(a);
+    }
+}
+
+void
+test_sed_hydro_process_records(void)
+{
+    GRand* r = g_rand_new_with_seed(1945);
+    gint trial;
+
+    for (trial = 0 ; trial < 500 ; trial++) {
+        const gint n_recs = g_rand_int_range(r, 1, 80);
+        Sed_hydro* rec = _hydro_test_random_records(r, n_recs, 3);
+
+        _hydro_test_process_records(rec, n_recs, g_rand_int_range(r, 0, n_recs + 5));
+
+        sed_hydro_array_destroy(rec);
+    }
+
+    g_rand_free(r);
+}
+
+void
+test_sed_hydro_process_records_ties(void)
+{
+    const gint n_recs = 30;
+    Sed_hydro* rec = eh_new(Sed_hydro, n_recs + 1);
+    gint i, n_sig_values;
+
+    // every record has the same flux; the earliest ones are the events.
+    for (i = 0 ; i < n_recs ; i++) {
+        rec[i] = sed_hydro_new(2);
+
+        sed_hydro_set_velocity(rec[i], 1.);
+        sed_hydro_set_width(rec[i], 10.);
+        sed_hydro_set_depth(rec[i], 1.);
+        sed_hydro_set_bedload(rec[i], i);
+        sed_hydro_set_nth_concentration(rec[i], 0, .5);
+        sed_hydro_set_nth_concentration(rec[i], 1, .5);
+    }
+
+    rec[n_recs] = NULL;
+
+    for (n_sig_values = 0 ; n_sig_values <= n_recs + 1 ; n_sig_values++) {
+        Sed_hydro* a = sed_hydro_process_records(rec, n_recs, n_sig_values, FALSE);
+
+        g_assert_cmpint(g_strv_length((gchar**)a), ==, MIN(n_sig_values, n_recs));
+
+        for (i = 0 ; a[i] ; i++) {
+            g_assert(sed_hydro_is_same(a[i], rec[i]));
+        }
+
+        sed_hydro_array_destroy(a);
+
+        _hydro_test_process_records(rec, n_recs, n_sig_values);
+    }
+
+    sed_hydro_array_destroy(rec);
+}
+
+void
+test_sed_hydro_process_records_few_events(void)
+{
+    const gint n_recs = 20;
+    const gint n_sig_values = 10;
+    gint wet[] = { 2, 3, 11 };
+    Sed_hydro* rec = eh_new(Sed_hydro, n_recs + 1);
+    gint i, j;
+
+    // only three records carry suspended sediment
+    for (i = 0 ; i < n_recs ; i++) {
+        rec[i] = sed_hydro_new(1);
+
+        sed_hydro_set_velocity(rec[i], 1. + i);
+        sed_hydro_set_width(rec[i], 10.);
+        sed_hydro_set_depth(rec[i], 1.);
+        sed_hydro_set_bedload(rec[i], 1.);
+    }
+
+    rec[n_recs] = NULL;
+
+    for (j = 0 ; j < G_N_ELEMENTS(wet) ; j++) {
+        sed_hydro_set_nth_concentration(rec[wet[j]], 0, 1.);
+    }
+
+    {
+        Sed_hydro* a = sed_hydro_process_records(rec, n_recs, n_sig_values, FALSE);
+
+        g_assert_cmpint(g_strv_length((gchar**)a), ==, G_N_ELEMENTS(wet));
+
+        for (j = 0 ; j < G_N_ELEMENTS(wet) ; j++) {
+            g_assert(sed_hydro_is_same(a[j], rec[wet[j]]));
+        }
+
+        sed_hydro_array_destroy(a);
+    }
+
+    {
+        Sed_hydro* a = sed_hydro_process_records(rec, n_recs, n_sig_values, TRUE);
+        Sed_hydro mean;
+
+        // mean, 2, 3, mean, 11, mean
+        g_assert_cmpint(g_strv_length((gchar**)a), ==, 6);
+
+        mean = sed_hydro_average_records(rec, 2);
+        g_assert(_hydro_test_is_close(a[0], mean));
+        sed_hydro_destroy(mean);
+
+        mean = sed_hydro_average_records(rec + 4, 7);
+        g_assert(_hydro_test_is_close(a[3], mean));
+        sed_hydro_destroy(mean);
+
+        mean = sed_hydro_average_records(rec + 12, n_recs - 12);
+        g_assert(_hydro_test_is_close(a[5], mean));
+        sed_hydro_destroy(mean);
+
+        sed_hydro_array_destroy(a);
+    }
+
+    _hydro_test_process_records(rec, n_recs, n_sig_values);
+
+    sed_hydro_array_destroy(rec);
+}
+
+static int
+_hydro_test_cmp_dbl_descending(const void* a, const void* b)
+{
+    const double x = *(const double*)a;
+    const double y = *(const double*)b;
+
+    return (x < y) - (x > y);
+}
+
+void
+test_sed_hydro_array_eventize(void)
+{
+    GRand* r = g_rand_new_with_seed(1964);
+    double f[] = { 0., .1, .5, .9, .999, 1. };
+    gint trial;
+
+    for (trial = 0 ; trial < 100 ; trial++) {
+        const gint n_recs = g_rand_int_range(r, 1, 80);
+        Sed_hydro* rec = _hydro_test_random_records(r, n_recs, 2);
+        double* load = eh_new(double, n_recs);
+        gint i, j, k;
+
+        for (i = 0 ; i < n_recs ; i++) {
+            load[i] = sed_hydro_suspended_load(rec[i]);
+        }
+
+        qsort(load, n_recs, sizeof(double), &_hydro_test_cmp_dbl_descending);
+
+        for (j = 0 ; j < G_N_ELEMENTS(f) ; j++)
+            for (k = 0 ; k < 2 ; k++) {
+                const gboolean insert_mean_values = (k == 1);
+                Sed_hydro* a = sed_hydro_array_eventize(rec, f[j], insert_mean_values);
+                Sed_hydro* b;
+
+                if (f[j] <= 0.) {
+                    g_assert(a == NULL);
+                    continue;
+                } else if (f[j] >= 1.) {
+                    b = sed_hydro_array_dup(rec);
+                } else {
+                    double threshold, sum;
+                    gint n_events;
+
+                    // the fewest of the largest loads that add up to the fraction
+                    for (i = 0, threshold = 0. ; i < n_recs ; i++) {
+                        threshold += sed_hydro_suspended_load(rec[i]);
+                    }
+
+                    threshold *= f[j];
+
+                    for (n_events = 0, sum = 0. ; n_events < n_recs && sum < threshold ; n_events++) {
+                        sum += load[n_events];
+                    }
+
+                    b = _hydro_reference_process_records(rec, n_recs, n_events,
+                            insert_mean_values);
+                }
+
+                _hydro_test_arrays_are_close(a, b);
+
+                sed_hydro_array_destroy(b);
+                sed_hydro_array_destroy(a);
+            }
+
+        eh_free(load);
+        sed_hydro_array_destroy(rec);
+    }
+
+    g_rand_free(r);
+}
+
+/* Read n_recs records, or up to the end of a stream */
+static Sed_hydro*
+_hydro_test_read_records(Sed_hydro_file fp, gint n_recs)
+{
+    GPtrArray* out = g_ptr_array_new();
+    Sed_hydro rec;
+    gint i;
+
+    for (i = 0 ; i < n_recs && (rec = sed_hydro_file_read_record(fp)) ; i++) {
+        g_ptr_array_add(out, rec);
+    }
+
+    g_ptr_array_add(out, NULL);
+
+    return (Sed_hydro*)g_ptr_array_free(out, FALSE);
+}
+
+static void
+_hydro_test_set_small_buffer(Sed_hydro_file fp)
+{
+    sed_hydro_file_set_buffer_length(fp, 16);
+    sed_hydro_file_set_sig_values(fp, 4);
+}
+
+void
+test_sed_hydro_file_prefetch_wrap(void)
+{
+    gchar* name = _hydrotrend_test_file(STREAM_N_GRAINS, 50, G_BYTE_ORDER);
+    Sed_hydro_file fp[2];
+    Sed_hydro* rec[2];
+    gint k;
+
+    // the buffers don't divide the file, so some of them span the wrap.
+    for (k = 0 ; k < 2 ; k++) {
+        GError* error = NULL;
+
+        fp[k] = sed_hydro_file_new(name, SED_HYDRO_HYDROTREND, TRUE, TRUE, &error);
+
+        g_assert(fp[k] != NULL);
+        g_assert(error == NULL);
+
+        _hydro_test_set_small_buffer(fp[k]);
+    }
+
+    g_assert(sed_hydro_file_set_prefetch(fp[1], 3));
+
+    for (k = 0 ; k < 2 ; k++) {
+        rec[k] = _hydro_test_read_records(fp[k], 200);
+    }
+
+    g_assert_cmpint(g_strv_length((gchar**)rec[0]), ==, 200);
+    _hydro_test_arrays_are_close(rec[0], rec[1]);
+    g_assert_cmpint(sed_hydro_file_n_fills(fp[0]), ==, sed_hydro_file_n_fills(fp[1]));
+
+    for (k = 0 ; k < 2 ; k++) {
+        sed_hydro_array_destroy(rec[k]);
+        sed_hydro_file_destroy(fp[k]);
+    }
+
+    remove(name);
+    g_free(name);
+}
+
+/* A model that pushes the same random records each time it is run */
+static gpointer
+_stream_push_random_records(gpointer data)
+{
+    Stream_test_job* job = (Stream_test_job*)data;
+    GRand* r = g_rand_new_with_seed(2010);
+    gint i;
+
+    for (i = 0 ; i < job->n_recs ; i++) {
+        Sed_hydro rec = _hydro_test_random_record(r, STREAM_N_GRAINS);
+
+        if (!sed_hydro_file_push_record(job->fp, rec)) {
+            job->push_failed = TRUE;
+            break;
+        }
+
+        g_atomic_int_inc(&job->n_pushed);
+    }
+
+    g_rand_free(r);
+
+    sed_hydro_file_close_stream(job->fp);
+
+    return NULL;
+}
+
+void
+test_sed_hydro_file_prefetch_end(void)
+{
+    Stream_test_job job[2];
+    GThread* t[2];
+    Sed_hydro* rec[2];
+    gint k;
+
+    // the last buffer of the stream is a short one.
+    for (k = 0 ; k < 2 ; k++) {
+        job[k].fp          = sed_hydro_file_new_stream(STREAM_N_GRAINS, 8, TRUE);
+        job[k].n_recs      = 100;
+        job[k].n_pushed    = 0;
+        job[k].push_failed = FALSE;
+
+        _hydro_test_set_small_buffer(job[k].fp);
+    }
+
+    g_assert(sed_hydro_file_set_prefetch(job[1].fp, 3));
+
+    for (k = 0 ; k < 2 ; k++) {
+        t[k] = g_thread_create(_stream_push_random_records, job + k, TRUE, NULL);
+        g_assert(t[k] != NULL);
+    }
+
+    for (k = 0 ; k < 2 ; k++) {
+        rec[k] = _hydro_test_read_records(job[k].fp, G_MAXINT);
+
+        // and the stream stays dry
+        g_assert(sed_hydro_file_read_record(job[k].fp) == NULL);
+    }
+
+    g_assert_cmpint(g_strv_length((gchar**)rec[0]), >, 0);
+    _hydro_test_arrays_are_close(rec[0], rec[1]);
+
+    for (k = 0 ; k < 2 ; k++) {
+        g_thread_join(t[k]);
+        g_assert(!job[k].push_failed);
+        g_assert_cmpint(job[k].n_pushed, ==, 100);
+
+        sed_hydro_array_destroy(rec[k]);
+        sed_hydro_file_destroy(job[k].fp);
+    }
+}
+
 
 int
 main(int argc, char* argv[])
@@ -409,6 +1233,21 @@ main(int argc, char* argv[])
     g_test_add_func("/libsed/sed_hydro/new_inline", &test_sed_hydro_file_new_inline);
     //g_test_add_func ("/libsed/sed_hydro/new_binary", &test_sed_hydro_file_new_binary);
     //g_test_add_func ("/libsed/sed_hydro/new_buffer", &test_sed_hydro_file_new_buffer);
+    g_test_add_func("/libsed/sed_hydro/process_records", &test_sed_hydro_process_records);
+    g_test_add_func("/libsed/sed_hydro/process_records_ties",
+        &test_sed_hydro_process_records_ties);
+    g_test_add_func("/libsed/sed_hydro/process_records_few_events",
+        &test_sed_hydro_process_records_few_events);
+    g_test_add_func("/libsed/sed_hydro/eventize", &test_sed_hydro_array_eventize);
+    g_test_add_func("/libsed/sed_hydro/hydrotrend_big_endian", &test_sed_hydrotrend_big_endian);
+    g_test_add_func("/libsed/sed_hydro/hydrotrend_little_endian",
+        &test_sed_hydrotrend_little_endian);
+    g_test_add_func("/libsed/sed_hydro/prefetch_wrap", &test_sed_hydro_file_prefetch_wrap);
+    g_test_add_func("/libsed/sed_hydro/prefetch_end", &test_sed_hydro_file_prefetch_end);
+    g_test_add_func("/libsed/sed_hydro/stream_push", &test_sed_hydro_file_stream_push);
+    g_test_add_func("/libsed/sed_hydro/stream_bounded", &test_sed_hydro_file_stream_bounded);
+    g_test_add_func("/libsed/sed_hydro/stream_close", &test_sed_hydro_file_stream_close);
+    g_test_add_func("/libsed/sed_hydro/stream_cancel", &test_sed_hydro_file_stream_cancel);
 
     g_test_run();
 }
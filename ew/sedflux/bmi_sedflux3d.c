@@ -170,6 +170,77 @@ get_time_units(BMI_Model* self, char* units)
 }
 
 
+/* Name of the sedflux measurement for a variable, or NULL.
+*/
+static const char*
+_sedflux_measurement_name(const char* name)
+{
+    const char* sedflux_name = NULL;
+
+    if (strcmp(name, "sea_water__depth") == 0) {
+        sedflux_name = "DEPTH";
+    } else if (strcmp(name, "bedrock_surface__elevation") == 0) {
+        sedflux_name = "BASEMENT";
+    } else if (g_str_has_suffix(name, "surface__elevation")) {
+        sedflux_name = "ELEVATION";
+    } else if (g_str_has_suffix(name, "surface__x_derivative_of_elevation")) {
+        sedflux_name = "XSLOPE";
+    } else if (g_str_has_suffix(name, "surface__y_derivative_of_elevation")) {
+        sedflux_name = "YSLOPE";
+    } else if (g_str_has_suffix(name, "sediment_grain__mean_diameter")) {
+        sedflux_name = "GRAIN";
+    } else if (g_str_has_suffix(name, "sediment__mean_of_deposition_age")) {
+        sedflux_name = "AGE";
+    } else if (g_str_has_suffix(name, "sediment_sand__volume_fraction")) {
+        sedflux_name = "SAND";
+    } else if (g_str_has_suffix(name, "sediment_silt__volume_fraction")) {
+        sedflux_name = "SILT";
+    } else if (g_str_has_suffix(name, "sediment_clay__volume_fraction")) {
+        sedflux_name = "CLAY";
+    } else if (g_str_has_suffix(name, "sediment_mud__volume_fraction")) {
+        sedflux_name = "MUD";
+    } else if (g_str_has_suffix(name, "sediment__bulk_mass-per-volume_density")) {
+        sedflux_name = "DENSITY";
+    } else if (g_str_has_suffix(name, "sediment__porosity")) {
+        sedflux_name = "POROSITY";
+    } else if (g_str_has_suffix(name, "sediment__permeability")) {
+        sedflux_name = "PERMEABILITY";
+    }
+    //     else if (g_str_has_suffix(name, "sediment_model_grain_class_0__volume_fraction"))
+    //         sedflux_name = "";
+
+    return sedflux_name;
+}
+
+
+/* Map the name of a surface variable to a sedflux measurement and a mask of
+   cells to exclude.  Return FALSE if name is not a surface variable.
+*/
+static gboolean
+_surface_value_name(const char* name, const char** sedflux_name, gint* mask)
+{
+    *mask = 0;
+
+    if (g_str_has_prefix(name, "sediment_") ||
+        g_str_has_prefix(name, "channel_exit_")) {
+        return FALSE;
+    }
+
+    *sedflux_name = _sedflux_measurement_name(name);
+
+    if (!*sedflux_name) {
+        return FALSE;
+    }
+
+    // NOTE: Need to check for 'land-or-seabed_sediment_'
+    if (g_str_has_prefix(name, "sea_bottom_")) {
+        *mask |= MASK_LAND;
+    }
+
+    return TRUE;
+}
+
+
 static int
 initialize(BMI_Model* self, const char* file)
 {
@@ -232,6 +303,17 @@ initialize(BMI_Model* self, const char* file)
                 return BMI_FAILURE;
             }
 
+            /* Resolve surface variables to buffer ids once */
+            for (i = 0; i < OUTPUT_VAR_NAME_COUNT; i++) {
+                const char* sedflux_name = NULL;
+                gint mask;
+
+                if (_surface_value_name(output_var_names[i], &sedflux_name, &mask)) {
+                    sedflux_add_surface_value(data, output_var_names[i], sedflux_name,
+                        mask);
+                }
+            }
+
             //set_input_var_names(*handle, input_var_names);
             //set_output_var_names(*handle, output_var_names);
         } else {
@@ -841,10 +923,52 @@ get_var_location(BMI_Model* self, const char* name, char* location)
 }
 
 
+static int
+get_value_ptr(BMI_Model* self, const char* name, void** dest)
+{
+    Sedflux_state* state = (Sedflux_state*)self->data;
+    gint id = sedflux_surface_value_id(state, name);
+
+    if (id < 0) { /* A surface variable that is not in the output list */
+        const char* sedflux_name = NULL;
+        gint mask;
+
+        if (_surface_value_name(name, &sedflux_name, &mask)) {
+            id = sedflux_add_surface_value(state, name, sedflux_name, mask);
+        }
+    }
+
+    if (id < 0) {
+        *dest = NULL;
+        return BMI_FAILURE;
+    }
+
+    *dest = sedflux_get_surface_value_ptr(state, id);
+
+    if (*dest) {
+        return BMI_SUCCESS;
+    } else {
+        return BMI_FAILURE;
+    }
+}
+
+
 static int
 get_value(BMI_Model* self, const char* name, void* dest)
 {
-    const char* sedflux_name = NULL;
+    void* src = NULL;
+
+    if (get_value_ptr(self, name, &src) == BMI_SUCCESS) {
+        int nbytes = 0;
+
+        if (get_var_nbytes(self, name, &nbytes) == BMI_FAILURE) {
+            return BMI_FAILURE;
+        }
+
+        memcpy(dest, src, nbytes);
+
+        return BMI_SUCCESS;
+    }
 
     if (g_str_has_prefix(name, "channel_exit_")) {
         if (g_str_has_suffix(name, "water_flow__speed")) {
@@ -862,84 +986,22 @@ get_value(BMI_Model* self, const char* name, void* dest)
         return BMI_SUCCESS;
     }
 
-    if (strcmp(name, "sea_water__depth") == 0) {
-        sedflux_name = "DEPTH";
-    } else if (strcmp(name, "bedrock_surface__elevation") == 0) {
-        sedflux_name = "BASEMENT";
-    } else if (g_str_has_suffix(name, "surface__elevation")) {
-        sedflux_name = "ELEVATION";
-    } else if (g_str_has_suffix(name, "surface__x_derivative_of_elevation")) {
-        sedflux_name = "XSLOPE";
-    } else if (g_str_has_suffix(name, "surface__y_derivative_of_elevation")) {
-        sedflux_name = "YSLOPE";
-    } else if (g_str_has_suffix(name, "sediment_grain__mean_diameter")) {
-        sedflux_name = "GRAIN";
-    } else if (g_str_has_suffix(name, "sediment__mean_of_deposition_age")) {
-        sedflux_name = "AGE";
-    } else if (g_str_has_suffix(name, "sediment_sand__volume_fraction")) {
-        sedflux_name = "SAND";
-    } else if (g_str_has_suffix(name, "sediment_silt__volume_fraction")) {
-        sedflux_name = "SILT";
-    } else if (g_str_has_suffix(name, "sediment_clay__volume_fraction")) {
-        sedflux_name = "CLAY";
-    } else if (g_str_has_suffix(name, "sediment_mud__volume_fraction")) {
-        sedflux_name = "MUD";
-    } else if (g_str_has_suffix(name, "sediment__bulk_mass-per-volume_density")) {
-        sedflux_name = "DENSITY";
-    } else if (g_str_has_suffix(name, "sediment__porosity")) {
-        sedflux_name = "POROSITY";
-    } else if (g_str_has_suffix(name, "sediment__permeability")) {
-        sedflux_name = "PERMEABILITY";
-    }
-    //     else if (g_str_has_suffix(name, "sediment_model_grain_class_0__volume_fraction"))
-    //         sedflux_name = "";
-    else {
-        return BMI_FAILURE;
-    }
-
     if (g_str_has_prefix(name, "sediment_")) {
-        if (!sedflux_get_sediment_value((Sedflux_state*)self->data, sedflux_name,
-                (double*)dest)) {
-            return BMI_FAILURE;
-        }
-    } else {
-        // NOTE: Need to check for 'land-or-seabed_sediment_'
-        gint mask = 0;
+        const char* sedflux_name = _sedflux_measurement_name(name);
 
-        if (g_str_has_prefix(name, "sea_bottom_")) {
-            mask |= MASK_LAND;
-        } else if (g_str_has_prefix(name, "land-or-seabed_")) {
-            mask = 0;
+        if (!sedflux_name) {
+            return BMI_FAILURE;
         }
 
-        if (!sedflux_get_surface_value((Sedflux_state*)self->data, sedflux_name, (double*)dest,
-                mask)) {
+        if (!sedflux_get_sediment_value((Sedflux_state*)self->data, sedflux_name,
+                (double*)dest)) {
             return BMI_FAILURE;
         }
-    }
-
-    return BMI_SUCCESS;
-}
-
-
-#if 0
-int
-get_value(BMI_Model* self, const char* name, void* dest)
-{
-    void* src = NULL;
-    int nbytes = 0;
 
-    if (get_value_ptr(self, name, &src) == BMI_FAILURE) {
-        return BMI_FAILURE;
-    }
-
-    if (get_var_nbytes(self, name, &nbytes) == BMI_FAILURE) {
-        return BMI_FAILURE;
+        return BMI_SUCCESS;
     }
 
-    memcpy(dest, src, nbytes);
-
-    return BMI_SUCCESS;
+    return BMI_FAILURE;
 }
 
 
@@ -948,30 +1010,23 @@ get_value_at_indices(BMI_Model* self, const char* name, void* dest,
     int* inds, int len)
 {
     void* src = NULL;
-    int itemsize = 0;
 
     if (get_value_ptr(self, name, &src) == BMI_FAILURE) {
         return BMI_FAILURE;
     }
 
-    if (get_var_itemsize(self, name, &itemsize) == BMI_FAILURE) {
-        return BMI_FAILURE;
-    }
-
-    {   /* Copy the data */
+    { /* Gather the data */
+        const double* from = (const double*)src;
+        double* to = (double*)dest;
         int i;
-        int offset;
-        void* ptr;
 
-        for (i = 0, ptr = dest; i < len; i++, ptr += itemsize) {
-            offset = inds[i] * itemsize;
-            memcpy(ptr, src + offset, itemsize);
+        for (i = 0; i < len; i++) {
+            to[i] = from[inds[i]];
         }
     }
 
     return BMI_SUCCESS;
 }
-#endif
 
 
 static int
@@ -1065,8 +1120,8 @@ register_bmi_sedflux3d(BMI_Model* model)
     model->get_time_step = get_time_step;
 
     model->get_value = get_value;
-    model->get_value_ptr = NULL;
-    model->get_value_at_indices = NULL;
+    model->get_value_ptr = get_value_ptr;
+    model->get_value_at_indices = get_value_at_indices;
 
     model->set_value = set_value;
     // model->set_value_ptr = NULL;
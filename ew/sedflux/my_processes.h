@@ -161,6 +161,32 @@ Sed_proc_destroy destroy_subsidence;
 Sed_proc_destroy destroy_tide;
 Sed_proc_destroy destroy_xshore;
 
+gboolean
+dump_cpr_data(gpointer, FILE*);
+gboolean
+dump_data_dump_data(gpointer, FILE*);
+gboolean
+dump_isostasy_data(gpointer, FILE*);
+gboolean
+dump_quake_data(gpointer, FILE*);
+gboolean
+dump_storm_data(gpointer, FILE*);
+gboolean
+dump_subsidence_data(gpointer, FILE*);
+
+gboolean
+load_cpr_data(gpointer, FILE*);
+gboolean
+load_data_dump_data(gpointer, FILE*);
+gboolean
+load_isostasy_data(gpointer, FILE*);
+gboolean
+load_quake_data(gpointer, FILE*);
+gboolean
+load_storm_data(gpointer, FILE*);
+gboolean
+load_subsidence_data(gpointer, FILE*);
+
 #define BBL_PROCESS_NAME_S    "bbl"
 
 typedef struct {
@@ -188,17 +214,28 @@ Bioturbation_t;
 typedef struct {
     Eh_file_list* file_list;
     gchar*        output_dir;
+    gint          full_interval; //< Write a full checkpoint every this many
+    gint          n_deltas;      //< Deltas written since the last full one
+    gchar*        base_file;     //< Last full checkpoint (or NULL)
+    gint*         base_stamps;   //< Snapshot stamps when base_file was written
+    Sed_cube      base_cube;     //< Cube that base_stamps are the stamps of
+    Sed_cube      snapshot;      //< Copy of the cube that is written (if
+                                 //< there are output threads)
+    gint*         stamps;        //< Column stamps when the snapshot was taken
 }
 Cpr_t;
 
 typedef struct {
-    double  vertical_resolution;
-    double  horizontal_resolution;
-    double  y_lim_min, y_lim_max;
-    double  x_lim_min, x_lim_max;
-    gchar*  output_dir;
-    GArray* property;
-    int     count;
+    double   vertical_resolution;
+    double   horizontal_resolution;
+    double   y_lim_min, y_lim_max;
+    double   x_lim_min, x_lim_max;
+    gchar*   output_dir;
+    GArray*  property;
+    int      count;
+    Sed_cube snapshot; //< Copy of the cube that is written in the background
+                       //< (if there are output threads)
+    gint*    stamps;   //< Column stamps when the snapshot was taken
 }
 Data_dump_t;
 
@@ -236,6 +273,7 @@ typedef struct {
     double       friction_angle;
     double       gravity;
     double       density_sea_water;
+    gint         n_threads;
     Sed_process  turbidity_current;
     Sed_process  debris_flow;
     Sed_process  slump;
@@ -282,12 +320,16 @@ typedef struct {
     char*            filename;
     Sed_hydro_file_type type;
     gboolean         buffer_is_on;
+    gint             n_prefetch;     // Number of river buffers to read ahead
     int              location;
     double           total_mass;
     double           total_mass_from_river;
     //Sed_riv          this_river;
     gpointer         this_river;
     char*            river_name;
+    gpointer         model;          // The HydroTrend run feeding a "model" river
+    GThread*         model_thread;
+    gboolean         is_dry;         // The river model has no more records
 }
 River_t;
 
@@ -332,6 +374,7 @@ typedef struct {
     Eh_input_val k_long_max;
     Eh_input_val k_cross_max;
     double       skin_depth;
+    int          method;
 }
 Diffusion_t;
 
@@ -375,6 +418,7 @@ plume_hydro_data_quark(void);
 
 #include "plume_types.h"
 #include "plumeinput.h"
+#include "plume_cache.h"
 
 typedef struct {
     Eh_input_val  current_velocity;
@@ -387,11 +431,13 @@ typedef struct {
     Sed_cell**    deposit;
     Sed_cell**    last_deposit;
     double**      plume_deposit;
-    Plume_river   last_river_data;
     Plume_data*   plume_data;
 
     Sed_cell_grid deposit_grid;
-    Sed_cell_grid last_deposit_grid;
+
+    double        cache_size;      //< Megabytes of plume deposits to keep
+    double        cache_tolerance; //< Relative tolerance of cache keys
+    Plume_cache*  cache;
 }
 Plume_hypo_t;
 
@@ -73,12 +73,16 @@ run_bbl(Sed_process p, Sed_cube prof)
         Sed_riv* r;
 
         if (all) {
+            SED_PROFILE_BEGIN("deposit");
+
             for (r = all ; *r ; r++) {
                 eh_debug("Depositing sediment for river: %s", sed_river_name_loc(*r));
                 rain_sediment_3(prof, data->algorithm, *r);
             }
 
-            info.mass_lost += sed_cube_mass_in_suspension(prof);
+            SED_PROFILE_END();
+
+            info.mass_lost += sed_cube_sediment_mass_in_suspension(prof);
 
             // remove any remaining suspended sediment from the model.
             for (r = all ; *r ; r++) {
@@ -279,7 +283,7 @@ add_sediment_from_external_source(Sed_cube p,
                 if (h > 0) {
                     sed_cell_resize(deposit_cell, h);
 
-                    mass_added += sed_cell_mass(deposit_cell);
+                    mass_added += sed_cell_sediment_mass(deposit_cell);
 
                     sed_column_add_cell(sed_cube_col_ij(p, i, j), deposit_cell);
                 }
@@ -324,7 +328,7 @@ add_sediment_from_external_source(Sed_cube p,
                         if (h > 0) {
                             sed_cell_resize(deposit_cell, h);
 
-                            mass_added += sed_cell_mass(deposit_cell);
+                            mass_added += sed_cell_sediment_mass(deposit_cell);
 
                             sed_column_add_cell(sed_cube_col_ij(p, i, j), deposit_cell);
                         }
@@ -26,10 +26,6 @@
 #include <sed/sed_sedflux.h>
 #include "my_processes.h"
 
-gboolean
-dump_cpr_data(gpointer ptr, FILE* fp);
-gpointer
-load_cpr_data(FILE* fp);
 void
 eh_dump_file_list(Eh_file_list* fl, FILE* fp);
 Eh_file_list*
@@ -37,30 +33,127 @@ eh_load_file_list(FILE* fp);
 gboolean
 init_cpr_data(Sed_process proc, Sed_cube prof, GError** error);
 
+typedef struct {
+    Cpr_t*      data;
+    Sed_cube    cube;
+    gchar*      file;
+    GByteArray* procs;
+    gchar*      base;
+}
+Cpr_job;
+
+/* Write a checkpoint of the cube.  If there are output threads, this is run
+   by one of them and the cube is a snapshot.  The process doesn't touch its
+   data again until the job is finished (see sed_output_wait). */
+static void
+_cpr_write(gpointer ptr)
+{
+    Cpr_job* job = (Cpr_job*)ptr;
+    Cpr_t* data = job->data;
+    GError* error = NULL;
+
+    if (!sed_checkpoint_write_snapshot(job->file, job->cube, job->procs,
+            job->base, data->base_stamps, &error)) {
+        eh_warning("%s: Unable to write checkpoint: %s", job->file,
+            error->message);
+        g_error_free(error);
+
+        if (!job->base) {
+            // There is no full checkpoint to base the next delta on.
+            eh_free(data->base_file);
+            data->base_file = NULL;
+        }
+    }
+}
+
+static void
+_cpr_job_destroy(gpointer ptr)
+{
+    Cpr_job* job = (Cpr_job*)ptr;
+
+    if (job->procs) {
+        g_byte_array_free(job->procs, TRUE);
+    }
+
+    eh_free(job->base);
+    eh_free(job->file);
+    eh_free(job);
+}
+
 Sed_process_info
 run_cpr(Sed_process proc, Sed_cube prof)
 {
     Cpr_t*           data = (Cpr_t*)sed_process_user_data(proc);
     Sed_process_info info = SED_EMPTY_INFO;
-    gchar* file_name;
-    FILE*  fp;
+    Cpr_job* job;
 
     if (sed_process_run_count(proc) == 0) {
         init_cpr_data(proc, prof, NULL);
     }
 
-    file_name = eh_get_next_file(data->file_list);
+    // The last checkpoint may still be reading the snapshot.
+    sed_output_wait(data);
+
+    job        = eh_new(Cpr_job, 1);
+    job->data  = data;
+    job->file  = eh_get_next_file(data->file_list);
+    job->procs = NULL;
+    job->base  = NULL;
+
+    { /* The epoch queue is provided by sedflux so that its processes can be
+         restarted along with the cube. */
+        Sed_epoch_queue q = (Sed_epoch_queue)sed_process_use(proc,
+                SED_CHECKPOINT_EPOCH_QUEUE);
+        const double age = sed_cube_age(prof);
+
+        eh_message("checkpoint file: %s", job->file);
+
+        /* The checkpoint process is run last (see
+           _sedflux_provide_epoch_queue) so every other process of this time
+           step has already run and a restart begins with the next time
+           step. */
+        sed_cube_increment_age(prof);
+
+        if (sed_output_n_threads() > 0) {
+            /* The cube and processes are copied now and written while the
+               run carries on. */
+            data->snapshot = sed_cube_snapshot(data->snapshot, prof, data->stamps);
+            data->stamps   = sed_cube_stamps(prof, data->stamps);
+            job->cube      = data->snapshot;
+        } else {
+            /* The checkpoint is written as the job is pushed, so from the
+               cube itself. */
+            job->cube      = prof;
+        }
+
+        if (q) {
+            job->procs = sed_checkpoint_processes(q);
+        }
 
-    fp = fopen(file_name, "wb");
+        if (data->base_file && data->base_cube == job->cube
+            && data->n_deltas + 1 < data->full_interval) {
+            /* Only write the columns that changed since the last full one */
+            job->base = g_strdup(data->base_file);
+            data->n_deltas++;
+        } else {
+            eh_free(data->base_file);
+
+            data->base_file   = g_strdup(job->file);
+            data->base_cube   = job->cube;
+            data->base_stamps = sed_cube_stamps(job->cube, data->base_stamps);
+            data->n_deltas    = 0;
+        }
 
-    sed_cube_write(fp, prof);
+        sed_output_push(data, _cpr_write, job, _cpr_job_destroy);
 
-    fclose(fp);
+        sed_cube_set_age(prof, age);
+    }
 
     return info;
 }
 
 #define S_KEY_DIR       "output directory"
+#define S_KEY_FULL      "full checkpoint interval"
 
 gboolean
 init_cpr(Sed_process p, Eh_symbol_table tab, GError** error)
@@ -71,10 +164,29 @@ init_cpr(Sed_process p, Eh_symbol_table tab, GError** error)
 
     eh_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
-    data->file_list  = NULL;
+    data->file_list   = NULL;
+    data->n_deltas    = 0;
+    data->base_file   = NULL;
+    data->base_stamps = NULL;
+    data->base_cube   = NULL;
+    data->snapshot    = NULL;
+    data->stamps      = NULL;
 
     data->output_dir = eh_symbol_table_value(tab, S_KEY_DIR);
 
+    // Checkpoints in between full ones hold only the columns that changed.
+    // If not given, every checkpoint is a full one.
+    if (eh_symbol_table_has_label(tab, S_KEY_FULL)) {
+        data->full_interval = eh_symbol_table_int_value(tab, S_KEY_FULL);
+    } else {
+        data->full_interval = 1;
+    }
+
+    if (data->full_interval < 1) {
+        g_set_error(&tmp_err, SEDFLUX_ERROR, SEDFLUX_ERROR_BAD_PARAM,
+            "%s: Full checkpoint interval must be positive", S_KEY_FULL);
+    }
+
     if (!tmp_err) {
         try_dir(data->output_dir, &tmp_err);
     }
@@ -116,8 +228,15 @@ destroy_cpr(Sed_process p)
         Cpr_t* data = (Cpr_t*)sed_process_user_data(p);
 
         if (data) {
+            // A checkpoint may still be written from the snapshot.
+            sed_output_wait(data);
+
             eh_destroy_file_list(data->file_list);
+            sed_cube_destroy(data->snapshot);
+            eh_free(data->stamps);
 
+            eh_free(data->base_file);
+            eh_free(data->base_stamps);
             eh_free(data->output_dir);
             data->output_dir = NULL;
             eh_free(data);
@@ -127,82 +246,100 @@ destroy_cpr(Sed_process p)
     return TRUE;
 }
 
+/* Only the file list is written.  The output directory is read from the
+   input file when the process is created.  The column stamps of the last
+   full checkpoint are not saved so the first checkpoint after a restart is
+   always a full one. */
 gboolean
 dump_cpr_data(gpointer ptr, FILE* fp)
 {
     Cpr_t* data = (Cpr_t*)ptr;
-    gint len;
 
     eh_require(ptr != NULL);
     eh_require(fp != NULL);
 
-    len = strlen(data->output_dir) + 1;
-
-    eh_dump_file_list(data->file_list, fp);
-    fwrite(&len, sizeof(gint), 1, fp);
-    fwrite(data->output_dir, sizeof(char), len, fp);
+    if (data->file_list) {
+        eh_dump_file_list(data->file_list, fp);
+    }
 
     return TRUE;
 }
 
-gpointer
-load_cpr_data(FILE* fp)
+gboolean
+load_cpr_data(gpointer ptr, FILE* fp)
 {
-    Cpr_t* data;
-    gint len;
+    Cpr_t* data = (Cpr_t*)ptr;
+    Eh_file_list* fl;
 
+    eh_require(ptr != NULL);
     eh_require(fp != NULL);
 
-    data = eh_new(Cpr_t, 1);
+    fl = eh_load_file_list(fp);
 
-    data->file_list = eh_load_file_list(fp);
-    fread(&len, sizeof(gint), 1, fp);
-    fread(data->output_dir, sizeof(char), len, fp);
+    if (fl) {
+        eh_destroy_file_list(data->file_list);
+        data->file_list = fl;
+    }
 
-    return (gpointer)data;
+    return fl != NULL;
 }
 
-void
-eh_dump_file_list(Eh_file_list* fl, FILE* fp)
+static void
+_dump_string(const gchar* str, FILE* fp)
 {
-    int len;
+    gint32 len = strlen(str);
 
-    len = strlen(fl->prefix);
-    fwrite(&len, sizeof(int), 1, fp);
-    fwrite(fl->prefix, sizeof(char), len, fp);
+    fwrite(&len, sizeof(gint32), 1, fp);
+    fwrite(str, sizeof(char), len, fp);
+}
 
-    len = strlen(fl->suffix);
-    fwrite(&len, sizeof(int), 1, fp);
-    fwrite(fl->suffix, sizeof(char), len, fp);
+static gchar*
+_load_string(FILE* fp)
+{
+    gchar* str = NULL;
+    gint32 len;
 
-    len = strlen(fl->format);
-    fwrite(&len, sizeof(int), 1, fp);
-    fwrite(fl->suffix, sizeof(char), len, fp);
+    if (fread(&len, sizeof(gint32), 1, fp) == 1 && len >= 0) {
+        str = eh_new0(gchar, len + 1);
 
-    fwrite(&(fl->count), sizeof(int), 1, fp);
+        if (fread(str, sizeof(char), len, fp) != len) {
+            eh_free(str);
+            str = NULL;
+        }
+    }
 
+    return str;
 }
 
-Eh_file_list*
-eh_load_file_list(FILE* fp)
+void
+eh_dump_file_list(Eh_file_list* fl, FILE* fp)
 {
-    int len;
-    Eh_file_list* fl = eh_new(Eh_file_list, 1);
-
-    fread(&len, sizeof(int), 1, fp);
-    fl->prefix = eh_new(char, len);
-    fread(fl->prefix, sizeof(char), len, fp);
+    gint32 count = fl->count;
 
-    fread(&len, sizeof(int), 1, fp);
-    fl->suffix = eh_new(char, len);
-    fread(fl->suffix, sizeof(char), len, fp);
+    _dump_string(fl->prefix, fp);
+    _dump_string(fl->suffix, fp);
+    _dump_string(fl->format, fp);
 
-    fread(&len, sizeof(int), 1, fp);
-    fl->format = eh_new(char, len);
-    fread(fl->format, sizeof(char), len, fp);
+    fwrite(&count, sizeof(gint32), 1, fp);
+}
 
-    fread(&(fl->count), sizeof(int), 1, fp);
+Eh_file_list*
+eh_load_file_list(FILE* fp)
+{
+    Eh_file_list* fl = eh_new(Eh_file_list, 1);
+    gint32 count;
+
+    fl->prefix = _load_string(fp);
+    fl->suffix = _load_string(fp);
+    fl->format = _load_string(fp);
+
+    if (!fl->prefix || !fl->suffix || !fl->format
+        || fread(&count, sizeof(gint32), 1, fp) != 1) {
+        eh_destroy_file_list(fl);
+        fl = NULL;
+    } else {
+        fl->count = count;
+    }
 
     return fl;
 }
-
@@ -26,60 +26,125 @@
 #include <sed/sed_sedflux.h>
 #include "my_processes.h"
 
+typedef struct {
+    Sed_cube      cube;
+    gchar**       filename;
+    Sed_property* property;
+    gint          len;
+}
+Data_dump_job;
+
+/* Write each of the property files of a data dump.  If there are output
+   threads, this is run by one of them so it only looks at the snapshot of
+   the cube. */
+static void
+_data_dump_write(gpointer data)
+{
+    Data_dump_job* job = (Data_dump_job*)data;
+    Sed_property_file* fp = eh_new0(Sed_property_file, job->len + 1);
+    gint i;
+
+    for (i = 0; i < job->len ; i++) {
+        fp[i] = sed_property_file_new(job->filename[i], job->property[i], NULL);
+    }
+
+    // Rebin the cube once for all of the properties.
+    sed_property_file_write_all(fp, job->cube);
+
+    for (i = 0; i < job->len ; i++) {
+        sed_property_file_destroy(fp[i]);
+    }
+
+    eh_free(fp);
+}
+
+static void
+_data_dump_job_destroy(gpointer data)
+{
+    Data_dump_job* job = (Data_dump_job*)data;
+    gint i;
+
+    for (i = 0; i < job->len ; i++) {
+        sed_property_destroy(job->property[i]);
+    }
+
+    eh_free(job->property);
+    g_strfreev(job->filename);
+    eh_free(job);
+}
+
 Sed_process_info
 run_data_dump(Sed_process proc, Sed_cube prof)
 {
     Data_dump_t*     data = (Data_dump_t*)sed_process_user_data(proc);
     Sed_process_info info = SED_EMPTY_INFO;
-    int i;
-    char str[S_NAMEMAX], *filename;
+    int i, n_files;
+    char str[S_NAMEMAX];
     gchar* cube_name;
-    Sed_property_file fp;
+    Data_dump_job* job;
     Sed_property_file_attr attr;
-    Sed_property property;
 
     data->count++;
     sprintf(str, "%04d", data->count);
 
+    n_files = (data->property) ? data->property->len : 0;
+
+    if (n_files == 0) {
+        return info;
+    }
+
+    // The last dump may still be reading the snapshot.
+    sed_output_wait(data);
+
     cube_name = sed_cube_name(prof);
 
-    for (i = 0; data->property && i < data->property->len ; i++) {
-        property = sed_property_dup(g_array_index(data->property, Sed_property, i));
+    job           = eh_new(Data_dump_job, 1);
 
-        filename = g_strconcat(data->output_dir,
-                G_DIR_SEPARATOR_S,
-                cube_name,
-                str,
-                ".",
-                sed_property_extension(property), NULL);
+    if (sed_output_n_threads() > 0) {
+        data->snapshot = sed_cube_snapshot(data->snapshot, prof, data->stamps);
+        data->stamps   = sed_cube_stamps(prof, data->stamps);
+        job->cube      = data->snapshot;
+    } else {
+        // The files are written as the job is pushed, so from the cube itself.
+        job->cube      = prof;
+    }
 
-        attr = sed_property_file_attr_new();
+    job->len      = n_files;
+    job->filename = eh_new0(gchar*, n_files + 1);
+    job->property = eh_new0(Sed_property, n_files);
 
-        eh_warning("property file attributes are not being used.");
-        /*
-              sed_set_sed_file_attr_y_res( attr , data->vertical_resolution );
-              sed_set_sed_file_attr_x_res( attr , data->horizontal_resolution );
-              sed_set_sed_file_attr_y_lim( attr , data->y_lim_min , data->y_lim_max );
-              sed_set_sed_file_attr_x_lim( attr , data->x_lim_min , data->x_lim_max );
-        */
+    attr = sed_property_file_attr_new();
 
-        fp = sed_property_file_new(filename, property, NULL);
+    eh_warning("property file attributes are not being used.");
+    /*
+          sed_set_sed_file_attr_y_res( attr , data->vertical_resolution );
+          sed_set_sed_file_attr_x_res( attr , data->horizontal_resolution );
+          sed_set_sed_file_attr_y_lim( attr , data->y_lim_min , data->y_lim_max );
+          sed_set_sed_file_attr_x_lim( attr , data->x_lim_min , data->x_lim_max );
+    */
 
-        sed_property_file_write(fp, prof);
-        sed_property_file_attr_destroy(attr);
-        sed_property_file_destroy(fp);
+    for (i = 0; i < n_files ; i++) {
+        job->property[i] = sed_property_dup(g_array_index(data->property, Sed_property, i));
+
+        job->filename[i] = g_strconcat(data->output_dir,
+                G_DIR_SEPARATOR_S,
+                cube_name,
+                str,
+                ".",
+                sed_property_extension(job->property[i]), NULL);
 
         eh_message("time                           : %f",
             sed_cube_age_in_years(prof));
-        eh_message("filename                       : %s", filename);
+        eh_message("filename                       : %s", job->filename[i]);
         eh_message("vertical resolution (0=full)   : %f",
             data->vertical_resolution);
         eh_message("horizontal resolution (0=full) : %f",
             data->horizontal_resolution);
-
-        eh_free(filename);
     }
 
+    sed_output_push(data, _data_dump_write, job, _data_dump_job_destroy);
+
+    sed_property_file_attr_destroy(attr);
     eh_free(cube_name);
 
     return info;
@@ -114,6 +179,8 @@ init_data_dump(Sed_process p, Eh_symbol_table tab, GError** error)
     if (eh_symbol_table_require_labels(tab, data_dump_req_labels, &tmp_err)) {
         data->property   = g_array_new(FALSE, FALSE, sizeof(Sed_property));
         data->output_dir = eh_symbol_table_value(tab, DATA_DUMP_KEY_DIR);
+        data->snapshot   = NULL;
+        data->stamps     = NULL;
 
         // ---
         // read the vertical and horizontal resolutions.  if the key word, 'full'
@@ -196,6 +263,12 @@ destroy_data_dump(Sed_process p)
         Data_dump_t* data = (Data_dump_t*)sed_process_user_data(p);
 
         if (data) {
+            // Files may still be written from the snapshot.
+            sed_output_wait(data);
+
+            sed_cube_destroy(data->snapshot);
+            eh_free(data->stamps);
+
             if (data->property) {
                 g_array_free(data->property, TRUE);
             }
@@ -208,28 +281,15 @@ destroy_data_dump(Sed_process p)
     return TRUE;
 }
 
+/* The resolution, limits, and properties are read from the input file when
+   the process is created so only the file counter needs to be saved. */
 gboolean
 dump_data_dump_data(gpointer ptr, FILE* fp)
 {
-    guint len;
     Data_dump_t* data = (Data_dump_t*)ptr;
+    gint32 count = data->count;
 
-    fwrite(&(data->vertical_resolution), sizeof(double), 1, fp);
-    fwrite(&(data->horizontal_resolution), sizeof(double), 1, fp);
-    fwrite(&(data->y_lim_min), sizeof(double), 1, fp);
-    fwrite(&(data->y_lim_max), sizeof(double), 1, fp);
-    fwrite(&(data->x_lim_min), sizeof(double), 1, fp);
-    fwrite(&(data->x_lim_max), sizeof(double), 1, fp);
-
-    len = strlen(data->output_dir);
-    fwrite(&len, sizeof(guint), 1, fp);
-    fwrite(data->output_dir, sizeof(char), len, fp);
-
-    len = data->property->len;
-    fwrite(&len, sizeof(guint), 1, fp);
-    fwrite(&(data->property->data), sizeof(guint), len, fp);
-
-    fwrite(&(data->count), sizeof(int), 1, fp);
+    fwrite(&count, sizeof(gint32), 1, fp);
 
     return TRUE;
 }
@@ -238,27 +298,13 @@ gboolean
 load_data_dump_data(gpointer ptr, FILE* fp)
 {
     Data_dump_t* data = (Data_dump_t*)ptr;
-    Sed_property* property;
-    guint len;
-
-    fread(&(data->vertical_resolution), sizeof(double), 1, fp);
-    fread(&(data->horizontal_resolution), sizeof(double), 1, fp);
-    fread(&(data->y_lim_min), sizeof(double), 1, fp);
-    fread(&(data->y_lim_max), sizeof(double), 1, fp);
-    fread(&(data->x_lim_min), sizeof(double), 1, fp);
-    fread(&(data->x_lim_max), sizeof(double), 1, fp);
-
-    fread(&len, sizeof(guint), 1, fp);
-    data->output_dir = eh_new(char, len);
-    fread(data->output_dir, sizeof(char), len, fp);
-
-    data->property = g_array_new(FALSE, FALSE, sizeof(Sed_property));
-    fread(&len, sizeof(guint), 1, fp);
-    property = eh_new(Sed_property, len);
-    fread(property, sizeof(Sed_property), len, fp);
-    g_array_append_vals(data->property, property, len);
-
-    fread(&(data->count), sizeof(int), 1, fp);
+    gint32 count;
+
+    if (fread(&count, sizeof(gint32), 1, fp) != 1) {
+        return FALSE;
+    }
+
+    data->count = count;
 
     return TRUE;
 }
@@ -63,12 +63,12 @@ run_diffusion(Sed_process proc, Sed_cube prof)
             lost = diffuse_sediment_2(
                     prof, k_max, k_max,
                     skin_depth, sed_cube_time_step_in_days(prof),
-                    DIFFUSION_OPT_WATER);
+                    DIFFUSION_OPT_WATER | data->method);
         else
             lost = diffuse_sediment(
                     prof, k_max,
                     skin_depth, sed_cube_time_step_in_days(prof),
-                    DIFFUSION_OPT_WATER);
+                    DIFFUSION_OPT_WATER | data->method);
 
         if (lost) {
             int i;
@@ -94,6 +94,7 @@ run_diffusion(Sed_process proc, Sed_cube prof)
 #define DIFFUSION_KEY_SKIN_DEPTH    "diffusion 1% depth"
 #define DIFFUSION_KEY_K_LONG_MAX    "long-shore diffusion constant"
 #define DIFFUSION_KEY_K_CROSS_MAX   "cross-shore diffusion constant"
+#define DIFFUSION_KEY_METHOD        "diffusion method"
 
 static const gchar* diffusion_req_labels[] = {
     DIFFUSION_KEY_K_MAX,
@@ -111,6 +112,8 @@ init_diffusion(Sed_process p, Eh_symbol_table tab, GError** error)
 
     eh_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
+    data->method = 0;
+
     eh_symbol_table_require_labels(tab, diffusion_req_labels, &tmp_err);
 
     if (!tmp_err) {
@@ -120,6 +123,16 @@ init_diffusion(Sed_process p, Eh_symbol_table tab, GError** error)
         // eh_check_to_s(data->k_max > 0., "Diffusion coefficient positive", &err_s);
         eh_check_to_s(data->skin_depth > 0., "Skin depth positive", &err_s);
 
+        if (!tmp_err && eh_symbol_table_has_label(tab, DIFFUSION_KEY_METHOD)) {
+            gchar* key = eh_symbol_table_lookup(tab, DIFFUSION_KEY_METHOD);
+
+            if (g_ascii_strcasecmp(key, "IMPLICIT") == 0) {
+                data->method = DIFFUSION_OPT_IMPLICIT;
+            } else if (g_ascii_strcasecmp(key, "EXPLICIT") != 0)
+                g_set_error(&tmp_err, SEDFLUX_ERROR, SEDFLUX_ERROR_BAD_ALGORITHM,
+                    "Invalid diffusion method (explicit or implicit): %s", key);
+        }
+
         if (!tmp_err && err_s) {
             eh_set_error_strv(&tmp_err, SEDFLUX_ERROR, SEDFLUX_ERROR_BAD_PARAM, err_s);
         }
@@ -94,8 +94,14 @@ run_failure(Sed_process proc, Sed_cube p)
 
     fprintf(stderr, "\n");
 
-    eh_debug("initializing failure profile");
-    fail_prof = fail_reinit_fail_profile(fail_prof, p, failure_const);
+    // The profile is kept from the last time step and only the columns
+    // that have changed since then are rebuilt (by fail_update_fail_profile).
+    if (fail_prof->p != p || fail_prof->size != sed_cube_n_y(p)) {
+        eh_debug("initializing failure profile");
+        fail_prof = fail_reinit_fail_profile(fail_prof, p, failure_const);
+    } else {
+        fail_clear_ignored_surfaces(fail_prof);
+    }
 
     do {
 
@@ -219,6 +225,7 @@ run_failure(Sed_process proc, Sed_cube p)
 #define S_KEY_COHESION       "cohesion of sediments"
 #define S_KEY_FRICTION_ANGLE "apparent coulomb friction angle"
 #define S_KEY_CLAY_FRACTION  "fraction of clay for debris flow"
+#define S_KEY_N_THREADS      "number of threads"
 
 gboolean
 init_failure(Sed_process p, Eh_symbol_table tab, GError** error)
@@ -243,6 +250,14 @@ init_failure(Sed_process p, Eh_symbol_table tab, GError** error)
 
     data->friction_angle        *= S_RADS_PER_DEGREE;
 
+    // The number of threads is optional.  If not given, use the number of
+    // threads given on the command line.
+    if (eh_symbol_table_has_label(tab, S_KEY_N_THREADS)) {
+        data->n_threads = eh_symbol_table_int_value(tab, S_KEY_N_THREADS);
+    } else {
+        data->n_threads = 0;
+    }
+
     data->gravity                = sed_gravity();
     data->density_sea_water      = sed_rho_sea_water();
 
@@ -253,6 +268,7 @@ init_failure(Sed_process p, Eh_symbol_table tab, GError** error)
         &err_s);
     eh_check_to_s(data->decider_clay_fraction <= 1, "Clay fraction between 0 and 1",
         &err_s);
+    eh_check_to_s(data->n_threads >= 0, "Number of threads positive", &err_s);
 
     if (!tmp_err && err_s) {
         eh_set_error_strv(&tmp_err, SEDFLUX_ERROR, SEDFLUX_ERROR_BAD_PARAM, err_s);
@@ -280,7 +296,10 @@ init_failure_data(Sed_process proc, Sed_cube prof, GError** error)
         failure_const.gravity           = data->gravity;
         failure_const.density_sea_water = data->density_sea_water;
 
-        data->fail_prof = fail_init_fail_profile(prof, failure_const);
+        data->fail_prof = fail_create_fail_profile(sed_cube_n_y(prof));
+        fail_set_n_threads(data->fail_prof, data->n_threads);
+
+        data->fail_prof = fail_reinit_fail_profile(data->fail_prof, prof, failure_const);
 
         data->turbidity_current = sed_process_child(proc, "TURBIDITY CURRENT");
         // data->turbidity_current = sed_process_child( proc , "INFLOW" );
@@ -299,6 +318,12 @@ destroy_failure(Sed_process p)
 
         if (data) {
             if (data->fail_prof) {
+                // The counts are totals over the whole run.
+                eh_message("columns rebuilt  : %d", data->fail_prof->n_cols_rebuilt);
+                eh_message("columns reused   : %d", data->fail_prof->n_cols_reused);
+                eh_message("surfaces computed: %d", data->fail_prof->n_fos_computed);
+                eh_message("surfaces reused  : %d", data->fail_prof->n_fos_reused);
+
                 fail_destroy_failure_profile(data->fail_prof);
             }
 
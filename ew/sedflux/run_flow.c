@@ -33,6 +33,9 @@ void
 run_terzaghi_flow(Sed_column c, double time_now_in_years);
 void
 run_darcy_flow(Sed_column c, double dt_in_years);
+static void
+_run_darcy_flow_worker(Sed_cube p, gssize n, gssize id, Sed_worker w,
+    gpointer user_data);
 
 Sed_process_info
 run_flow(Sed_process proc, Sed_cube p)
@@ -66,7 +69,9 @@ run_flow(Sed_process proc, Sed_cube p)
             eh_require_not_reached();
     }
 
-    {
+    if (data->method == FLOW_ALGORITHM_DARCY) {
+        sed_cube_foreach_column_parallel(p, &_run_darcy_flow_worker, &dt_in_years);
+    } else {
         gssize i;
         gssize len = sed_cube_size(p);
         Sed_column this_col;
@@ -84,10 +89,6 @@ run_flow(Sed_process proc, Sed_cube p)
                         run_terzaghi_flow(this_col, time_now);
                         break;
 
-                    case FLOW_ALGORITHM_DARCY:
-                        run_darcy_flow(this_col, dt_in_years);
-                        break;
-
                     default:
                         eh_require_not_reached();
                 }
@@ -202,6 +203,8 @@ run_exponential_flow(Sed_column c, double time_now_in_years)
 
     }
 
+    sed_column_touch_keep_load(c);
+
     eh_free(k);
 
     return;
@@ -248,88 +251,107 @@ run_terzaghi_flow(Sed_column c, double time_now_in_years)
 
     }
 
+    sed_column_touch_keep_load(c);
+
     eh_free(c_v);
     eh_free(u);
 
     return;
 }
 
-void
-run_darcy_flow(Sed_column col, double dt_in_years)
+/* Excess pore pressure, hydraulic conductivity and compressibility of the
+   cells of a column, as used by the darcy method.  Returns the hydrostatic
+   pressure at the top of the column. */
+static double
+_darcy_flow_coefficients(Sed_column col, double* u, double* k, double* c)
 {
-    int j, n;
-    double* load, *u, *k, *c;
-    double hydro_static, dz, sed_rate;
-    double max_k, mean_k, mean_c;
-    double time, dt_in_secs;
-    //double *solve_excess_pore_pressure( double* , double* , double* , int ,
-    //                                    double  , double  , double  , double );
-    Sed_cell this_cell;
-
-    dt_in_secs   = years_to_secs(dt_in_years);
-
-    hydro_static = sed_column_water_pressure(col);
-    dz           = sed_column_z_res(col);
-    load         = sed_column_load(col, 0, -1, NULL);
-    //   sed_rate     = ( load[0] - data->old_load[i] ) / dt_in_secs;
-
-    n = sed_column_len(col);
-
-    u = eh_new(double, n);
-    k = eh_new(double, n);
-    c = eh_new(double, n);
+    const gint n = sed_column_len(col);
+    const double hydro_static = sed_column_water_pressure(col);
+    double mean_k;
+    gint j;
 
     for (j = n - 1 ; j >= 0 ; j--) {
-        this_cell = sed_column_nth_cell(col, j);
+        Sed_cell this_cell = sed_column_nth_cell(col, j);
 
         u[j] = sed_cell_pressure(this_cell) - hydro_static;
 
         eh_lower_bound(u[j], 1e-5);
 
         k[j] = sed_cell_hydraulic_conductivity(this_cell);
-        c[j] = sed_cell_compressibility(this_cell)
-            * sed_rho_sea_water() * sed_gravity();
-
-
-        //c[j] = 0;
-        //k[j] = 0;
-        //k[j] /= 1e6;
-        //k[j] = 1e-9;
-        //c[j] = 1e-4;
-        //c[j] *= 1000000;
-
-        eh_lower_bound(max_k, k[j] / c[j]);
-
     }
 
     mean_k = eh_dbl_array_mean(k, n);
-    mean_c = eh_dbl_array_mean(c, n);
-
-    mean_c = 1.;
 
     eh_dbl_array_set(k, n, mean_k);
-    eh_dbl_array_set(c, n, mean_c);
+    eh_dbl_array_set(c, n, 1.);
 
-    sed_rate = 0;
+    return hydro_static;
+}
 
-    // solve for the excess porewater pressure for this column.
-    for (time = 0 ; time < dt_in_secs ; time += dt_in_secs)
-        solve_excess_pore_pressure(u, k, c, n,
-            dz, dt_in_secs, 0., sed_rate);
+static void
+_darcy_flow_set_pressure(Sed_column col, const double* u, double hydro_static)
+{
+    const gint n = sed_column_len(col);
+    gint j;
 
     // set_the new excess porewater pressures for this column.
     for (j = 0 ; j < n ; j++)
         sed_cell_set_pressure(sed_column_nth_cell(col, j),
             (u[j] < 0) ? (hydro_static) : (u[j] + hydro_static));
 
-    //   data->old_load[i] = load[0];
+    sed_column_touch_keep_load(col);
+}
 
-    eh_free(load);
-    eh_free(u);
-    eh_free(k);
+static void
+_darcy_flow_column(Sed_column col, double dt_in_years, double* u, double* k,
+    double* c, double* work)
+{
+    const gint n = sed_column_len(col);
+    const double dt_in_secs = years_to_secs(dt_in_years);
+    double hydro_static;
+
+    hydro_static = _darcy_flow_coefficients(col, u, k, c);
+
+    // solve for the excess porewater pressure for this column.
+    solve_excess_pore_pressure_with_work(u, k, c, n, sed_column_z_res(col),
+        dt_in_secs, 0., 0., work);
+
+    _darcy_flow_set_pressure(col, u, hydro_static);
+}
+
+void
+run_darcy_flow(Sed_column col, double dt_in_years)
+{
+    const gint n = sed_column_len(col);
+    double* u = eh_new(double, n);
+    double* k = eh_new(double, n);
+    double* c = eh_new(double, n);
+    double* work = eh_new(double, 4 * n);
+
+    _darcy_flow_column(col, dt_in_years, u, k, c, work);
+
+    eh_free(work);
     eh_free(c);
+    eh_free(k);
+    eh_free(u);
 
     return;
 }
 
-
+/* Solve the darcy flow of a column of a cube.  Each worker's scratch buffers
+   are reused from one column to the next. */
+static void
+_run_darcy_flow_worker(Sed_cube p, gssize n, gssize id, Sed_worker w,
+    gpointer user_data)
+{
+    Sed_column col = sed_cube_col(p, id);
+    const gint len = sed_column_len(col);
+
+    if (len > 3) {
+        _darcy_flow_column(col, *(double*)user_data,
+            sed_worker_scratch(w, 0, len),
+            sed_worker_scratch(w, 1, len),
+            sed_worker_scratch(w, 2, len),
+            sed_worker_scratch(w, 3, 4 * len));
+    }
+}
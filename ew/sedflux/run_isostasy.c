@@ -381,14 +381,30 @@ destroy_isostasy(Sed_process p)
     return TRUE;
 }
 
+/* The loads and the distance from isostatic equilibrium of the last time
+   the basin was subsided.  Without them, a restarted run would start again
+   from equilibrium with the load of the restored cube. */
 gboolean
 dump_isostasy_data(gpointer ptr, FILE* fp)
 {
     Isostasy_t* data = (Isostasy_t*)ptr;
+    gint32 n_x = 0;
+    gint32 n_y = 0;
 
-    fwrite(data, sizeof(Isostasy_t), 1, fp);
-    //   fwrite( data->old_thickness , sizeof(double) , data->len , fp );
-    //   fwrite( data->old_height    , sizeof(double) , data->len , fp );
+    if (data->last_load && data->last_dw_iso) {
+        n_x = eh_grid_n_x(data->last_load);
+        n_y = eh_grid_n_y(data->last_load);
+    }
+
+    fwrite(&n_x, sizeof(gint32), 1, fp);
+    fwrite(&n_y, sizeof(gint32), 1, fp);
+    fwrite(&data->last_time, sizeof(double), 1, fp);
+    fwrite(&data->last_half_load, sizeof(double), 1, fp);
+
+    if (n_x > 0 && n_y > 0) {
+        fwrite(eh_grid_data_start(data->last_load), sizeof(double), n_x * n_y, fp);
+        fwrite(eh_grid_data_start(data->last_dw_iso), sizeof(double), n_x * n_y, fp);
+    }
 
     return TRUE;
 }
@@ -397,14 +413,37 @@ gboolean
 load_isostasy_data(gpointer ptr, FILE* fp)
 {
     Isostasy_t* data = (Isostasy_t*)ptr;
+    gint32 n_x, n_y;
+    double last_time, last_half_load;
+
+    if (fread(&n_x, sizeof(gint32), 1, fp) != 1
+        || fread(&n_y, sizeof(gint32), 1, fp) != 1
+        || fread(&last_time, sizeof(double), 1, fp) != 1
+        || fread(&last_half_load, sizeof(double), 1, fp) != 1
+        || n_x <= 0 || n_y <= 0) {
+        // The process had not been run.  Its data are set up on its first run.
+        return FALSE;
+    }
 
-    fread(data, sizeof(Isostasy_t), 1, fp);
+    {
+        Eh_dbl_grid last_load   = eh_grid_new(double, n_x, n_y);
+        Eh_dbl_grid last_dw_iso = eh_grid_new(double, n_x, n_y);
+
+        if (fread(eh_grid_data_start(last_load), sizeof(double), n_x * n_y, fp) != n_x * n_y
+            || fread(eh_grid_data_start(last_dw_iso), sizeof(double), n_x * n_y, fp) != n_x * n_y) {
+            eh_grid_destroy(last_load, TRUE);
+            eh_grid_destroy(last_dw_iso, TRUE);
+            return FALSE;
+        }
 
-    //   data->old_thickness = eh_new( double , data->len );
-    //   data->old_height    = eh_new( double , data->len );
+        eh_grid_destroy(data->last_load, TRUE);
+        eh_grid_destroy(data->last_dw_iso, TRUE);
 
-    //   fread( data->old_thickness , sizeof(double) , data->len , fp );
-    //   fread( data->old_height    , sizeof(double) , data->len , fp );
+        data->last_load      = last_load;
+        data->last_dw_iso    = last_dw_iso;
+        data->last_time      = last_time;
+        data->last_half_load = last_half_load;
+    }
 
     return TRUE;
 }
@@ -28,6 +28,7 @@
 #include <sed/sed_sedflux.h>
 #include <plume_types.h>
 #include <plumeinput.h>
+#include <plume_cache.h>
 #include "my_processes.h"
 
 #define LEFT 0
@@ -39,10 +40,6 @@ gboolean
 plume3d(Plume_inputs* plume_const, Plume_river river,
     int n_grains, Plume_sediment* sedload,
     Eh_dbl_grid* deposit, Plume_data* data);
-gboolean
-compare_river(Plume_river* r1, Plume_river* r2, int n_grains);
-int
-copy_river(Plume_river* r1, Plume_river* r2, int n_grains);
 
 gboolean
 init_plume_data(Sed_process proc, Sed_cube prof, GError** error);
@@ -105,6 +102,100 @@ run_plume(Sed_process proc, Sed_cube p)
     return info;
 }
 
+/* Create a NULL-terminated array of grids to hold the deposit rate of each
+   suspended grain size. */
+static Eh_dbl_grid*
+_plume_hypo_deposit_grid_new(Sed_cube prof, gint n_susp_grains)
+{
+    Eh_dbl_grid* g = eh_new(Eh_dbl_grid, n_susp_grains + 1);
+    gint n;
+
+    for (n = 0 ; n < n_susp_grains ; n++) {
+        eh_debug("Creating grid for grain type %d", n);
+
+        g[n] = eh_grid_new(double,
+                2 * sed_cube_n_x(prof),
+                2 * sed_cube_n_y(prof));
+
+        eh_debug("Setting x values");
+
+        if (sed_mode_is_3d())
+            eh_grid_set_x_lin(g[n],
+                - sed_cube_n_x(prof)*sed_cube_x_res(prof)
+                + sed_cube_x_res(prof)*.5,
+                sed_cube_x_res(prof));
+        else
+            eh_grid_set_x_lin(g[n],
+                -sed_cube_x_res(prof),
+                sed_cube_x_res(prof));
+
+        eh_debug("Setting y values");
+        eh_grid_set_y_lin(g[n],
+            - sed_cube_n_y(prof)*sed_cube_y_res(prof)
+            + sed_cube_y_res(prof)*.5,
+            sed_cube_y_res(prof));
+    }
+
+    g[n_susp_grains] = NULL;
+
+    return g;
+}
+
+static void
+_plume_hypo_deposit_grid_destroy(Eh_dbl_grid* g)
+{
+    if (g) {
+        Eh_dbl_grid* d;
+
+        for (d = g ; *d ; d++) {
+            eh_grid_destroy(*d, TRUE);
+        }
+
+        eh_free(g);
+    }
+}
+
+/* Everything that the plume deposit depends on: the river, the ocean, the
+   suspended grains, and the grid that the deposit is put on. */
+static double*
+_plume_hypo_cache_key(const Plume_river* r, const Plume_inputs* c,
+    const Plume_sediment* sed, gint n_grains, Sed_cube prof, gint* len)
+{
+    double* key = eh_new(double, 15 + 5 * n_grains);
+    gint i = 0;
+    gint n;
+
+    key[i++] = r->Q;
+    key[i++] = r->u0;
+    key[i++] = r->b0;
+    key[i++] = r->d0;
+    key[i++] = r->rdirection;
+    key[i++] = r->rma;
+
+    key[i++] = c->current_velocity;
+    key[i++] = c->ocean_concentration;
+    key[i++] = c->plume_width;
+    key[i++] = c->ndx;
+    key[i++] = c->ndy;
+
+    for (n = 0 ; n < n_grains ; n++) {
+        key[i++] = r->Cs[n];
+        key[i++] = sed[n].lambda;
+        key[i++] = sed[n].rho;
+        key[i++] = sed[n].grainsize;
+        key[i++] = sed[n].diff_coef;
+    }
+
+    key[i++] = sed_cube_n_x(prof);
+    key[i++] = sed_cube_n_y(prof);
+    key[i++] = sed_cube_x_res(prof);
+    key[i++] = sed_cube_y_res(prof);
+
+    *len = i;
+
+    return key;
+}
+
 Sed_process_info
 run_plume_hypo(Sed_process proc, Sed_cube prof)
 {
@@ -151,34 +242,11 @@ run_plume_hypo(Sed_process proc, Sed_cube prof)
         Sed_riv       this_river;
         Plume_river   river_data;
         Plume_inputs  plume_const;
-        Eh_dbl_grid*  plume_deposit_grid = eh_new(Eh_dbl_grid, n_susp_grains);
+        Eh_dbl_grid*  plume_deposit_grid;
+        gboolean      deposit_is_cached;
         Sed_cell_grid in_suspension;
-
-        for (n = 0 ; n < n_susp_grains ; n++) {
-            eh_debug("Creating grid for grain type %d", n);
-
-            plume_deposit_grid[n] = eh_grid_new(double,
-                    2 * sed_cube_n_x(prof),
-                    2 * sed_cube_n_y(prof));
-
-            eh_debug("Setting x values");
-
-            if (sed_mode_is_3d())
-                eh_grid_set_x_lin(plume_deposit_grid[n],
-                    - sed_cube_n_x(prof)*sed_cube_x_res(prof)
-                    + sed_cube_x_res(prof)*.5,
-                    sed_cube_x_res(prof));
-            else
-                eh_grid_set_x_lin(plume_deposit_grid[n],
-                    -sed_cube_x_res(prof),
-                    sed_cube_x_res(prof));
-
-            eh_debug("Setting y values");
-            eh_grid_set_y_lin(plume_deposit_grid[n],
-                - sed_cube_n_y(prof)*sed_cube_y_res(prof)
-                + sed_cube_y_res(prof)*.5,
-                sed_cube_y_res(prof));
-        }
+        double*       key;
+        gint          key_len;
 
         this_river = (Sed_riv)sed_process_use(proc, PLUME_HYDRO_DATA);
         hydro_data = sed_river_hydro(this_river);
@@ -246,18 +314,40 @@ run_plume_hypo(Sed_process proc, Sed_cube prof)
 
         in_suspension = sed_cube_in_suspension(prof, this_river);
 
-        // compare this river with the river at the last time step.  if they are
-        // the same, then we don't have to run the plume again.
-        if (compare_river(&river_data,
-                &data->last_river_data,
-                n_susp_grains)) {
-            sed_cell_grid_copy_data(data->deposit_grid, data->last_deposit_grid);
-        } else if (plume3d(&plume_const,
-                river_data,
-                n_susp_grains,
-                sediment_data,
-                plume_deposit_grid,
-                data->plume_data)) {
+        key = _plume_hypo_cache_key(&river_data, &plume_const, sediment_data,
+                n_susp_grains, prof, &key_len);
+
+        // If a plume like this one has been run before, its deposit is in the
+        // cache.  Otherwise, run the plume and remember its deposit.
+        plume_deposit_grid = plume_cache_lookup(data->cache, key, key_len);
+        deposit_is_cached  = (plume_deposit_grid != NULL);
+
+        if (!plume_deposit_grid) {
+            SED_PROFILE_BEGIN("grid build");
+
+            plume_deposit_grid = _plume_hypo_deposit_grid_new(prof, n_susp_grains);
+
+            if (plume3d(&plume_const,
+                    river_data,
+                    n_susp_grains,
+                    sediment_data,
+                    plume_deposit_grid,
+                    data->plume_data)) {
+                deposit_is_cached = plume_cache_insert(data->cache, key, key_len,
+                        plume_deposit_grid);
+            } else {
+                _plume_hypo_deposit_grid_destroy(plume_deposit_grid);
+                plume_deposit_grid = NULL;
+            }
+
+            SED_PROFILE_END();
+        }
+
+        eh_free(key);
+
+        SED_PROFILE_BEGIN("deposit");
+
+        if (plume_deposit_grid) {
             double*    deposit_rate;
             double**   plume_deposit;
             Sed_cell** deposit = sed_cell_grid_data(data->deposit_grid);
@@ -287,13 +377,6 @@ run_plume_hypo(Sed_process proc, Sed_cube prof)
             sed_cell_grid_clear(data->deposit_grid);
         }
 
-        eh_debug("Save the current plume");
-        sed_cell_grid_copy_data(data->last_deposit_grid,
-            data->deposit_grid);
-        copy_river(&data->last_river_data,
-            &river_data,
-            n_susp_grains);
-
         info.mass_added = sed_hydro_suspended_load(hydro_data);
 
         // calculate the inital mass of sediment in suspension.
@@ -318,6 +401,8 @@ run_plume_hypo(Sed_process proc, Sed_cube prof)
             sed_cell_grid_add(in_suspension, data->deposit_grid);
             eh_grid_reindex(in_suspension, -sed_cube_n_x(prof), -sed_cube_n_y(prof));
 
+            SED_PROFILE_END();
+
             eh_debug("Calculate the final mass of sediment in suspension.");
             final_mass = sed_cell_grid_mass(in_suspension)
                 * sed_cube_x_res(prof)
@@ -353,12 +438,10 @@ run_plume_hypo(Sed_process proc, Sed_cube prof)
 
         eh_debug("Free temporary grids");
 
-        for (n = 0 ; n < n_susp_grains ; n++) {
-            eh_grid_destroy(plume_deposit_grid[n], TRUE);
+        if (!deposit_is_cached) {
+            _plume_hypo_deposit_grid_destroy(plume_deposit_grid);
         }
 
-        eh_free(plume_deposit_grid);
-
         eh_free(river_data.Cs);
 
         hydro_data = sed_hydro_destroy(hydro_data);
@@ -433,6 +516,8 @@ init_plume_data(Sed_process proc, Sed_cube prof, GError** error)
 #define HYPO_KEY_WIDTH            "maximum plume width"
 #define HYPO_KEY_X_SHORE_NODES    "number of grid nodes in cross-shore"
 #define HYPO_KEY_RIVER_NODES      "number of grid nodes in river mouth"
+#define HYPO_KEY_CACHE_SIZE       "plume cache size (MB)"
+#define HYPO_KEY_CACHE_TOL        "plume cache tolerance"
 
 static const gchar* hypo_3d_req_labels[] = {
     HYPO_KEY_CONCENTRATION,
@@ -465,10 +550,9 @@ init_plume_hypo(Sed_process p, Eh_symbol_table tab, GError** error)
     data->deposit            = NULL;
     data->last_deposit       = NULL;
     data->plume_deposit      = NULL;
-    data->last_river_data.Cs = NULL;
     data->plume_data         = NULL;
     data->deposit_grid       = NULL;
-    data->last_deposit_grid  = NULL;
+    data->cache              = NULL;
 
     if (sed_mode_is_3d()) {
         eh_symbol_table_require_labels(tab, hypo_3d_req_labels, &tmp_err);
@@ -491,10 +575,27 @@ init_plume_hypo(Sed_process p, Eh_symbol_table tab, GError** error)
 
         data->plume_width *= 1000.;
 
+        // Deposits of recent plumes are kept so that floods that are like
+        // earlier ones don't have to be run again.
+        if (eh_symbol_table_has_label(tab, HYPO_KEY_CACHE_SIZE)) {
+            data->cache_size = eh_symbol_table_dbl_value(tab, HYPO_KEY_CACHE_SIZE);
+        } else {
+            data->cache_size = 64.;
+        }
+
+        if (eh_symbol_table_has_label(tab, HYPO_KEY_CACHE_TOL)) {
+            data->cache_tolerance = eh_symbol_table_dbl_value(tab, HYPO_KEY_CACHE_TOL);
+        } else {
+            data->cache_tolerance = 0.;
+        }
+
         eh_check_to_s(data->ocean_concentration >= 0., "Ocean concentration positive", &err_s);
         eh_check_to_s(data->plume_width >= 0., "Plume width positive", &err_s);
         eh_check_to_s(data->ndx > 0., "Plume ndx positive integer", &err_s);
         eh_check_to_s(data->ndy > 0., "Plume ndy positive integer", &err_s);
+        eh_check_to_s(data->cache_size >= 0., "Plume cache size not negative", &err_s);
+        eh_check_to_s(data->cache_tolerance >= 0., "Plume cache tolerance not negative",
+            &err_s);
 
         if (err_s) {
             eh_set_error_strv(&tmp_err, SEDFLUX_ERROR, SEDFLUX_ERROR_BAD_PARAM, err_s);
@@ -515,16 +616,13 @@ init_plume_hypo_data(Sed_process proc, Sed_cube prof, GError** error)
     Plume_hypo_t* data = (Plume_hypo_t*)sed_process_user_data(proc);
 
     if (data) {
-        data->last_deposit_grid = sed_cell_grid_new(2 * sed_cube_n_x(prof),
-                2 * sed_cube_n_y(prof));
-        data->deposit_grid      = sed_cell_grid_new(2 * sed_cube_n_x(prof),
+        data->deposit_grid = sed_cell_grid_new(2 * sed_cube_n_x(prof),
                 2 * sed_cube_n_y(prof));
 
         sed_cell_grid_init(data->deposit_grid, sed_sediment_env_n_types());
-        sed_cell_grid_init(data->last_deposit_grid, sed_sediment_env_n_types());
 
-        memset(&data->last_river_data, 0, sizeof(Plume_river));
-        data->last_river_data.Cs = eh_new0(double, sed_sediment_env_n_types() - 1);
+        data->cache = plume_cache_new((gsize)(data->cache_size * 1024 * 1024),
+                data->cache_tolerance);
 
         data->plume_data = eh_new(Plume_data, 1);
         plume_data_init(data->plume_data);
@@ -541,12 +639,19 @@ destroy_plume_hypo(Sed_process p)
 
         if (data) {
             sed_cell_grid_free(data->deposit_grid);
-            sed_cell_grid_free(data->last_deposit_grid);
-
             eh_grid_destroy(data->deposit_grid, TRUE);
-            eh_grid_destroy(data->last_deposit_grid, TRUE);
 
-            eh_free(data->last_river_data.Cs);
+            if (data->cache) {
+                eh_message("plume cache hits      : %d",
+                    plume_cache_n_hits(data->cache));
+                eh_message("plume cache misses    : %d",
+                    plume_cache_n_misses(data->cache));
+                eh_message("plume cache size (MB) : %.1f",
+                    plume_cache_n_bytes(data->cache) / 1048576.);
+            }
+
+            data->cache = plume_cache_destroy(data->cache);
+
             destroy_plume_data(data->plume_data);
 
             eh_input_val_destroy(data->current_velocity);
@@ -574,52 +679,4 @@ dump_plume_data(gpointer ptr, FILE* fp)
     return TRUE;
 }
 
-gboolean
-compare_river(Plume_river* r1, Plume_river* r2, int n_grains)
-{
-    int n;
-    double load1 = 0., load2 = 0.;
-
-    for (n = 0; n < n_grains; n++) {
-        load1 += r1->Cs[n];
-        load2 += r2->Cs[n];
-    }
-
-    load1 *= r1->Q;
-    load2 *= r2->Q;
-
-    if (eh_compare_dbl(load2, load2, 0.1)) {
-        return TRUE;
-    }
-
-    for (n = 0; n < n_grains; n++)
-        if (r1->Cs[n] != r2->Cs[n]) {
-            return FALSE;
-        }
-
-    if (r1->Q == r2->Q &&
-        r1->u0 == r2->u0 &&
-        r1->b0 == r2->b0 &&
-        r1->d0 == r2->d0 &&
-        r1->rdirection == r2->rdirection &&
-        r1->rma == r2->rma) {
-        return TRUE;
-    }
-
-    return FALSE;
-}
-
-int
-copy_river(Plume_river* r1, Plume_river* r2, int n_grains)
-{
-    memcpy(r1->Cs, r2->Cs, sizeof(double)*n_grains);
-    r1->Q = r2->Q;
-    r1->u0 = r2->u0;
-    r1->b0 = r2->b0;
-    r1->d0 = r2->d0;
-    r1->rdirection = r2->rdirection;
-    r1->rma = r2->rma;
-    return 0;
-}
-
 
@@ -40,7 +40,7 @@ run_quake(Sed_process proc, Sed_cube prof)
     Sed_process_info info = SED_EMPTY_INFO;
     double a, acceleration, time_step;
 
-    if (sed_process_run_count(proc) == 0) {
+    if (sed_process_run_count(proc) == 0 || !data->rand) {
         init_quake_data(proc, prof, NULL);
     }
 
@@ -124,7 +124,11 @@ init_quake_data(Sed_process proc, Sed_cube prof, GError** error)
             data->rand = g_rand_new();
         }
 
-        data->last_time = sed_cube_age_in_years(prof);
+        // After a restart, the time of the last earthquake is that of the
+        // checkpoint (see load_quake_data).
+        if (sed_process_run_count(proc) == 0) {
+            data->last_time = sed_cube_age_in_years(prof);
+        }
     }
 
     return TRUE;
@@ -146,3 +150,29 @@ destroy_quake(Sed_process p)
     return TRUE;
 }
 
+/* Only the time of the last earthquake is saved.  The random number generator
+   starts again from its seed after a restart. */
+gboolean
+dump_quake_data(gpointer ptr, FILE* fp)
+{
+    Quake_t* data = (Quake_t*)ptr;
+
+    fwrite(&data->last_time, sizeof(double), 1, fp);
+
+    return TRUE;
+}
+
+gboolean
+load_quake_data(gpointer ptr, FILE* fp)
+{
+    Quake_t* data = (Quake_t*)ptr;
+    double last_time;
+
+    if (fread(&last_time, sizeof(double), 1, fp) != 1) {
+        return FALSE;
+    }
+
+    data->last_time = last_time;
+
+    return TRUE;
+}
@@ -27,11 +27,14 @@
 #include <string.h>
 #include <utils/utils.h>
 #include <sed/sed_sedflux.h>
+#include <hydrotrend/hydrotrend_api.h>
 #include "my_processes.h"
 #include "sedflux.h"
 
 gboolean
 init_river_data(Sed_process proc, Sed_cube prof, GError** error);
+static void
+_river_set_dry(Sed_cube prof, gpointer river_id);
 
 Sed_process_info
 run_river(Sed_process proc, Sed_cube prof)
@@ -46,6 +49,8 @@ run_river(Sed_process proc, Sed_cube prof)
 
     if (data->type == SED_HYDRO_EXTERNAL) {
         river_data = sed_hydro_dup(sed_cube_external_river(prof));
+    } else if (data->is_dry) {
+        river_data = NULL;
     } else {
         river_data = sed_hydro_file_read_record(data->fp_river);
     }
@@ -161,6 +166,13 @@ run_river(Sed_process proc, Sed_cube prof)
         //      hydro_destroy_hydro_record( river_data );
         //      river_data = NULL;
 
+    } else if (data->type == SED_HYDRO_STREAM) {
+        if (!data->is_dry) {
+            eh_warning("River model has no more records; the river is now dry");
+            data->is_dry = TRUE;
+        }
+
+        _river_set_dry(prof, data->this_river);
     } else {
         eh_require_not_reached();
     }
@@ -170,9 +182,34 @@ run_river(Sed_process proc, Sed_cube prof)
     return info;
 }
 
+/* A river whose model has run out of records keeps its last flow but
+   carries no more sediment to the basin. */
+static void
+_river_set_dry(Sed_cube prof, gpointer river_id)
+{
+    Sed_hydro h = sed_cube_river_hydro(prof, river_id);
+
+    if (h) {
+        gint n;
+
+        h = sed_hydro_dup(h);
+
+        for (n = 0 ; n < sed_hydro_size(h) ; n++) {
+            sed_hydro_set_nth_concentration(h, n, 0.);
+        }
+
+        sed_hydro_set_bedload(h, 0.);
+
+        sed_cube_river_set_hydro(prof, river_id, h);
+
+        sed_hydro_destroy(h);
+    }
+}
+
 #define RIVER_KEY_FILE_TYPE  "river values"
 #define RIVER_KEY_RIVER_FILE "river file"
 #define RIVER_KEY_RIVER_NAME "river name"
+#define RIVER_KEY_PREFETCH   "river prefetch buffers"
 
 static const gchar* river_req_labels[] = {
     RIVER_KEY_FILE_TYPE,
@@ -195,6 +232,9 @@ init_river(Sed_process p, Eh_symbol_table tab, GError** error)
     data->total_mass_from_river = 0;
     data->fp_river              = NULL;
     data->this_river            = NULL;
+    data->model                 = NULL;
+    data->model_thread          = NULL;
+    data->is_dry                = FALSE;
 
     if (eh_symbol_table_require_labels(tab, river_req_labels, &tmp_err)) {
         gchar* prefix = sed_process_prefix(p);
@@ -220,9 +260,24 @@ init_river(Sed_process p, Eh_symbol_table tab, GError** error)
         data->location     = 0;
         data->buffer_is_on = FALSE;
 
+        // Buffered rivers are read and eventized in the background, this
+        // many buffers ahead of the one in use (0 reads them as needed).
+        if (eh_symbol_table_has_label(tab, RIVER_KEY_PREFETCH)) {
+            data->n_prefetch = eh_symbol_table_int_value(tab, RIVER_KEY_PREFETCH);
+        } else {
+            data->n_prefetch = 2;
+        }
+
         data->type = sed_hydro_str_to_type(str);
 
-        if (data->type != SED_HYDRO_EXTERNAL) {
+        if (data->type == SED_HYDRO_STREAM) {
+            // the river file is the prefix of the HydroTrend input files.
+            gchar* input = g_strconcat(data->filename, ".IN", NULL);
+
+            eh_touch_file(input, O_RDONLY, &tmp_err);
+
+            eh_free(input);
+        } else if (data->type != SED_HYDRO_EXTERNAL) {
             if ((g_ascii_strcasecmp(str, "EVENT") == 0
                     || g_ascii_strcasecmp(str, "BUFFER") == 0)
                 && data->type == SED_HYDRO_HYDROTREND) {
@@ -231,7 +286,7 @@ init_river(Sed_process p, Eh_symbol_table tab, GError** error)
 
             if (data->type == SED_HYDRO_UNKNOWN)
                 g_set_error(&tmp_err, SEDFLUX_ERROR, SEDFLUX_ERROR_BAD_PARAM,
-                    "Invalid river type key (season, hydrotrend, or event): %s", str);
+                    "Invalid river type key (season, hydrotrend, event, or model): %s", str);
 
             if (!tmp_err) {
                 eh_touch_file(data->filename, O_RDONLY, &tmp_err);
@@ -266,6 +321,10 @@ init_river(Sed_process p, Eh_symbol_table tab, GError** error)
                 }
             }
         }
+
+        if (!tmp_err && data->n_prefetch < 0)
+            g_set_error(&tmp_err, SEDFLUX_ERROR, SEDFLUX_ERROR_BAD_PARAM,
+                "Number of river prefetch buffers is negative: %d", data->n_prefetch);
     }
 
     if (tmp_err) {
@@ -276,6 +335,110 @@ init_river(Sed_process p, Eh_symbol_table tab, GError** error)
     return is_ok;
 }
 
+#define RIVER_MODEL_QUEUE_LEN (730)
+
+typedef struct {
+    Hydrotrend_state* s;
+    Sed_hydro_file    fp;
+    gint              n_grains;
+}
+River_model_t;
+
+/* Convert a record of the river as a whole (outlet 0) to a Sed_hydro and
+   push it onto the river stream.  Stop the model if the river is gone.
+*/
+static int
+_river_model_push_record(const Hydrotrend_record* r, void* user_data)
+{
+    River_model_t* m = (River_model_t*)user_data;
+
+    if (r->outlet == 0) {
+        Sed_hydro rec = sed_hydro_new(m->n_grains);
+        gint i;
+
+        sed_hydro_set_velocity(rec, r->velocity);
+        sed_hydro_set_width(rec, r->width);
+        sed_hydro_set_depth(rec, r->depth);
+        sed_hydro_set_bedload(rec, r->bedload);
+
+        for (i = 0 ; i < m->n_grains ; i++) {
+            sed_hydro_set_nth_concentration(rec, i, i < r->n_grains ? r->conc[i] : 0.);
+        }
+
+        if (!sed_hydro_file_push_record(m->fp, rec)) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static gpointer
+_river_model_run(gpointer user_data)
+{
+    River_model_t* m = (River_model_t*)user_data;
+
+    if (hydrotrend_run(m->s) != 0) {
+        eh_warning("HydroTrend run stopped before it was done");
+    }
+
+    sed_hydro_file_close_stream(m->fp);
+
+    return NULL;
+}
+
+/* Start a HydroTrend run that streams its records to the river.  The river
+   file is the prefix of the HydroTrend input files.
+*/
+static Sed_hydro_file
+_river_model_new(River_t* data, GError** error)
+{
+    River_model_t* m = eh_new(River_model_t, 1);
+    GError* tmp_err = NULL;
+
+    m->n_grains = sed_sediment_env_n_types() - 1;
+    m->fp       = sed_hydro_file_new_stream(m->n_grains, RIVER_MODEL_QUEUE_LEN,
+            data->buffer_is_on);
+    m->s        = hydrotrend_state_new();
+
+    hydrotrend_state_set_name(m->s, data->river_name);
+    hydrotrend_state_set_input(m->s, data->filename);
+    hydrotrend_state_set_record_func(m->s, &_river_model_push_record, m);
+
+    data->model        = m;
+    data->model_thread = g_thread_create(_river_model_run, m, TRUE, &tmp_err);
+
+    if (tmp_err) {
+        g_propagate_error(error, tmp_err);
+        data->model_thread = NULL;
+        sed_hydro_file_close_stream(m->fp);
+    }
+
+    return m->fp;
+}
+
+static void
+_river_model_destroy(River_t* data)
+{
+    River_model_t* m = (River_model_t*)data->model;
+
+    if (m) {
+        // destroying the stream stops the model, which then closes it.
+        sed_hydro_file_destroy(m->fp);
+
+        if (data->model_thread) {
+            g_thread_join(data->model_thread);
+        }
+
+        hydrotrend_state_destroy(m->s);
+        eh_free(m);
+
+        data->fp_river     = NULL;
+        data->model        = NULL;
+        data->model_thread = NULL;
+    }
+}
+
 gboolean
 init_river_data(Sed_process proc, Sed_cube prof, GError** error)
 {
@@ -285,8 +448,19 @@ init_river_data(Sed_process proc, Sed_cube prof, GError** error)
         Sed_riv new_river;
         data->total_mass            = 0;
         data->total_mass_from_river = 0;
-        data->fp_river              = sed_hydro_file_new(data->filename, data->type,
-                data->buffer_is_on, TRUE, error);
+        data->is_dry                = FALSE;
+
+        if (data->type == SED_HYDRO_STREAM) {
+            data->fp_river = _river_model_new(data, error);
+        } else {
+            data->fp_river = sed_hydro_file_new(data->filename, data->type,
+                    data->buffer_is_on, TRUE, error);
+        }
+
+        if (data->fp_river && data->buffer_is_on) {
+            sed_hydro_file_set_prefetch(data->fp_river, data->n_prefetch);
+        }
+
         data->prof = prof;
 
         //data->this_river            = sed_river_new     ( data->river_name );
@@ -310,7 +484,20 @@ destroy_river(Sed_process p)
 
         if (data) {
             sed_cube_remove_trunk(data->prof, data->this_river);
-            sed_hydro_file_destroy(data->fp_river);
+
+            if (data->buffer_is_on) {
+                eh_debug("River buffer fills: %d, waits: %d (%f s)",
+                    sed_hydro_file_n_fills(data->fp_river),
+                    sed_hydro_file_n_waits(data->fp_river),
+                    sed_hydro_file_wait_time(data->fp_river));
+            }
+
+            if (data->model) {
+                _river_model_destroy(data);
+            } else {
+                sed_hydro_file_destroy(data->fp_river);
+            }
+
             eh_free(data->filename);
             eh_free(data->river_name);
             eh_free(data);
@@ -78,7 +78,7 @@ run_storm(Sed_process proc, Sed_cube prof)
     double           time_step;
     double           start_time;
 
-    if (sed_process_run_count(proc) == 0) {
+    if (sed_process_run_count(proc) == 0 || !data->rand) {
         init_storm_data(proc, prof, NULL);
     }
 
@@ -122,12 +122,13 @@ run_storm(Sed_process proc, Sed_cube prof)
 
             eh_message("time        : %f", this_time);
             eh_message("time step   : %f", sed_ocean_storm_duration(this_storm));
-            eh_message("storm number: %d", i++);
+            eh_message("storm number: %d", i);
             eh_message("total number: %d", n);
             eh_message("wave height : %f", sed_ocean_storm_wave_height(this_storm));
             eh_message("wave period : %f", sed_ocean_storm_wave_period(this_storm));
             eh_message("wave length : %f", sed_ocean_storm_wave_length(this_storm));
 
+            i++;
             this_time  += sed_ocean_storm_duration(this_storm) * S_YEARS_PER_DAY;
 
         }
@@ -238,7 +239,11 @@ init_storm_data(Sed_process proc, Sed_cube prof, GError** error)
             data->rand = g_rand_new();
         }
 
-        data->last_time = sed_cube_age_in_years(prof);
+        // After a restart, the time of the last storm is that of the
+        // checkpoint (see load_storm_data).
+        if (sed_process_run_count(proc) == 0) {
+            data->last_time = sed_cube_age_in_years(prof);
+        }
     }
 
     return TRUE;
@@ -864,3 +869,29 @@ get_wave_height_from_wind(double wind_speed_in_mps)
     return .004449 * pow(wind_speed_in_mps, 2.5);
 }
 
+/* Only the time of the last storm is saved.  The random number generator
+   starts again from its seed after a restart. */
+gboolean
+dump_storm_data(gpointer ptr, FILE* fp)
+{
+    Storm_t* data = (Storm_t*)ptr;
+
+    fwrite(&data->last_time, sizeof(double), 1, fp);
+
+    return TRUE;
+}
+
+gboolean
+load_storm_data(gpointer ptr, FILE* fp)
+{
+    Storm_t* data = (Storm_t*)ptr;
+    double last_time;
+
+    if (fread(&last_time, sizeof(double), 1, fp) != 1) {
+        return FALSE;
+    }
+
+    data->last_time = last_time;
+
+    return TRUE;
+}
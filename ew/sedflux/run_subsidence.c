@@ -54,7 +54,7 @@ run_subsidence(Sed_process proc, Sed_cube prof)
     double upper_edge, lower_edge;
     double time_step, total_time = 0., total_subsidence = 0.;
 
-    if (sed_process_run_count(proc) == 0) {
+    if (sed_process_run_count(proc) == 0 || !data->subsidence_seq) {
         init_subsidence_data(proc, prof, NULL);
     }
 
@@ -200,7 +200,11 @@ init_subsidence_data(Sed_process proc, Sed_cube prof, GError** error)
         GError* tmp_err = NULL;
         double* y       = sed_cube_y(prof, NULL);
 
-        data->last_year = sed_cube_age_in_years(prof);
+        // After a restart, the time of the last subsidence is that of the
+        // checkpoint (see load_subsidence_data).
+        if (sed_process_run_count(proc) == 0) {
+            data->last_year = sed_cube_age_in_years(prof);
+        }
 
         if (sed_mode_is_3d())
             data->subsidence_seq  = sed_get_floor_sequence_3(
@@ -251,21 +255,14 @@ destroy_subsidence(Sed_process p)
     return TRUE;
 }
 
+/* Only the time of the last subsidence is saved.  The subsidence curve is
+   read again from its file on the first run after a restart. */
 gboolean
 dump_subsidence_data(gpointer ptr, FILE* fp)
 {
     Subsidence_t* data = (Subsidence_t*)ptr;
-    guint len;
-
-    len = strlen(data->filename) + 1;
-    fwrite(&len, sizeof(guint), 1, fp);
-    fwrite(data->filename, sizeof(char), len, fp);
-
-    fwrite(&(data->last_year), sizeof(double), 1, fp);
 
-    len = data->tectonic_curve->len;
-    fwrite(&len, sizeof(guint), 1, fp);
-    fwrite(data->tectonic_curve->data, sizeof(double), len, fp);
+    fwrite(&data->last_year, sizeof(double), 1, fp);
 
     return TRUE;
 }
@@ -274,20 +271,13 @@ gboolean
 load_subsidence_data(gpointer ptr, FILE* fp)
 {
     Subsidence_t* data = (Subsidence_t*)ptr;
-    guint len;
-    double* tectonic_data;
+    double last_year;
 
-    fread(&len, sizeof(guint), 1, fp);
-    fread(data->filename, sizeof(char), len, fp);
-
-    fread(&(data->last_year), sizeof(double), 1, fp);
-
-    fread(&len, sizeof(guint), 1, fp);
-    tectonic_data = eh_new(double, len);
-    fread(tectonic_data, sizeof(double), len, fp);
+    if (fread(&last_year, sizeof(double), 1, fp) != 1) {
+        return FALSE;
+    }
 
-    data->tectonic_curve = g_array_new(FALSE, FALSE, sizeof(double));
-    g_array_append_vals(data->tectonic_curve, tectonic_data, len);
+    data->last_year = last_year;
 
     return TRUE;
 }
@@ -88,7 +88,7 @@ run_xshore(Sed_process proc, Sed_cube prof)
         double storm_wave;
         double max_current = eh_input_val_eval(data->xshore_current,
                 current_time);
-        mass_before = sed_cube_mass(prof);
+        mass_before = sed_cube_ledger_mass(prof);
 
         this_storm = (Sed_ocean_storm)this_link->data;
 
@@ -121,10 +121,10 @@ run_xshore(Sed_process proc, Sed_cube prof)
 
         if (TRUE) {
             if (x_info.added) {
-                mass_added = sed_cell_mass(x_info.added)
+                mass_added = sed_cell_sediment_mass(x_info.added)
                     * sed_cube_x_res(prof)
                     * sed_cube_y_res(prof);
-                mass_lost  = sed_cell_mass(x_info.lost)
+                mass_lost  = sed_cell_sediment_mass(x_info.lost)
                     * sed_cube_x_res(prof)
                     * sed_cube_y_res(prof);
                 //            sed_cell_resize( info.added , sed_cell_thickness(info.added)*2 );
@@ -142,7 +142,7 @@ run_xshore(Sed_process proc, Sed_cube prof)
 
             info.mass_added = mass_added;
             info.mass_lost  = mass_lost;
-            mass_after = sed_cube_mass(prof);
+            mass_after = sed_cube_ledger_mass(prof);
 
             eh_message("time step (days)                : %f",
                 sed_ocean_storm_duration(this_storm));
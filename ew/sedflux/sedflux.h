@@ -21,6 +21,14 @@ typedef struct {
     gint     verbosity;
     gboolean verbose;
     gboolean version;
+    gboolean contiguous;
+    gboolean cell_pool;
+    gboolean load_cache;
+    gint n_threads;
+    gint     n_output_threads;
+    gboolean log_thread;
+    gchar*   restart_file;
+    gchar*   profile_file;
     const char** active_procs;
 }
 Sedflux_param_st;
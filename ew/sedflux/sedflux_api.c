@@ -50,14 +50,54 @@ struct _Sedflux_state {
 
     // Keep track of these variables so that we can take time derivatives
     double* thickness; //< Sediment thickness at the last time state
+
+    // Surface values that are handed out by pointer
+    GPtrArray* surface; //< Buffers of surface values, indexed by id
+    GHashTable* surface_ids; //< Ids of surface values, keyed by name
+    gint revision; //< Incremented whenever the cube changes
+
+    char* profile_file; //< Prefix of the profile output files (or NULL)
 };
 
+typedef struct {
+    Sed_measurement m;
+    gint mask;
+    double* data;
+    gint revision; //< Revision of the state when the buffer was filled
+    gboolean is_shared; //< The buffer has been handed out by pointer
+}
+Sedflux_surface_value;
+
+static void
+_sedflux_measure_surface(Sedflux_state* state, Sed_measurement m, gint mask,
+    double* dest);
+
+/* Processes with dump and load functions keep their state through a
+   checkpoint.  Every other process starts again on its first run after a
+   restart, as if the run had just begun. Its data are set up again from the
+   restored cube and its input file. For these processes that means,
+     river:             hydrograph files are read again from their first
+                        record
+     avulsion:          the random walk of the river angle starts again from
+                        its seed
+     measuring station: output files are opened again
+     plume:             the plume cache is empty
+     failure:           the failure profile is built from the restored cube
+   For earthquakes and storms only the time of the last event is saved.
+   Their random number generators also start again from their seeds.
+*/
 static Sed_process_init_t my_proc_defs[] = {
     { "constants", init_constants, run_constants, destroy_constants },
-    { "earthquake", init_quake, run_quake, destroy_quake     },
+    {
+        "earthquake", init_quake, run_quake, destroy_quake,
+        dump_quake_data, load_quake_data
+    },
     { "tide", init_tide, run_tide, destroy_tide      },
     { "sea level", init_sea_level, run_sea_level, destroy_sea_level },
-    { "storms", init_storm, run_storm, destroy_storm     },
+    {
+        "storms", init_storm, run_storm, destroy_storm,
+        dump_storm_data, load_storm_data
+    },
     { "river", init_river, run_river, destroy_river     },
     { "erosion", init_erosion, run_erosion, destroy_erosion   },
     { "avulsion", init_avulsion, run_avulsion, destroy_avulsion  },
@@ -74,13 +114,25 @@ static Sed_process_init_t my_proc_defs[] = {
     { "bioturbation", bio_init, bio_run, bio_destroy },
     { "compaction", NULL, run_compaction, NULL                },
     { "flow", init_flow, run_flow, destroy_flow        },
-    { "isostasy", init_isostasy, run_isostasy, destroy_isostasy    },
-    { "subsidence", init_subsidence, run_subsidence, destroy_subsidence  },
-    { "data dump", init_data_dump, run_data_dump, destroy_data_dump   },
+    {
+        "isostasy", init_isostasy, run_isostasy, destroy_isostasy,
+        dump_isostasy_data, load_isostasy_data
+    },
+    {
+        "subsidence", init_subsidence, run_subsidence, destroy_subsidence,
+        dump_subsidence_data, load_subsidence_data
+    },
+    {
+        "data dump", init_data_dump, run_data_dump, destroy_data_dump,
+        dump_data_dump_data, load_data_dump_data
+    },
     { "failure", init_failure, run_failure, destroy_failure     },
     { "measuring station", init_met_station, run_met_station, destroy_met_station },
     { "bbl", init_bbl, run_bbl, destroy_bbl         },
-    { "cpr", init_cpr, run_cpr, destroy_cpr         },
+    {
+        "cpr", init_cpr, run_cpr, destroy_cpr,
+        dump_cpr_data, load_cpr_data
+    },
 
     { "turbidity current", init_inflow, run_turbidity_inflow, destroy_inflow     },
 
@@ -225,6 +277,12 @@ sedflux_new(void)
         state->is_2d = TRUE;
 
         state->thickness = NULL;
+
+        state->surface = g_ptr_array_new();
+        state->surface_ids = g_hash_table_new_full(&g_str_hash, &g_str_equal,
+                &g_free, NULL);
+        state->revision = 0;
+        state->profile_file = NULL;
     }
 
     return state;
@@ -458,6 +516,26 @@ sedflux_is_2d(Sedflux_state* self)
     return self->is_2d;
 }
 
+/* Refill the surface buffers that have been handed out by pointer, so that
+   a caller that holds on to a pointer sees the current values.  Buffers
+   that have not been handed out are refilled when they are next asked for.
+*/
+static void
+_sedflux_update_shared_surface_values(Sedflux_state* state)
+{
+    guint i;
+
+    for (i = 0; i < state->surface->len; i++) {
+        Sedflux_surface_value* v = (Sedflux_surface_value*)g_ptr_array_index(
+                state->surface, i);
+
+        if (v->is_shared && v->revision != state->revision) {
+            _sedflux_measure_surface(state, v->m, v->mask, v->data);
+            v->revision = state->revision;
+        }
+    }
+}
+
 void
 _sedflux_save_time_variables(Sedflux_state* state)
 {
@@ -472,12 +550,49 @@ _sedflux_save_time_variables(Sedflux_state* state)
 
         state->thickness = sedflux_get_value(state, "Thickness", dimen);
     }
+
+    state->revision++;
+    _sedflux_update_shared_surface_values(state);
+}
+
+/* Mark surface buffers as out of date after the cube is changed outside of
+   a time step.
+*/
+static void
+_sedflux_surface_changed(Sedflux_state* state)
+{
+    state->revision++;
+    _sedflux_update_shared_surface_values(state);
+}
+
+/* Give the checkpoint processes of every epoch the epoch queue so that the
+   state of the processes is written along with the cube.  Checkpoints are
+   moved to the end of each process queue so that they are taken once the
+   rest of the time step has run, wherever they are in the input file.
+*/
+static void
+_sedflux_provide_epoch_queue(Sed_epoch_queue q)
+{
+    gssize i;
+
+    for (i = 0 ; i < sed_epoch_queue_length(q) ; i++) {
+        Sed_process_queue proc_q = sed_epoch_proc_queue(sed_epoch_queue_nth(q, i));
+        Sed_process obj;
+        gssize n;
+
+        sed_process_queue_move_to_end(proc_q, "cpr");
+
+        for (n = 0 ; (obj = sed_process_queue_find_nth_obj(proc_q, "cpr", n)) ; n++) {
+            sed_process_provide(obj, SED_CHECKPOINT_EPOCH_QUEUE, q);
+        }
+    }
 }
 
 Sedflux_state*
 sedflux_initialize(const gint argc, const gchar* argv[])
 {
     Sedflux_state* state = NULL;
+    gchar* restart_file = NULL;
 
     eh_require(argc > 1);
     eh_require(argv && argv[0]);
@@ -500,6 +615,38 @@ sedflux_initialize(const gint argc, const gchar* argv[])
             sedflux_set_description(state, p->run_desc);
             sedflux_set_dimension(state, p->mode_2d);
 
+            if (p->contiguous) {
+                sed_column_set_default_storage(SED_COLUMN_STORAGE_CONTIGUOUS);
+            }
+
+            if (p->cell_pool) {
+                sed_cell_pool_enable(TRUE);
+            }
+
+            if (p->load_cache) {
+                sed_column_set_load_cache(TRUE);
+            }
+
+            sed_cube_set_n_threads(p->n_threads);
+            sed_output_set_n_threads(p->n_output_threads);
+            eh_set_log_async(p->log_thread);
+
+            restart_file = p->restart_file;
+
+            if (p->profile_file) {
+                // The run moves to the working directory, so keep the path
+                // to the profile relative to where sedflux was started.
+                if (g_path_is_absolute(p->profile_file)) {
+                    state->profile_file = g_strdup(p->profile_file);
+                } else {
+                    gchar* cur_dir = g_get_current_dir();
+                    state->profile_file = g_build_filename(cur_dir, p->profile_file, NULL);
+                    eh_free(cur_dir);
+                }
+
+                sed_profile_enable(TRUE);
+            }
+
             /* Setup the signal handling */
             if (p->set_signals) {
                 sed_signal_set_action();
@@ -540,6 +687,27 @@ sedflux_initialize(const gint argc, const gchar* argv[])
                     NULL, &error);
             eh_exit_on_error(error, "%s: Error reading epoch file",
                 sedflux_init_file(state));
+
+            _sedflux_provide_epoch_queue(state->q);
+        }
+
+        if (restart_file) {
+            /* Replace the initial state with that of the checkpoint. */
+            Sed_checkpoint c;
+
+            eh_info("Restarting from %s...", restart_file);
+
+            c = sed_checkpoint_open(restart_file, &error);
+
+            if (c) {
+                sed_checkpoint_restore(c, state->p, state->q, &error);
+                sed_checkpoint_close(c);
+            }
+
+            eh_exit_on_error(error, "%s: Error restarting from checkpoint",
+                restart_file);
+
+            _sedflux_surface_changed(state);
         }
 
         _sedflux_save_time_variables(state);
@@ -996,12 +1164,38 @@ sedflux_get_value(Sedflux_state* state, const char* val_s, int dimen[3])
     return data;
 }
 
+static void
+_sedflux_measure_surface(Sedflux_state* state, Sed_measurement m, gint mask,
+    double* dest)
+{
+    const int len = sed_cube_size(state->p);
+    Eh_ind_2 sub;
+    gint i;
+
+    for (i = 0; i < len; ++i) {
+        sub = sed_cube_sub(state->p, i);
+        dest[i] = sed_measurement_make(m, state->p, sub.i, sub.j);
+    }
+
+    if (mask & MASK_LAND) {
+        for (i = 0; i < len; i++)
+            if (sed_cube_elevation(state->p, 0, i) > .1) {
+                dest[i] = -9999.;
+            }
+    }
+
+    if (mask & MASK_OCEAN) {
+        for (i = 0; i < len; i++)
+            if (sed_cube_elevation(state->p, 0, i) < -.1) {
+                dest[i] = -9999.;
+            }
+    }
+}
+
 double*
 sedflux_get_surface_value(Sedflux_state* state, const char* val_s, double* dest,
     gint mask)
 {
-    double* data = NULL;
-
     eh_return_val_if_fail(state, NULL);
     eh_return_val_if_fail(val_s, NULL);
     eh_return_val_if_fail(dest, NULL);
@@ -1010,48 +1204,100 @@ sedflux_get_surface_value(Sedflux_state* state, const char* val_s, double* dest,
         Sed_measurement m = sed_measurement_new(val_s);
 
         eh_require(m);
+        eh_require(state->p);
 
-        { /* Get values at all grid cells */
-            gint i;
-            const int len = sed_cube_size(state->p);
-            Eh_ind_2 sub;
+        _sedflux_measure_surface(state, m, mask, dest);
 
-            eh_require(state)
-            eh_require(state->p)
+        sed_measurement_destroy(m);
+    }
 
-            for (i = 0; i < len; ++i) {
-                sub = sed_cube_sub(state->p, i);
-                dest[i] = sed_measurement_make(m, state->p, sub.i, sub.j);
-            }
+    return dest;
+}
 
-            // fprintf (stderr, "These are my elevations (all %d=%dx%d of them):\n", len, sedflux_get_nx (state), sedflux_get_ny (state));
-            // for (i=0; i<len; ++i)
-            //   fprintf (stderr, "%d, %f\n", i, sed_cube_elevation (state->p, 0, i));
-        }
+/** Register a surface value that is to be handed out by pointer.
 
-        sed_measurement_destroy(m);
+The value is measured into a buffer owned by the state.  The buffer is
+refilled, at most once per time step, the next time it is asked for after
+the cube has changed.
 
-        if (mask) {
-            const int len = sed_cube_size(state->p);
-            int i;
+\param state  A Sedflux_state
+\param name   Name to look the value up by
+\param val_s  Name of the Sed_measurement
+\param mask   Mask of cells to set to -9999 (MASK_LAND, MASK_OCEAN)
 
-            if (mask & MASK_LAND) {
-                for (i = 0; i < len; i++)
-                    if (sed_cube_elevation(state->p, 0, i) > .1) {
-                        dest[i] = -9999.;
-                    }
-            }
+\return An id for the value, or -1 if the measurement is unknown.
+*/
+gint
+sedflux_add_surface_value(Sedflux_state* state, const char* name,
+    const char* val_s, gint mask)
+{
+    gint id = -1;
 
-            if (mask & MASK_OCEAN) {
-                for (i = 0; i < len; i++)
-                    if (sed_cube_elevation(state->p, 0, i) < -.1) {
-                        dest[i] = -9999.;
-                    }
-            }
+    eh_return_val_if_fail(state, -1);
+    eh_return_val_if_fail(name, -1);
+    eh_return_val_if_fail(val_s, -1);
+
+    id = sedflux_surface_value_id(state, name);
+
+    if (id < 0) {
+        Sed_measurement m = sed_measurement_new(val_s);
+
+        if (m) {
+            Sedflux_surface_value* v = eh_new(Sedflux_surface_value, 1);
+
+            v->m        = m;
+            v->mask     = mask;
+            v->data     = eh_new(double, sed_cube_size(state->p));
+            v->revision  = state->revision - 1;
+            v->is_shared = FALSE;
+
+            id = state->surface->len;
+
+            g_ptr_array_add(state->surface, v);
+            g_hash_table_insert(state->surface_ids, g_strdup(name),
+                GINT_TO_POINTER(id + 1));
         }
     }
 
-    return dest;
+    return id;
+}
+
+/** Id of a surface value added with sedflux_add_surface_value, or -1.
+*/
+gint
+sedflux_surface_value_id(Sedflux_state* state, const char* name)
+{
+    eh_return_val_if_fail(state, -1);
+    eh_return_val_if_fail(name, -1);
+
+    return GPOINTER_TO_INT(g_hash_table_lookup(state->surface_ids, name)) - 1;
+}
+
+/** Buffer of a surface value, brought up to date if the cube has changed.
+
+The buffer belongs to the state and must not be freed.  It stays at the
+same address until sedflux_finalize and, once it has been handed out, is
+refilled each time the cube changes (at the end of each time step, and by
+the setters) so that a caller may hold on to the pointer across updates.
+*/
+double*
+sedflux_get_surface_value_ptr(Sedflux_state* state, gint id)
+{
+    Sedflux_surface_value* v;
+
+    eh_return_val_if_fail(state, NULL);
+    eh_return_val_if_fail(id >= 0 && id < (gint)state->surface->len, NULL);
+
+    v = (Sedflux_surface_value*)g_ptr_array_index(state->surface, id);
+
+    if (v->revision != state->revision) {
+        _sedflux_measure_surface(state, v->m, v->mask, v->data);
+        v->revision = state->revision;
+    }
+
+    v->is_shared = TRUE;
+
+    return v->data;
 }
 
 double*
@@ -1327,6 +1573,8 @@ sedflux_set_uplift(Sedflux_state* state, const double* val)
         }
     }
 
+    _sedflux_surface_changed(state);
+
     return;
 }
 void
@@ -1345,6 +1593,8 @@ sedflux_set_basement(Sedflux_state* state, const double* val)
         }
     }
 
+    _sedflux_surface_changed(state);
+
     return;
 }
 
@@ -1363,6 +1613,8 @@ sedflux_set_deposition(Sedflux_state* state, const double* val)
         sed_cell_destroy(add_cell);
     }
 
+    _sedflux_surface_changed(state);
+
     return;
 }
 
@@ -1437,6 +1689,8 @@ sedflux_set_subaerial_deposition(Sedflux_state* state, const double* val)
 #endif
     }
 
+    _sedflux_surface_changed(state);
+
     return;
 }
 
@@ -1547,6 +1801,7 @@ void
 sedflux_set_sea_level(Sedflux_state* state, const double* val)
 {
     sed_cube_set_sea_level(state->p, *val);
+    _sedflux_surface_changed(state);
 }
 
 
@@ -1581,22 +1836,22 @@ sorted_shore_cells(const Sed_cube c, const double* val, int* len, int** sorted_i
     eh_debug("Sorting fluxes...\n");
 
     {
-        int i;
-        const gint cube_len = sed_cube_size(c);
+        gint* shore_ids = sed_cube_shore_ids(c);
+        gint* id;
         GSList* top = NULL;
         Flux_sort_st* data = NULL;
         int list_len = 0;
 
-        for (i = 0; i < cube_len; i++) {
-            if (is_shore_cell_id(c, i)) {
-                data = eh_new(Flux_sort_st, 1);
-                data->val = val[i];
-                data->ind = i;
-                top = g_slist_prepend(top, data);
-                list_len++;
-            }
+        for (id = shore_ids; *id >= 0; id++) {
+            data = eh_new(Flux_sort_st, 1);
+            data->val = val[*id];
+            data->ind = *id;
+            top = g_slist_prepend(top, data);
+            list_len++;
         }
 
+        eh_free(shore_ids);
+
         //eh_watch_int (list_len);
         //eh_require (list_len>0);
 
@@ -1726,22 +1981,26 @@ sedflux_set_bed_load_flux(Sedflux_state* state, const double* val)
 
         { /* Calculate flux for all coastal pixels */
             const gint len = sed_cube_size(c);
+            gint* shore_ids = sed_cube_shore_ids(c);
+            gint* id;
             int i;
             double max_flux = -1e32;
             int n = 0;
 
-            for (i = 0; i < len; i++) {
-                if (is_shore_cell_id(c, i)) {
-                    total_flux += val[i];
+            for (id = shore_ids; *id >= 0; id++) {
+                total_flux += val[*id];
 
-                    if (val[i] > max_flux) {
-                        max_flux = val[i];
-                        max_id = i;
-                    }
-
-                    n++;
+                if (val[*id] > max_flux) {
+                    max_flux = val[*id];
+                    max_id = *id;
                 }
 
+                n++;
+            }
+
+            eh_free(shore_ids);
+
+            for (i = 0; i < len; i++) {
                 total_flux += val[i];
             }
 
@@ -1886,10 +2145,54 @@ void
 sedflux_finalize(Sedflux_state* state)
 {
     if (state) {
+        guint i;
+
+        // Write any output that is still waiting before its process goes.
+        sed_output_shutdown();
+        sed_cube_workers_shutdown();
+        eh_set_log_async(FALSE);
+
+        for (i = 0; i < state->surface->len; i++) {
+            Sedflux_surface_value* v = (Sedflux_surface_value*)g_ptr_array_index(
+                    state->surface, i);
+
+            sed_measurement_destroy(v->m);
+            eh_free(v->data);
+            eh_free(v);
+        }
+
+        g_ptr_array_free(state->surface, TRUE);
+        g_hash_table_destroy(state->surface_ids);
+
         sed_epoch_queue_destroy(state->q);
 
         sed_cube_destroy(state->p);
 
+        if (sed_cell_pool_is_enabled()) {
+            sed_cell_pools_fprint(stdout);
+        }
+
+        if (sed_column_load_cache_is_enabled()) {
+            sed_column_load_cache_fprint(stdout);
+        }
+
+        if (state->profile_file) {
+            GError* error = NULL;
+
+            sed_profile_enable(FALSE);
+
+            if (sed_profile_write(state->profile_file, &error)) {
+                eh_info("Wrote profile to %s.json and %s.csv", state->profile_file,
+                    state->profile_file);
+            } else {
+                eh_warning("Unable to write profile: %s", error->message);
+                g_error_free(error);
+            }
+
+            eh_free(state->profile_file);
+            state->profile_file = NULL;
+        }
+
         sed_sediment_unset_env();
     }
 
@@ -44,6 +44,13 @@ sedflux_get_surface_value(Sedflux_state* state, const char* val_s, double* dest,
     gint mask);
 double*
 sedflux_get_sediment_value(Sedflux_state* state, const char* val_s, double* dest);
+gint
+sedflux_add_surface_value(Sedflux_state* state, const char* name,
+    const char* val_s, gint mask);
+gint
+sedflux_surface_value_id(Sedflux_state* state, const char* name);
+double*
+sedflux_get_surface_value_ptr(Sedflux_state* state, gint id);
 double*
 sedflux_get_value(Sedflux_state* state, const char* val_s, int dimen[3]);
 double*
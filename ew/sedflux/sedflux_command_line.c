@@ -38,6 +38,14 @@ static gint     verbosity    = -1;
 static gboolean verbose      = FALSE;
 static gboolean silent       = FALSE;
 static gboolean version      = FALSE;
+static gboolean contiguous   = FALSE;
+static gboolean cell_pool    = FALSE;
+static gboolean load_cache   = FALSE;
+static gint     n_threads    = 1;
+static gint     n_output_threads = 0;
+static gboolean log_thread   = FALSE;
+static gchar*   restart_file = NULL;
+static gchar*   profile_file = NULL;
 static const char** active_procs = NULL;
 
 /* Define the command line options */
@@ -62,6 +70,38 @@ static GOptionEntry command_line_entries[] = {
     { "verbose", 'V', 0, G_OPTION_ARG_NONE, &verbose, "Be verbose", NULL     },
     { "silent", 'S', 0, G_OPTION_ARG_NONE, &silent, "Be silent", NULL     },
     { "version", 'v', 0, G_OPTION_ARG_NONE, &version, "Version number", NULL     },
+    {
+        "contiguous-columns", 0, 0, G_OPTION_ARG_NONE, &contiguous,
+        "Store the cells of each column contiguously", NULL
+    },
+    {
+        "cell-pool", 0, 0, G_OPTION_ARG_NONE, &cell_pool,
+        "Allocate sediment cells from per-thread pools", NULL
+    },
+    {
+        "load-cache", 0, 0, G_OPTION_ARG_NONE, &load_cache,
+        "Cache the overburden load of each column", NULL
+    },
+    {
+        "threads", 0, 0, G_OPTION_ARG_INT, &n_threads,
+        "Number of threads for column operations", "n"
+    },
+    {
+        "output-threads", 0, 0, G_OPTION_ARG_INT, &n_output_threads,
+        "Number of threads that write output in the background", "n"
+    },
+    {
+        "log-thread", 0, 0, G_OPTION_ARG_NONE, &log_thread,
+        "Write log messages from a background thread", NULL
+    },
+    {
+        "restart", 0, 0, G_OPTION_ARG_FILENAME, &restart_file,
+        "Restart the run from a checkpoint file", "<file>"
+    },
+    {
+        "profile", 0, 0, G_OPTION_ARG_FILENAME, &profile_file,
+        "Profile processes and write <prefix>.json and <prefix>.csv", "<prefix>"
+    },
     { NULL }
 };
 
@@ -180,6 +220,14 @@ sedflux_parse_command_line(const int argc, const char* argv[], GError** error)
             p->verbosity    = verbosity;
             p->verbose      = verbose;
             p->version      = version;
+            p->contiguous   = contiguous;
+            p->cell_pool    = cell_pool;
+            p->load_cache   = load_cache;
+            p->n_threads    = n_threads;
+            p->n_output_threads = n_output_threads;
+            p->log_thread   = log_thread;
+            p->restart_file = restart_file;
+            p->profile_file = profile_file;
             p->active_procs = active_procs;
         } else {
             g_propagate_error(error, tmp_err);
@@ -0,0 +1,89 @@
+//---
+//
+// This file is part of sedflux.
+//
+// sedflux is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// sedflux is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with sedflux; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//---
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <utils/utils.h>
+#include <sed/sed_sedflux.h>
+
+static gchar*   out_file  = NULL;
+static gint     verbosity = 5;
+static gboolean version   = FALSE;
+
+GOptionEntry entries[] = {
+    { "out-file", 'o', 0, G_OPTION_ARG_FILENAME, &out_file, "Output file", "<file>" },
+    { "verbose", 'V', 0, G_OPTION_ARG_INT, &verbosity, "Verbosity level", "n" },
+    { "version", 'v', 0, G_OPTION_ARG_NONE, &version, "Version number", NULL },
+    { NULL }
+};
+
+int
+main(int argc, char* argv[])
+{
+    GOptionContext* context =
+        g_option_context_new("CHECKPOINT - Merge a delta checkpoint with its base");
+    GError*         error   = NULL;
+    Sed_checkpoint  c;
+
+    eh_init_glib();
+
+    g_option_context_add_main_entries(context, entries, NULL);
+
+    if (!g_option_context_parse(context, &argc, &argv, &error)) {
+        eh_error("Error parsing command line arguments: %s", error->message);
+    }
+
+    if (version) {
+        eh_fprint_version_info(stdout, "sedflux-merge-checkpoint", 0, 1, 0), exit(0);
+    }
+
+    eh_set_verbosity_level(verbosity);
+
+    if (argc != 2 || !out_file) {
+        eh_error("Specify one checkpoint file and an output file (see --help)");
+    }
+
+    c = sed_checkpoint_open(argv[1], &error);
+    eh_exit_on_error(error, "%s: Unable to open checkpoint", argv[1]);
+
+    if (!sed_checkpoint_is_delta(c)) {
+        eh_info("%s: Checkpoint is not a delta; copying as is", argv[1]);
+    }
+
+    sed_checkpoint_merge(c, out_file, &error);
+    eh_exit_on_error(error, "%s: Unable to write checkpoint", out_file);
+
+    {
+        gssize id, n = 0;
+
+        for (id = 0 ; id < sed_checkpoint_size(c) ; id++) {
+            n += sed_checkpoint_has_column(c, id);
+        }
+
+        eh_info("Columns in checkpoint   : %ld", (glong)sed_checkpoint_size(c));
+        eh_info("Columns in delta        : %ld", (glong)n);
+        eh_info("Age of checkpoint       : %f", sed_checkpoint_age(c));
+    }
+
+    sed_checkpoint_close(c);
+    g_option_context_free(context);
+
+    return EXIT_SUCCESS;
+}
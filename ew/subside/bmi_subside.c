@@ -21,9 +21,10 @@ get_component_name(BMI_Model* self, char* name)
 }
 
 
-#define INPUT_VAR_NAME_COUNT (1)
+#define INPUT_VAR_NAME_COUNT (2)
 static const char* input_var_names[INPUT_VAR_NAME_COUNT] = {
-    "earth_material_load__pressure"
+    "earth_material_load__pressure",
+    "lithosphere__flexure_kernel"
 };
 
 
@@ -225,6 +226,8 @@ get_var_grid(BMI_Model* self, const char* name, int* grid)
         *grid = 0;
     } else if (strcmp(name, "earth_material_load__pressure") == 0) {
         *grid = 0;
+    } else if (strcmp(name, "lithosphere__flexure_kernel") == 0) {
+        *grid = 0;
     } else {
         *grid = -1;
         return BMI_FAILURE;
@@ -241,6 +244,8 @@ get_var_type(BMI_Model* self, const char* name, char* type)
         strncpy(type, "double", BMI_MAX_UNITS_NAME);
     } else if (strcmp(name, "earth_material_load__pressure") == 0) {
         strncpy(type, "double", BMI_MAX_UNITS_NAME);
+    } else if (strcmp(name, "lithosphere__flexure_kernel") == 0) {
+        strncpy(type, "double", BMI_MAX_UNITS_NAME);
     } else {
         type[0] = '\0';
         return BMI_FAILURE;
@@ -257,6 +262,8 @@ get_var_units(BMI_Model* self, const char* name, char* units)
         strncpy(units, "m", BMI_MAX_UNITS_NAME);
     } else if (strcmp(name, "earth_material_load__pressure") == 0) {
         strncpy(units, "Pa", BMI_MAX_UNITS_NAME);
+    } else if (strcmp(name, "lithosphere__flexure_kernel") == 0) {
+        strncpy(units, "m Pa-1", BMI_MAX_UNITS_NAME);
     } else {
         units[0] = '\0';
         return BMI_FAILURE;
@@ -273,6 +280,8 @@ get_var_itemsize(BMI_Model* self, const char* name, int* itemsize)
         *itemsize = sizeof(double);
     } else if (strcmp(name, "earth_material_load__pressure") == 0) {
         *itemsize = sizeof(double);
+    } else if (strcmp(name, "lithosphere__flexure_kernel") == 0) {
+        *itemsize = sizeof(double);
     } else {
         *itemsize = 0;
         return BMI_FAILURE;
@@ -423,6 +432,8 @@ get_value_ptr(BMI_Model* self, const char* name, void** dest)
         *dest = sub_get_deflection((Subside_state*)self->data);
     } else if (strcmp(name, "earth_material_load__pressure") == 0) {
         *dest = sub_get_load((Subside_state*)self->data);
+    } else if (strcmp(name, "lithosphere__flexure_kernel") == 0) {
+        *dest = sub_get_flexure_kernel((Subside_state*)self->data);
     } else {
         *dest = NULL;
         return BMI_FAILURE;
@@ -502,6 +513,10 @@ set_value(BMI_Model* self, const char* name, void* array)
 
     memcpy(dest, array, nbytes);
 
+    if (strcmp(name, "lithosphere__flexure_kernel") == 0) {
+        sub_set_flexure_kernel((Subside_state*)self->data, dest);
+    }
+
     return BMI_SUCCESS;
 }
 
@@ -532,6 +547,10 @@ set_value_at_indices(BMI_Model* self, const char* name, int* inds, int len,
         }
     }
 
+    if (strcmp(name, "lithosphere__flexure_kernel") == 0) {
+        sub_set_flexure_kernel((Subside_state*)self->data, to);
+    }
+
     return BMI_SUCCESS;
 }
 
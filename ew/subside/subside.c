@@ -25,29 +25,76 @@
 #include "subside.h"
 
 #include <math.h>
-#ifdef HAVE_OMP_H
-    #include <omp.h>
-#endif
-
-#define N_THREADS 5
-
-typedef struct {
-    Eh_dbl_grid w;
-    double      v_0;
-    double      eet;
-    double      y;
-    gint        id;
-}
-Subside_data;
+#include <string.h>
 
-void
-subside_helper(gpointer data, gpointer v_0);
 void
 subside_parallel_row(double* w, const double* load, const gint len, const double dy,
     const double dx, const double alpha, const double* r);
 
+static void
+_subside_grid_load_point(Eh_dbl_grid w, Eh_dbl_grid v_0, double eet, double y);
+static void
+_subside_grid_load_fft(Eh_dbl_grid w, Eh_dbl_grid v_0, Subside_kernel k);
+
+static Subside_solver __solver = SUBSIDE_SOLVER_AUTO;
+static Subside_kernel __kernel = NULL; ///< Kernel shared by subside_grid_load
+static GStaticMutex __kernel_lock = G_STATIC_MUTEX_INIT;
+
+/** Set the method used by subside_grid_load
+
+\param solver The solver to use.
+*/
+void
+subside_set_solver(Subside_solver solver)
+{
+    __solver = solver;
+}
+
+/** The method used by subside_grid_load
+*/
+Subside_solver
+subside_solver(void)
+{
+    return __solver;
+}
+
+static gboolean
+_subside_array_is_uniform(const double* x, gint len)
+{
+    gboolean is_uniform = TRUE;
+
+    if (len > 2) {
+        gint i;
+        const double dx = x[1] - x[0];
+
+        for (i = 2 ; is_uniform && i < len ; i++) {
+            is_uniform = fabs((x[i] - x[i - 1]) - dx) <= 1e-6 * fabs(dx);
+        }
+    }
+
+    return is_uniform;
+}
+
+/** Is a grid equally spaced in each direction?
+
+\param g A grid.
+
+\return TRUE if the nodes of the grid are equally spaced in x, and in y.
+*/
+gboolean
+subside_grid_is_uniform(Eh_dbl_grid g)
+{
+    return _subside_array_is_uniform(eh_grid_x(g), eh_grid_n_x(g))
+        && _subside_array_is_uniform(eh_grid_y(g), eh_grid_n_y(g));
+}
+
 /* Calculate a deflection grid
 
+With SUBSIDE_SOLVER_AUTO, equally spaced grids are solved by FFT
+convolution and other grids by summing point loads.  The flexure kernel
+used by the FFT solver is kept between calls and is only rebuilt when the
+grid or the flexure parameters change.
+
 \param w   Grid of deflections.
 \param v_0 Grid of loads.
 \param eet Effective elastic thickness.
@@ -60,179 +107,495 @@ subside_grid_load(Eh_dbl_grid w, Eh_dbl_grid v_0, double eet, double y)
     eh_require(w);
     eh_require(v_0);
 
-    if (!g_thread_supported()) {
-        g_thread_init(NULL);
-    }
-
-#undef WITH_THREADS
-#ifndef WITH_THREADS
-
     if (w && v_0) {
-        gint i, j;
-        const gint n_x = eh_grid_n_x(v_0);
-        const gint n_y = eh_grid_n_y(v_0);
+        gboolean use_fft;
 
-        if (TRUE) {
-            /* Grid is not equally spaced. */
-            double load;
+        if (__solver == SUBSIDE_SOLVER_AUTO) {
+            use_fft = subside_grid_is_uniform(w);
+        } else {
+            use_fft = (__solver == SUBSIDE_SOLVER_FFT);
+        }
 
-            for (i = 0 ; i < n_x ; i++) {
-                //load = eh_grid_row( v_0, i );
-                for (j = 0 ; j < n_y ; j++) {
-                    load = eh_dbl_grid_val(v_0, i, j);
+        if (use_fft) {
+            g_static_mutex_lock(&__kernel_lock);
 
-                    //if ( fabs(load[j]) > 1e-3 )
-                    if (fabs(load) > 1e-10) {
-                        subside_point_load(w, load, eet, y, i, j);
-                    }
+            __kernel = subside_kernel_update(__kernel, w, eet, y);
+            _subside_grid_load_fft(w, v_0, __kernel);
 
-                    //subside_point_load( w , load[j] , eet , y , i , j );
-                }
-            }
+            g_static_mutex_unlock(&__kernel_lock);
         } else {
-            /* Grid is equally spaced. */
-            const double alpha     = get_flexure_parameter(eet, y, (eh_grid_n_x(w) == 1) ? 1 : 2);
-            const double inv_alpha = 1. / alpha;
-            const double dx        = eh_grid_x(w)[1] - eh_grid_x(w)[0];
-            const double dy        = eh_grid_y(w)[1] - eh_grid_y(w)[0];
-            double** r             = eh_new_2(double, n_x, n_y);
-            gint d_row;
-            double dx_2, dy_2;
-
-            for (d_row = 0; d_row < n_x; d_row++) {
-                dx_2 = (d_row * dx) * (d_row * dx);
-
-                for (j = 0; j < n_y; j++) {
-                    dy_2 = (j * dy) * (j * dy);
-                    r[d_row][j] = eh_kei_0(sqrt(dx_2 + dy_2) * inv_alpha);
-                }
+            _subside_grid_load_point(w, v_0, eet, y);
+        }
+    }
+
+    return;
+}
+
+/* Deflect a grid by adding the deflection of each point load.  This is
+   the reference solution, and works for unequally spaced grids.
+*/
+static void
+_subside_grid_load_point(Eh_dbl_grid w, Eh_dbl_grid v_0, double eet, double y)
+{
+    gint i, j;
+    const gint n_x = eh_grid_n_x(v_0);
+    const gint n_y = eh_grid_n_y(v_0);
+    double load;
+
+    for (i = 0 ; i < n_x ; i++) {
+        for (j = 0 ; j < n_y ; j++) {
+            load = eh_dbl_grid_val(v_0, i, j);
+
+            if (fabs(load) > 1e-10) {
+                subside_point_load(w, load, eet, y, i, j);
             }
+        }
+    }
 
-#define USE_OMP
-#ifdef USE_OMP
-            //#pragma omp parallel num_threads(4)
-            {
-                /*
-                            int id        = omp_get_thread_num();
-                            int n_threads = omp_get_num_threads();
-                            int j_start   = id*n_x/n_threads;
-                            int j_end     = ( id+1 )*n_x/n_threads;
-
-                            if ( id==n_threads-1 )
-                               j_end = n_x;
-                            for ( j=j_start ; j<j_end ; j++ )
-                */
-
-                #pragma omp parallel for num_threads(4)
-                for (j = 0 ; j < n_x ; j++) {
-                    double* w_row = (double*)eh_grid_row(w, j);
-                    gint i;
-                    gint d_row;
-
-                    for (i = 0 ; i < n_x ; i++) {
-                        /* For each row of loads */
-                        d_row = abs(j - i);
-                        subside_parallel_row(w_row,
-                            (double*)eh_grid_row(v_0, i),
-                            n_y,
-                            dy,
-                            d_row * dx,
-                            alpha, r[d_row]); //r[d_row] );
-                    }
+    return;
+}
 
-                    //eh_message( "Done (row=%d).", j );
-                }
+/* The smallest power of two that is at least n.
+*/
+static gint
+_subside_pow_2(gint n)
+{
+    gint p = 1;
 
+    while (p < n) {
+        p <<= 1;
+    }
+
+    return p;
+}
+
+/* Two-dimensional FFT of an n_x by n_y array of complex numbers (stored as
+   interleaved real and imaginary parts, row by row).  n_x and n_y must be
+   powers of two.  This is the transform of four1, so isign=-1 gives the
+   inverse transform without the 1/(n_x*n_y) factor.
+*/
+static void
+_subside_fft_2(double* data, gint n_x, gint n_y, gint isign)
+{
+    gint i, j;
+
+    for (i = 0 ; i < n_x ; i++) {
+        four1(data + 2 * i * n_y - 1, n_y, isign);
+    }
+
+    if (n_x > 1) {
+        double* col = eh_new(double, 2 * n_x);
+
+        for (j = 0 ; j < n_y ; j++) {
+            for (i = 0 ; i < n_x ; i++) {
+                col[2 * i]     = data[2 * (i * n_y + j)];
+                col[2 * i + 1] = data[2 * (i * n_y + j) + 1];
             }
-#else
-
-            //         for ( j=0 ; j<n_x ; j++ )
-            //         { /* For each row of locations */
-            //            w_row = eh_grid_row(w,j);
-            //            for ( i=0 ; i<n_x ; i++ )
-            //            { /* For each row of loads */
-            //               d_row = abs(j-i);
-            //               subside_parallel_row( w_row, eh_grid_row(v_0,i), n_y, dy, d_row*dx, alpha, NULL );
-            //            }
-            //         }
+
+            four1(col - 1, n_x, isign);
 
             for (i = 0 ; i < n_x ; i++) {
-                /* For each row of loads. */
-                load = eh_grid_row(v_0, i);
-
-                for (j = 0 ; j < n_x ; j++) {
-                    /* For each row of locations */
-                    d_row = abs(j - i);
-                    //subside_parallel_row( eh_grid_row(w,j), load, n_y, dy, d_row*dx, alpha, r[d_row] );
-                    subside_parallel_row(eh_grid_row(w, j), load, n_y, dy, d_row * dx, alpha, NULL);
-                }
+                data[2 * (i * n_y + j)]     = col[2 * i];
+                data[2 * (i * n_y + j) + 1] = col[2 * i + 1];
             }
+        }
 
-#endif
+        eh_free(col);
+    }
+}
+
+/* The deflection due to a unit load a distance r from the load.
+*/
+static double
+_subside_unit_deflection(double r, double alpha, gboolean is_1d)
+{
+    double w;
+
+    if (is_1d) {
+        const double x = r / alpha;
+        w = exp(-x) * (cos(x) + sin(x)) / (2.*alpha * sed_rho_mantle() * sed_gravity());
+    } else {
+        w = -eh_kei_0(r / alpha)
+            / (2.*M_PI * sed_rho_mantle() * sed_gravity() * alpha * alpha);
+    }
+
+    return w;
+}
 
-            eh_free_2(r);
+CLASS(Subside_kernel)
+{
+    gint n_x;
+    gint n_y;
+    double dx;
+    double dy;
+    double eet;
+    double youngs;
+    double* r; ///< Deflection a distance (d_i*dx, d_j*dy) from a unit load, r[d_i*n_y+d_j]
+    gint pad_x;
+    gint pad_y;
+    double* k; ///< Transform of r wrapped onto the padded grid (NULL until needed)
+};
+
+static gint __kernel_builds = 0;
+static gint __kernel_reuses = 0;
+
+/** Create a flexure kernel for an equally spaced grid
+
+The kernel is a table of the deflection due to a unit load as a function
+of the row and column distance from the load.  Since the table depends
+only on the grid spacing and the flexure parameters, it can be reused
+for any number of loads on grids of the same shape.
+
+\param n_x    Number of rows in the grid.
+\param n_y    Number of columns in the grid.
+\param dx     Spacing between rows.
+\param dy     Spacing between columns.
+\param eet    Effective elastic thickness.
+\param youngs Young's modulus.
+
+\return A newly created Subside_kernel.  Use subside_kernel_destroy to free.
+*/
+Subside_kernel
+subside_kernel_new(gint n_x, gint n_y, double dx, double dy, double eet,
+    double youngs)
+{
+    Subside_kernel k = NULL;
+
+    eh_require(n_x > 0);
+    eh_require(n_y > 0);
+
+    if (n_x > 0 && n_y > 0) {
+        const gboolean is_1d = (n_x == 1);
+        const double alpha   = get_flexure_parameter(eet, youngs, is_1d ? 1 : 2);
+        gint d_i, d_j;
+
+        NEW_OBJECT(Subside_kernel, k);
+
+        k->n_x    = n_x;
+        k->n_y    = n_y;
+        k->dx     = dx;
+        k->dy     = dy;
+        k->eet    = eet;
+        k->youngs = youngs;
+        k->r      = eh_new(double, n_x * n_y);
+        k->pad_x  = _subside_pow_2(2 * n_x - 1);
+        k->pad_y  = _subside_pow_2(2 * n_y - 1);
+        k->k      = NULL;
+
+        for (d_i = 0 ; d_i < n_x ; d_i++) {
+            for (d_j = 0 ; d_j < n_y ; d_j++) {
+                k->r[d_i * n_y + d_j] =
+                    _subside_unit_deflection(sqrt(d_i * dx * d_i * dx + d_j * dy * d_j * dy),
+                        alpha, is_1d);
+            }
         }
+
+        g_atomic_int_inc(&__kernel_builds);
     }
 
-#else
+    return k;
+}
+
+/** Destroy a Subside_kernel
 
-    if (w && v_0) {
-        GThreadPool* pool;
+\param k A Subside_kernel
+
+\return NULL
+*/
+Subside_kernel
+subside_kernel_destroy(Subside_kernel k)
+{
+    if (k) {
+        eh_free(k->r);
+        eh_free(k->k);
+        eh_free(k);
+    }
+
+    return NULL;
+}
+
+/** Was a kernel built for a grid and set of flexure parameters?
 
-        pool = g_thread_pool_new(subside_helper, NULL, N_THREADS, TRUE, NULL);
+\param k      A Subside_kernel
+\param n_x    Number of rows in the grid.
+\param n_y    Number of columns in the grid.
+\param dx     Spacing between rows.
+\param dy     Spacing between columns.
+\param eet    Effective elastic thickness.
+\param youngs Young's modulus.
 
-        eh_require(pool);
-        {
-            Subside_data* queue = NULL;
-            gssize len = eh_grid_n_el(v_0);
-            gssize id, n, n_jobs;
-            double load;
+\return TRUE if the kernel can be used for the grid.
+*/
+gboolean
+subside_kernel_matches(Subside_kernel k, gint n_x, gint n_y, double dx,
+    double dy, double eet, double youngs)
+{
+    return k
+        && k->n_x == n_x && k->n_y == n_y
+        && k->dx == dx && k->dy == dy
+        && k->eet == eet && k->youngs == youngs;
+}
 
-            queue = eh_new(Subside_data, len);
+/* The row and column spacing of an equally spaced grid.  The spacing of a
+   direction with only one node is zero.
+*/
+static void
+_subside_grid_spacing(Eh_dbl_grid g, double* dx, double* dy)
+{
+    *dx = (eh_grid_n_x(g) > 1) ? eh_grid_x(g)[1] - eh_grid_x(g)[0] : 0.;
+    *dy = (eh_grid_n_y(g) > 1) ? eh_grid_y(g)[1] - eh_grid_y(g)[0] : 0.;
+}
 
-            for (id = 0, n = 0 ; id < len ; id++) {
-                load = eh_dbl_grid_data(v_0)[0][id];
+/** Get a flexure kernel for a grid, reusing an existing one if possible
 
-                if (fabs(load) > 1e-3) {
-                    queue[n].w   = eh_grid_dup(w);
-                    eh_dbl_grid_set(queue[n].w, 0.);
+If \a k was built for the same grid shape, spacing and flexure parameters
+it is returned unchanged.  Otherwise it is destroyed and a new kernel is
+created.
 
-                    queue[n].v_0 = load;
-                    queue[n].id  = id;
-                    queue[n].eet = eet;
-                    queue[n].y   = y;
+\param k      A Subside_kernel (or NULL)
+\param g      An equally spaced grid.
+\param eet    Effective elastic thickness.
+\param youngs Young's modulus.
 
-                    g_thread_pool_push(pool, &(queue[n]), NULL);
+\return A Subside_kernel for the grid.
+*/
+Subside_kernel
+subside_kernel_update(Subside_kernel k, Eh_dbl_grid g, double eet, double youngs)
+{
+    eh_require(g);
+    eh_require(subside_grid_is_uniform(g));
 
-                    n++;
-                }
-            }
+    if (g) {
+        const gint n_x = eh_grid_n_x(g);
+        const gint n_y = eh_grid_n_y(g);
+        double dx, dy;
+
+        _subside_grid_spacing(g, &dx, &dy);
+
+        if (subside_kernel_matches(k, n_x, n_y, dx, dy, eet, youngs)) {
+            g_atomic_int_inc(&__kernel_reuses);
+        } else {
+            k = subside_kernel_destroy(k);
+            k = subside_kernel_new(n_x, n_y, dx, dy, eet, youngs);
+        }
+    }
+
+    return k;
+}
+
+/** The table of deflections due to a unit load
+
+The table is stored row by row with element [d_i*n_y+d_j] the
+deflection at a distance of d_i rows and d_j columns from the load.
+
+\param k A Subside_kernel
+
+\return A pointer to the (n_x by n_y) table.  The table is owned by the kernel.
+*/
+double*
+subside_kernel_data(Subside_kernel k)
+{
+    eh_return_val_if_fail(k, NULL);
+    return k->r;
+}
+
+/** Number of rows in the grid that a kernel was built for
+*/
+gint
+subside_kernel_n_x(Subside_kernel k)
+{
+    eh_return_val_if_fail(k, 0);
+    return k->n_x;
+}
+
+/** Number of columns in the grid that a kernel was built for
+*/
+gint
+subside_kernel_n_y(Subside_kernel k)
+{
+    eh_return_val_if_fail(k, 0);
+    return k->n_y;
+}
+
+/** Replace the table of deflections of a kernel
+
+Use this to install a table computed elsewhere (by another instance of
+the model, for instance) for the same grid and flexure parameters.
+
+\param k    A Subside_kernel
+\param data An (n_x by n_y) table of unit deflections.
+*/
+void
+subside_kernel_set_data(Subside_kernel k, const double* data)
+{
+    eh_return_if_fail(k);
+    eh_return_if_fail(data);
+
+    if (data != k->r) {
+        memcpy(k->r, data, sizeof(double) * k->n_x * k->n_y);
+    }
+
+    eh_free(k->k);
+    k->k = NULL;
+}
+
+/** Print statistics for the flexure kernel cache
+
+\param fp A FILE to print to (or NULL for stdout).
+
+\return The number of bytes printed.
+*/
+gint
+subside_kernel_fprint(FILE* fp)
+{
+    gint n = 0;
+
+    if (!fp) {
+        fp = stdout;
+    }
 
-            g_thread_pool_free(pool, FALSE, TRUE);
-            n_jobs = n;
+    n += fprintf(fp, "Flexure kernels built  : %d\n", g_atomic_int_get(&__kernel_builds));
+    n += fprintf(fp, "Flexure kernels reused : %d\n", g_atomic_int_get(&__kernel_reuses));
 
-            for (n = 0 ; n < n_jobs ; n++) {
-                eh_dbl_grid_add(w, queue[n].w);
-                eh_grid_destroy(queue[n].w, TRUE);
+    return n;
+}
+
+/* The transform of a kernel's table wrapped onto a (pad_x by pad_y) grid
+   that is large enough that the circular convolution of a zero-padded load
+   grid with it is the same as the linear one.  The transform is computed
+   the first time it is needed.
+*/
+static const double*
+_subside_kernel_transform(Subside_kernel k)
+{
+    if (!k->k) {
+        const gint pad_x = k->pad_x;
+        const gint pad_y = k->pad_y;
+        gint i, j, d_i, d_j;
+
+        k->k = eh_new0(double, 2 * pad_x * pad_y);
+
+        for (d_i = -(k->n_x - 1) ; d_i < k->n_x ; d_i++) {
+            i = (d_i + pad_x) % pad_x;
+
+            for (d_j = -(k->n_y - 1) ; d_j < k->n_y ; d_j++) {
+                j = (d_j + pad_y) % pad_y;
+
+                k->k[2 * (i * pad_y + j)] = k->r[abs(d_i) * k->n_y + abs(d_j)];
             }
+        }
+
+        _subside_fft_2(k->k, pad_x, pad_y, 1);
+    }
+
+    return k->k;
+}
 
-            eh_free(queue);
+/* Deflect an equally spaced grid by convolving the load with the flexure
+   kernel using FFTs.
+*/
+static void
+_subside_grid_load_fft(Eh_dbl_grid w, Eh_dbl_grid v_0, Subside_kernel k)
+{
+    const gint n_x       = k->n_x;
+    const gint n_y       = k->n_y;
+    const gint pad_x     = k->pad_x;
+    const gint pad_y     = k->pad_y;
+    const double inv_len = 1. / (pad_x * pad_y);
+    const double* kern   = _subside_kernel_transform(k);
+    double** z           = eh_dbl_grid_data(w);
+    double* data         = eh_new0(double, 2 * pad_x * pad_y);
+    double re, im;
+    gint i, j, n;
+
+    for (i = 0 ; i < n_x ; i++) {
+        for (j = 0 ; j < n_y ; j++) {
+            data[2 * (i * pad_y + j)] = eh_dbl_grid_val(v_0, i, j);
+        }
+    }
+
+    _subside_fft_2(data, pad_x, pad_y, 1);
+
+    for (n = 0 ; n < pad_x * pad_y ; n++) {
+        re = data[2 * n] * kern[2 * n] - data[2 * n + 1] * kern[2 * n + 1];
+        im = data[2 * n] * kern[2 * n + 1] + data[2 * n + 1] * kern[2 * n];
+        data[2 * n]     = re;
+        data[2 * n + 1] = im;
+    }
+
+    _subside_fft_2(data, pad_x, pad_y, -1);
+
+    for (i = 0 ; i < n_x ; i++) {
+        for (j = 0 ; j < n_y ; j++) {
+            z[i][j] += data[2 * (i * pad_y + j)] * inv_len;
         }
     }
 
-#endif
+    eh_free(data);
 
     return;
 }
 
+/* Deflect an equally spaced grid by adding the deflection of each point
+   load, looking up the deflections in the kernel's table.
+*/
+static void
+_subside_grid_load_table(Eh_dbl_grid w, Eh_dbl_grid v_0, Subside_kernel k)
+{
+    const gint n_x = k->n_x;
+    const gint n_y = k->n_y;
+    double** z     = eh_dbl_grid_data(w);
+    double load;
+    double* r_i;
+    gint i, j, i_0, j_0;
+
+    for (i_0 = 0 ; i_0 < n_x ; i_0++) {
+        for (j_0 = 0 ; j_0 < n_y ; j_0++) {
+            load = eh_dbl_grid_val(v_0, i_0, j_0);
+
+            if (fabs(load) > 1e-10) {
+                for (i = 0 ; i < n_x ; i++) {
+                    r_i = k->r + abs(i - i_0) * n_y;
+
+                    for (j = 0 ; j < n_y ; j++) {
+                        z[i][j] += load * r_i[abs(j - j_0)];
+                    }
+                }
+            }
+        }
+    }
+
+    return;
+}
+
+/** Calculate a deflection grid with a precomputed kernel
+
+The kernel must have been built for the shape and spacing of the grid.
+The loads are convolved with the kernel by FFT unless the solver is
+SUBSIDE_SOLVER_POINT_LOAD, in which case the point loads are added
+one at a time.
+
+\param w   Grid of deflections.
+\param v_0 Grid of loads.
+\param k   Flexure kernel for the grid.
+*/
 void
-subside_helper(gpointer d, gpointer g)
+subside_grid_load_with_kernel(Eh_dbl_grid w, Eh_dbl_grid v_0, Subside_kernel k)
 {
-    Subside_data* data = (Subside_data*)d;
-    Eh_ind_2      sub  = eh_grid_id_to_sub(eh_grid_n_y(data->w), data->id);
-    double        load = data->v_0;
+    eh_require(w);
+    eh_require(v_0);
+    eh_require(k);
 
-    subside_point_load(data->w, load, data->eet, data->y, sub.i, sub.j);
+    if (w && v_0 && k) {
+        eh_require(eh_grid_n_x(v_0) == k->n_x);
+        eh_require(eh_grid_n_y(v_0) == k->n_y);
+
+        if (__solver == SUBSIDE_SOLVER_POINT_LOAD) {
+            _subside_grid_load_table(w, v_0, k);
+        } else {
+            _subside_grid_load_fft(w, v_0, k);
+        }
+    }
 
     return;
 }
@@ -262,22 +625,30 @@ subside_point_load(Eh_dbl_grid g, double load, double h, double E, int i_load,
 
     if (eh_grid_n_x(g) > 1) {
         gssize i, j;
-        double r;
         double c = load / (2.*M_PI * sed_rho_mantle() * sed_gravity() * pow(alpha, 2.));
         double* x = eh_grid_x(g);
         double* y = eh_grid_y(g);
         const double inv_alpha = 1. / alpha;
+        const gssize n_y = eh_grid_n_y(g);
+        double* kei = eh_new(double, n_y);
         double dx_2, dy_2;
 
         for (i = 0 ; i < eh_grid_n_x(g) ; i++) {
             dx_2 = (x[i] - x_0) * (x[i] - x_0);
 
-            for (j = 0 ; j < eh_grid_n_y(g) ; j++) {
-                dy_2     = (y[j] - y_0) * (y[j] - y_0);
-                r        = sqrt(dx_2 + dy_2) * inv_alpha;
-                z[i][j] += - c * eh_kei_0(r);
+            for (j = 0 ; j < n_y ; j++) {
+                dy_2   = (y[j] - y_0) * (y[j] - y_0);
+                kei[j] = sqrt(dx_2 + dy_2) * inv_alpha;
+            }
+
+            eh_kei_0_array(kei, kei, n_y);
+
+            for (j = 0 ; j < n_y ; j++) {
+                z[i][j] += - c * kei[j];
             }
         }
+
+        eh_free(kei);
     } else {
         //if ( fabs( load )>1e-5 )
         if (fabs(load) > 1e-10) {
@@ -318,9 +689,11 @@ subside_parallel_row(double* w, const double* load, const gint len, const double
 
             for (i = 0; i < len; i++) {
                 dy_2 = (i * dy) * (i * dy);
-                kei[i] = eh_kei_0(sqrt(dx_2 + dy_2) * inv_alpha);
+                kei[i] = sqrt(dx_2 + dy_2) * inv_alpha;
             }
 
+            eh_kei_0_array(kei, kei, len);
+
             free_kei = TRUE;
         } else {
             kei = (double*)r;
@@ -43,8 +43,48 @@ G_BEGIN_DECLS
 #define SUBSIDE_MINOR_VERSION 1
 #define SUBSIDE_MICRO_VERSION 0
 
+/** Methods for solving for the deflection due to a grid of loads
+*/
+typedef enum {
+    SUBSIDE_SOLVER_AUTO = 0,   ///< FFT for equally spaced grids, else point loads
+    SUBSIDE_SOLVER_POINT_LOAD, ///< Add the deflection of each point load
+    SUBSIDE_SOLVER_FFT         ///< Convolve the loads with the flexure kernel
+}
+Subside_solver;
+
+new_handle(Subside_kernel);
+
 void
 subside_grid_load(Eh_dbl_grid w, Eh_dbl_grid v_0, double eet, double y);
+void
+subside_grid_load_with_kernel(Eh_dbl_grid w, Eh_dbl_grid v_0, Subside_kernel k);
+void
+subside_set_solver(Subside_solver solver);
+Subside_solver
+subside_solver(void);
+gboolean
+subside_grid_is_uniform(Eh_dbl_grid g);
+
+Subside_kernel
+subside_kernel_new(gint n_x, gint n_y, double dx, double dy, double eet,
+    double youngs);
+Subside_kernel
+subside_kernel_destroy(Subside_kernel k);
+Subside_kernel
+subside_kernel_update(Subside_kernel k, Eh_dbl_grid g, double eet, double youngs);
+gboolean
+subside_kernel_matches(Subside_kernel k, gint n_x, gint n_y, double dx,
+    double dy, double eet, double youngs);
+double*
+subside_kernel_data(Subside_kernel k);
+gint
+subside_kernel_n_x(Subside_kernel k);
+gint
+subside_kernel_n_y(Subside_kernel k);
+void
+subside_kernel_set_data(Subside_kernel k, const double* data);
+gint
+subside_kernel_fprint(FILE* fp);
 
 /**
    \brief Solve the flexure equation for a point load.
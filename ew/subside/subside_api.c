@@ -17,6 +17,7 @@ sub_init(Subside_state* state, int nx, int ny, double dx, double dy)
         state->rho_m = 3300.;
 
         state->time = 0;
+        state->kernel = NULL;
     }
 
     { /* Set up the initial profile */
@@ -47,7 +48,15 @@ sub_init(Subside_state* state, int nx, int ny, double dx, double dy)
 void
 sub_run(Subside_state* s, double t)
 {
-    subside_grid_load(s->z, s->load, s->eet, s->youngs);
+    // The kernel is tabulated by distance in nodes, which needs equally
+    // spaced nodes.  Other grids are solved a point load at a time.
+    if (subside_grid_is_uniform(s->z)) {
+        s->kernel = subside_kernel_update(s->kernel, s->z, s->eet, s->youngs);
+        subside_grid_load_with_kernel(s->z, s->load, s->kernel);
+    } else {
+        subside_grid_load(s->z, s->load, s->eet, s->youngs);
+    }
+
     s->time = t;
 }
 
@@ -55,6 +64,7 @@ void
 sub_destroy(Subside_state* state)
 {
     if (state) {
+        subside_kernel_destroy(state->kernel);
         eh_grid_destroy(state->z, TRUE);
         g_free(state);
     }
@@ -88,6 +98,21 @@ sub_get_y(Subside_state* state)
     return eh_grid_y(state->z);
 }
 
+double*
+sub_get_flexure_kernel(Subside_state* state)
+{
+    eh_return_val_if_fail(state, NULL);
+
+    if (!subside_grid_is_uniform(state->z)) {
+        return NULL;
+    }
+
+    state->kernel = subside_kernel_update(state->kernel, state->z, state->eet,
+            state->youngs);
+
+    return subside_kernel_data(state->kernel);
+}
+
 int
 sub_get_nx(Subside_state* state)
 {
@@ -138,3 +163,15 @@ sub_set_relax_time(Subside_state* state, double new_val)
     state->relaxation = new_val;
 }
 
+
+void
+sub_set_flexure_kernel(Subside_state* state, const double* kernel)
+{
+    eh_return_if_fail(state);
+
+    if (subside_grid_is_uniform(state->z)) {
+        state->kernel = subside_kernel_update(state->kernel, state->z, state->eet,
+                state->youngs);
+        subside_kernel_set_data(state->kernel, kernel);
+    }
+}
@@ -16,6 +16,8 @@ typedef struct {
     double rho_m; //< Density of mantle (kg/m3)
 
     double time; //< The current time (y)
+
+    Subside_kernel kernel; //< Flexure kernel, rebuilt when eet or youngs change
 }
 Subside_state;
 
@@ -62,6 +64,21 @@ sub_get_x(Subside_state*);
 const double*
 sub_get_y(Subside_state*);
 
+/** Get the flexure kernel
+
+The kernel is the deflection due to a unit load, tabulated by row and
+column distance from the load.  It has the same shape as the
+computation grid, and is built if it is not already up to date.
+Grids whose nodes are not equally spaced have no kernel.
+
+@param s A Subside_state
+
+@return Array of deflections per unit load (in m/Pa), or NULL if the grid
+        is not equally spaced.
+*/
+double*
+sub_get_flexure_kernel(Subside_state* s);
+
 int
 sub_get_nx(Subside_state*);
 int
@@ -78,6 +95,18 @@ sub_set_youngs(Subside_state*, double);
 void
 sub_set_relax_time(Subside_state*, double);
 
+/** Set the flexure kernel
+
+Install a kernel computed elsewhere for the same grid and flexure
+parameters so that it does not need to be rebuilt.  The kernel is ignored
+if the grid is not equally spaced.
+
+@param s A Subside_state
+@param kernel Array of deflections per unit load (in m/Pa)
+*/
+void
+sub_set_flexure_kernel(Subside_state* s, const double* kernel);
+
 G_END_DECLS
 
 #endif
@@ -4,8 +4,8 @@
 #include <check.h>
 #include <time.h>
 
-void
-subside_grid_load(Eh_dbl_grid w, Eh_dbl_grid v_0, double eet, double y);
+#include "subside.h"
+#include "subside_api.h"
 
 Eh_dbl_grid
 subside_test(const gint n_x, const gint n_y)
@@ -63,6 +63,218 @@ START_TEST(test_subside_0)
 }
 END_TEST
 
+/* Deflect a random load with a solver, and return the cpu time. */
+double
+subside_time_solver(Eh_dbl_grid w, Eh_dbl_grid v_0, Subside_solver solver)
+{
+    clock_t start;
+
+    subside_set_solver(solver);
+
+    eh_dbl_grid_set(w, 0.);
+
+    start = clock();
+    subside_grid_load(w, v_0, 5000., 7e10);
+
+    return ((double)(clock() - start)) / CLOCKS_PER_SEC;
+}
+
+START_TEST(test_subside_fft)
+{
+    gint n[][2] = { { 1, 256 }, { 16, 16 }, { 32, 48 }, { 64, 64 }, { 128, 128 } };
+    gint len = sizeof(n) / sizeof(n[0]);
+    gint k;
+
+    for (k = 0; k < len; k++) {
+        Eh_dbl_grid v_0   = eh_grid_new(double, n[k][0], n[k][1]);
+        Eh_dbl_grid w_fft = eh_grid_new(double, n[k][0], n[k][1]);
+        Eh_dbl_grid w_pt  = eh_grid_new(double, n[k][0], n[k][1]);
+        double t_fft, t_pt;
+        double err = 0., w_max = 0.;
+        gint i;
+
+        eh_grid_set_x_lin(v_0,   0., 1000.);
+        eh_grid_set_y_lin(v_0,   0., 1000.);
+        eh_grid_set_x_lin(w_fft, 0., 1000.);
+        eh_grid_set_y_lin(w_fft, 0., 1000.);
+        eh_grid_set_x_lin(w_pt,  0., 1000.);
+        eh_grid_set_y_lin(w_pt,  0., 1000.);
+
+        eh_dbl_grid_randomize(v_0);
+        eh_dbl_grid_scalar_mult(v_0, 5000.);
+
+        fail_unless(subside_grid_is_uniform(w_fft), "Grid should be uniform");
+
+        t_pt  = subside_time_solver(w_pt,  v_0, SUBSIDE_SOLVER_POINT_LOAD);
+        t_fft = subside_time_solver(w_fft, v_0, SUBSIDE_SOLVER_FFT);
+
+        for (i = 0; i < eh_grid_n_el(v_0); i++) {
+            double a = eh_dbl_grid_data_start(w_pt)[i];
+            double b = eh_dbl_grid_data_start(w_fft)[i];
+
+            err   = eh_max(err, fabs(a - b));
+            w_max = eh_max(w_max, fabs(a));
+        }
+
+        eh_message("Grid size: %d, %d", n[k][0], n[k][1]);
+        eh_message("Point load cpu time: %f", t_pt);
+        eh_message("FFT cpu time: %f", t_fft);
+        eh_message("Maximum relative error: %g", err / w_max);
+
+        fail_unless(err <= 1e-8 * w_max, "FFT deflection does not match point loads");
+
+        eh_grid_destroy(w_pt, TRUE);
+        eh_grid_destroy(w_fft, TRUE);
+        eh_grid_destroy(v_0, TRUE);
+    }
+
+    subside_set_solver(SUBSIDE_SOLVER_AUTO);
+}
+END_TEST
+
+START_TEST(test_subside_kernel)
+{
+    const gint n_x = 16;
+    const gint n_y = 24;
+    Eh_dbl_grid v_0   = eh_grid_new(double, n_x, n_y);
+    Eh_dbl_grid w_pt  = eh_grid_new(double, n_x, n_y);
+    Eh_dbl_grid w_tab = eh_grid_new(double, n_x, n_y);
+    Eh_dbl_grid w_fft = eh_grid_new(double, n_x, n_y);
+    Subside_kernel k, k_new, k_copy;
+    double err_tab = 0., err_fft = 0., w_max = 0.;
+    gint i;
+
+    eh_grid_set_x_lin(v_0,   0., 1000.);
+    eh_grid_set_y_lin(v_0,   0., 2000.);
+    eh_grid_set_x_lin(w_pt,  0., 1000.);
+    eh_grid_set_y_lin(w_pt,  0., 2000.);
+    eh_grid_set_x_lin(w_tab, 0., 1000.);
+    eh_grid_set_y_lin(w_tab, 0., 2000.);
+    eh_grid_set_x_lin(w_fft, 0., 1000.);
+    eh_grid_set_y_lin(w_fft, 0., 2000.);
+
+    eh_dbl_grid_randomize(v_0);
+    eh_dbl_grid_scalar_mult(v_0, 5000.);
+
+    k = subside_kernel_update(NULL, v_0, 5000., 7e10);
+
+    fail_unless(k != NULL, "Kernel not created");
+    fail_unless(subside_kernel_n_x(k) == n_x, "Kernel has wrong number of rows");
+    fail_unless(subside_kernel_n_y(k) == n_y, "Kernel has wrong number of columns");
+    fail_unless(subside_kernel_matches(k, n_x, n_y, 1000., 2000., 5000., 7e10),
+        "Kernel does not match its grid");
+
+    k_new = subside_kernel_update(k, w_pt, 5000., 7e10);
+    fail_unless(k_new == k, "Kernel should be reused for the same parameters");
+
+    subside_set_solver(SUBSIDE_SOLVER_POINT_LOAD);
+    subside_grid_load(w_pt, v_0, 5000., 7e10);
+    subside_grid_load_with_kernel(w_tab, v_0, k);
+
+    subside_set_solver(SUBSIDE_SOLVER_FFT);
+    subside_grid_load_with_kernel(w_fft, v_0, k);
+
+    subside_set_solver(SUBSIDE_SOLVER_AUTO);
+
+    for (i = 0; i < eh_grid_n_el(v_0); i++) {
+        double a = eh_dbl_grid_data_start(w_pt)[i];
+
+        err_tab = eh_max(err_tab, fabs(a - eh_dbl_grid_data_start(w_tab)[i]));
+        err_fft = eh_max(err_fft, fabs(a - eh_dbl_grid_data_start(w_fft)[i]));
+        w_max   = eh_max(w_max, fabs(a));
+    }
+
+    fail_unless(err_tab <= 1e-10 * w_max, "Kernel table does not match point loads");
+    fail_unless(err_fft <= 1e-8 * w_max, "Kernel FFT does not match point loads");
+
+    k_copy = subside_kernel_new(n_x, n_y, 1000., 2000., 5000., 7e10);
+    eh_dbl_array_set(subside_kernel_data(k_copy), n_x * n_y, 0.);
+    subside_kernel_set_data(k_copy, subside_kernel_data(k));
+
+    eh_dbl_grid_set(w_fft, 0.);
+    subside_grid_load_with_kernel(w_fft, v_0, k_copy);
+
+    for (i = 0, err_fft = 0.; i < eh_grid_n_el(v_0); i++) {
+        err_fft = eh_max(err_fft,
+                fabs(eh_dbl_grid_data_start(w_pt)[i] - eh_dbl_grid_data_start(w_fft)[i]));
+    }
+
+    fail_unless(err_fft <= 1e-8 * w_max, "Copied kernel does not match point loads");
+
+    k_new = subside_kernel_update(k, w_pt, 10000., 7e10);
+    fail_unless(subside_kernel_matches(k_new, n_x, n_y, 1000., 2000., 10000., 7e10),
+        "Kernel should be rebuilt when the flexure parameters change");
+
+    subside_kernel_destroy(k_new);
+    subside_kernel_destroy(k_copy);
+
+    eh_grid_destroy(w_fft, TRUE);
+    eh_grid_destroy(w_tab, TRUE);
+    eh_grid_destroy(w_pt, TRUE);
+    eh_grid_destroy(v_0, TRUE);
+}
+END_TEST
+
+START_TEST(test_subside_non_uniform)
+{
+    Eh_dbl_grid g = eh_grid_new(double, 4, 4);
+
+    eh_grid_set_x_lin(g, 0., 1000.);
+    eh_grid_set_y_lin(g, 0., 1000.);
+
+    fail_unless(subside_grid_is_uniform(g), "Grid should be uniform");
+
+    eh_grid_y(g)[3] += 10.;
+
+    fail_if(subside_grid_is_uniform(g), "Grid should not be uniform");
+
+    eh_grid_destroy(g, TRUE);
+}
+END_TEST
+
+START_TEST(test_subside_api_non_uniform)
+{
+    Subside_state* s = sub_init(NULL, 8, 8, 1000., 1000.);
+    Eh_dbl_grid w    = eh_grid_new(double, 8, 8);
+    const double* z;
+    double** w_data;
+    gint i, j;
+
+    eh_grid_set_x_lin(w, 0., 1000.);
+    eh_grid_set_y_lin(w, 0., 1000.);
+    eh_dbl_grid_set(w, 0.);
+
+    eh_grid_y(w)[7]        += 100.;
+    eh_grid_y(s->z)[7]     += 100.;
+    eh_grid_y(s->load)[7]  += 100.;
+
+    sub_set_load_at(s, 1e6, 3, 3);
+    sub_set_load_at(s, 1e6, 4, 6);
+
+    sub_run(s, 1.);
+    subside_grid_load(w, s->load, s->eet, s->youngs);
+
+    fail_unless(sub_get_flexure_kernel(s) == NULL,
+        "A grid that is not equally spaced has no kernel");
+
+    z      = sub_get_deflection(s);
+    w_data = eh_dbl_grid_data(w);
+
+    for (i = 0 ; i < 8 ; i++) {
+        for (j = 0 ; j < 8 ; j++) {
+            fail_unless(eh_compare_dbl(z[i * 8 + j], w_data[i][j], 1e-12),
+                "Deflection of a non-uniform grid should be found point by point");
+        }
+    }
+
+    fail_unless(fabs(z[3 * 8 + 3]) > 0., "Load should deflect the grid");
+
+    eh_grid_destroy(w, TRUE);
+    eh_grid_destroy(s->load, TRUE);
+    sub_destroy(s);
+}
+END_TEST
+
 Suite*
 sed_subside_suite(void)
 {
@@ -73,6 +285,10 @@ sed_subside_suite(void)
 
     tcase_set_timeout(test_case_core, 0);
     tcase_add_test(test_case_core, test_subside_0);
+    tcase_add_test(test_case_core, test_subside_fft);
+    tcase_add_test(test_case_core, test_subside_kernel);
+    tcase_add_test(test_case_core, test_subside_non_uniform);
+    tcase_add_test(test_case_core, test_subside_api_non_uniform);
 
     return s;
 }
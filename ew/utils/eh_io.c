@@ -1,4 +1,52 @@
 #include <eh_utils.h>
+#include <string.h>
+
+/** Byte swap an array of 32-bit values
+
+The source need not be aligned and may be the same as the destination. The
+loop is simple enough that the compiler turns it into vector shuffles.
+
+\param dst     Swapped values
+\param src     Values to swap
+\param nitems  Number of values
+*/
+void
+eh_swap_int32_array(void* dst, const void* src, gsize nitems)
+{
+    const guint8* s = (const guint8*)src;
+    guint8* d = (guint8*)dst;
+    gsize i;
+
+    for (i = 0 ; i < nitems ; i++) {
+        guint32 val;
+
+        memcpy(&val, s + i * sizeof(guint32), sizeof(guint32));
+        val = GUINT32_SWAP_LE_BE(val);
+        memcpy(d + i * sizeof(guint32), &val, sizeof(guint32));
+    }
+}
+
+/** Byte swap an array of 64-bit values
+
+\param dst     Swapped values
+\param src     Values to swap
+\param nitems  Number of values
+*/
+void
+eh_swap_int64_array(void* dst, const void* src, gsize nitems)
+{
+    const guint8* s = (const guint8*)src;
+    guint8* d = (guint8*)dst;
+    gsize i;
+
+    for (i = 0 ; i < nitems ; i++) {
+        guint64 val;
+
+        memcpy(&val, s + i * sizeof(guint64), sizeof(guint64));
+        val = GUINT64_SWAP_LE_BE(val);
+        memcpy(d + i * sizeof(guint64), &val, sizeof(guint64));
+    }
+}
 
 #if G_BYTE_ORDER==G_LITTLE_ENDIAN
 
@@ -10,13 +58,8 @@ eh_fread_int32_from_be(void* ptr, gsize size, gsize nitems, FILE* stream)
     eh_require(size == sizeof(gint32));
 
     if (ptr && stream) {
-        gsize i;
-        gint32 i_val;
-
-        for (i = 0 ; i < nitems ; i++) {
-            n += fread(&i_val, sizeof(gint32), 1, stream);
-            ((gint32*)ptr)[i] = GINT32_TO_BE(i_val);
-        }
+        n = fread(ptr, sizeof(gint32), nitems, stream);
+        eh_swap_int32_array(ptr, ptr, n);
     }
 
     return n;
@@ -30,13 +73,8 @@ eh_fread_int64_from_be(void* ptr, gsize size, gsize nitems, FILE* stream)
     eh_require(size == sizeof(gint64));
 
     if (ptr && stream) {
-        gsize i;
-        gint64 i_val;
-
-        for (i = 0 ; i < nitems ; i++) {
-            n += fread(&i_val, sizeof(gint64), 1, stream);
-            ((gint64*)ptr)[i] = GINT64_TO_BE(i_val);
-        }
+        n = fread(ptr, sizeof(gint64), nitems, stream);
+        eh_swap_int64_array(ptr, ptr, n);
     }
 
     return n;
@@ -93,33 +131,23 @@ eh_fread_int32_from_le(void* ptr, gsize size, gsize nitems, FILE* stream)
     eh_require(size == sizeof(gint32));
 
     if (ptr && stream) {
-        gsize i;
-        gint32 i_val;
-
-        for (i = 0 ; i < nitems ; i++) {
-            n += fread(&i_val, sizeof(gint32), 1, stream);
-            ((gint32*)ptr)[i] = GINT32_TO_LE(i_val);
-        }
+        n = fread(ptr, sizeof(gint32), nitems, stream);
+        eh_swap_int32_array(ptr, ptr, n);
     }
 
     return n;
 }
 
 gsize
-eh_fread_int64_from_le(const void* ptr, gsize size, gsize nitems, FILE* stream)
+eh_fread_int64_from_le(void* ptr, gsize size, gsize nitems, FILE* stream)
 {
     gsize n = 0;
 
     eh_require(size == sizeof(gint64));
 
     if (ptr && stream) {
-        gsize i;
-        gint64 i_val;
-
-        for (i = 0 ; i < nitems ; i++) {
-            n += fread(&i_val, sizeof(gint64), 1, stream);
-            ((gint64*)ptr)[i] = GINT64_TO_LE(i_val);
-        }
+        n = fread(ptr, sizeof(gint64), nitems, stream);
+        eh_swap_int64_array(ptr, ptr, n);
     }
 
     return n;
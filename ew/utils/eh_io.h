@@ -38,8 +38,8 @@ gsize eh_fread_int64_from_be(void* ptr, gsize size, gsize nitems, FILE* stream);
 
 gsize eh_fwrite_int32_to_le(const void* ptr, gsize size, gsize nitems, FILE* stream);
 gsize eh_fwrite_int64_to_le(const void* ptr, gsize size, gsize nitems, FILE* stream);
-gsize eh_fread_int32_from_le(const void* ptr, gsize size, gsize nitems, FILE* stream);
-gsize eh_fread_int64_from_le(const void* ptr, gsize size, gsize nitems, FILE* stream);
+gsize eh_fread_int32_from_le(void* ptr, gsize size, gsize nitems, FILE* stream);
+gsize eh_fread_int64_from_le(void* ptr, gsize size, gsize nitems, FILE* stream);
 
 #define eh_fwrite_int32_to_be  ( fwrite )
 #define eh_fwrite_int64_to_be  ( fwrite )
@@ -63,6 +63,9 @@ gsize eh_fread_int64_from_le(const void* ptr, gsize size, gsize nitems, FILE* st
 
 #endif
 
+void eh_swap_int32_array(void* dst, const void* src, gsize nitems);
+void eh_swap_int64_array(void* dst, const void* src, gsize nitems);
+
 #if !defined( HAVE_GETLINE )
 gssize getline(gchar** lineptr, gsize* n, FILE* stream);
 #endif
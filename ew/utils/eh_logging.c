@@ -188,6 +188,22 @@ eh_set_ignore_log_level(GLogLevelFlags ignore)
     eh_ignore_log_level = (GLogLevelFlags)(eh_ignore_log_level | ignore);
 }
 
+/** Are messages of a log level thrown away?
+
+The eh_message, eh_info, eh_debug, and eh_data macros check this before
+their arguments are formatted so that a message that would be ignored
+costs nothing more than this call.
+
+\param level A log level
+
+\return TRUE if messages of \a level are ignored
+*/
+gboolean
+eh_log_level_is_ignored(GLogLevelFlags level)
+{
+    return (eh_ignore_log_level & level) != 0;
+}
+
 GLogLevelFlags
 eh_set_verbosity_level(gint verbosity)
 {
@@ -246,6 +262,141 @@ eh_get_verbosity_level()
     }
 }
 
+typedef struct {
+    FILE** fp_list; //< NULL-terminated list of files (NULL to stop the writer)
+    gchar* text;
+}
+Eh_log_record;
+
+static GAsyncQueue* _log_queue_  = NULL;
+static GThread*     _log_thread_ = NULL;
+
+// Guards _log_queue_ so that no message is pushed onto a queue that is being
+// drained and freed by another thread.
+static GStaticMutex _log_queue_lock_ = G_STATIC_MUTEX_INIT;
+
+static void
+_eh_log_write(FILE** fp_list, const gchar* text, gboolean flush)
+{
+    gint i;
+
+    for (i = 0 ; fp_list[i] != NULL ; i++) {
+        fputs(text, fp_list[i]);
+
+        if (flush) {
+            fflush(fp_list[i]);
+        }
+    }
+}
+
+/* Write log records as they are queued.  Files are only flushed once the
+   queue is empty so that a burst of messages is written all at once. */
+static gpointer
+_eh_log_writer(gpointer data)
+{
+    GAsyncQueue* q = (GAsyncQueue*)data;
+    Eh_log_record* r;
+
+    while ((r = (Eh_log_record*)g_async_queue_pop(q))->fp_list) {
+        _eh_log_write(r->fp_list, r->text, FALSE);
+
+        if (g_async_queue_length(q) <= 0) {
+            fflush(NULL);
+        }
+
+        eh_free(r->fp_list);
+        eh_free(r->text);
+        eh_free(r);
+    }
+
+    fflush(NULL);
+    eh_free(r);
+
+    return NULL;
+}
+
+/** Write log messages from a background thread
+
+When set, eh_logger formats each message and hands it to a writer thread
+rather than writing and flushing it itself.  Fatal messages are always
+written right away.  Unsetting waits for every queued message to be
+written.  Threads that log while the queue is being drained wait for it to
+finish rather than writing out of order.
+
+\param async TRUE to write messages from a background thread
+*/
+void
+eh_set_log_async(gboolean async)
+{
+    if (async && !g_thread_supported()) {
+        g_thread_init(NULL);
+    }
+
+    g_static_mutex_lock(&_log_queue_lock_);
+
+    if (async && !_log_queue_) {
+        _log_queue_  = g_async_queue_new();
+        _log_thread_ = g_thread_create(_eh_log_writer, _log_queue_, TRUE, NULL);
+
+        if (!_log_thread_) {
+            g_async_queue_unref(_log_queue_);
+            _log_queue_ = NULL;
+        }
+    } else if (!async && _log_queue_) {
+        GAsyncQueue* q = _log_queue_;
+
+        _log_queue_ = NULL;
+
+        g_async_queue_push(q, eh_new0(Eh_log_record, 1));
+        g_thread_join(_log_thread_);
+        g_async_queue_unref(q);
+
+        _log_thread_ = NULL;
+    }
+
+    g_static_mutex_unlock(&_log_queue_lock_);
+}
+
+gboolean
+eh_log_is_async(void)
+{
+    gboolean is_async;
+
+    g_static_mutex_lock(&_log_queue_lock_);
+    is_async = (_log_queue_ != NULL);
+    g_static_mutex_unlock(&_log_queue_lock_);
+
+    return is_async;
+}
+
+/* Hand a message to the writer thread.  Return FALSE if messages aren't being
+   written from a background thread. */
+static gboolean
+_eh_log_push(FILE** fp_list, gchar* text)
+{
+    gboolean is_pushed = FALSE;
+
+    g_static_mutex_lock(&_log_queue_lock_);
+
+    if (_log_queue_) {
+        Eh_log_record* r = eh_new(Eh_log_record, 1);
+        gint len;
+
+        for (len = 0 ; fp_list[len] ; len++);
+
+        r->fp_list = (FILE**)g_memdup(fp_list, (len + 1) * sizeof(FILE*));
+        r->text    = text;
+
+        g_async_queue_push(_log_queue_, r);
+
+        is_pushed = TRUE;
+    }
+
+    g_static_mutex_unlock(&_log_queue_lock_);
+
+    return is_pushed;
+}
+
 void
 eh_logger(const gchar*   log_domain,
     GLogLevelFlags log_level,
@@ -253,11 +404,12 @@ eh_logger(const gchar*   log_domain,
     gpointer       user_data)
 {
     FILE** fp_list;
+    FILE*  default_list[2] = { stderr, NULL };
     const gchar* warning_label = "Warning";
     const gchar* error_label = "Error";
     const gchar* log_label = NULL;
     gboolean is_fatal = (log_level & G_LOG_FLAG_FATAL) != 0;
-    int i;
+    gchar* text;
 
     if (eh_ignore_log_level & log_level) {
         return;
@@ -270,9 +422,11 @@ eh_logger(const gchar*   log_domain,
     if (user_data && !(log_level & G_LOG_LEVEL_DEBUG)) {
         fp_list = (FILE**)user_data;
     } else {
-        fp_list = eh_new(FILE*, 2);
-        fp_list[0] = stderr;
-        fp_list[1] = NULL;
+        fp_list = default_list;
+    }
+
+    if (!fp_list[0]) {
+        return;
     }
 
     if (log_level & G_LOG_LEVEL_WARNING) {
@@ -281,27 +435,23 @@ eh_logger(const gchar*   log_domain,
         log_label = error_label;
     }
 
-    for (i = 0 ; fp_list[i] != NULL ; i++) {
-        if (log_label) {
-            fprintf(fp_list[i], "%s: ", log_label);
-        }
+    text = g_strconcat(log_label ? log_label : "", log_label ? ": " : "",
+            (log_domain && !(log_level & EH_LOG_LEVEL_DATA)) ? log_domain : "",
+            (log_domain && !(log_level & EH_LOG_LEVEL_DATA)) ? ": " : "",
+            message, "\n", NULL);
 
-        if (log_domain && !(log_level & EH_LOG_LEVEL_DATA)) {
-            fprintf(fp_list[i], "%s: ", log_domain);
+    if (is_fatal || !_eh_log_push(fp_list, text)) {
+        // Anything that is queued goes first.
+        if (is_fatal) {
+            eh_set_log_async(FALSE);
         }
 
-        fprintf(fp_list[i], "%s\n", message);
+        _eh_log_write(fp_list, text, TRUE);
 
-        fflush(fp_list[i]);
+        eh_free(text);
     }
 
     if (is_fatal) {
         eh_exit(EXIT_FAILURE);
     }
-
-    if (!(user_data && !(log_level & G_LOG_LEVEL_DEBUG))) {
-        eh_free(fp_list);
-    }
 }
-
-
@@ -71,54 +71,74 @@ void eh_redirect_log(const char* log_file1, const char* log_file2);
 #endif
 
 void eh_set_ignore_log_level(GLogLevelFlags ignore);
+gboolean eh_log_level_is_ignored(GLogLevelFlags level);
+void eh_set_log_async(gboolean async);
+gboolean eh_log_is_async(void);
 gint eh_get_verbosity_level();
 GLogLevelFlags eh_set_verbosity_level(gint verbosity);
 void eh_logger(const gchar* log_domain,
     GLogLevelFlags log_level,
     const gchar* message,
     gpointer user_data);
+// Messages that would be ignored are not formatted.
+#define EH_LOG_IF_NOT_IGNORED( level , call ) \
+    ( eh_log_level_is_ignored( level ) ? (void)0 : (void)(call) )
+
 #ifdef G_HAVE_ISO_VARARGS
-#define eh_message(...)  g_log( EH_LOG_DOMAIN ,       \
+#define eh_message(...)  EH_LOG_IF_NOT_IGNORED( G_LOG_LEVEL_MESSAGE , \
+    g_log( EH_LOG_DOMAIN ,       \
     G_LOG_LEVEL_MESSAGE , \
-    __VA_ARGS__ )
-#define eh_info(...)     g_log( EH_LOG_DOMAIN ,    \
+    __VA_ARGS__ ) )
+#define eh_info(...)     EH_LOG_IF_NOT_IGNORED( G_LOG_LEVEL_INFO , \
+    g_log( EH_LOG_DOMAIN ,    \
     G_LOG_LEVEL_INFO , \
-    __VA_ARGS__ )
+    __VA_ARGS__ ) )
 #define eh_warning(...)  g_log( EH_LOG_DOMAIN ,       \
     G_LOG_LEVEL_WARNING , \
     __VA_ARGS__ )
 #define eh_error(...)    g_log( EH_LOG_DOMAIN ,     \
     G_LOG_LEVEL_ERROR , \
     __VA_ARGS__ )
-#define eh_debug(...)    g_log( EH_LOG_DOMAIN ,     \
+#define eh_debug(...)    EH_LOG_IF_NOT_IGNORED( G_LOG_LEVEL_DEBUG , \
+    g_log( EH_LOG_DOMAIN ,     \
     G_LOG_LEVEL_DEBUG , \
-    __VA_ARGS__ )
-#define eh_data(...)     g_log( EH_LOG_DOMAIN ,     \
+    __VA_ARGS__ ) )
+#define eh_data(...)     EH_LOG_IF_NOT_IGNORED( EH_LOG_LEVEL_DATA , \
+    g_log( EH_LOG_DOMAIN ,     \
     EH_LOG_LEVEL_DATA , \
-    __VA_ARGS__ )
+    __VA_ARGS__ ) )
 #elif defined(G_HAVE_GNUC_VARARGS)
-#define eh_message(format...)  g_log( EH_LOG_DOMAIN ,       \
+#define eh_message(format...)  EH_LOG_IF_NOT_IGNORED( G_LOG_LEVEL_MESSAGE , \
+    g_log( EH_LOG_DOMAIN ,       \
     G_LOG_LEVEL_MESSAGE , \
-    format )
-#define eh_info(format...)     g_log( EH_LOG_DOMAIN ,    \
+    format ) )
+#define eh_info(format...)     EH_LOG_IF_NOT_IGNORED( G_LOG_LEVEL_INFO , \
+    g_log( EH_LOG_DOMAIN ,    \
     G_LOG_LEVEL_INFO , \
-    format )
+    format ) )
 #define eh_warning(format...)  g_log( EH_LOG_DOMAIN ,       \
     G_LOG_LEVEL_WARNING , \
     format )
 #define eh_error(format...)    g_log( EH_LOG_DOMAIN ,     \
     G_LOG_LEVEL_ERROR , \
     format )
-#define eh_debug(format...)    g_log( EH_LOG_DOMAIN ,     \
+#define eh_debug(format...)    EH_LOG_IF_NOT_IGNORED( G_LOG_LEVEL_DEBUG , \
+    g_log( EH_LOG_DOMAIN ,     \
     G_LOG_LEVEL_DEBUG , \
-    format )
-#define eh_data(format...)     g_log( EH_LOG_DOMAIN ,     \
+    format ) )
+#define eh_data(format...)     EH_LOG_IF_NOT_IGNORED( EH_LOG_LEVEL_DATA , \
+    g_log( EH_LOG_DOMAIN ,     \
     EH_LOG_LEVEL_DATA , \
-    format )
+    format ) )
 #else
 static void eh_message(const char* format, ...)
 {
     va_list args;
+
+    if (eh_log_level_is_ignored(G_LOG_LEVEL_MESSAGE)) {
+        return;
+    }
+
     va_start(args, format);
     g_logv(EH_LOG_DOMAIN, G_LOG_LEVEL_MESSAGE, format, args);
     va_end(args);
@@ -126,6 +146,11 @@ static void eh_message(const char* format, ...)
 static void eh_info(const char* format, ...)
 {
     va_list args;
+
+    if (eh_log_level_is_ignored(G_LOG_LEVEL_INFO)) {
+        return;
+    }
+
     va_start(args, format);
     g_logv(EH_LOG_DOMAIN, G_LOG_LEVEL_INFO, format, args);
     va_end(args);
@@ -150,6 +175,11 @@ static void eh_error(const char* format, ...)
 static void eh_debug(const char* format, ...)
 {
     va_list args;
+
+    if (eh_log_level_is_ignored(G_LOG_LEVEL_DEBUG)) {
+        return;
+    }
+
     va_start(args, format);
     g_logv(EH_LOG_DOMAIN, G_LOG_LEVEL_DEBUG, format, args);
     va_end(args);
@@ -158,6 +188,11 @@ static void eh_debug(const char* format, ...)
 static void eh_data(const char* format, ...)
 {
     va_list args;
+
+    if (eh_log_level_is_ignored(EH_LOG_LEVEL_DATA)) {
+        return;
+    }
+
     va_start(args, format);
     g_logv(EH_LOG_DOMAIN, EH_LOG_LEVEL_DATA, format, args);
     va_end(args);
@@ -1465,8 +1465,16 @@ void
 zbesk_(double*, double*, double*, long int*, long int*, double*, double*, long int*,
     long int*);
 
+/** The Kelvin function kei_0 computed from the AMOS complex Bessel routine.
+
+This is slow but accurate and is kept as the reference for eh_kei_0.
+
+@param x A non-negative value
+
+@return kei_0(x)
+*/
 double
-eh_kei_0(double x)
+eh_kei_0_zbesk(double x)
 {
     double n = 0;
     long int n_mem = 1;
@@ -1517,6 +1525,195 @@ eh_kei_0(double x)
     return ans[1];
 }
 
+/* Coefficients of the power series of ber, bei, and the remaining part of
+   kei in powers of (x^2/4)^2 (Abramowitz and Stegun, 9.9.10-9.9.12).
+*/
+#define EH_KEI_0_N_SERIES (14)
+
+static const double _eh_ber_series[EH_KEI_0_N_SERIES] = {
+    1.00000000000000000e+00,
+    -2.50000000000000000e-01,
+    1.73611111111111101e-03,
+    -1.92901234567901239e-06,
+    6.15118732678256523e-10,
+    -7.59405842812662337e-14,
+    4.35838982330499500e-18,
+    -1.31578004567835862e-22,
+    2.28434035708048379e-27,
+    -2.43959626327532528e-32,
+    1.68947109645105643e-37,
+    -7.91528970807826165e-43,
+    2.59769799808281522e-48,
+    -6.14839762859837960e-54
+};
+
+static const double _eh_bei_series[EH_KEI_0_N_SERIES] = {
+    1.00000000000000000e+00,
+    -2.77777777777777762e-02,
+    6.94444444444444444e-05,
+    -3.93675988914084175e-08,
+    7.59405842812662392e-12,
+    -6.27608134555919329e-16,
+    2.57892888952958276e-20,
+    -5.84791131412603850e-25,
+    7.90429189301205402e-30,
+    -6.75788438580422547e-35,
+    3.83100021870987849e-40,
+    -1.49627404689570164e-45,
+    4.15631679693250416e-51,
+    -8.43401595143810599e-57
+};
+
+static const double _eh_kei_series[EH_KEI_0_N_SERIES] = {
+    4.22784335098467134e-01,
+    -3.48921574564389006e-02,
+    1.18480393641097261e-04,
+    -7.93509652130420864e-08,
+    1.70999407270580786e-11,
+    -1.53303434032084727e-15,
+    6.71274065997904724e-20,
+    -1.60292028548964242e-24,
+    2.26247460196977533e-29,
+    -2.00744577048300526e-34,
+    1.17540566567414355e-39,
+    -4.72385065272836096e-45,
+    1.34612399071060454e-50,
+    -2.79523622060601207e-56
+};
+
+/* Real and imaginary parts of the coefficients of the asymptotic expansion of
+   K_0(x e^(i pi/4)) in powers of 1/x (Abramowitz and Stegun, 9.7.2).
+*/
+#define EH_KEI_0_N_ASYMPTOTIC (16)
+
+static const double _eh_kei_asymptotic_re[EH_KEI_0_N_ASYMPTOTIC] = {
+    1.00000000000000000e+00,
+    -8.83883476483184466e-02,
+    0.00000000000000000e+00,
+    5.17900474501865882e-02,
+    -1.12152099609375000e-01,
+    1.60589608070148882e-01,
+    0.00000000000000000e+00,
+    -1.22168783311996831e+00,
+    6.07404200127348304e+00,
+    -1.72396378794761134e+01,
+    0.00000000000000000e+00,
+    3.89853350859442742e+02,
+    -3.03809051092238406e+03,
+    1.29101827051185155e+04,
+    0.00000000000000000e+00,
+    -5.88920461644226569e+05,
+};
+
+static const double _eh_kei_asymptotic_im[EH_KEI_0_N_ASYMPTOTIC] = {
+    0.00000000000000000e+00,
+    8.83883476483184466e-02,
+    -7.03125000000000000e-02,
+    5.17900474501865882e-02,
+    0.00000000000000000e+00,
+    -1.60589608070148882e-01,
+    5.72501420974731445e-01,
+    -1.22168783311996831e+00,
+    0.00000000000000000e+00,
+    1.72396378794761134e+01,
+    -1.10017140269246738e+02,
+    3.89853350859442742e+02,
+    0.00000000000000000e+00,
+    -1.29101827051185155e+04,
+    1.18838426256783248e+05,
+    -5.88920461644226569e+05,
+};
+
+/* Switch from the power series to the asymptotic expansion at this x. */
+#define EH_KEI_0_X_SWITCH (9.)
+
+static double
+_eh_kei_0_series(double x)
+{
+    const double v = .25 * x * x;
+    const double w = v * v;
+    double ber = 0., bei = 0., g = 0.;
+    gint k;
+
+    for (k = EH_KEI_0_N_SERIES - 1; k >= 0; k--) {
+        ber = ber * w + _eh_ber_series[k];
+        bei = bei * w + _eh_bei_series[k];
+        g   = g   * w + _eh_kei_series[k];
+    }
+
+    return -log(.5 * x) * v * bei - M_PI_4 * ber + v * g;
+}
+
+static double
+_eh_kei_0_asymptotic(double x)
+{
+    const double t = 1. / x;
+    const double phi = x * M_SQRT1_2 + M_PI / 8.;
+    double re = 0., im = 0.;
+    gint k;
+
+    for (k = EH_KEI_0_N_ASYMPTOTIC - 1; k >= 0; k--) {
+        re = re * t + _eh_kei_asymptotic_re[k];
+        im = im * t + _eh_kei_asymptotic_im[k];
+    }
+
+    return sqrt(M_PI * .5 * t) * exp(-x * M_SQRT1_2)
+        * (im * cos(phi) - re * sin(phi));
+}
+
+/** The Kelvin function kei_0.
+
+Uses the power series for small x and the asymptotic expansion of
+K_0(x e^(i pi/4)) for large x.  It agrees with eh_kei_0_zbesk to within
+1e-12.
+
+@param x A non-negative value
+
+@return kei_0(x)
+*/
+double
+eh_kei_0(double x)
+{
+    eh_require(x >= 0);
+
+    if (x <= 0.) {
+        return -M_PI_4;
+    } else if (x < EH_KEI_0_X_SWITCH) {
+        return _eh_kei_0_series(x);
+    } else {
+        return _eh_kei_0_asymptotic(x);
+    }
+}
+
+/** Evaluate the Kelvin function kei_0 for an array of values.
+
+@param x   Array of non-negative values
+@param kei Array to put kei_0(x) into (may be x)
+@param len Length of the arrays
+
+@return kei
+*/
+double*
+eh_kei_0_array(const double* x, double* kei, gssize len)
+{
+    gssize i;
+
+    eh_require(x);
+    eh_require(kei);
+
+    for (i = 0; i < len; i++) {
+        const double xi = x[i];
+
+        if (xi < EH_KEI_0_X_SWITCH) {
+            kei[i] = (xi > 0.) ? _eh_kei_0_series(xi) : -M_PI_4;
+        } else {
+            kei[i] = _eh_kei_0_asymptotic(xi);
+        }
+    }
+
+    return kei;
+}
+
 #include <math.h>
 
 /** Inverse error function.
@@ -99,6 +99,8 @@ double* anneal(double* x, int n, Cost_fcn* f, double cost_min);
 double bessel_i_0(double x);
 double bessel_k_0(double x);
 double eh_kei_0(double x);
+double eh_kei_0_zbesk(double x);
+double* eh_kei_0_array(const double* x, double* kei, gssize len);
 
 double eh_erf_inv(double y);
 
@@ -0,0 +1,185 @@
+#include <stdio.h>
+#include <glib.h>
+#include "utils/utils.h"
+#include <eh_utils.h>
+
+#define N_THREADS  (4)
+#define N_MESSAGES (500)
+
+typedef struct {
+    FILE** fp_list;
+    gint   id;
+}
+Log_test_job;
+
+/* Count the lines of a file, and check that each one is a whole message. */
+static gint
+_count_log_lines(const gchar* name)
+{
+    FILE*  fp = fopen(name, "r");
+    gchar* line = NULL;
+    gsize  len = 0;
+    gint   n_lines = 0;
+
+    g_assert_true(fp);
+
+    while (getline(&line, &len, fp) != -1) {
+        gint id, n;
+
+        g_assert_cmpint(sscanf(line, "thread %d message %d", &id, &n), ==, 2);
+        g_assert_cmpint(id, >=, 0);
+        g_assert_cmpint(id, <, N_THREADS);
+        g_assert_cmpint(n, >=, 0);
+        g_assert_cmpint(n, <, N_MESSAGES);
+
+        n_lines++;
+    }
+
+    fclose(fp);
+    g_free(line);
+
+    return n_lines;
+}
+
+static gpointer
+_log_messages(gpointer data)
+{
+    Log_test_job* job = (Log_test_job*)data;
+    gint n;
+
+    for (n = 0 ; n < N_MESSAGES ; n++) {
+        gchar* message = g_strdup_printf("thread %d message %d", job->id, n);
+
+        eh_logger(NULL, G_LOG_LEVEL_MESSAGE, message, job->fp_list);
+
+        g_free(message);
+    }
+
+    return NULL;
+}
+
+/* Log from a number of threads and, if asked, turn the writer thread on and
+   off while they do.  Return the number of lines that were written. */
+static gint
+_log_from_threads(gboolean toggle)
+{
+    gchar* name = NULL;
+    FILE*  fp = eh_open_temp_file(NULL, &name);
+    FILE*  fp_list[2] = { fp, NULL };
+    GThread* threads[N_THREADS];
+    Log_test_job jobs[N_THREADS];
+    gint i, n_lines;
+
+    g_assert_true(fp);
+
+    eh_set_log_async(TRUE);
+
+    for (i = 0 ; i < N_THREADS ; i++) {
+        jobs[i].fp_list = fp_list;
+        jobs[i].id      = i;
+        threads[i] = g_thread_create(_log_messages, jobs + i, TRUE, NULL);
+        g_assert_true(threads[i]);
+    }
+
+    if (toggle) {
+        for (i = 0 ; i < 50 ; i++) {
+            eh_set_log_async(i % 2 == 1);
+        }
+    }
+
+    for (i = 0 ; i < N_THREADS ; i++) {
+        g_thread_join(threads[i]);
+    }
+
+    eh_set_log_async(FALSE);
+    g_assert_true(!eh_log_is_async());
+
+    fclose(fp);
+
+    n_lines = _count_log_lines(name);
+
+    remove(name);
+    g_free(name);
+
+    return n_lines;
+}
+
+void
+test_log_async(void)
+{
+    g_assert_cmpint(_log_from_threads(FALSE), ==, N_THREADS * N_MESSAGES);
+}
+
+void
+test_log_async_toggle(void)
+{
+    g_assert_cmpint(_log_from_threads(TRUE), ==, N_THREADS * N_MESSAGES);
+}
+
+static gint
+_count_call(gint* count)
+{
+    (*count)++;
+    return *count;
+}
+
+void
+test_log_if_not_ignored(void)
+{
+    gchar* name = NULL;
+    FILE*  fp = eh_open_temp_file(NULL, &name);
+    FILE*  fp_list[2] = { fp, NULL };
+    gint   count = 0;
+    guint  id;
+
+    g_assert_true(fp);
+
+    id = g_log_set_handler(EH_LOG_DOMAIN, G_LOG_LEVEL_MASK, eh_logger, fp_list);
+
+    eh_message("count %d", _count_call(&count));
+    g_assert_cmpint(count, ==, 1);
+
+    // Ignored log levels can't be unset, so this must be the last test.
+    eh_set_ignore_log_level(G_LOG_LEVEL_MESSAGE);
+    g_assert_true(eh_log_level_is_ignored(G_LOG_LEVEL_MESSAGE));
+    g_assert_true(!eh_log_level_is_ignored(G_LOG_LEVEL_INFO));
+
+    eh_message("count %d", _count_call(&count));
+    g_assert_cmpint(count, ==, 1);
+
+    eh_info("count %d", _count_call(&count));
+    g_assert_cmpint(count, ==, 2);
+
+    g_log_remove_handler(EH_LOG_DOMAIN, id);
+    fclose(fp);
+
+    {
+        gchar* contents = NULL;
+
+        g_assert_true(g_file_get_contents(name, &contents, NULL, NULL));
+        g_assert_cmpstr(contents, ==, "count 1\ncount 2\n");
+
+        g_free(contents);
+    }
+
+    remove(name);
+    g_free(name);
+}
+
+int
+main(int argc, char* argv[])
+{
+    eh_init_glib();
+
+    if (!g_thread_supported()) {
+        g_thread_init(NULL);
+    }
+
+    g_test_init(&argc, &argv, NULL);
+
+    g_test_add_func("/utils/logging/async", &test_log_async);
+    g_test_add_func("/utils/logging/async_toggle", &test_log_async_toggle);
+    g_test_add_func("/utils/logging/if_not_ignored", &test_log_if_not_ignored);
+
+    g_test_run();
+}
@@ -852,6 +852,38 @@ test_convolve(void)
     //   eh_dbl_array_fprint( stdout , z , len_x );
 }
 
+void
+test_kei_0(void)
+{
+    // Flexure evaluates kei_0 at r/alpha for every pair of nodes.  Cover the
+    // range where the deflection is significant and beyond.
+    const gssize len = 200000;
+    const double dx  = 1e-3;
+    double* x   = eh_new(double, len);
+    double* kei = eh_new(double, len);
+    gssize i;
+
+    for (i = 0 ; i < len ; i++) {
+        x[i] = i * dx;
+    }
+
+    eh_kei_0_array(x, kei, len);
+
+    for (i = 0 ; i < len ; i++) {
+        const double ref = eh_kei_0_zbesk(x[i]);
+        const double env = (x[i] > 1.) ? sqrt(M_PI / (2.*x[i])) * exp(-x[i] * M_SQRT1_2) : 1.;
+
+        g_assert_cmpfloat(fabs(kei[i] - ref), <, 1e-10);
+        g_assert_cmpfloat(fabs(kei[i] - ref) / env, <, 1e-8);
+        g_assert_cmpfloat(eh_kei_0(x[i]), ==, kei[i]);
+    }
+
+    g_assert_cmpfloat(eh_kei_0(0.), ==, -M_PI / 4.);
+
+    eh_free(kei);
+    eh_free(x);
+}
+
 int
 main(int argc, char* argv[])
 {
@@ -874,6 +906,7 @@ main(int argc, char* argv[])
     g_test_add_func("/utils/num/core/convolve", &test_convolve);
     g_test_add_func("/utils/num/core/running_mean", &test_running_mean);
     g_test_add_func("/utils/num/core/rebin", &test_rebin);
+    g_test_add_func("/utils/num/core/kei_0", &test_kei_0);
 
     g_test_add_func("/utils/num/gamma/p", &test_gamma_p);
     g_test_add_func("/utils/num/gamma/q", &test_gamma_q);